@@ -47,6 +47,7 @@ if(USE_FFTWD OR USE_FFTWF)
       set(FFTWD_FOUND 1)
       if(FFTWD_THREADS_LIB)
         set(FFTWD_LIB ${FFTWD_LIB} ${FFTWD_THREADS_LIB} )
+        set(USE_FFTWD_THREADS 1)
       endif(FFTWD_THREADS_LIB)
     endif(FFTWD_LIB)
   endif(USE_FFTWD)
@@ -61,6 +62,7 @@ if(USE_FFTWD OR USE_FFTWF)
       set(FFTWF_FOUND 1)
       if(FFTWF_THREADS_LIB)
         set(FFTWF_LIB ${FFTWF_LIB} ${FFTWF_THREADS_LIB} )
+        set(USE_FFTWF_THREADS 1)
       endif(FFTWF_THREADS_LIB)
     endif(FFTWF_LIB)
   endif(USE_FFTWF)
@@ -48,6 +48,10 @@ namespace itk
  * of the filter, since wave propagation does not take place on the complete
  * image.
  *
+ * If UseFastIterativeMethod is On, the arrival times of both fronts are
+ * computed with the multi-threaded fast iterative method of
+ * FastMarchingImageFilter instead of fast marching.
+ *
  * Optionally, a connectivity criterion can be applied to the resulting dot
  * product image. In this case, the only negative region in the output image is
  * the one connected to the seeds.
@@ -145,6 +149,10 @@ public:
   itkGetConstMacro(StopOnTargets, bool);
   itkBooleanMacro(StopOnTargets);
 
+  itkSetMacro(UseFastIterativeMethod, bool);
+  itkGetConstMacro(UseFastIterativeMethod, bool);
+  itkBooleanMacro(UseFastIterativeMethod);
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro( InputHasNumericTraitsCheck,
@@ -167,6 +175,7 @@ private:
 
   bool m_StopOnTargets;
   bool m_ApplyConnectivity;
+  bool m_UseFastIterativeMethod;
 
   double m_NegativeEpsilon;
 };
@@ -33,6 +33,7 @@ CollidingFrontsImageFilter< TInputImage, TOutputImage >
   m_SeedPoints2 = NULL;
   m_StopOnTargets = false;
   m_ApplyConnectivity = true;
+  m_UseFastIterativeMethod = false;
   m_NegativeEpsilon = -1E-6;
 }
 
@@ -51,6 +52,7 @@ CollidingFrontsImageFilter< TInputImage, TOutputImage >
   fastMarchingFilter1->SetOutputSpacing( this->GetInput()->GetSpacing() );
   fastMarchingFilter1->SetOutputDirection( this->GetInput()->GetDirection() );
   fastMarchingFilter1->GenerateGradientImageOn();
+  fastMarchingFilter1->SetUseFastIterativeMethod(m_UseFastIterativeMethod);
   if ( m_StopOnTargets )
     {
     fastMarchingFilter1->SetTargetReachedModeToAllTargets();
@@ -71,6 +73,7 @@ CollidingFrontsImageFilter< TInputImage, TOutputImage >
   fastMarchingFilter2->SetOutputSpacing( this->GetInput()->GetSpacing() );
   fastMarchingFilter2->SetOutputDirection( this->GetInput()->GetDirection() );
   fastMarchingFilter2->GenerateGradientImageOn();
+  fastMarchingFilter2->SetUseFastIterativeMethod(m_UseFastIterativeMethod);
   if ( m_StopOnTargets )
     {
     fastMarchingFilter2->SetTargetReachedModeToAllTargets();
@@ -159,6 +162,7 @@ CollidingFrontsImageFilter< TInputImage, TOutputImage >
   os << indent << "SeedPoints2: " << m_SeedPoints2.GetPointer() << std::endl;
   os << indent << "NegativeEpsilon: " << m_NegativeEpsilon << std::endl;
   os << indent << "StopOnTargets: " << m_StopOnTargets << std::endl;
+  os << indent << "UseFastIterativeMethod: " << m_UseFastIterativeMethod << std::endl;
 }
 } // end namespace itk
 
@@ -18,10 +18,17 @@
 #ifndef __itkFFTWCommon_h
 #define __itkFFTWCommon_h
 
+#include "itkFFTWGlobalConfiguration.h"
+#include "itkSimpleFastMutexLock.h"
+
 #if defined( USE_FFTWF ) || defined( USE_FFTWD )
 #include "fftw3.h"
 #endif
 
+#include <cstdio>
+#include <map>
+#include <vector>
+
 namespace itk
 {
 namespace fftw
@@ -130,6 +137,70 @@ public:
   {
     fftwf_destroy_plan(p);
   }
+
+  static PlanType Plan_dft(int rank,
+                           const int *n,
+                           ComplexType *in,
+                           ComplexType *out,
+                           int sign,
+                           unsigned flags)
+  {
+    return fftwf_plan_dft(rank, n, in, out, sign, flags);
+  }
+
+  static void Execute_dft_r2c(PlanType p, PixelType *in, ComplexType *out)
+  {
+    fftwf_execute_dft_r2c(p, in, out);
+  }
+
+  static void Execute_dft_c2r(PlanType p, ComplexType *in, PixelType *out)
+  {
+    fftwf_execute_dft_c2r(p, in, out);
+  }
+
+  static void Execute_dft(PlanType p, ComplexType *in, ComplexType *out)
+  {
+    fftwf_execute_dft(p, in, out);
+  }
+
+  static void * Malloc(size_t n)
+  {
+    return fftwf_malloc(n);
+  }
+
+  static void Free(void *p)
+  {
+    fftwf_free(p);
+  }
+
+  /** Whether the plans can use several threads. */
+  static bool InitThreads()
+  {
+#if defined( USE_FFTWF_THREADS )
+    return fftwf_init_threads() != 0;
+#else
+    return false;
+#endif
+  }
+
+  static void PlanWithNThreads(int numberOfThreads)
+  {
+#if defined( USE_FFTWF_THREADS )
+    fftwf_plan_with_nthreads(numberOfThreads);
+#else
+    (void)numberOfThreads;
+#endif
+  }
+
+  static bool ImportWisdomFromFile(FILE *file)
+  {
+    return fftwf_import_wisdom_from_file(file) != 0;
+  }
+
+  static void ExportWisdomToFile(FILE *file)
+  {
+    fftwf_export_wisdom_to_file(file);
+  }
 };
 #endif // USE_FFTWF
 #if defined( USE_FFTWD )
@@ -222,8 +293,256 @@ public:
   {
     fftw_destroy_plan(p);
   }
+
+  static PlanType Plan_dft(int rank,
+                           const int *n,
+                           ComplexType *in,
+                           ComplexType *out,
+                           int sign,
+                           unsigned flags)
+  {
+    return fftw_plan_dft(rank, n, in, out, sign, flags);
+  }
+
+  static void Execute_dft_r2c(PlanType p, PixelType *in, ComplexType *out)
+  {
+    fftw_execute_dft_r2c(p, in, out);
+  }
+
+  static void Execute_dft_c2r(PlanType p, ComplexType *in, PixelType *out)
+  {
+    fftw_execute_dft_c2r(p, in, out);
+  }
+
+  static void Execute_dft(PlanType p, ComplexType *in, ComplexType *out)
+  {
+    fftw_execute_dft(p, in, out);
+  }
+
+  static void * Malloc(size_t n)
+  {
+    return fftw_malloc(n);
+  }
+
+  static void Free(void *p)
+  {
+    fftw_free(p);
+  }
+
+  /** Whether the plans can use several threads. */
+  static bool InitThreads()
+  {
+#if defined( USE_FFTWD_THREADS )
+    return fftw_init_threads() != 0;
+#else
+    return false;
+#endif
+  }
+
+  static void PlanWithNThreads(int numberOfThreads)
+  {
+#if defined( USE_FFTWD_THREADS )
+    fftw_plan_with_nthreads(numberOfThreads);
+#else
+    (void)numberOfThreads;
+#endif
+  }
+
+  static bool ImportWisdomFromFile(FILE *file)
+  {
+    return fftw_import_wisdom_from_file(file) != 0;
+  }
+
+  static void ExportWisdomToFile(FILE *file)
+  {
+    fftw_export_wisdom_to_file(file);
+  }
 };
 #endif
+
+#if defined( USE_FFTWF ) || defined( USE_FFTWD )
+/**
+ * \class PlanCache
+ * \brief Plans shared by the FFTW image filters of a pixel type
+ *
+ * A plan is computed the first time a kind of transform is requested for
+ * a size and a number of threads, with the rigor set in
+ * FFTWGlobalConfiguration, and it is kept until the end of the process.
+ * The plans are computed on scratch buffers with FFTW_UNALIGNED, so they
+ * apply to the buffers of any image through the new array execute
+ * functions of the Proxy.  The FFTW planner is not thread safe, so the
+ * plans are computed under a lock; executing them is safe from any
+ * thread.
+ */
+template< typename TPixel >
+class PlanCache
+{
+public:
+  typedef Proxy< TPixel >                 ProxyType;
+  typedef typename ProxyType::PixelType   PixelType;
+  typedef typename ProxyType::ComplexType ComplexType;
+  typedef typename ProxyType::PlanType    PlanType;
+
+  /** Kinds of transforms. The complex to complex ones are named after the
+   * sign of FFTW_FORWARD and FFTW_BACKWARD. */
+  enum {
+    RealToComplex = 0,
+    ComplexToReal = 1,
+    ComplexToComplexForward = 2,
+    ComplexToComplexBackward = 3
+    };
+
+  /** Plan of the transform of an image of the given size, the fastest
+   * dimension first.  For the real transforms, size is the size of the
+   * real image. */
+  static PlanType GetPlan(int kind, unsigned int dimension,
+                          const unsigned long *size, int numberOfThreads)
+  {
+    KeyType key;
+
+    key.Kind = kind;
+    key.Rigor = FFTWGlobalConfiguration::GetPlanRigor();
+    // FFTW lists the slowest dimension first
+    for ( unsigned int i = 0; i < dimension; i++ )
+      {
+      key.Size.push_back( static_cast< int >( size[dimension - 1 - i] ) );
+      }
+
+    m_Lock.Lock();
+
+    if ( m_ThreadsSupported < 0 )
+      {
+      m_ThreadsSupported = ProxyType::InitThreads() ? 1 : 0;
+      }
+    key.NumberOfThreads = ( m_ThreadsSupported && numberOfThreads > 1 ) ? numberOfThreads : 1;
+
+    typename MapType::const_iterator it = m_Plans.find(key);
+    if ( it != m_Plans.end() )
+      {
+      const PlanType plan = it->second;
+      m_Lock.Unlock();
+      return plan;
+      }
+
+    const std::string wisdomFileName = FFTWGlobalConfiguration::GetWisdomFileName();
+    if ( !wisdomFileName.empty() && wisdomFileName != m_ImportedWisdomFileName )
+      {
+      FILE *file = fopen(wisdomFileName.c_str(), "r");
+      if ( file )
+        {
+        ProxyType::ImportWisdomFromFile(file);
+        fclose(file);
+        }
+      m_ImportedWisdomFileName = wisdomFileName;
+      }
+
+    const PlanType plan = CreatePlan(key);
+    m_Plans[key] = plan;
+
+    if ( !wisdomFileName.empty() && !( key.Rigor & FFTW_ESTIMATE ) )
+      {
+      FILE *file = fopen(wisdomFileName.c_str(), "w");
+      if ( file )
+        {
+        ProxyType::ExportWisdomToFile(file);
+        fclose(file);
+        }
+      }
+
+    m_Lock.Unlock();
+    return plan;
+  }
+
+private:
+  struct KeyType {
+    int                Kind;
+    unsigned int       Rigor;
+    int                NumberOfThreads;
+    std::vector< int > Size;
+
+    bool operator<(const KeyType & other) const
+    {
+      if ( Kind != other.Kind ) { return Kind < other.Kind; }
+      if ( Rigor != other.Rigor ) { return Rigor < other.Rigor; }
+      if ( NumberOfThreads != other.NumberOfThreads ) { return NumberOfThreads < other.NumberOfThreads; }
+      return Size < other.Size;
+    }
+  };
+
+  typedef std::map< KeyType, PlanType > MapType;
+
+  static PlanType CreatePlan(const KeyType & key)
+  {
+    const int          rank = static_cast< int >( key.Size.size() );
+    const bool         real = ( key.Kind == RealToComplex || key.Kind == ComplexToReal );
+    unsigned long      realSize = 1;
+    unsigned long      complexSize = 1;
+    for ( int i = 0; i < rank; i++ )
+      {
+      realSize *= key.Size[i];
+      complexSize *= ( real && i == rank - 1 ) ? key.Size[i] / 2 + 1 : key.Size[i];
+      }
+
+    // the scratch buffers may be overwritten by the planner
+    PixelType *  realBuffer = 0;
+    ComplexType *complexBuffer =
+      static_cast< ComplexType * >( ProxyType::Malloc( sizeof( ComplexType ) * complexSize ) );
+    ComplexType *complexOutputBuffer = 0;
+    if ( real )
+      {
+      realBuffer = static_cast< PixelType * >( ProxyType::Malloc( sizeof( PixelType ) * realSize ) );
+      }
+    else
+      {
+      complexOutputBuffer =
+        static_cast< ComplexType * >( ProxyType::Malloc( sizeof( ComplexType ) * complexSize ) );
+      }
+
+    ProxyType::PlanWithNThreads(key.NumberOfThreads);
+    const unsigned flags = key.Rigor | FFTW_UNALIGNED;
+    PlanType       plan;
+    switch ( key.Kind )
+      {
+      case RealToComplex:
+        plan = ProxyType::Plan_dft_r2c(rank, &key.Size[0], realBuffer, complexBuffer, flags);
+        break;
+      case ComplexToReal:
+        plan = ProxyType::Plan_dft_c2r(rank, &key.Size[0], complexBuffer, realBuffer, flags);
+        break;
+      case ComplexToComplexForward:
+        plan = ProxyType::Plan_dft(rank, &key.Size[0], complexBuffer, complexOutputBuffer,
+                                   FFTW_FORWARD, flags);
+        break;
+      default:
+        plan = ProxyType::Plan_dft(rank, &key.Size[0], complexBuffer, complexOutputBuffer,
+                                   FFTW_BACKWARD, flags);
+        break;
+      }
+
+    ProxyType::Free(complexBuffer);
+    ProxyType::Free(realBuffer);
+    ProxyType::Free(complexOutputBuffer);
+    return plan;
+  }
+
+  static SimpleFastMutexLock m_Lock;
+  static MapType             m_Plans;
+  static int                 m_ThreadsSupported;
+  static std::string         m_ImportedWisdomFileName;
+};
+
+template< typename TPixel >
+SimpleFastMutexLock PlanCache< TPixel >::m_Lock;
+
+template< typename TPixel >
+typename PlanCache< TPixel >::MapType PlanCache< TPixel >::m_Plans;
+
+template< typename TPixel >
+int PlanCache< TPixel >::m_ThreadsSupported = -1;
+
+template< typename TPixel >
+std::string PlanCache< TPixel >::m_ImportedWisdomFileName;
+#endif
 }
 }
 #endif
@@ -24,7 +24,11 @@
 namespace itk
 {
 /** \class FFTWComplexConjugateToRealImageFilter
- * \brief TODO
+ * \brief Inverse Fourier transform of a complex conjugate image with FFTW.
+ *
+ * The plans come from fftw::PlanCache and are shared with the other
+ * filters of the same size.  FFTW overwrites the input of a complex to
+ * real transform, so the input is copied before the transform.
  *
  * \ingroup FourierTransform
  */
@@ -50,6 +54,7 @@ public:
    * configured in, or float if only double is configured.
    */
   typedef typename fftw::Proxy< TPixel > FFTWProxyType;
+  typedef fftw::PlanCache< TPixel >      FFTWPlanCacheType;
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
@@ -69,21 +74,8 @@ public:
   virtual bool FullMatrix();
 
 protected:
-  FFTWComplexConjugateToRealImageFilter():m_PlanComputed(false),
-    m_LastImageSize(0),
-    m_InputBuffer(0),
-    m_OutputBuffer(0)
-  {}
-
-  virtual ~FFTWComplexConjugateToRealImageFilter()
-  {
-    if ( m_PlanComputed )
-      {
-      FFTWProxyType::DestroyPlan(m_Plan);
-      delete[] m_InputBuffer;
-      delete[] m_OutputBuffer;
-      }
-  }
+  FFTWComplexConjugateToRealImageFilter() {}
+  virtual ~FFTWComplexConjugateToRealImageFilter() {}
 
 private:
   FFTWComplexConjugateToRealImageFilter(const Self &); //purposely not
@@ -91,17 +83,6 @@ private:
   void operator=(const Self &);                        //purposely not
 
   // implemented
-
-  bool m_PlanComputed;
-
-  typename FFTWProxyType::PlanType m_Plan;
-
-  unsigned int m_LastImageSize;
-
-  // local storage needed to keep fftw from scribbling on
-  typename FFTWProxyType::ComplexType * m_InputBuffer;
-
-  TPixel *m_OutputBuffer;
 };
 } // namespace itk
 
@@ -25,6 +25,7 @@
 #include "itkMetaDataObject.h"
 #include "itkImageRegionIterator.h"
 #include "itkProgressReporter.h"
+#include <vector>
 
 namespace itk
 {
@@ -68,65 +69,21 @@ FFTWComplexConjugateToRealImageFilter< TPixel, VDimension >::GenerateData()
     total_inputSize *= inputSize[i];
     }
 
-  if ( this->m_PlanComputed )            // if we've already computed a plan
+  unsigned long sizes[VDimension];
+  for ( unsigned int i = 0; i < VDimension; i++ )
     {
-    // if the image sizes aren't the same,
-    // we have to compute the plan again
-    if ( this->m_LastImageSize != total_outputSize )
-      {
-      delete[] this->m_InputBuffer;
-      delete[] this->m_OutputBuffer;
-      FFTWProxyType::DestroyPlan(this->m_Plan);
-      this->m_PlanComputed = false;
-      }
+    sizes[i] = outputSize[i];
     }
-  // either plan never computed, or need to re-compute
-  if ( !this->m_PlanComputed )
-    {
-    // if we've never computed the plan, or we need to redo it
-    this->m_InputBuffer = new typename FFTWProxyType::ComplexType[total_inputSize];
-    this->m_OutputBuffer = new TPixel[total_outputSize];
-    this->m_LastImageSize = total_outputSize;
+  typename FFTWProxyType::PlanType plan =
+    FFTWPlanCacheType::GetPlan(FFTWPlanCacheType::ComplexToReal, VDimension,
+                               sizes, this->GetNumberOfThreads());
 
-    switch ( VDimension )
-      {
-      case 1:
-        this->m_Plan = FFTWProxyType::Plan_dft_c2r_1d(outputSize[0],
-                                                      this->m_InputBuffer, this->m_OutputBuffer,
-                                                      FFTW_ESTIMATE);
-        break;
-      case 2:
-        this->m_Plan = FFTWProxyType::Plan_dft_c2r_2d(outputSize[1], outputSize[0],
-                                                      this->m_InputBuffer, this->m_OutputBuffer,
-                                                      FFTW_ESTIMATE);
-        break;
-      case 3:
-        this->m_Plan = FFTWProxyType::Plan_dft_c2r_3d(outputSize[2], outputSize[1], outputSize[0],
-                                                      this->m_InputBuffer, this->m_OutputBuffer,
-                                                      FFTW_ESTIMATE);
-        break;
-      default:
-        int *sizes = new int[VDimension];
-        for ( unsigned int i = 0; i < VDimension; i++ )
-          {
-          sizes[( VDimension - 1 ) - i] = outputSize[i];
-          }
-        this->m_Plan = FFTWProxyType::Plan_dft_c2r(VDimension, sizes,
-                                                   this->m_InputBuffer,
-                                                   this->m_OutputBuffer, FFTW_ESTIMATE);
-        delete[] sizes;
-      }
-    this->m_PlanComputed = true;
-    }
-  // copy the input, because it may be destroyed by computing the plan
-  memcpy( this->m_InputBuffer,
-          inputPtr->GetBufferPointer(),
-          total_inputSize * sizeof( typename FFTWProxyType::ComplexType ) );
-  fftw::Proxy< TPixel >::Execute(this->m_Plan);
-  // copy the output
-  memcpy( outputPtr->GetBufferPointer(),
-          this->m_OutputBuffer,
-          total_outputSize * sizeof( TPixel ) );
+  // copy the input, because the transform destroys it
+  std::vector< std::complex< TPixel > > inputBuffer( inputPtr->GetBufferPointer(),
+                                                     inputPtr->GetBufferPointer() + total_inputSize );
+  FFTWProxyType::Execute_dft_c2r( plan,
+                                  reinterpret_cast< typename FFTWProxyType::ComplexType * >( &inputBuffer[0] ),
+                                  outputPtr->GetBufferPointer() );
 
   typedef ImageRegionIterator< TOutputImageType > IteratorType;
 
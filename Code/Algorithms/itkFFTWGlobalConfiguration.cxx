@@ -0,0 +1,57 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkFFTWGlobalConfiguration.h"
+#include "itkFFTWCommon.h"
+
+namespace itk
+{
+#if defined( USE_FFTWF ) || defined( USE_FFTWD )
+unsigned int FFTWGlobalConfiguration::m_PlanRigor = FFTW_ESTIMATE;
+#else
+unsigned int FFTWGlobalConfiguration::m_PlanRigor = 0;
+#endif
+std::string FFTWGlobalConfiguration::m_WisdomFileName;
+
+void
+FFTWGlobalConfiguration
+::SetPlanRigor(unsigned int rigor)
+{
+  m_PlanRigor = rigor;
+}
+
+unsigned int
+FFTWGlobalConfiguration
+::GetPlanRigor()
+{
+  return m_PlanRigor;
+}
+
+void
+FFTWGlobalConfiguration
+::SetWisdomFileName(const std::string & fileName)
+{
+  m_WisdomFileName = fileName;
+}
+
+std::string
+FFTWGlobalConfiguration
+::GetWisdomFileName()
+{
+  return m_WisdomFileName;
+}
+} // end namespace itk
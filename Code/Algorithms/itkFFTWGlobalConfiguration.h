@@ -0,0 +1,65 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkFFTWGlobalConfiguration_h
+#define __itkFFTWGlobalConfiguration_h
+
+#include "itkMacro.h"
+#include <string>
+
+namespace itk
+{
+/** \class FFTWGlobalConfiguration
+ * \brief Process wide settings of the FFTW image filters.
+ *
+ * The FFTW filters share their plans through fftw::PlanCache, which
+ * computes each plan once per size, kind of transform and number of
+ * threads.  PlanRigor is the FFTW planner flag used for the new plans:
+ * FFTW_ESTIMATE, the default, picks a plan at once, while FFTW_MEASURE,
+ * FFTW_PATIENT and FFTW_EXHAUSTIVE time more and more candidates.  The
+ * slower planners pay off when many images of the same size are
+ * transformed.
+ *
+ * The timings can be kept across processes in a wisdom file.  When
+ * WisdomFileName is set, the file is read before the next plan is
+ * computed, and it is rewritten after each new plan that is not
+ * estimated.
+ *
+ * \ingroup FourierTransform
+ */
+class ITKAlgorithms_EXPORT FFTWGlobalConfiguration
+{
+public:
+  /** FFTW planner flag of the new plans. */
+  static void SetPlanRigor(unsigned int rigor);
+  static unsigned int GetPlanRigor();
+
+  /** File that keeps the FFTW wisdom; empty, the default, for none. */
+  static void SetWisdomFileName(const std::string & fileName);
+  static std::string GetWisdomFileName();
+
+private:
+  FFTWGlobalConfiguration();                            //purposely not implemented
+  FFTWGlobalConfiguration(const FFTWGlobalConfiguration &); //purposely not implemented
+  void operator=(const FFTWGlobalConfiguration &);      //purposely not implemented
+
+  static unsigned int m_PlanRigor;
+  static std::string  m_WisdomFileName;
+};
+} // end namespace itk
+
+#endif
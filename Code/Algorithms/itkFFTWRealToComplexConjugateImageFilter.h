@@ -24,7 +24,12 @@
 namespace itk
 {
 /** \class FFTWRealToComplexConjugateImageFilter
- * \brief TODO
+ * \brief Fourier transform of a real image with FFTW.
+ *
+ * The plans come from fftw::PlanCache, so the filters of an image size
+ * share one plan per number of threads, computed with the rigor of
+ * FFTWGlobalConfiguration.  The transform runs on the buffers of the
+ * images, with the number of threads of the filter.
  *
  * \ingroup FourierTransform
  */
@@ -50,6 +55,7 @@ public:
    * configured in, or float if only double is configured.
    */
   typedef typename fftw::Proxy< TPixel > FFTWProxyType;
+  typedef fftw::PlanCache< TPixel >      FFTWPlanCacheType;
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
@@ -63,21 +69,8 @@ public:
   virtual void GenerateData();  // generates output from input
 
 protected:
-  FFTWRealToComplexConjugateImageFilter():m_PlanComputed(false),
-    m_LastImageSize(0),
-    m_InputBuffer(0),
-    m_OutputBuffer(0)
-  {}
-
-  ~FFTWRealToComplexConjugateImageFilter()
-  {
-    if ( m_PlanComputed )
-      {
-      FFTWProxyType::DestroyPlan(this->m_Plan);
-      delete[] this->m_InputBuffer;
-      delete[] this->m_OutputBuffer;
-      }
-  }
+  FFTWRealToComplexConjugateImageFilter() {}
+  ~FFTWRealToComplexConjugateImageFilter() {}
 
   virtual bool FullMatrix();
 
@@ -87,16 +80,6 @@ private:
   void operator=(const Self &);                        //purposely not
 
   // implemented
-
-  bool m_PlanComputed;
-
-  typename FFTWProxyType::PlanType m_Plan;
-
-  unsigned int m_LastImageSize;
-
-  TPixel *m_InputBuffer;
-
-  typename FFTWProxyType::ComplexType * m_OutputBuffer;
 };
 } // namespace itk
 
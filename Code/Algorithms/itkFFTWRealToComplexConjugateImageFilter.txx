@@ -53,88 +53,23 @@ FFTWRealToComplexConjugateImageFilter< TPixel, VDimension >::GenerateData()
   outputPtr->SetBufferedRegion( outputPtr->GetRequestedRegion() );
   outputPtr->Allocate();
 
-  const typename TInputImageType::SizeType &   inputSize =
+  const typename TInputImageType::SizeType & inputSize =
     inputPtr->GetLargestPossibleRegion().GetSize();
-  const typename TOutputImageType::SizeType &   outputSize =
-    outputPtr->GetLargestPossibleRegion().GetSize();
 
-  // figure out sizes
-  // size of input and output aren't the same which is handled in the
-  // superclass,
-  // sort of.
-  // the input size and output size only differ in the fastest moving dimension
-  unsigned int total_inputSize = 1;
-  unsigned int total_outputSize = 1;
-
-  for ( unsigned i = 0; i < VDimension; i++ )
-    {
-    total_inputSize *= inputSize[i];
-    total_outputSize *= outputSize[i];
-    }
-
-  if ( this->m_PlanComputed )            // if we've already computed a plan
+  unsigned long sizes[VDimension];
+  for ( unsigned int i = 0; i < VDimension; i++ )
     {
-    // if the image sizes aren't the same,
-    // we have to compute the plan again
-    if ( this->m_LastImageSize != total_inputSize )
-      {
-      delete[] this->m_InputBuffer;
-      delete[] this->m_OutputBuffer;
-      FFTWProxyType::DestroyPlan(this->m_Plan);
-      this->m_PlanComputed = false;
-      }
+    sizes[i] = inputSize[i];
     }
-  if ( !this->m_PlanComputed )
-    {
-    this->m_InputBuffer = new TPixel[total_inputSize];
-    this->m_OutputBuffer =
-      new typename FFTWProxyType::ComplexType[total_outputSize];
-    this->m_LastImageSize = total_inputSize;
-    switch ( VDimension )
-      {
-      case 1:
-        this->m_Plan = FFTWProxyType::Plan_dft_r2c_1d(inputSize[0],
-                                                      this->m_InputBuffer,
-                                                      this->m_OutputBuffer,
-                                                      FFTW_ESTIMATE);
-        break;
-      case 2:
-        this->m_Plan = FFTWProxyType::Plan_dft_r2c_2d(inputSize[1],
-                                                      inputSize[0],
-                                                      this->m_InputBuffer,
-                                                      this->m_OutputBuffer,
-                                                      FFTW_ESTIMATE);
-        break;
-      case 3:
-        this->m_Plan = FFTWProxyType::Plan_dft_r2c_3d(inputSize[2],
-                                                      inputSize[1],
-                                                      inputSize[0],
-                                                      this->m_InputBuffer,
-                                                      this->m_OutputBuffer,
-                                                      FFTW_ESTIMATE);
-        break;
-      default:
-        int *sizes = new int[VDimension];
-        for ( unsigned int i = 0; i < VDimension; i++ )
-          {
-          sizes[( VDimension - 1 ) - i] = inputSize[i];
-          }
+  typename FFTWProxyType::PlanType plan =
+    FFTWPlanCacheType::GetPlan(FFTWPlanCacheType::RealToComplex, VDimension,
+                               sizes, this->GetNumberOfThreads());
 
-        this->m_Plan = FFTWProxyType::Plan_dft_r2c(VDimension, sizes,
-                                                   this->m_InputBuffer,
-                                                   this->m_OutputBuffer,
-                                                   FFTW_ESTIMATE);
-        delete[] sizes;
-      }
-    this->m_PlanComputed = true;
-    }
-  memcpy( this->m_InputBuffer,
-          inputPtr->GetBufferPointer(),
-          total_inputSize * sizeof( TPixel ) );
-  FFTWProxyType::Execute(this->m_Plan);
-  memcpy( outputPtr->GetBufferPointer(),
-          this->m_OutputBuffer,
-          total_outputSize * sizeof( typename FFTWProxyType::ComplexType ) );
+  // the plan does not write to its input
+  FFTWProxyType::Execute_dft_r2c( plan,
+                                  const_cast< TPixel * >( inputPtr->GetBufferPointer() ),
+                                  reinterpret_cast< typename FFTWProxyType::ComplexType * >(
+                                    outputPtr->GetBufferPointer() ) );
 }
 
 template< typename TPixel, unsigned int VDimension >
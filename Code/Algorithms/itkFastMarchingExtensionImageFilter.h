@@ -42,6 +42,10 @@ namespace itk
  * "Level Set Methods and Fast Marching Methods", J.A. Sethian,
  * Cambridge Press, Second edition, 1999.
  *
+ * The auxiliary values are extended from the points used to compute each
+ * arrival time, so they require the points to be made alive in order.
+ * UseFastIterativeMethod is therefore ignored by this class.
+ *
  * \sa FastMarchingImageFilter
  * \sa LevelSetTypeDefault
  * \sa AuxVarTypeDefault
@@ -137,6 +141,10 @@ protected:
   virtual double UpdateValue(const IndexType & index,
                              const SpeedImageType *speed, LevelSetImageType *output);
 
+  /** The auxiliary values are only extended by fast marching. */
+  virtual bool CanUseFastIterativeMethod() const
+  { return false; }
+
   /** Generate the output image meta information */
   virtual void GenerateOutputInformation();
 
@@ -22,8 +22,7 @@
 #include "itkLevelSet.h"
 #include "vnl/vnl_math.h"
 
-#include <functional>
-#include <queue>
+#include <vector>
 
 namespace itk
 {
@@ -37,8 +36,10 @@ namespace itk
  *
  * Updates are preformed using an entropy satisfy scheme where only
  * "upwind" neighborhoods are used. This implementation of Fast Marching
- * uses a std::priority_queue to locate the next proper grid position to
- * update.
+ * uses a binary min-heap to locate the next proper grid position to
+ * update. The heap is indexed by pixel: when the value of a trial point
+ * changes, its entry is moved within the heap instead of being added a
+ * second time.
  *
  * Fast Marching sweeps through N grid points in (N log N) steps to obtain
  * the arrival time value as the front propagates through the grid.
@@ -82,17 +83,24 @@ namespace itk
  * and SetOutputOrigin(). Else if the speed image is not NULL, the output information
  * is copied from the input speed image.
  *
- * Possible Improvements:
- * In the current implemenation, std::priority_queue only allows
- * taking nodes out from the front and putting nodes in from the back.
- * To update a value already on the heap, a new node is added to the heap.
- * The defunct old node is left on the heap. When it is removed from the
- * top, it will be recognized as invalid and not used.
- * Future implementations can implement the heap in a different way
- * allowing the values to be updated. This will generally require
- * some sift-up and sift-down functions and
- * an image of back-pointers going from the image to heap in order
- * to locate the node which is to be updated.
+ * The arrival times can also be computed with a block-based fast iterative
+ * method (Jeong and Whitaker, "A Fast Iterative Method for Eikonal
+ * Equations", SIAM J. Sci. Comput., 2008) by turning UseFastIterativeMethod
+ * on. The output is partitioned into blocks of FastIterativeBlockSize pixels
+ * along each dimension. The blocks are colored like a checkerboard, and the
+ * active blocks of one color are updated in parallel by the MultiThreader
+ * until their values no longer change. Since neighboring blocks have
+ * different colors, a thread never reads values that another thread is
+ * writing, and the result does not depend on the number of threads. A
+ * block whose border changed activates its neighbors. The same
+ * upwind scheme, alive points, trial points, speed and stopping value are
+ * used, and the solution converges to the fast marching arrival times up to
+ * round-off. Points beyond the stopping value are labeled as they would be
+ * by fast marching.
+ *
+ * In terms of memory, the heap holds one entry (a value and a buffer
+ * offset) per trial point, and a table of heap positions with one entry
+ * per pixel is kept while the filter runs.
  *
  * \sa LevelSetTypeDefault
  * \ingroup LevelSetSegmentation
@@ -250,6 +258,21 @@ private:
     return m_ProcessedPoints;
   }
 
+  /** Set/Get whether the arrival times are computed with the multi-threaded
+   * fast iterative method instead of the fast marching method. When points
+   * are collected, they are sorted by arrival time once the solution is
+   * known. Subclasses that depend on the order in which points are made
+   * alive fall back to fast marching. The default is false. */
+  itkSetMacro(UseFastIterativeMethod, bool);
+  itkGetConstReferenceMacro(UseFastIterativeMethod, bool);
+  itkBooleanMacro(UseFastIterativeMethod);
+
+  /** Set/Get the number of pixels along each dimension of the blocks
+   * updated by the fast iterative method. The default is 8. */
+  itkSetClampMacro( FastIterativeBlockSize, unsigned int, 1,
+                    NumericTraits< unsigned int >::max() );
+  itkGetConstMacro(FastIterativeBlockSize, unsigned int);
+
   /** The output largeset possible, spacing and origin is computed as follows.
    * If the speed image is NULL or if the OverrideOutputInformation is true,
    * the output information is set from user specified parameters. These
@@ -302,6 +325,29 @@ protected:
 
   void GenerateData();
 
+  /** Compute the arrival times with the fast iterative method. Called by
+   * GenerateData() after Initialize() when UseFastIterativeMethod is on.
+   * The default implementation calls ComputeFastIterativeSolution() and
+   * then FinalizeFastIterativeSolution(). */
+  virtual void FastIterativeGenerateData(const SpeedImageType *, LevelSetImageType *);
+
+  /** Update the arrival times of the far points until convergence. Only
+   * points whose arrival time does not exceed the stopping value propagate
+   * the front. The label image is left as set by Initialize(). */
+  void ComputeFastIterativeSolution(const SpeedImageType *, LevelSetImageType *);
+
+  /** Label the points as fast marching would have after stopping at the
+   * current stopping value: points up to the stopping value become alive
+   * and their neighbors become trial points. Far points are reset to the
+   * large value and the processed points are collected if requested. */
+  void FinalizeFastIterativeSolution(const SpeedImageType *, LevelSetImageType *);
+
+  /** Return false if the subclass relies on the points being made alive
+   * one at a time in increasing order, in which case GenerateData() uses
+   * fast marching whatever the value of UseFastIterativeMethod. */
+  virtual bool CanUseFastIterativeMethod() const
+  { return true; }
+
   /** Generate the output image meta information. */
   virtual void GenerateOutputInformation();
 
@@ -345,17 +391,83 @@ private:
   typename LevelSetImageType::PixelType m_LargeValue;
   AxisNodeType m_NodesUsed[SetDimension];
 
+  typedef typename LevelSetImageType::OffsetValueType OffsetValueType;
+
   /** Trial points are stored in a min-heap. This allow efficient access
    * to the trial point with minimum value which is the next grid point
-   * the algorithm processes. */
-  typedef std::vector< AxisNodeType >  HeapContainer;
-  typedef std::greater< AxisNodeType > NodeComparer;
-  typedef std::priority_queue< AxisNodeType, HeapContainer, NodeComparer >
-  HeapType;
+   * the algorithm processes. Each entry is identified by the offset of the
+   * point in the output buffer, and m_TrialHeapPositions gives the
+   * position of the entry of each point in the heap. */
+  struct TrialHeapNodeType {
+    PixelType Value;
+    OffsetValueType Offset;
+  };
+
+  typedef std::vector< TrialHeapNodeType > HeapType;
+  typedef std::vector< unsigned int >      HeapPositionContainer;
+
+  /** Position of the points which are not in the heap. */
+  static const unsigned int NotInTrialHeap = 0xffffffff;
+
+  HeapType              m_TrialHeap;
+  HeapPositionContainer m_TrialHeapPositions;
 
-  HeapType m_TrialHeap;
+  /** Insert a point in the heap, or move its entry if it is already in
+   * the heap. */
+  void PushTrialPoint(OffsetValueType offset, PixelType value);
+
+  /** Remove the point with the smallest value from the heap. */
+  TrialHeapNodeType PopTrialPoint();
+
+  void SiftUpTrialPoint(unsigned int position);
+
+  void SiftDownTrialPoint(unsigned int position);
+
+  /** Empty the heap and release the table of positions. */
+  void ReleaseTrialHeap();
 
   double m_NormalizationFactor;
+
+  bool         m_UseFastIterativeMethod;
+  unsigned int m_FastIterativeBlockSize;
+
+  /** Types and methods used by the fast iterative method. */
+  typedef std::vector< unsigned long > BlockListType;
+
+  struct FastIterativeThreadStruct {
+    Self *Filter;
+    const SpeedImageType *SpeedImage;
+    LevelSetImageType *Output;
+    const BlockListType *ActiveBlocks;
+    std::vector< BlockListType > *ActivatedBlocks;
+    std::vector< unsigned char > *Failed;
+    OutputSizeType NumberOfBlocks;
+    unsigned long BlockStride[SetDimension];
+    double SpaceFactor[SetDimension];
+  };
+
+  /** Solve the upwind quadratic equation at a point from the neighbors
+   * whose arrival time does not exceed the threshold. Return the large
+   * value if none of these neighbors was reached by the front itself. */
+  double SolveFastIterativeValue(const IndexType & index,
+                                 OffsetValueType offset,
+                                 const SpeedImageType *speedImage,
+                                 const LevelSetImageType *output,
+                                 double threshold,
+                                 const double *spaceFactor,
+                                 bool & failed) const;
+
+  /** Color of a block in the checkerboard of the blocks, 0 or 1. Blocks
+   * that share a face have different colors. */
+  unsigned int GetFastIterativeBlockColor(const FastIterativeThreadStruct & str,
+                                          unsigned long block) const;
+
+  /** Update the active blocks assigned to a thread until they converge. */
+  void ThreadedFastIterativeUpdate(const FastIterativeThreadStruct & str,
+                                   unsigned long first, unsigned long last,
+                                   int threadId);
+
+  static ITK_THREAD_RETURN_TYPE FastIterativeThreaderCallback(void *arg);
 };
 } // namespace itk
 
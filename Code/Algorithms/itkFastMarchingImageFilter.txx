@@ -20,6 +20,7 @@
 
 #include "itkFastMarchingImageFilter.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
 #include "itkNumericTraits.h"
 #include "vnl/vnl_math.h"
 #include <algorithm>
@@ -59,6 +60,9 @@ FastMarchingImageFilter< TLevelSet, TSpeedImage >
   m_CollectPoints = false;
 
   m_NormalizationFactor = 1.0;
+
+  m_UseFastIterativeMethod = false;
+  m_FastIterativeBlockSize = 8;
 }
 
 template< class TLevelSet, class TSpeedImage >
@@ -76,6 +80,8 @@ FastMarchingImageFilter< TLevelSet, TSpeedImage >
      << std::endl;
   os << indent << "Normalization Factor: " << m_NormalizationFactor << std::endl;
   os << indent << "Collect points: " << m_CollectPoints << std::endl;
+  os << indent << "UseFastIterativeMethod: " << m_UseFastIterativeMethod << std::endl;
+  os << indent << "FastIterativeBlockSize: " << m_FastIterativeBlockSize << std::endl;
   os << indent << "OverrideOutputInformation: ";
   os << m_OverrideOutputInformation << std::endl;
   os << indent << "OutputRegion: " << m_OutputRegion << std::endl;
@@ -203,11 +209,10 @@ FastMarchingImageFilter< TLevelSet, TSpeedImage >
       }
     }
 
-  // make sure the heap is empty
-  while ( !m_TrialHeap.empty() )
-    {
-    m_TrialHeap.pop();
-    }
+  // make sure the heap is empty, no point is in the heap
+  m_TrialHeap.clear();
+  m_TrialHeapPositions.assign( m_BufferedRegion.GetNumberOfPixels(),
+                               static_cast< unsigned int >( NotInTrialHeap ) );
 
   // process the input trial points
   if ( m_TrialPoints )
@@ -232,7 +237,7 @@ FastMarchingImageFilter< TLevelSet, TSpeedImage >
       outputPixel = node.GetValue();
       output->SetPixel(node.GetIndex(), outputPixel);
 
-      m_TrialHeap.push(node);
+      this->PushTrialPoint(output->ComputeOffset( node.GetIndex() ), outputPixel);
       }
     }
 }
@@ -259,25 +264,19 @@ FastMarchingImageFilter< TLevelSet, TSpeedImage >
 
   this->UpdateProgress(0.0);   // Send first progress event
 
-  while ( !m_TrialHeap.empty() )
+  if ( m_UseFastIterativeMethod && this->CanUseFastIterativeMethod() )
     {
-    // get the node with the smallest value
-    node = m_TrialHeap.top();
-    m_TrialHeap.pop();
-
-    // does this node contain the current value ?
-    currentValue = (double)output->GetPixel( node.GetIndex() );
-
-    if ( node.GetValue() != currentValue )
-      {
-      continue;
-      }
+    this->FastIterativeGenerateData(speedImage, output);
+    this->UpdateProgress(1.0);
+    return;
+    }
 
-    // is this node already alive ?
-    if ( m_LabelImage->GetPixel( node.GetIndex() ) == AlivePoint )
-      {
-      continue;
-      }
+  while ( !m_TrialHeap.empty() )
+    {
+    // get the node with the smallest value, the heap entry of a point
+    // always holds its current value
+    const TrialHeapNodeType trial = m_TrialHeap.front();
+    currentValue = static_cast< double >( trial.Value );
 
     if ( currentValue > m_StoppingValue )
       {
@@ -285,6 +284,11 @@ FastMarchingImageFilter< TLevelSet, TSpeedImage >
       break;
       }
 
+    this->PopTrialPoint();
+
+    node.SetValue(trial.Value);
+    node.SetIndex( output->ComputeIndex(trial.Offset) );
+
     if ( m_CollectPoints )
       {
       m_ProcessedPoints->InsertElement(m_ProcessedPoints->Size(), node);
@@ -313,6 +317,8 @@ FastMarchingImageFilter< TLevelSet, TSpeedImage >
         }
       }
     }
+
+  this->ReleaseTrialHeap();
 }
 
 template< class TLevelSet, class TSpeedImage >
@@ -465,15 +471,678 @@ FastMarchingImageFilter< TLevelSet, TSpeedImage >
     outputPixel = static_cast< PixelType >( solution );
     output->SetPixel(index, outputPixel);
 
-    // insert point into trial heap
+    // insert point into trial heap, or update its entry
     m_LabelImage->SetPixel(index, TrialPoint);
-    node.SetValue( static_cast< PixelType >( solution ) );
-    node.SetIndex(index);
-    m_TrialHeap.push(node);
+    this->PushTrialPoint(output->ComputeOffset(index), outputPixel);
+    }
+
+  return solution;
+}
+
+template< class TLevelSet, class TSpeedImage >
+void
+FastMarchingImageFilter< TLevelSet, TSpeedImage >
+::PushTrialPoint(OffsetValueType offset, PixelType value)
+{
+  unsigned int position = m_TrialHeapPositions[offset];
+
+  if ( position == NotInTrialHeap )
+    {
+    TrialHeapNodeType trial;
+    trial.Value = value;
+    trial.Offset = offset;
+    position = static_cast< unsigned int >( m_TrialHeap.size() );
+    m_TrialHeap.push_back(trial);
+    m_TrialHeapPositions[offset] = position;
+    this->SiftUpTrialPoint(position);
+    }
+  else if ( value < m_TrialHeap[position].Value )
+    {
+    m_TrialHeap[position].Value = value;
+    this->SiftUpTrialPoint(position);
+    }
+  else
+    {
+    m_TrialHeap[position].Value = value;
+    this->SiftDownTrialPoint(position);
+    }
+}
+
+template< class TLevelSet, class TSpeedImage >
+typename FastMarchingImageFilter< TLevelSet, TSpeedImage >::TrialHeapNodeType
+FastMarchingImageFilter< TLevelSet, TSpeedImage >
+::PopTrialPoint()
+{
+  const TrialHeapNodeType top = m_TrialHeap.front();
+
+  m_TrialHeapPositions[top.Offset] = NotInTrialHeap;
+
+  // move the last entry to the top and restore the heap property
+  const TrialHeapNodeType last = m_TrialHeap.back();
+  m_TrialHeap.pop_back();
+  if ( !m_TrialHeap.empty() )
+    {
+    m_TrialHeap[0] = last;
+    m_TrialHeapPositions[last.Offset] = 0;
+    this->SiftDownTrialPoint(0);
+    }
+
+  return top;
+}
+
+template< class TLevelSet, class TSpeedImage >
+void
+FastMarchingImageFilter< TLevelSet, TSpeedImage >
+::SiftUpTrialPoint(unsigned int position)
+{
+  const TrialHeapNodeType trial = m_TrialHeap[position];
+
+  while ( position > 0 )
+    {
+    const unsigned int parent = ( position - 1 ) / 2;
+    if ( !( trial.Value < m_TrialHeap[parent].Value ) )
+      {
+      break;
+      }
+    m_TrialHeap[position] = m_TrialHeap[parent];
+    m_TrialHeapPositions[m_TrialHeap[position].Offset] = position;
+    position = parent;
+    }
+
+  m_TrialHeap[position] = trial;
+  m_TrialHeapPositions[trial.Offset] = position;
+}
+
+template< class TLevelSet, class TSpeedImage >
+void
+FastMarchingImageFilter< TLevelSet, TSpeedImage >
+::SiftDownTrialPoint(unsigned int position)
+{
+  const TrialHeapNodeType trial = m_TrialHeap[position];
+  const unsigned int      size = static_cast< unsigned int >( m_TrialHeap.size() );
+
+  for (;; )
+    {
+    unsigned int child = 2 * position + 1;
+    if ( child >= size )
+      {
+      break;
+      }
+    if ( child + 1 < size && m_TrialHeap[child + 1].Value < m_TrialHeap[child].Value )
+      {
+      child++;
+      }
+    if ( !( m_TrialHeap[child].Value < trial.Value ) )
+      {
+      break;
+      }
+    m_TrialHeap[position] = m_TrialHeap[child];
+    m_TrialHeapPositions[m_TrialHeap[position].Offset] = position;
+    position = child;
+    }
+
+  m_TrialHeap[position] = trial;
+  m_TrialHeapPositions[trial.Offset] = position;
+}
+
+template< class TLevelSet, class TSpeedImage >
+void
+FastMarchingImageFilter< TLevelSet, TSpeedImage >
+::ReleaseTrialHeap()
+{
+  HeapType().swap(m_TrialHeap);
+  HeapPositionContainer().swap(m_TrialHeapPositions);
+}
+
+template< class TLevelSet, class TSpeedImage >
+void
+FastMarchingImageFilter< TLevelSet, TSpeedImage >
+::FastIterativeGenerateData(
+  const SpeedImageType *speedImage,
+  LevelSetImageType *output)
+{
+  this->ComputeFastIterativeSolution(speedImage, output);
+  this->FinalizeFastIterativeSolution(speedImage, output);
+}
+
+template< class TLevelSet, class TSpeedImage >
+void
+FastMarchingImageFilter< TLevelSet, TSpeedImage >
+::ComputeFastIterativeSolution(
+  const SpeedImageType *speedImage,
+  LevelSetImageType *output)
+{
+  // the trial points were pushed by Initialize() but are not needed here
+  this->ReleaseTrialHeap();
+
+  FastIterativeThreadStruct str;
+  str.Filter = this;
+  str.SpeedImage = speedImage;
+  str.Output = output;
+
+  // partition the buffered region into blocks
+  const OutputSizeType & size = m_BufferedRegion.GetSize();
+  OutputSpacingType      spacing = output->GetSpacing();
+  unsigned long          numberOfBlocks = 1;
+  for ( unsigned int j = 0; j < SetDimension; j++ )
+    {
+    str.NumberOfBlocks[j] =
+      ( size[j] + m_FastIterativeBlockSize - 1 ) / m_FastIterativeBlockSize;
+    str.BlockStride[j] = numberOfBlocks;
+    str.SpaceFactor[j] = vnl_math_sqr(1.0 / spacing[j]);
+    numberOfBlocks *= str.NumberOfBlocks[j];
+    }
+
+  // the blocks next to the initial trial points start the propagation
+  BlockListType                activeBlocks;
+  std::vector< unsigned char > isActive(numberOfBlocks, 0);
+
+  if ( m_TrialPoints )
+    {
+    typename NodeContainer::ConstIterator pointsIter = m_TrialPoints->Begin();
+    typename NodeContainer::ConstIterator pointsEnd = m_TrialPoints->End();
+
+    for (; pointsIter != pointsEnd; ++pointsIter )
+      {
+      const IndexType & index = pointsIter.Value().GetIndex();
+      if ( !m_BufferedRegion.IsInside(index) )
+        {
+        continue;
+        }
+
+      for ( int n = -1; n < static_cast< int >( 2 * SetDimension ); n++ )
+        {
+        IndexType neighIndex = index;
+        if ( n >= 0 )
+          {
+          neighIndex[n / 2] += ( n % 2 ) ? 1 : -1;
+          if ( !m_BufferedRegion.IsInside(neighIndex) )
+            {
+            continue;
+            }
+          }
+
+        unsigned long block = 0;
+        for ( unsigned int j = 0; j < SetDimension; j++ )
+          {
+          block += str.BlockStride[j]
+                   * ( ( neighIndex[j] - m_StartIndex[j] ) / m_FastIterativeBlockSize );
+          }
+        if ( !isActive[block] )
+          {
+          isActive[block] = 1;
+          activeBlocks.push_back(block);
+          }
+        }
+      }
+    }
+
+  std::vector< BlockListType > activatedBlocks;
+  std::vector< unsigned char > failed;
+  str.ActivatedBlocks = &activatedBlocks;
+  str.Failed = &failed;
+
+  // The blocks are colored like a checkerboard and the active blocks of
+  // one color are updated at a time. A block only reads the pixels of the
+  // blocks that share a face with it, which have the other color, so no
+  // thread reads values that another thread is writing. The values do not
+  // depend on the order of the blocks or on the number of threads.
+  BlockListType colorBlocks[2];
+
+  while ( !activeBlocks.empty() )
+    {
+    colorBlocks[0].clear();
+    colorBlocks[1].clear();
+    for ( unsigned long i = 0; i < activeBlocks.size(); i++ )
+      {
+      const unsigned long block = activeBlocks[i];
+      const unsigned int  color = this->GetFastIterativeBlockColor(str, block);
+      colorBlocks[color].push_back(block);
+      if ( color == 0 )
+        {
+        isActive[block] = 0;
+        }
+      }
+    activeBlocks.clear();
+
+    for ( unsigned int color = 0; color < 2; color++ )
+      {
+      if ( color == 1 )
+        {
+        for ( unsigned long i = 0; i < colorBlocks[1].size(); i++ )
+          {
+          isActive[colorBlocks[1][i]] = 0;
+          }
+        }
+
+      if ( colorBlocks[color].empty() )
+        {
+        continue;
+        }
+
+      // update the active blocks of this color, several per thread
+      str.ActiveBlocks = &( colorBlocks[color] );
+
+      int numberOfThreads = this->GetNumberOfThreads();
+      if ( static_cast< unsigned long >( numberOfThreads ) > colorBlocks[color].size() )
+        {
+        numberOfThreads = static_cast< int >( colorBlocks[color].size() );
+        }
+      activatedBlocks.resize(numberOfThreads);
+      failed.assign(numberOfThreads, 0);
+      for ( int i = 0; i < numberOfThreads; i++ )
+        {
+        activatedBlocks[i].clear();
+        }
+
+      this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+      this->GetMultiThreader()->SetSingleMethod(this->FastIterativeThreaderCallback,
+                                                &str);
+      this->GetMultiThreader()->SingleMethodExecute();
+
+      for ( int i = 0; i < numberOfThreads; i++ )
+        {
+        if ( failed[i] )
+          {
+          // Discriminant of quadratic eqn. is negative
+          ExceptionObject err(__FILE__, __LINE__);
+          err.SetLocation(ITK_LOCATION);
+          err.SetDescription("Discriminant of quadratic equation is negative");
+          throw err;
+          }
+        }
+
+      // The neighbors of the blocks whose border values changed have the
+      // other color. After the first color they are updated in this
+      // iteration, after the second one in the next iteration.
+      for ( int i = 0; i < numberOfThreads; i++ )
+        {
+        const BlockListType & activated = activatedBlocks[i];
+        for ( unsigned long j = 0; j < activated.size(); j++ )
+          {
+          if ( !isActive[activated[j]] )
+            {
+            isActive[activated[j]] = 1;
+            if ( color == 0 )
+              {
+              colorBlocks[1].push_back(activated[j]);
+              }
+            else
+              {
+              activeBlocks.push_back(activated[j]);
+              }
+            }
+          }
+        }
+      }
+
+    if ( this->GetAbortGenerateData() )
+      {
+      this->InvokeEvent( AbortEvent() );
+      this->ResetPipeline();
+      ProcessAborted e(__FILE__, __LINE__);
+      e.SetDescription("Process aborted.");
+      e.SetLocation(ITK_LOCATION);
+      throw e;
+      }
+    }
+
+  // The buffer was changed through raw pointers.
+  output->Modified();
+}
+
+template< class TLevelSet, class TSpeedImage >
+unsigned int
+FastMarchingImageFilter< TLevelSet, TSpeedImage >
+::GetFastIterativeBlockColor(const FastIterativeThreadStruct & str,
+                             unsigned long block) const
+{
+  unsigned long sum = 0;
+  for ( unsigned int j = 0; j < SetDimension; j++ )
+    {
+    sum += ( block / str.BlockStride[j] ) % str.NumberOfBlocks[j];
+    }
+  return static_cast< unsigned int >( sum % 2 );
+}
+
+template< class TLevelSet, class TSpeedImage >
+ITK_THREAD_RETURN_TYPE
+FastMarchingImageFilter< TLevelSet, TSpeedImage >
+::FastIterativeThreaderCallback(void *arg)
+{
+  FastIterativeThreadStruct *str;
+  int                        threadId, threadCount;
+
+  threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  str = (FastIterativeThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  const unsigned long numberOfBlocks = str->ActiveBlocks->size();
+  const unsigned long first = ( numberOfBlocks * threadId ) / threadCount;
+  const unsigned long last = ( numberOfBlocks * ( threadId + 1 ) ) / threadCount;
+
+  if ( first < last )
+    {
+    str->Filter->ThreadedFastIterativeUpdate(*str, first, last, threadId);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TLevelSet, class TSpeedImage >
+void
+FastMarchingImageFilter< TLevelSet, TSpeedImage >
+::ThreadedFastIterativeUpdate(
+  const FastIterativeThreadStruct & str,
+  unsigned long first, unsigned long last,
+  int threadId)
+{
+  LevelSetImageType   *output = str.Output;
+  PixelType           *buffer = output->GetBufferPointer();
+  const unsigned char *labels = m_LabelImage->GetBufferPointer();
+  BlockListType &      activated = ( *str.ActivatedBlocks )[threadId];
+
+  for ( unsigned long b = first; b < last; b++ )
+    {
+    const unsigned long block = ( *str.ActiveBlocks )[b];
+
+    // region covered by the block
+    IndexType     blockStart;
+    IndexType     blockEnd;
+    unsigned long blockIndex[SetDimension];
+    unsigned long numberOfPixels = 1;
+    for ( unsigned int j = 0; j < SetDimension; j++ )
+      {
+      blockIndex[j] = ( block / str.BlockStride[j] ) % str.NumberOfBlocks[j];
+      blockStart[j] = m_StartIndex[j] + blockIndex[j] * m_FastIterativeBlockSize;
+      blockEnd[j] = vnl_math_min(
+        static_cast< long >( blockStart[j] + m_FastIterativeBlockSize - 1 ),
+        static_cast< long >( m_LastIndex[j] ) );
+      numberOfPixels *= blockEnd[j] - blockStart[j] + 1;
+      }
+
+    // sweep the block alternately forward and backward until no value
+    // changes, keeping track of the faces whose values changed
+    bool faceChanged[2 * SetDimension];
+    std::fill(faceChanged, faceChanged + 2 * SetDimension, false);
+
+    bool changed = true;
+    for ( unsigned int pass = 0; changed; pass++ )
+      {
+      changed = false;
+      const bool forward = ( pass % 2 == 0 );
+      IndexType  index = forward ? blockStart : blockEnd;
+
+      for ( unsigned long n = 0; n < numberOfPixels; n++ )
+        {
+        const OffsetValueType offset = output->ComputeOffset(index);
+        if ( labels[offset] == FarPoint )
+          {
+          bool         discriminantFailed = false;
+          const double solution = this->SolveFastIterativeValue(
+            index, offset, str.SpeedImage, output, m_StoppingValue, str.SpaceFactor,
+            discriminantFailed);
+          if ( discriminantFailed )
+            {
+            ( *str.Failed )[threadId] = 1;
+            return;
+            }
+
+          if ( solution < m_LargeValue )
+            {
+            const PixelType value = static_cast< PixelType >( solution );
+            if ( value < buffer[offset] )
+              {
+              buffer[offset] = value;
+              changed = true;
+              for ( unsigned int j = 0; j < SetDimension; j++ )
+                {
+                if ( index[j] == blockStart[j] )
+                  {
+                  faceChanged[2 * j] = true;
+                  }
+                if ( index[j] == blockEnd[j] )
+                  {
+                  faceChanged[2 * j + 1] = true;
+                  }
+                }
+              }
+            }
+          }
+
+        // move to the next pixel of the block
+        for ( unsigned int j = 0; j < SetDimension; j++ )
+          {
+          if ( forward )
+            {
+            if ( index[j] < blockEnd[j] )
+              {
+              ++index[j];
+              break;
+              }
+            index[j] = blockStart[j];
+            }
+          else
+            {
+            if ( index[j] > blockStart[j] )
+              {
+              --index[j];
+              break;
+              }
+            index[j] = blockEnd[j];
+            }
+          }
+        }
+      }
+
+    // neighbor blocks must be updated with the new border values
+    for ( unsigned int j = 0; j < SetDimension; j++ )
+      {
+      if ( faceChanged[2 * j] && blockIndex[j] > 0 )
+        {
+        activated.push_back(block - str.BlockStride[j]);
+        }
+      if ( faceChanged[2 * j + 1] && blockIndex[j] + 1 < str.NumberOfBlocks[j] )
+        {
+        activated.push_back(block + str.BlockStride[j]);
+        }
+      }
+    }
+}
+
+template< class TLevelSet, class TSpeedImage >
+double
+FastMarchingImageFilter< TLevelSet, TSpeedImage >
+::SolveFastIterativeValue(
+  const IndexType & index,
+  OffsetValueType offset,
+  const SpeedImageType *speedImage,
+  const LevelSetImageType *output,
+  double threshold,
+  const double *spaceFactor,
+  bool & failed) const
+{
+  const PixelType       *buffer = output->GetBufferPointer();
+  const unsigned char   *labels = m_LabelImage->GetBufferPointer();
+  const OffsetValueType *offsetTable = output->GetOffsetTable();
+
+  // smallest neighbor value along each axis, sorted by value
+  double       values[SetDimension];
+  unsigned int axes[SetDimension];
+  unsigned int numberOfValues = 0;
+  bool         reached = false;
+
+  for ( unsigned int j = 0; j < SetDimension; j++ )
+    {
+    double minValue = m_LargeValue;
+
+    for ( int s = -1; s < 2; s = s + 2 )
+      {
+      if ( ( s < 0 && index[j] <= m_StartIndex[j] )
+           || ( s > 0 && index[j] >= m_LastIndex[j] ) )
+        {
+        continue;
+        }
+
+      // only the front propagates: the initial alive points are used in
+      // the calculation but do not reach their neighbors by themselves
+      const OffsetValueType neighOffset = offset + s * offsetTable[j];
+      const double          neighValue = buffer[neighOffset];
+      if ( neighValue < minValue && neighValue <= threshold )
+        {
+        minValue = neighValue;
+        }
+      if ( neighValue < m_LargeValue && neighValue <= threshold
+           && labels[neighOffset] != AlivePoint )
+        {
+        reached = true;
+        }
+      }
+
+    if ( minValue < m_LargeValue )
+      {
+      unsigned int k = numberOfValues++;
+      for (; k > 0 && values[k - 1] > minValue; k-- )
+        {
+        values[k] = values[k - 1];
+        axes[k] = axes[k - 1];
+        }
+      values[k] = minValue;
+      axes[k] = j;
+      }
+    }
+
+  if ( !reached )
+    {
+    return m_LargeValue;
+    }
+
+  // solve quadratic equation
+  double aa = 0.0;
+  double bb = 0.0;
+  double cc;
+  double solution = m_LargeValue;
+
+  if ( speedImage )
+    {
+    cc = (double)speedImage->GetPixel(index) / m_NormalizationFactor;
+    cc = -1.0 * vnl_math_sqr(1.0 / cc);
+    }
+  else
+    {
+    cc = m_InverseSpeed;
+    }
+
+  for ( unsigned int j = 0; j < numberOfValues; j++ )
+    {
+    if ( solution < values[j] )
+      {
+      break;
+      }
+
+    aa += spaceFactor[axes[j]];
+    bb += values[j] * spaceFactor[axes[j]];
+    cc += vnl_math_sqr(values[j]) * spaceFactor[axes[j]];
+
+    const double discrim = vnl_math_sqr(bb) - aa * cc;
+    if ( discrim < 0.0 )
+      {
+      failed = true;
+      return m_LargeValue;
+      }
+
+    solution = ( vcl_sqrt(discrim) + bb ) / aa;
     }
 
   return solution;
 }
+
+template< class TLevelSet, class TSpeedImage >
+void
+FastMarchingImageFilter< TLevelSet, TSpeedImage >
+::FinalizeFastIterativeSolution(
+  const SpeedImageType *speedImage,
+  LevelSetImageType *output)
+{
+  OutputSpacingType spacing = output->GetSpacing();
+  double            spaceFactor[SetDimension];
+
+  for ( unsigned int j = 0; j < SetDimension; j++ )
+    {
+    spaceFactor[j] = vnl_math_sqr(1.0 / spacing[j]);
+    }
+
+  typedef ImageRegionIteratorWithIndex< LevelSetImageType > OutputIterator;
+  typedef ImageRegionIterator< LabelImageType >             LabelIterator;
+
+  OutputIterator outIt(output, m_BufferedRegion);
+  LabelIterator  typeIt(m_LabelImage, m_BufferedRegion);
+
+  // Beyond the stopping value, fast marching only knows the neighbors of
+  // the alive points, computed from the alive points alone. The values
+  // they use are not modified by this loop.
+  for ( outIt.GoToBegin(), typeIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt, ++typeIt )
+    {
+    if ( typeIt.Get() == AlivePoint || typeIt.Get() == InitialTrialPoint
+         || outIt.Get() >= m_LargeValue
+         || static_cast< double >( outIt.Get() ) <= m_StoppingValue )
+      {
+      continue;
+      }
+
+    bool         failed = false;
+    const double solution = this->SolveFastIterativeValue(
+      outIt.GetIndex(), output->ComputeOffset( outIt.GetIndex() ), speedImage, output, m_StoppingValue, spaceFactor, failed);
+
+    if ( solution < m_LargeValue )
+      {
+      outIt.Set( static_cast< PixelType >( solution ) );
+      typeIt.Set(TrialPoint);
+      }
+    else
+      {
+      outIt.Set(m_LargeValue);
+      typeIt.Set(FarPoint);
+      }
+    }
+
+  // the points up to the stopping value are alive
+  std::vector< NodeType > processedPoints;
+  NodeType                node;
+
+  for ( outIt.GoToBegin(), typeIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt, ++typeIt )
+    {
+    const unsigned char label = typeIt.Get();
+    if ( label == AlivePoint || label == TrialPoint
+         || outIt.Get() >= m_LargeValue
+         || static_cast< double >( outIt.Get() ) > m_StoppingValue )
+      {
+      continue;
+      }
+
+    typeIt.Set(AlivePoint);
+
+    if ( m_CollectPoints )
+      {
+      node.SetValue( outIt.Get() );
+      node.SetIndex( outIt.GetIndex() );
+      processedPoints.push_back(node);
+      }
+    }
+
+  if ( m_CollectPoints )
+    {
+    std::stable_sort( processedPoints.begin(), processedPoints.end() );
+
+    m_ProcessedPoints = NodeContainer::New();
+    m_ProcessedPoints->Reserve( processedPoints.size() );
+    for ( unsigned long i = 0; i < processedPoints.size(); i++ )
+      {
+      m_ProcessedPoints->SetElement(i, processedPoints[i]);
+      }
+    }
+}
 } // namespace itk
 
 #endif
@@ -49,6 +49,12 @@ namespace itk
  * met. This way the solution is computed a bit downstream the Target points,
  * so that the level sets of T(x) corresponding to the Target are smooth.
  *
+ * When UseFastIterativeMethod is on, the arrival times are computed first.
+ * The targets are then considered in increasing order of arrival time to
+ * set the stopping value, and the gradient vectors are computed from the
+ * alive neighbors of each alive point. This gives the same targets and
+ * gradients as when they are computed while fast marching.
+ *
  *
  * \author Luca Antiga Ph.D.  Biomedical Technologies Laboratory,
  *                            Bioengineering Deparment, Mario Negri Institute, Italy.
@@ -191,6 +197,10 @@ protected:
 
   void GenerateData();
 
+  /** Compute the arrival times with the fast iterative method, then check
+   * the targets and compute the gradient image. */
+  virtual void FastIterativeGenerateData(const SpeedImageType *, LevelSetImageType *);
+
   virtual void UpdateNeighbors(const IndexType & index,
                                const SpeedImageType *, LevelSetImageType *);
 
@@ -20,6 +20,7 @@
 
 #include "itkFastMarchingUpwindGradientImageFilter.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkNumericTraits.h"
 #include "vnl/vnl_math.h"
 #include <algorithm>
@@ -234,6 +235,160 @@ FastMarchingUpwindGradientImageFilter< TLevelSet, TSpeedImage >
     }
 }
 
+template< class TLevelSet, class TSpeedImage >
+void
+FastMarchingUpwindGradientImageFilter< TLevelSet, TSpeedImage >
+::FastIterativeGenerateData(
+  const SpeedImageType *speedImage,
+  LevelSetImageType *output)
+{
+  this->ComputeFastIterativeSolution(speedImage, output);
+
+  const LabelImageType *labelImage = this->GetLabelImage();
+  const double          largeValue = static_cast< double >( this->GetLargeValue() );
+
+  // Fast marching updates the target value with every processed point when
+  // there are no targets, and with every point processed while exactly the
+  // requested number of targets has been reached otherwise.
+  bool   updateWithProcessedPoints = true;
+  double processedValueBound = largeValue;
+
+  if ( m_TargetReachedMode != NoTargets &&  m_TargetPoints )
+    {
+    // Fast marching reaches the targets in increasing order of arrival
+    // time. Only the points processed by the front count: the initial
+    // alive points are never processed.
+    typedef std::pair< double, unsigned long > TargetType;
+    std::vector< TargetType > reachedTargets;
+
+    typename NodeContainer::ConstIterator pointsIter = m_TargetPoints->Begin();
+    typename NodeContainer::ConstIterator pointsEnd = m_TargetPoints->End();
+    for ( unsigned long i = 0; pointsIter != pointsEnd; ++pointsIter, i++ )
+      {
+      const IndexType & index = pointsIter.Value().GetIndex();
+      if ( !labelImage->GetBufferedRegion().IsInside(index)
+           || labelImage->GetPixel(index) == Superclass::AlivePoint )
+        {
+        continue;
+        }
+
+      const double value = static_cast< double >( output->GetPixel(index) );
+      if ( value < largeValue && value <= this->GetStoppingValue() )
+        {
+        reachedTargets.push_back( TargetType(value, i) );
+        }
+      }
+
+    std::sort( reachedTargets.begin(), reachedTargets.end() );
+
+    // target after which the front stops
+    long stopTarget = -1;
+    if ( m_TargetReachedMode == OneTarget && !reachedTargets.empty() )
+      {
+      stopTarget = 0;
+      }
+    else if ( m_TargetReachedMode == SomeTargets && m_NumberOfTargets > 0
+              && static_cast< long >( reachedTargets.size() ) >= m_NumberOfTargets )
+      {
+      stopTarget = m_NumberOfTargets - 1;
+      }
+    else if ( m_TargetReachedMode == AllTargets
+              && reachedTargets.size() == m_TargetPoints->Size() )
+      {
+      stopTarget = static_cast< long >( reachedTargets.size() ) - 1;
+      }
+
+    if ( stopTarget >= 0 )
+      {
+      m_TargetValue = reachedTargets[stopTarget].first;
+      double newStoppingValue = m_TargetValue + m_TargetOffset;
+      if ( newStoppingValue < this->GetStoppingValue() )
+        {
+        // The value set by the user is restored by GenerateData().
+        this->SetStoppingValue(newStoppingValue);
+        }
+      }
+
+    // targets reached before the front stopped
+    for ( unsigned long i = 0; i < reachedTargets.size(); i++ )
+      {
+      if ( reachedTargets[i].first > this->GetStoppingValue() )
+        {
+        break;
+        }
+
+      if ( m_TargetReachedMode == OneTarget )
+        {
+        m_TargetValue = reachedTargets[i].first;
+        }
+      else
+        {
+        m_ReachedTargetPoints->InsertElement( m_ReachedTargetPoints->Size(),
+                                              m_TargetPoints->GetElement(reachedTargets[i].second) );
+        if ( static_cast< long >( i ) == stopTarget + 1 )
+          {
+          processedValueBound = reachedTargets[i].first;
+          }
+        }
+      }
+
+    updateWithProcessedPoints = ( stopTarget >= 0 && m_TargetReachedMode != OneTarget );
+    }
+
+  if ( updateWithProcessedPoints )
+    {
+    typedef ImageRegionConstIterator< LevelSetImageType > OutputIterator;
+    typedef ImageRegionConstIterator< LabelImageType >    LabelIterator;
+
+    OutputIterator outIt( output, output->GetBufferedRegion() );
+    LabelIterator  typeIt( labelImage, labelImage->GetBufferedRegion() );
+    for (; !outIt.IsAtEnd(); ++outIt, ++typeIt )
+      {
+      const double value = static_cast< double >( outIt.Get() );
+      if ( typeIt.Get() != Superclass::AlivePoint && value < processedValueBound
+           && value <= this->GetStoppingValue() && value > m_TargetValue )
+        {
+        m_TargetValue = value;
+        }
+      }
+    }
+
+  this->FinalizeFastIterativeSolution(speedImage, output);
+
+  if ( m_GenerateGradientImage )
+    {
+    typedef ImageRegionConstIteratorWithIndex< LabelImageType > LabelIterator;
+
+    LabelIterator typeIt( labelImage, labelImage->GetBufferedRegion() );
+    for (; !typeIt.IsAtEnd(); ++typeIt )
+      {
+      if ( typeIt.Get() == Superclass::AlivePoint )
+        {
+        this->ComputeGradient(typeIt.GetIndex(), output, labelImage, m_GradientImage);
+        }
+      }
+
+    // the initial alive points are not processed by fast marching
+    if ( this->GetAlivePoints() )
+      {
+      GradientPixelType zeroGradient;
+      typedef typename GradientPixelType::ValueType GradientPixelValueType;
+      zeroGradient.Fill(NumericTraits< GradientPixelValueType >::Zero);
+
+      typename NodeContainer::ConstIterator pointsIter = this->GetAlivePoints()->Begin();
+      typename NodeContainer::ConstIterator pointsEnd = this->GetAlivePoints()->End();
+      for (; pointsIter != pointsEnd; ++pointsIter )
+        {
+        const IndexType & index = pointsIter.Value().GetIndex();
+        if ( m_GradientImage->GetBufferedRegion().IsInside(index) )
+          {
+          m_GradientImage->SetPixel(index, zeroGradient);
+          }
+        }
+      }
+    }
+}
+
 /**
  *
  */
@@ -212,6 +212,29 @@ public:
   itkSetMacro(UseExplicitPDFDerivatives, bool);
   itkGetConstReferenceMacro(UseExplicitPDFDerivatives, bool);
   itkBooleanMacro(UseExplicitPDFDerivatives);
+
+  /** This variable selects a third mode of computing the Metric derivatives
+   * that is only available when the Transform is a
+   * BSplineDeformableTransform. When enabled, it takes precedence over
+   * UseExplicitPDFDerivatives for BSpline transforms.
+   *
+   * UseSparsePDFDerivatives = True
+   * will not allocate the Joint PDF derivatives at all. Instead, during the
+   * pass over the samples that builds the Joint PDF, the moving image Parzen
+   * window term and the moving image gradient of each sample are recorded.
+   * Once the Joint PDF ratios are known, a second, multi-threaded pass over
+   * the recorded samples accumulates each sample's contribution directly into
+   * the derivative, touching only the parameters in the support region of
+   * the BSpline weights of that sample. The moving image is therefore
+   * transformed and interpolated only once per evaluation, and the memory
+   * used grows with the number of samples instead of with
+   * (number of histogram bins)^2 times the number of transform parameters.
+   *
+   * For transforms other than BSplineDeformableTransform this flag is
+   * ignored and UseExplicitPDFDerivatives determines the method used. */
+  itkSetMacro(UseSparsePDFDerivatives, bool);
+  itkGetConstReferenceMacro(UseSparsePDFDerivatives, bool);
+  itkBooleanMacro(UseSparsePDFDerivatives);
 protected:
 
   MattesMutualInformationImageToImageMetric();
@@ -313,6 +336,30 @@ private:
   bool         m_UseExplicitPDFDerivatives;
   mutable bool m_ImplicitDerivativesSecondPass;
 
+  /** Sparse PDF derivatives are only used with BSpline transforms.
+   * This flag is resolved in Initialize(). */
+  bool m_UseSparsePDFDerivatives;
+  bool m_SparsePDFDerivativesActive;
+
+  /** Per-sample information recorded for the sparse derivative pass.
+   * A negative MovingImageParzenWindowIndex flags samples that did not
+   * contribute to the Joint PDF. */
+  struct SparsePDFDerivativeSampleType {
+    double               MovingImageParzenWindowTerm;
+    OffsetValueType      MovingImageParzenWindowIndex;
+    ImageDerivativesType MovingImageGradient;
+  };
+
+  typedef std::vector< SparsePDFDerivativeSampleType > SparsePDFDerivativeSampleArrayType;
+  mutable SparsePDFDerivativeSampleArrayType m_SparsePDFDerivativeSamples;
+
+  /** Accumulate the derivative from the recorded samples. */
+  void ComputeSparsePDFDerivativesMultiThreadedInitiate(void) const;
+
+  static ITK_THREAD_RETURN_TYPE ComputeSparsePDFDerivativesMultiThreaded(void *arg);
+
+  void ComputeSparsePDFDerivativesThread(unsigned int threadID) const;
+
   virtual inline void GetValueThreadPreProcess(unsigned int threadID,
                                                bool withinSampleThread) const;
 
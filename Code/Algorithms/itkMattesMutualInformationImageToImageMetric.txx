@@ -71,6 +71,8 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   this->m_ThreaderMetricDerivative = NULL;
   this->m_UseExplicitPDFDerivatives = true;
   this->m_ImplicitDerivativesSecondPass = false;
+  this->m_UseSparsePDFDerivatives = false;
+  this->m_SparsePDFDerivativesActive = false;
 }
 
 template< class TFixedImage, class TMovingImage >
@@ -160,6 +162,8 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   os << this->m_UseExplicitPDFDerivatives << std::endl;
   os << indent << "ImplicitDerivativesSecondPass: ";
   os << this->m_ImplicitDerivativesSecondPass << std::endl;
+  os << indent << "UseSparsePDFDerivatives: ";
+  os << this->m_UseSparsePDFDerivatives << std::endl;
 }
 
 /**
@@ -272,13 +276,18 @@ throw ( ExceptionObject )
   this->m_PRatioArray.SetSize(1, 1);   // and by allocating very small the
                                        // static ones
   this->m_MetricDerivative = DerivativeType(1);
+  this->m_SparsePDFDerivativeSamples.clear();
 
   JointPDFDerivativesRegionType jointPDFDerivativesRegion;
 
+  // The sparse mode relies on the support region of the BSpline weights.
+  this->m_SparsePDFDerivativesActive =
+    this->m_UseSparsePDFDerivatives && this->m_TransformIsBSpline;
+
   //
   // Now allocate memory according to the user-selected method.
   //
-  if ( this->m_UseExplicitPDFDerivatives )
+  if ( this->m_UseExplicitPDFDerivatives && !this->m_SparsePDFDerivativesActive )
     {
     this->m_JointPDFDerivatives = JointPDFDerivativesType::New();
 
@@ -315,6 +324,11 @@ throw ( ExceptionObject )
      */
     this->m_PRatioArray.SetSize(this->m_NumberOfHistogramBins, this->m_NumberOfHistogramBins);
     this->m_MetricDerivative = DerivativeType( this->GetNumberOfParameters() );
+
+    if ( this->m_SparsePDFDerivativesActive )
+      {
+      this->m_SparsePDFDerivativeSamples.resize( this->m_FixedImageSamples.size() );
+      }
     }
 
   // For the joint PDF define a region starting from {0,0}
@@ -413,7 +427,7 @@ throw ( ExceptionObject )
     }
   m_ThreaderMetricDerivative = NULL;
 
-  if ( this->m_UseExplicitPDFDerivatives )
+  if ( this->m_UseExplicitPDFDerivatives && !this->m_SparsePDFDerivativesActive )
     {
     m_ThreaderJointPDFDerivatives = new typename
                                     JointPDFDerivativesType::Pointer[this->m_NumberOfThreads - 1];
@@ -775,7 +789,7 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
             0,
             m_NumberOfHistogramBins * sizeof( PDFValueType ) );
 
-    if ( this->m_UseExplicitPDFDerivatives )
+    if ( this->m_UseExplicitPDFDerivatives && !this->m_SparsePDFDerivativesActive )
       {
       memset(m_ThreaderJointPDFDerivatives[threadID - 1]->GetBufferPointer(),
              0,
@@ -791,7 +805,7 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
             0,
             m_NumberOfHistogramBins * sizeof( PDFValueType ) );
 
-    if ( this->m_UseExplicitPDFDerivatives )
+    if ( this->m_UseExplicitPDFDerivatives && !this->m_SparsePDFDerivativesActive )
       {
       memset(m_JointPDFDerivatives->GetBufferPointer(),
              0,
@@ -899,6 +913,28 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   double movingImageParzenWindowArg = static_cast< double >( pdfMovingIndex )
                                       - static_cast< double >( movingImageParzenWindowTerm );
 
+  if ( this->m_SparsePDFDerivativesActive )
+    {
+    // Record what is needed to compute this sample's contribution to the
+    // derivative once the Joint PDF ratios are known.
+    SparsePDFDerivativeSampleType & sparseSample =
+      this->m_SparsePDFDerivativeSamples[fixedImageSample];
+    sparseSample.MovingImageParzenWindowTerm = movingImageParzenWindowTerm;
+    sparseSample.MovingImageParzenWindowIndex = movingImageParzenWindowIndex;
+    sparseSample.MovingImageGradient = movingImageGradientValue;
+
+    while ( pdfMovingIndex <= pdfMovingIndexMax )
+      {
+      *( pdfPtr++ ) += static_cast< PDFValueType >( m_CubicBSplineKernel
+                                                    ->Evaluate(
+                                                      movingImageParzenWindowArg) );
+      movingImageParzenWindowArg += 1;
+      ++pdfMovingIndex;
+      }
+
+    return true;
+    }
+
   while ( pdfMovingIndex <= pdfMovingIndexMax )
     {
     *( pdfPtr++ ) += static_cast< PDFValueType >( m_CubicBSplineKernel
@@ -934,7 +970,7 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
 {
   this->GetValueThreadPostProcess(threadID, withinSampleThread);
 
-  if ( this->m_UseExplicitPDFDerivatives )
+  if ( this->m_UseExplicitPDFDerivatives && !this->m_SparsePDFDerivativesActive )
     {
     const unsigned int rowSize = this->m_NumberOfParameters * m_NumberOfHistogramBins;
 
@@ -989,7 +1025,10 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   // Set output values to zero
   value = NumericTraits< MeasureType >::Zero;
 
-  if ( this->m_UseExplicitPDFDerivatives )
+  const bool useExplicitPDFDerivatives =
+    this->m_UseExplicitPDFDerivatives && !this->m_SparsePDFDerivativesActive;
+
+  if ( useExplicitPDFDerivatives )
     {
     // Set output values to zero
     if ( derivative.GetSize() != this->m_NumberOfParameters )
@@ -1011,6 +1050,19 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     this->m_ImplicitDerivativesSecondPass = false;
     }
 
+  if ( this->m_SparsePDFDerivativesActive )
+    {
+    // Samples that are not visited in this evaluation must not contribute.
+    typename SparsePDFDerivativeSampleArrayType::iterator sparseIt =
+      this->m_SparsePDFDerivativeSamples.begin();
+    const typename SparsePDFDerivativeSampleArrayType::iterator sparseEnd =
+      this->m_SparsePDFDerivativeSamples.end();
+    while ( sparseIt != sparseEnd )
+      {
+      ( sparseIt++ )->MovingImageParzenWindowIndex = -1;
+      }
+    }
+
   // Set up the parameters in the transform
   this->m_Transform->SetParameters(parameters);
   this->m_Parameters = parameters;
@@ -1107,7 +1159,7 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
           sum += jointPDFValue * ( pRatio - vcl_log(fixedImagePDFValue) );
           }
 
-        if ( this->m_UseExplicitPDFDerivatives )
+        if ( useExplicitPDFDerivatives )
           {
           // move joint pdf derivative pointer to the right position
           JointPDFValueType *derivPtr = m_JointPDFDerivatives->GetBufferPointer()
@@ -1128,18 +1180,27 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
       }   // end for-loop over moving index
     }     // end for-loop over fixed index
 
-  if ( !( this->m_UseExplicitPDFDerivatives ) )
+  if ( !useExplicitPDFDerivatives )
     {
-    // Second pass: This one is done for accumulating the contributions
-    //              to the derivative array.
-    //
-    this->m_ImplicitDerivativesSecondPass = true;
-    //
-    // MUST BE CALLED TO INITIATE PROCESSING ON SAMPLES
-    this->GetValueAndDerivativeMultiThreadedInitiate();
+    if ( this->m_SparsePDFDerivativesActive )
+      {
+      // Accumulate the contributions of the recorded samples without
+      // revisiting the moving image.
+      this->ComputeSparsePDFDerivativesMultiThreadedInitiate();
+      }
+    else
+      {
+      // Second pass: This one is done for accumulating the contributions
+      //              to the derivative array.
+      //
+      this->m_ImplicitDerivativesSecondPass = true;
+      //
+      // MUST BE CALLED TO INITIATE PROCESSING ON SAMPLES
+      this->GetValueAndDerivativeMultiThreadedInitiate();
 
-    // CALL IF DOING THREADED POST PROCESSING
-    this->GetValueAndDerivativeMultiThreadedPostProcessInitiate();
+      // CALL IF DOING THREADED POST PROCESSING
+      this->GetValueAndDerivativeMultiThreadedPostProcessInitiate();
+      }
 
     // Consolidate the contributions from each one of the threads to the total
     // derivative.
@@ -1173,6 +1234,138 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   this->GetValueAndDerivative(parameters, value, derivative);
 }
 
+template< class TFixedImage, class TMovingImage >
+void
+MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeSparsePDFDerivativesMultiThreadedInitiate(void) const
+{
+  this->m_Threader->SetSingleMethod( ComputeSparsePDFDerivativesMultiThreaded,
+                                     const_cast< void * >( static_cast< const void * >( this ) ) );
+  this->m_Threader->SingleMethodExecute();
+}
+
+template< class TFixedImage, class TMovingImage >
+ITK_THREAD_RETURN_TYPE
+MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeSparsePDFDerivativesMultiThreaded(void *arg)
+{
+  int         threadID;
+  const Self *metric;
+
+  threadID = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+
+  metric = (const Self *)
+           ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  metric->ComputeSparsePDFDerivativesThread(threadID);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/**
+ * Accumulate the derivative contributions of the samples recorded
+ * while building the Joint PDF. For a sample falling in fixed bin f,
+ * the derivative of the metric with respect to a parameter mu is
+ *
+ *   sum_m pRatio(f,m) * B'(m - term) * gradient . Jacobian(mu)
+ *
+ * The sum over the four moving bins affected by the cubic Parzen window
+ * does not depend on mu, so it is folded into a single weight and only
+ * the parameters in the support of the BSpline weights are updated.
+ */
+template< class TFixedImage, class TMovingImage >
+void
+MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeSparsePDFDerivativesThread(unsigned int threadID) const
+{
+  // Use the same partition of the samples as the sample processing pass.
+  unsigned long chunkSize = this->m_FixedImageSamples.size() / this->m_NumberOfThreads;
+  unsigned long fixedImageSample = threadID * chunkSize;
+
+  if ( threadID == this->m_NumberOfThreads - 1 )
+    {
+    chunkSize = this->m_FixedImageSamples.size()
+                - ( ( this->m_NumberOfThreads - 1 ) * chunkSize );
+    }
+
+  DerivativeType *                derivativeHelperArray;
+  BSplineTransformWeightsType *   weightsHelper;
+  BSplineTransformIndexArrayType *indicesHelper;
+
+  if ( threadID > 0 )
+    {
+    derivativeHelperArray = &( this->m_ThreaderMetricDerivative[threadID - 1] );
+    weightsHelper = &( this->m_ThreaderBSplineTransformWeights[threadID - 1] );
+    indicesHelper = &( this->m_ThreaderBSplineTransformIndices[threadID - 1] );
+    }
+  else
+    {
+    derivativeHelperArray = &( this->m_MetricDerivative );
+    weightsHelper = &( this->m_BSplineTransformWeights );
+    indicesHelper = &( this->m_BSplineTransformIndices );
+    }
+
+  for ( unsigned long count = 0; count < chunkSize; ++count, ++fixedImageSample )
+    {
+    const SparsePDFDerivativeSampleType & sparseSample =
+      this->m_SparsePDFDerivativeSamples[fixedImageSample];
+
+    if ( sparseSample.MovingImageParzenWindowIndex < 0 )
+      {
+      continue;
+      }
+
+    const unsigned int pdfFixedIndex =
+      this->m_FixedImageSamples[fixedImageSample].valueIndex;
+
+    int    pdfMovingIndex = static_cast< int >( sparseSample.MovingImageParzenWindowIndex ) - 1;
+    double movingImageParzenWindowArg = static_cast< double >( pdfMovingIndex )
+                                        - sparseSample.MovingImageParzenWindowTerm;
+
+    // Fold the Parzen window derivative into a single weight per sample.
+    double sampleWeight = 0.0;
+    for ( unsigned int k = 0; k < 4; ++k, ++pdfMovingIndex )
+      {
+      sampleWeight += this->m_PRatioArray[pdfFixedIndex][pdfMovingIndex]
+                      * m_CubicBSplineDerivativeKernel->Evaluate(movingImageParzenWindowArg);
+      movingImageParzenWindowArg += 1;
+      }
+
+    if ( sampleWeight == 0.0 )
+      {
+      continue;
+      }
+
+    const WeightsValueType *weights;
+    const IndexValueType *  indices;
+
+    if ( this->m_UseCachingOfBSplineWeights )
+      {
+      weights = this->m_BSplineTransformWeightsArray[fixedImageSample];
+      indices = this->m_BSplineTransformIndicesArray[fixedImageSample];
+      }
+    else
+      {
+      this->m_BSplineTransform->GetJacobian(
+        this->m_FixedImageSamples[fixedImageSample].point,
+        *weightsHelper, *indicesHelper);
+      weights = weightsHelper->data_block();
+      indices = indicesHelper->data_block();
+      }
+
+    for ( unsigned int dim = 0; dim < Superclass::FixedImageDimension; dim++ )
+      {
+      const double dimWeight = sampleWeight * sparseSample.MovingImageGradient[dim];
+      const unsigned long parametersOffset = this->m_BSplineParametersOffset[dim];
+
+      for ( unsigned int mu = 0; mu < this->m_NumBSplineWeights; mu++ )
+        {
+        ( *derivativeHelperArray )[indices[mu] + parametersOffset] += dimWeight * weights[mu];
+        }
+      }
+    }
+}
+
 /**
  * Compute PDF derivatives contribution for each parameter
  */
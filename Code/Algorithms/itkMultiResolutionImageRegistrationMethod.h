@@ -22,6 +22,7 @@
 #include "itkImageToImageMetric.h"
 #include "itkSingleValuedNonLinearOptimizer.h"
 #include "itkMultiResolutionPyramidImageFilter.h"
+#include "itkMultiResolutionPyramidImageCache.h"
 #include "itkNumericTraits.h"
 #include "itkDataObjectDecorator.h"
 
@@ -124,6 +125,12 @@ public:
   typedef MultiResolutionPyramidImageFilter< MovingImageType, MovingImageType > MovingImagePyramidType;
   typedef typename MovingImagePyramidType::Pointer                              MovingImagePyramidPointer;
 
+  /** Type of the caches of pyramid levels. */
+  typedef MultiResolutionPyramidImageCache< FixedImageType >  FixedImagePyramidCacheType;
+  typedef typename FixedImagePyramidCacheType::Pointer        FixedImagePyramidCachePointer;
+  typedef MultiResolutionPyramidImageCache< MovingImageType > MovingImagePyramidCacheType;
+  typedef typename MovingImagePyramidCacheType::Pointer       MovingImagePyramidCachePointer;
+
   /** Type of the Transformation parameters This is the same type used to
    *  represent the search space of the optimization algorithm */
   typedef  typename MetricType::TransformParametersType ParametersType;
@@ -173,6 +180,20 @@ public:
   itkSetObjectMacro(MovingImagePyramid, MovingImagePyramidType);
   itkGetObjectMacro(MovingImagePyramid, MovingImagePyramidType);
 
+  /** Set/Get the cache of the Fixed image pyramid levels. When a cache is
+   * set, the levels of the fixed image are taken from it and the fixed
+   * image pyramid is only executed if the cache does not hold them for the
+   * current fixed image and schedule. A cache can be shared by several
+   * registration methods, for instance when one atlas is registered
+   * against many subjects. By default no cache is used. */
+  itkSetObjectMacro(FixedImagePyramidCache, FixedImagePyramidCacheType);
+  itkGetObjectMacro(FixedImagePyramidCache, FixedImagePyramidCacheType);
+
+  /** Set/Get the cache of the Moving image pyramid levels.
+   * \sa SetFixedImagePyramidCache */
+  itkSetObjectMacro(MovingImagePyramidCache, MovingImagePyramidCacheType);
+  itkGetObjectMacro(MovingImagePyramidCache, MovingImagePyramidCacheType);
+
   /** Set/Get the schedules . */
   void SetSchedules(const ScheduleType & fixedSchedule,
                     const ScheduleType & movingSchedule);
@@ -253,6 +274,13 @@ private:
   MovingImagePyramidPointer m_MovingImagePyramid;
   FixedImagePyramidPointer  m_FixedImagePyramid;
 
+  MovingImagePyramidCachePointer m_MovingImagePyramidCache;
+  FixedImagePyramidCachePointer  m_FixedImagePyramidCache;
+
+  /** Levels in use for the current registration when taken from a cache. */
+  typename FixedImagePyramidCacheType::LevelContainerType  m_FixedImageLevels;
+  typename MovingImagePyramidCacheType::LevelContainerType m_MovingImageLevels;
+
   ParametersType m_InitialTransformParameters;
   ParametersType m_InitialTransformParametersOfNextLevel;
   ParametersType m_LastTransformParameters;
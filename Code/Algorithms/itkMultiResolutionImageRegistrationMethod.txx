@@ -44,6 +44,10 @@ MultiResolutionImageRegistrationMethod< TFixedImage, TMovingImage >
   m_FixedImagePyramid  = FixedImagePyramidType::New();
   m_MovingImagePyramid = MovingImagePyramidType::New();
 
+  // No caching of the pyramid levels by default.
+  m_FixedImagePyramidCache  = 0;
+  m_MovingImagePyramidCache = 0;
+
   m_NumberOfLevels = 1;
   m_CurrentLevel = 0;
 
@@ -98,8 +102,22 @@ throw ( ExceptionObject )
     }
 
   // Setup the metric
-  m_Metric->SetMovingImage( m_MovingImagePyramid->GetOutput(m_CurrentLevel) );
-  m_Metric->SetFixedImage( m_FixedImagePyramid->GetOutput(m_CurrentLevel) );
+  if ( m_MovingImagePyramidCache )
+    {
+    m_Metric->SetMovingImage(m_MovingImageLevels[m_CurrentLevel]);
+    }
+  else
+    {
+    m_Metric->SetMovingImage( m_MovingImagePyramid->GetOutput(m_CurrentLevel) );
+    }
+  if ( m_FixedImagePyramidCache )
+    {
+    m_Metric->SetFixedImage(m_FixedImageLevels[m_CurrentLevel]);
+    }
+  else
+    {
+    m_Metric->SetFixedImage( m_FixedImagePyramid->GetOutput(m_CurrentLevel) );
+    }
   m_Metric->SetTransform(m_Transform);
   m_Metric->SetInterpolator(m_Interpolator);
   m_Metric->SetFixedImageRegion(m_FixedImageRegionPyramid[m_CurrentLevel]);
@@ -238,12 +256,31 @@ MultiResolutionImageRegistrationMethod< TFixedImage, TMovingImage >
     m_MovingImagePyramid->SetSchedule(m_MovingImagePyramidSchedule);
     }
 
-  m_FixedImagePyramid->SetInput(m_FixedImage);
-  m_FixedImagePyramid->UpdateLargestPossibleRegion();
+  // Levels found in a cache are not computed again.
+  if ( m_FixedImagePyramidCache )
+    {
+    m_FixedImageLevels =
+      m_FixedImagePyramidCache->GetLevels(m_FixedImagePyramid, m_FixedImage);
+    }
+  else
+    {
+    m_FixedImageLevels.clear();
+    m_FixedImagePyramid->SetInput(m_FixedImage);
+    m_FixedImagePyramid->UpdateLargestPossibleRegion();
+    }
 
   // Setup the moving image pyramid
-  m_MovingImagePyramid->SetInput(m_MovingImage);
-  m_MovingImagePyramid->UpdateLargestPossibleRegion();
+  if ( m_MovingImagePyramidCache )
+    {
+    m_MovingImageLevels =
+      m_MovingImagePyramidCache->GetLevels(m_MovingImagePyramid, m_MovingImage);
+    }
+  else
+    {
+    m_MovingImageLevels.clear();
+    m_MovingImagePyramid->SetInput(m_MovingImage);
+    m_MovingImagePyramid->UpdateLargestPossibleRegion();
+    }
 
   typedef typename FixedImageRegionType::SizeType  SizeType;
   typedef typename FixedImageRegionType::IndexType IndexType;
@@ -394,6 +431,10 @@ MultiResolutionImageRegistrationMethod< TFixedImage, TMovingImage >
   os << m_FixedImagePyramid.GetPointer() << std::endl;
   os << indent << "MovingImagePyramid: ";
   os << m_MovingImagePyramid.GetPointer() << std::endl;
+  os << indent << "FixedImagePyramidCache: ";
+  os << m_FixedImagePyramidCache.GetPointer() << std::endl;
+  os << indent << "MovingImagePyramidCache: ";
+  os << m_MovingImagePyramidCache.GetPointer() << std::endl;
 
   os << indent << "NumberOfLevels: ";
   os << m_NumberOfLevels << std::endl;
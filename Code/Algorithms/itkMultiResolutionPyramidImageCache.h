@@ -0,0 +1,164 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkMultiResolutionPyramidImageCache_h
+#define __itkMultiResolutionPyramidImageCache_h
+
+#include "itkMultiResolutionPyramidImageFilter.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class MultiResolutionPyramidImageCache
+ * \brief Keeps the levels of multi-resolution pyramids so that they can be
+ * shared between several registrations.
+ *
+ * MultiResolutionPyramidImageCache stores the levels produced by a
+ * MultiResolutionPyramidImageFilter for a given image. An entry is
+ * identified by the image, the modified time of the image, the class of
+ * the pyramid filter and its settings (schedule, maximum error and
+ * UseShrinkImageFilter). When the same image is requested again from an
+ * equivalent pyramid and the image has not been modified since, the stored
+ * levels are returned and the pyramid filter is not executed. The image is
+ * brought up to date before the lookup, so a change upstream of the image
+ * is seen as a new version of the image.
+ *
+ * A typical use is the registration of one atlas against many subjects
+ * with MultiResolutionImageRegistrationMethod: a single cache is set as the
+ * fixed image pyramid cache of every registration, so the atlas is smoothed
+ * and downsampled only once.
+ *
+ * Levels computed outside of this class can be added with SetLevels().
+ *
+ * The cache holds references to the images it was given. The number of
+ * entries kept is bounded by MaximumNumberOfEntries; when it is exceeded
+ * the oldest entry is released.
+ *
+ * The entries are guarded by a lock, so a cache can be used by
+ * registrations running in different threads. The pyramid filter and the
+ * pipeline of the image are executed while the lock is held.
+ *
+ * \sa MultiResolutionPyramidImageFilter
+ * \sa MultiResolutionImageRegistrationMethod
+ * \ingroup RegistrationFilters
+ */
+template< class TImage >
+class ITK_EXPORT MultiResolutionPyramidImageCache:public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef MultiResolutionPyramidImageCache Self;
+  typedef Object                           Superclass;
+  typedef SmartPointer< Self >             Pointer;
+  typedef SmartPointer< const Self >       ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MultiResolutionPyramidImageCache, Object);
+
+  /** Image related typedefs. */
+  typedef TImage                           ImageType;
+  typedef typename ImageType::Pointer      ImagePointer;
+  typedef typename ImageType::ConstPointer ImageConstPointer;
+
+  /** Pyramid related typedefs. */
+  typedef MultiResolutionPyramidImageFilter< ImageType, ImageType > PyramidType;
+  typedef typename PyramidType::ScheduleType                       ScheduleType;
+
+  /** Container for the levels of one pyramid, from the coarsest to the
+   * finest, in the same order as the outputs of the pyramid filter. */
+  typedef std::vector< ImagePointer > LevelContainerType;
+
+  /** Return the levels of the pyramid of the image computed by the
+   * pyramid filter with its current settings. The image is updated first.
+   * If the levels are not in the cache, the pyramid filter is executed on
+   * the image and its outputs are stored. */
+  LevelContainerType GetLevels(PyramidType *pyramid,
+                               const ImageType *image);
+
+  /** Store externally computed levels for an image, as the given pyramid
+   * filter would compute them with its current settings. The number of
+   * levels must match the number of levels of the pyramid. */
+  void SetLevels(const ImageType *image,
+                 const PyramidType *pyramid,
+                 const LevelContainerType & levels);
+
+  /** Return true if levels are cached for the image and the pyramid
+   * filter with its current settings. The image is not updated. */
+  bool HasLevels(const ImageType *image,
+                 const PyramidType *pyramid) const;
+
+  /** Release all the cached levels. */
+  void ReleaseLevels();
+
+  /** Get the number of cached pyramids. */
+  unsigned int GetNumberOfEntries() const;
+
+  /** Set/Get the maximum number of cached pyramids. The default is 1. */
+  itkSetClampMacro( MaximumNumberOfEntries, unsigned int,
+                    1, NumericTraits< unsigned int >::max() );
+  itkGetConstMacro(MaximumNumberOfEntries, unsigned int);
+protected:
+  MultiResolutionPyramidImageCache();
+  ~MultiResolutionPyramidImageCache() {}
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+private:
+  MultiResolutionPyramidImageCache(const Self &); //purposely not implemented
+  void operator=(const Self &);                   //purposely not implemented
+
+  struct EntryType {
+    ImageConstPointer Image;
+    unsigned long ImageMTime;
+    std::string PyramidClass;
+    ScheduleType Schedule;
+    double MaximumError;
+    bool UseShrinkImageFilter;
+    LevelContainerType Levels;
+  };
+
+  typedef std::vector< EntryType > EntryContainerType;
+
+  /** Fill the key of an entry from the image and the pyramid filter. */
+  void SetKey(EntryType & entry, const ImageType *image,
+              const PyramidType *pyramid) const;
+
+  /** Return the index of the entry matching the image and the pyramid
+   * filter, or -1 if there is none. The lock must be held. */
+  int FindEntry(const ImageType *image, const PyramidType *pyramid) const;
+
+  /** Append an entry, releasing the oldest ones if needed. */
+  void AddEntry(const EntryType & entry);
+
+  EntryContainerType m_Entries;
+  unsigned int       m_MaximumNumberOfEntries;
+
+  /** Guards the entries. */
+  mutable SimpleFastMutexLock m_Lock;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMultiResolutionPyramidImageCache.txx"
+#endif
+
+#endif
@@ -0,0 +1,295 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkMultiResolutionPyramidImageCache_txx
+#define __itkMultiResolutionPyramidImageCache_txx
+
+#include "itkMultiResolutionPyramidImageCache.h"
+
+namespace itk
+{
+/**
+ * Constructor
+ */
+template< class TImage >
+MultiResolutionPyramidImageCache< TImage >
+::MultiResolutionPyramidImageCache()
+{
+  m_MaximumNumberOfEntries = 1;
+}
+
+/**
+ * Identify the image version and the pyramid that computes the levels
+ */
+template< class TImage >
+void
+MultiResolutionPyramidImageCache< TImage >
+::SetKey(EntryType & entry, const ImageType *image,
+         const PyramidType *pyramid) const
+{
+  entry.Image = image;
+  entry.ImageMTime = image->GetMTime();
+  entry.PyramidClass = pyramid->GetNameOfClass();
+  entry.Schedule = pyramid->GetSchedule();
+  entry.MaximumError = pyramid->GetMaximumError();
+  entry.UseShrinkImageFilter = pyramid->GetUseShrinkImageFilter();
+}
+
+/**
+ * Look for an entry matching the image, its modified time and the pyramid
+ */
+template< class TImage >
+int
+MultiResolutionPyramidImageCache< TImage >
+::FindEntry(const ImageType *image, const PyramidType *pyramid) const
+{
+  if ( !image || !pyramid )
+    {
+    return -1;
+    }
+
+  EntryType key;
+  this->SetKey(key, image, pyramid);
+
+  for ( unsigned int i = 0; i < m_Entries.size(); i++ )
+    {
+    const EntryType & entry = m_Entries[i];
+    if ( entry.Image == key.Image
+         && entry.ImageMTime == key.ImageMTime
+         && entry.PyramidClass == key.PyramidClass
+         && entry.Schedule.rows() == key.Schedule.rows()
+         && entry.Schedule.cols() == key.Schedule.cols()
+         && entry.Schedule == key.Schedule
+         && entry.MaximumError == key.MaximumError
+         && entry.UseShrinkImageFilter == key.UseShrinkImageFilter )
+      {
+      return static_cast< int >( i );
+      }
+    }
+  return -1;
+}
+
+/**
+ * Append an entry, replacing stale entries of the same image
+ */
+template< class TImage >
+void
+MultiResolutionPyramidImageCache< TImage >
+::AddEntry(const EntryType & entry)
+{
+  // Entries of an older version of the image can never be hit again.
+  typename EntryContainerType::iterator it = m_Entries.begin();
+  while ( it != m_Entries.end() )
+    {
+    if ( it->Image == entry.Image && it->ImageMTime != entry.ImageMTime )
+      {
+      it = m_Entries.erase(it);
+      }
+    else
+      {
+      ++it;
+      }
+    }
+
+  m_Entries.push_back(entry);
+
+  while ( m_Entries.size() > m_MaximumNumberOfEntries )
+    {
+    m_Entries.erase( m_Entries.begin() );
+    }
+}
+
+/**
+ * Get the levels, running the pyramid on a cache miss
+ */
+template< class TImage >
+typename MultiResolutionPyramidImageCache< TImage >::LevelContainerType
+MultiResolutionPyramidImageCache< TImage >
+::GetLevels(PyramidType *pyramid, const ImageType *image)
+{
+  if ( !pyramid )
+    {
+    itkExceptionMacro(<< "Pyramid is not present");
+    }
+
+  if ( !image )
+    {
+    itkExceptionMacro(<< "Image is not present");
+    }
+
+  m_Lock.Lock();
+
+  try
+    {
+    // Bring the image up to date, as the pyramid filter would. If its
+    // source executes, the image is modified and the cached levels of the
+    // previous version are not hit.
+    ImageType *input = const_cast< ImageType * >( image );
+    input->UpdateOutputInformation();
+    input->SetRequestedRegionToLargestPossibleRegion();
+    input->Update();
+    }
+  catch ( ... )
+    {
+    m_Lock.Unlock();
+    throw;
+    }
+
+  const int found = this->FindEntry(image, pyramid);
+  if ( found >= 0 )
+    {
+    itkDebugMacro(<< "Reusing cached pyramid of image " << image);
+    LevelContainerType levels = m_Entries[found].Levels;
+    m_Lock.Unlock();
+    return levels;
+    }
+
+  itkDebugMacro(<< "Computing pyramid of image " << image);
+
+  try
+    {
+    pyramid->SetInput(image);
+    pyramid->UpdateLargestPossibleRegion();
+    }
+  catch ( ... )
+    {
+    m_Lock.Unlock();
+    throw;
+    }
+
+  EntryType entry;
+  this->SetKey(entry, image, pyramid);
+
+  const unsigned int numberOfLevels = pyramid->GetNumberOfLevels();
+  entry.Levels.resize(numberOfLevels);
+  for ( unsigned int level = 0; level < numberOfLevels; level++ )
+    {
+    // Take the output away from the pyramid so that running the pyramid
+    // again does not overwrite the cached level.
+    ImagePointer output = pyramid->GetOutput(level);
+    output->DisconnectPipeline();
+    entry.Levels[level] = output;
+    }
+
+  this->AddEntry(entry);
+
+  m_Lock.Unlock();
+
+  return entry.Levels;
+}
+
+/**
+ * Store externally computed levels
+ */
+template< class TImage >
+void
+MultiResolutionPyramidImageCache< TImage >
+::SetLevels(const ImageType *image,
+            const PyramidType *pyramid,
+            const LevelContainerType & levels)
+{
+  if ( !pyramid )
+    {
+    itkExceptionMacro(<< "Pyramid is not present");
+    }
+
+  if ( !image )
+    {
+    itkExceptionMacro(<< "Image is not present");
+    }
+
+  if ( levels.size() != pyramid->GetNumberOfLevels() )
+    {
+    itkExceptionMacro(<< "The number of levels (" << levels.size()
+                      << ") does not match the pyramid ("
+                      << pyramid->GetNumberOfLevels() << " levels)");
+    }
+
+  m_Lock.Lock();
+  const int found = this->FindEntry(image, pyramid);
+  if ( found >= 0 )
+    {
+    m_Entries[found].Levels = levels;
+    }
+  else
+    {
+    EntryType entry;
+    this->SetKey(entry, image, pyramid);
+    entry.Levels = levels;
+    this->AddEntry(entry);
+    }
+  m_Lock.Unlock();
+
+  this->Modified();
+}
+
+template< class TImage >
+bool
+MultiResolutionPyramidImageCache< TImage >
+::HasLevels(const ImageType *image, const PyramidType *pyramid) const
+{
+  m_Lock.Lock();
+  const bool found = this->FindEntry(image, pyramid) >= 0;
+  m_Lock.Unlock();
+  return found;
+}
+
+template< class TImage >
+void
+MultiResolutionPyramidImageCache< TImage >
+::ReleaseLevels()
+{
+  m_Lock.Lock();
+  m_Entries.clear();
+  m_Lock.Unlock();
+  this->Modified();
+}
+
+template< class TImage >
+unsigned int
+MultiResolutionPyramidImageCache< TImage >
+::GetNumberOfEntries() const
+{
+  m_Lock.Lock();
+  const unsigned int numberOfEntries = static_cast< unsigned int >( m_Entries.size() );
+  m_Lock.Unlock();
+  return numberOfEntries;
+}
+
+/**
+ * PrintSelf
+ */
+template< class TImage >
+void
+MultiResolutionPyramidImageCache< TImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "MaximumNumberOfEntries: " << m_MaximumNumberOfEntries << std::endl;
+  m_Lock.Lock();
+  os << indent << "NumberOfEntries: " << m_Entries.size() << std::endl;
+  for ( unsigned int i = 0; i < m_Entries.size(); i++ )
+    {
+    os << indent.GetNextIndent() << "Image: " << m_Entries[i].Image.GetPointer()
+       << " Pyramid: " << m_Entries[i].PyramidClass
+       << " Levels: " << m_Entries[i].Levels.size() << std::endl;
+    }
+  m_Lock.Unlock();
+}
+} // end namespace itk
+
+#endif
@@ -21,6 +21,8 @@
 #include "itkDenseFiniteDifferenceImageFilter.h"
 #include "itkPDEDeformableRegistrationFunction.h"
 
+#include <vector>
+
 namespace itk
 {
 /**
@@ -54,10 +56,12 @@ namespace itk
  * of smoothing is governed by a set of user defined standard deviations
  * (one for each dimension).
  *
- * In terms of memory, this filter keeps two internal buffers: one for storing
- * the intermediate updates to the field and one for double-buffering when
- * smoothing the deformation field. Both buffers are the same type and size as the
- * output deformation field.
+ * In terms of memory, this filter keeps one internal buffer for storing
+ * the intermediate updates to the field. It is the same type and size as the
+ * output deformation field. Smoothing of the deformation and update fields
+ * is done in place, one direction at a time: each thread filters whole lines
+ * of its piece of the field through a line buffer, so no additional field
+ * sized buffer is allocated during the iterations.
  *
  * This class make use of the finite difference solver hierarchy. Update
  * for each iteration is computed using a PDEDeformableRegistrationFunction.
@@ -229,6 +233,13 @@ protected:
    * UpdateFieldStandardDeviations. */
   virtual void SmoothUpdateField();
 
+  /** Utility to smooth a field in place using a separable Gaussian
+   * operator with the given standard deviations (in pixel units).
+   * The kernel is the one of GaussianOperator and the field is extended
+   * by zero-flux Neumann conditions at the border of its buffered region. */
+  virtual void SmoothGivenField(DeformationFieldType *field,
+                                const double StandardDeviations[]);
+
   /** This method is called after the solution has been generated. In this case,
    * the filter release the memory of the internal buffers. */
   virtual void PostProcessOutput();
@@ -262,9 +273,36 @@ private:
   bool m_SmoothDeformationField;
   bool m_SmoothUpdateField;
 
-  /** Temporary deformation field use for smoothing the
-   * the deformation field. */
-  DeformationFieldPointer m_TempField;
+  /** Types used by the in-place smoothing. */
+  typedef typename DeformationFieldType::PixelType  DeformationVectorType;
+  typedef typename DeformationFieldType::RegionType DeformationFieldRegionType;
+  typedef std::vector< DeformationVectorType >      LineBufferType;
+
+  /** Structure for passing information into the static smoothing
+   * callback. */
+  struct SmoothingThreadStruct {
+    Self *Filter;
+    DeformationFieldType *Field;
+    unsigned int Direction;
+    const double *Kernel;
+    int Radius;
+  };
+
+  /** Split the buffered region of the field along a dimension other than
+   * the smoothing direction, so that every line lies within one piece. */
+  int SplitSmoothingRegion(int i, int num, unsigned int direction,
+                           const DeformationFieldRegionType & region,
+                           DeformationFieldRegionType & splitRegion) const;
+
+  /** Filter all the lines of the region along the given direction. */
+  void ThreadedSmoothGivenField(const SmoothingThreadStruct & str,
+                                const DeformationFieldRegionType & region,
+                                int threadId);
+
+  static ITK_THREAD_RETURN_TYPE SmoothGivenFieldThreaderCallback(void *arg);
+
+  /** One line buffer per thread, reused across iterations. */
+  std::vector< LineBufferType > m_SmoothingLineBuffers;
 private:
   /** Maximum error for Gaussian operator approximation. */
   double m_MaximumError;
@@ -25,7 +25,6 @@
 #include "itkDataObject.h"
 
 #include "itkGaussianOperator.h"
-#include "itkVectorNeighborhoodOperatorImageFilter.h"
 
 #include "vnl/vnl_math.h"
 
@@ -49,7 +48,6 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
     m_UpdateFieldStandardDeviations[j] = 1.0;
     }
 
-  m_TempField = DeformationFieldType::New();
   m_MaximumError = 0.1;
   m_MaximumKernelWidth = 30;
   m_StopRegistrationFlag = false;
@@ -363,7 +361,7 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
 ::PostProcessOutput()
 {
   this->Superclass::PostProcessOutput();
-  m_TempField->Initialize();
+  m_SmoothingLineBuffers.clear();
 }
 
 /*
@@ -388,123 +386,218 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
 {
   DeformationFieldPointer field = this->GetOutput();
 
-  // copy field to TempField
-  m_TempField->SetOrigin( field->GetOrigin() );
-  m_TempField->SetSpacing( field->GetSpacing() );
-  m_TempField->SetDirection( field->GetDirection() );
-  m_TempField->SetLargestPossibleRegion(
-    field->GetLargestPossibleRegion() );
-  m_TempField->SetRequestedRegion(
-    field->GetRequestedRegion() );
-  m_TempField->SetBufferedRegion( field->GetBufferedRegion() );
-  m_TempField->Allocate();
-
-  typedef typename DeformationFieldType::PixelType       VectorType;
-  typedef typename VectorType::ValueType                 ScalarType;
+  this->SmoothGivenField(field, m_StandardDeviations);
+}
+
+/*
+ * Smooth update field using a separable Gaussian kernel
+ */
+template< class TFixedImage, class TMovingImage, class TDeformationField >
+void
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
+::SmoothUpdateField()
+{
+  // The update buffer will be overwritten with new data.
+  DeformationFieldPointer field = this->GetUpdateBuffer();
+
+  this->SmoothGivenField(field, m_UpdateFieldStandardDeviations);
+}
+
+/*
+ * Smooth a field in place using a separable Gaussian kernel
+ */
+template< class TFixedImage, class TMovingImage, class TDeformationField >
+void
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
+::SmoothGivenField(DeformationFieldType *field,
+                   const double StandardDeviations[])
+{
+  typedef typename DeformationVectorType::ValueType      ScalarType;
   typedef GaussianOperator< ScalarType, ImageDimension > OperatorType;
-  typedef VectorNeighborhoodOperatorImageFilter<
-    DeformationFieldType,
-    DeformationFieldType >                             SmootherType;
 
-  OperatorType *oper = new OperatorType;
-  typename SmootherType::Pointer smoother = SmootherType::New();
+  const int numberOfThreads = this->GetNumberOfThreads();
 
-  typedef typename DeformationFieldType::PixelContainerPointer
-  PixelContainerPointer;
-  PixelContainerPointer swapPtr;
+  if ( m_SmoothingLineBuffers.size() != static_cast< unsigned int >( numberOfThreads ) )
+    {
+    m_SmoothingLineBuffers.resize(numberOfThreads);
+    }
+
+  OperatorType       oper;
+  std::vector< double > kernel;
 
-  // graft the output field onto the mini-pipeline
-  smoother->GraftOutput(m_TempField);
+  SmoothingThreadStruct str;
+  str.Filter = this;
+  str.Field = field;
 
   for ( unsigned int j = 0; j < ImageDimension; j++ )
     {
     // smooth along this dimension
-    oper->SetDirection(j);
-    double variance = vnl_math_sqr(m_StandardDeviations[j]);
-    oper->SetVariance(variance);
-    oper->SetMaximumError(m_MaximumError);
-    oper->SetMaximumKernelWidth(m_MaximumKernelWidth);
-    oper->CreateDirectional();
-
-    // todo: make sure we only smooth within the buffered region
-    smoother->SetOperator(*oper);
-    smoother->SetInput(field);
-    smoother->Update();
-
-    if ( j < ImageDimension - 1 )
+    oper.SetDirection(j);
+    double variance = vnl_math_sqr(StandardDeviations[j]);
+    oper.SetVariance(variance);
+    oper.SetMaximumError(m_MaximumError);
+    oper.SetMaximumKernelWidth(m_MaximumKernelWidth);
+    oper.CreateDirectional();
+
+    kernel.resize( oper.Size() );
+    for ( unsigned int k = 0; k < oper.Size(); k++ )
       {
-      // swap the containers
-      swapPtr = smoother->GetOutput()->GetPixelContainer();
-      smoother->GraftOutput(field);
-      field->SetPixelContainer(swapPtr);
-      smoother->Modified();
+      kernel[k] = oper[k];
       }
+
+    str.Direction = j;
+    str.Kernel = &( kernel[0] );
+    str.Radius = static_cast< int >( oper.GetRadius(j) );
+
+    this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+    this->GetMultiThreader()->SetSingleMethod(this->SmoothGivenFieldThreaderCallback,
+                                              &str);
+    this->GetMultiThreader()->SingleMethodExecute();
     }
 
-  // graft the output back to this filter
-  m_TempField->SetPixelContainer( field->GetPixelContainer() );
-  this->GraftOutput( smoother->GetOutput() );
+  // The buffer was changed through raw pointers.
+  field->Modified();
+}
+
+template< class TFixedImage, class TMovingImage, class TDeformationField >
+ITK_THREAD_RETURN_TYPE
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
+::SmoothGivenFieldThreaderCallback(void *arg)
+{
+  SmoothingThreadStruct *str;
+  int                    total, threadId, threadCount;
+
+  threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  str = (SmoothingThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  DeformationFieldRegionType splitRegion;
+  total = str->Filter->SplitSmoothingRegion(threadId, threadCount, str->Direction,
+                                            str->Field->GetBufferedRegion(),
+                                            splitRegion);
+
+  if ( threadId < total )
+    {
+    str->Filter->ThreadedSmoothGivenField(*str, splitRegion, threadId);
+    }
 
-  delete oper;
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TFixedImage, class TMovingImage, class TDeformationField >
+int
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
+::SplitSmoothingRegion(int i, int num, unsigned int direction,
+                       const DeformationFieldRegionType & region,
+                       DeformationFieldRegionType & splitRegion) const
+{
+  splitRegion = region;
+
+  // Lines along the smoothing direction must not be cut, so split the
+  // outermost of the remaining dimensions.
+  int splitAxis = ImageDimension - 1;
+  if ( static_cast< unsigned int >( splitAxis ) == direction )
+    {
+    --splitAxis;
+    }
+  if ( splitAxis < 0 )
+    {
+    return 1;
+    }
+
+  const typename DeformationFieldRegionType::SizeValueType range =
+    region.GetSize()[splitAxis];
+  if ( range == 0 )
+    {
+    return 1;
+    }
+
+  // determine the actual number of pieces that will be generated
+  const int valuesPerThread = (int)vcl_ceil( range / (double)num );
+  const int maxThreadIdUsed = (int)vcl_ceil( range / (double)valuesPerThread ) - 1;
+
+  typename DeformationFieldRegionType::IndexType splitIndex = region.GetIndex();
+  typename DeformationFieldRegionType::SizeType  splitSize = region.GetSize();
+
+  if ( i < maxThreadIdUsed )
+    {
+    splitIndex[splitAxis] += i * valuesPerThread;
+    splitSize[splitAxis] = valuesPerThread;
+    }
+  if ( i == maxThreadIdUsed )
+    {
+    splitIndex[splitAxis] += i * valuesPerThread;
+    splitSize[splitAxis] = splitSize[splitAxis] - i * valuesPerThread;
+    }
+
+  splitRegion.SetIndex(splitIndex);
+  splitRegion.SetSize(splitSize);
+
+  return maxThreadIdUsed + 1;
 }
 
-/*
- * Smooth deformation using a separable Gaussian kernel
- */
 template< class TFixedImage, class TMovingImage, class TDeformationField >
 void
 PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
-::SmoothUpdateField()
+::ThreadedSmoothGivenField(const SmoothingThreadStruct & str,
+                           const DeformationFieldRegionType & region,
+                           int threadId)
 {
-  // The update buffer will be overwritten with new data.
-  DeformationFieldPointer field = this->GetUpdateBuffer();
+  const unsigned int direction = str.Direction;
+  const int          length = static_cast< int >( region.GetSize()[direction] );
 
-  typedef typename DeformationFieldType::PixelType       VectorType;
-  typedef typename VectorType::ValueType                 ScalarType;
-  typedef GaussianOperator< ScalarType, ImageDimension > OperatorType;
-  typedef VectorNeighborhoodOperatorImageFilter<
-    DeformationFieldType,
-    DeformationFieldType >                             SmootherType;
+  if ( length == 0 )
+    {
+    return;
+    }
 
-  OperatorType opers[ImageDimension];
-  typename SmootherType::Pointer smoothers[ImageDimension];
+  const int     radius = str.Radius;
+  const double *kernel = str.Kernel;
 
-  for ( unsigned int j = 0; j < ImageDimension; j++ )
+  const typename DeformationFieldType::OffsetValueType stride =
+    str.Field->GetOffsetTable()[direction];
+
+  LineBufferType & line = m_SmoothingLineBuffers[threadId];
+  line.resize(length);
+
+  typedef ImageLinearIteratorWithIndex< DeformationFieldType > LineIteratorType;
+  LineIteratorType it(str.Field, region);
+  it.SetDirection(direction);
+
+  for ( it.GoToBegin(); !it.IsAtEnd(); it.NextLine() )
     {
-    // smooth along this dimension
-    opers[j].SetDirection(j);
-    double variance = vnl_math_sqr(this->GetUpdateFieldStandardDeviations()[j]);
-    //double variance = vnl_math_sqr( 1.0 );
-    opers[j].SetVariance(variance);
-    opers[j].SetMaximumError( this->GetMaximumError() );
-    opers[j].SetMaximumKernelWidth( this->GetMaximumKernelWidth() );
-    opers[j].CreateDirectional();
-
-    smoothers[j] = SmootherType::New();
-    smoothers[j]->SetOperator(opers[j]);
-    smoothers[j]->ReleaseDataFlagOn();
-
-    if ( j > 0 )
+    DeformationVectorType *linePtr = &( it.Value() );
+
+    // Copy the line so that it can be overwritten in place.
+    for ( int k = 0; k < length; k++ )
+      {
+      line[k] = linePtr[k * stride];
+      }
+
+    for ( int k = 0; k < length; k++ )
       {
-      smoothers[j]->SetInput( smoothers[j - 1]->GetOutput() );
+      DeformationVectorType sum;
+      sum.Fill(0);
+
+      for ( int m = -radius; m <= radius; m++ )
+        {
+        // zero-flux Neumann boundary condition
+        int n = k + m;
+        if ( n < 0 )
+          {
+          n = 0;
+          }
+        else if ( n >= length )
+          {
+          n = length - 1;
+          }
+        sum += line[n] * kernel[m + radius];
+        }
+
+      linePtr[k * stride] = sum;
       }
     }
-  smoothers[0]->SetInput(field);
-  smoothers[ImageDimension - 1]->GetOutput()
-  ->SetRequestedRegion( field->GetBufferedRegion() );
-
-  smoothers[ImageDimension - 1]->Update();
-
-  // field to contain the final smoothed data, do the equivalent of a graft
-  field->SetPixelContainer( smoothers[ImageDimension - 1]->GetOutput()
-                            ->GetPixelContainer() );
-  field->SetRequestedRegion( smoothers[ImageDimension - 1]->GetOutput()
-                             ->GetRequestedRegion() );
-  field->SetBufferedRegion( smoothers[ImageDimension - 1]->GetOutput()
-                            ->GetBufferedRegion() );
-  field->SetLargestPossibleRegion( smoothers[ImageDimension - 1]->GetOutput()
-                                   ->GetLargestPossibleRegion() );
-  field->CopyInformation( smoothers[ImageDimension - 1]->GetOutput() );
 }
 } // end namespace itk
 
@@ -0,0 +1,504 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+// histogram from the moving histogram operations
+#ifndef __itkRankHistogram_h
+#define __itkRankHistogram_h
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace itk
+{
+namespace Function
+{
+// a simple histogram class hierarchy. One subclass will be sorted
+// windows or maps, the other vectors.
+// This version is intended for keeping track of arbitary ranks. It is
+// based on the code from consolidatedMorphology.
+//
+// Support for different TCompare hasn't been tested, and shouldn't be
+// necessary for the rank filters.
+//
+// The histogram may be empty when it is used with masks.
+
+// The generic histogram keeps the values of the window sorted, so the
+// value at a given rank is found directly. Inserting and removing a
+// value moves the larger values of the window, which is faster than
+// maintaining a tree while the window fits in about 16 kilobytes. Past
+// that size, the moves cost more than the tree, so the values are
+// transferred to a map of the counts of the values, where the rank
+// value is tracked by an iterator. The histogram stays a map from then
+// on, because the windows of a filter all have about the same size.
+template< class TInputPixel >
+class RankHistogram
+{
+public:
+
+  typedef std::less< TInputPixel > TCompare;
+
+  RankHistogram()
+  {
+    m_Rank = 0.5;
+    m_UseMap = false;
+    m_Below = m_Entries = 0;
+    m_RankIt = m_Map.end();
+  }
+
+  RankHistogram(const RankHistogram & hist)
+  {
+    *this = hist;
+  }
+
+  ~RankHistogram()
+  {}
+
+  RankHistogram & operator=(const RankHistogram & hist)
+  {
+    if ( this != &hist )
+      {
+      m_Rank = hist.m_Rank;
+      m_UseMap = hist.m_UseMap;
+      m_Values = hist.m_Values;
+      m_Map = hist.m_Map;
+      m_Below = hist.m_Below;
+      m_Entries = hist.m_Entries;
+      // the iterator has to point in the map of this histogram
+      m_RankIt = m_Map.end();
+      if ( hist.m_RankIt != hist.m_Map.end() )
+        {
+        m_RankIt = m_Map.find(hist.m_RankIt->first);
+        }
+      }
+    return *this;
+  }
+
+  void AddPixel(const TInputPixel & p)
+  {
+    if ( !m_UseMap )
+      {
+      m_Values.insert(std::upper_bound(m_Values.begin(), m_Values.end(), p, m_Compare), p);
+      if ( m_Values.size() > MapThreshold )
+        {
+        this->TransferToMap();
+        }
+      return;
+      }
+
+    typename MapType::iterator it = m_Map.insert( typename MapType::value_type(p, 0) ).first;
+    ++it->second;
+    ++m_Entries;
+    if ( m_RankIt == m_Map.end() )
+      {
+      m_RankIt = it;
+      m_Below = it->second;
+      }
+    else if ( !m_Compare(m_RankIt->first, p) )
+      {
+      ++m_Below;
+      }
+  }
+
+  void RemovePixel(const TInputPixel & p)
+  {
+    if ( !m_UseMap )
+      {
+      typename ValuesType::iterator it =
+        std::lower_bound(m_Values.begin(), m_Values.end(), p, m_Compare);
+
+      itkAssertInDebugAndIgnoreInReleaseMacro( it != m_Values.end() );
+      m_Values.erase(it);
+      return;
+      }
+
+    typename MapType::iterator it = m_Map.find(p);
+    itkAssertInDebugAndIgnoreInReleaseMacro( it != m_Map.end() );
+    itkAssertInDebugAndIgnoreInReleaseMacro( m_Entries >= 1 );
+
+    --it->second;
+    --m_Entries;
+    if ( !m_Compare(m_RankIt->first, p) )
+      {
+      --m_Below;
+      }
+    if ( it->second == 0 )
+      {
+      // the empty bins are erased, so the rank iterator moves to a
+      // neighbor bin when its own is erased
+      if ( it == m_RankIt )
+        {
+        if ( m_RankIt != m_Map.begin() )
+          {
+          --m_RankIt;
+          }
+        else
+          {
+          ++m_RankIt;
+          if ( m_RankIt != m_Map.end() )
+            {
+            m_Below += m_RankIt->second;
+            }
+          }
+        }
+      m_Map.erase(it);
+      }
+  }
+
+  bool IsValid()
+  {
+    return m_UseMap ? m_Entries > 0 : !m_Values.empty();
+  }
+
+  TInputPixel GetValueBruteForce()
+  {
+    if ( !m_UseMap )
+      {
+      return this->GetValue( TInputPixel() );
+      }
+
+    unsigned long count = 0;
+    const unsigned long target = (unsigned long)( m_Rank * ( m_Entries - 1 ) ) + 1;
+    for ( typename MapType::iterator it = m_Map.begin(); it != m_Map.end(); ++it )
+      {
+      count += it->second;
+      if ( count >= target )
+        {
+        return it->first;
+        }
+      }
+    return NumericTraits< TInputPixel >::max();
+  }
+
+  TInputPixel GetValue(const TInputPixel &)
+  {
+    if ( !m_UseMap )
+      {
+      itkAssertInDebugAndIgnoreInReleaseMacro( !m_Values.empty() );
+      const unsigned long target = (unsigned long)( m_Rank * ( m_Values.size() - 1 ) );
+      return m_Values[target];
+      }
+
+    itkAssertInDebugAndIgnoreInReleaseMacro( m_Entries > 0 );
+
+    // m_Below is the number of pixels in the bins up to m_RankIt
+    const unsigned long target = (unsigned long)( m_Rank * ( m_Entries - 1 ) ) + 1;
+    while ( m_Below < target )
+      {
+      ++m_RankIt;
+      m_Below += m_RankIt->second;
+      }
+    while ( m_Below - m_RankIt->second >= target )
+      {
+      m_Below -= m_RankIt->second;
+      --m_RankIt;
+      }
+    itkAssertInDebugAndIgnoreInReleaseMacro( m_RankIt->first == GetValueBruteForce() );
+    return m_RankIt->first;
+  }
+
+  void SetRank(float rank)
+  {
+    m_Rank = rank;
+  }
+
+  void AddBoundary(){}
+
+  void RemoveBoundary(){}
+
+  static bool UseVectorBasedAlgorithm()
+  {
+    return false;
+  }
+
+protected:
+  float m_Rank;
+
+private:
+  typedef typename std::vector< TInputPixel >                       ValuesType;
+  typedef typename std::map< TInputPixel, unsigned long, TCompare > MapType;
+
+  // The number of values above which the sorted window is slower than
+  // the map.
+  itkStaticConstMacro(MapThreshold, unsigned long, 16384 / sizeof( TInputPixel ));
+
+  void TransferToMap()
+  {
+    for ( typename ValuesType::const_iterator it = m_Values.begin(); it != m_Values.end(); ++it )
+      {
+      // the values are sorted, so each one goes at the end of the map
+      m_Map.insert(m_Map.end(), typename MapType::value_type(*it, 0))->second++;
+      }
+    m_Entries = m_Values.size();
+    m_RankIt = m_Map.begin();
+    m_Below = m_RankIt->second;
+    m_UseMap = true;
+    ValuesType().swap(m_Values);
+  }
+
+  bool       m_UseMap;
+  ValuesType m_Values;
+  TCompare   m_Compare;
+
+  MapType       m_Map;
+  unsigned long m_Below;
+  unsigned long m_Entries;
+  // the bin of the last rank value
+  typename MapType::iterator m_RankIt;
+};
+
+
+// The histogram of the pixel types with few values is an array with a
+// bin for each value. The bins are grouped in blocks of 256 values, so
+// that finding the rank value and copying the histogram skip the empty
+// parts of the array of 16 bit pixels.
+template< class TInputPixel >
+class VectorRankHistogram
+{
+public:
+
+  typedef std::less< TInputPixel > TCompare;
+
+  VectorRankHistogram()
+  {
+    m_Size = (long)NumericTraits< TInputPixel >::max() - (long)NumericTraits< TInputPixel >::NonpositiveMin() + 1;
+    m_Vec.resize(m_Size, 0);
+    m_Blocks.resize( ( ( m_Size - 1 ) >> BlockBits ) + 1, 0 );
+    // the rank position starts on the last bin, all the pixels are below it
+    m_Entries = m_Below = 0;
+    m_RankPosition = m_Size - 1;
+    m_Rank = 0.5;
+  }
+
+  ~VectorRankHistogram() {}
+
+  VectorRankHistogram & operator=(const VectorRankHistogram & hist)
+  {
+    if ( this != &hist )
+      {
+      // only the blocks used by one of the histograms have to be copied
+      for ( unsigned long b = 0; b < m_Blocks.size(); b++ )
+        {
+        if ( m_Blocks[b] != 0 || hist.m_Blocks[b] != 0 )
+          {
+          const unsigned long begin = b << BlockBits;
+          const unsigned long end = std::min(begin + BlockSize, m_Size);
+          std::copy(hist.m_Vec.begin() + begin, hist.m_Vec.begin() + end, m_Vec.begin() + begin);
+          m_Blocks[b] = hist.m_Blocks[b];
+          }
+        }
+      m_Entries = hist.m_Entries;
+      m_Below = hist.m_Below;
+      m_RankPosition = hist.m_RankPosition;
+      m_Rank = hist.m_Rank;
+      }
+    return *this;
+  }
+
+  bool IsValid()
+  {
+    return m_Entries > 0;
+  }
+
+  TInputPixel GetValueBruteForce()
+  {
+    unsigned long count = 0;
+    unsigned long target = (unsigned long)( m_Rank * ( m_Entries - 1 ) ) + 1;
+    for( unsigned long i=0; i<m_Size; i++ )
+      {
+      count += m_Vec[i];
+      if( count >= target )
+        {
+        return (TInputPixel)( i + NumericTraits< TInputPixel >::NonpositiveMin() );
+        }
+      }
+    return NumericTraits< TInputPixel >::max();
+  }
+
+  TInputPixel GetValue(const TInputPixel &)
+  {
+    if ( m_Entries == 0 )
+      {
+      return NumericTraits< TInputPixel >::max();
+      }
+
+    // m_Below is the number of pixels in the bins up to m_RankPosition
+    const unsigned long target = (unsigned long)( m_Rank * ( m_Entries - 1 ) ) + 1;
+    unsigned long       total = m_Below;
+    unsigned long       pos = m_RankPosition;
+
+    if ( total < target )
+      {
+      // move up to the end of the current block, then over whole blocks
+      const unsigned long blockEnd = std::min(pos | BlockMask, m_Size - 1);
+      while ( pos < blockEnd && total < target )
+        {
+        ++pos;
+        total += m_Vec[pos];
+        }
+      if ( total < target )
+        {
+        unsigned long block = ( pos >> BlockBits ) + 1;
+        while ( total + m_Blocks[block] < target )
+          {
+          total += m_Blocks[block];
+          ++block;
+          }
+        pos = block << BlockBits;
+        total += m_Vec[pos];
+        while ( total < target )
+          {
+          ++pos;
+          total += m_Vec[pos];
+          }
+        }
+      }
+    else
+      {
+      // move down while the rank is still reached without the current bin
+      const unsigned long blockBegin = pos & ~BlockMask;
+      while ( pos > blockBegin && total - m_Vec[pos] >= target )
+        {
+        total -= m_Vec[pos];
+        --pos;
+        }
+      if ( pos == blockBegin && total - m_Vec[pos] >= target )
+        {
+        total -= m_Vec[pos];
+        unsigned long block = ( pos >> BlockBits ) - 1;
+        while ( total - m_Blocks[block] >= target )
+          {
+          total -= m_Blocks[block];
+          --block;
+          }
+        pos = ( block << BlockBits ) | BlockMask;
+        while ( total - m_Vec[pos] >= target )
+          {
+          total -= m_Vec[pos];
+          --pos;
+          }
+        }
+      }
+
+    m_RankPosition = pos;
+    m_Below = total;
+    const TInputPixel value = (TInputPixel)( pos + NumericTraits< TInputPixel >::NonpositiveMin() );
+    itkAssertInDebugAndIgnoreInReleaseMacro( value == GetValueBruteForce() );
+    return value;
+  }
+
+  void AddPixel(const TInputPixel & p)
+  {
+    const unsigned long q = (long)p - (long)NumericTraits< TInputPixel >::NonpositiveMin();
+
+    m_Vec[q]++;
+    m_Blocks[q >> BlockBits]++;
+    if ( q <= m_RankPosition )
+      {
+      ++m_Below;
+      }
+    ++m_Entries;
+  }
+
+  void RemovePixel(const TInputPixel & p)
+  {
+    const unsigned long q = (long)p - (long)NumericTraits< TInputPixel >::NonpositiveMin();
+
+    itkAssertInDebugAndIgnoreInReleaseMacro( q < m_Vec.size() );
+    itkAssertInDebugAndIgnoreInReleaseMacro( m_Entries >= 1 );
+    itkAssertInDebugAndIgnoreInReleaseMacro( m_Vec[q] > 0 );
+
+    m_Vec[q]--;
+    m_Blocks[q >> BlockBits]--;
+    --m_Entries;
+
+    if ( q <= m_RankPosition )
+      {
+      --m_Below;
+      }
+  }
+
+  void SetRank(float rank)
+  {
+    m_Rank = rank;
+  }
+
+  void AddBoundary(){}
+
+  void RemoveBoundary(){}
+
+  static bool UseVectorBasedAlgorithm()
+  {
+    return true;
+  }
+
+protected:
+  float m_Rank;
+
+private:
+  typedef typename std::vector< unsigned long > VecType;
+
+  itkStaticConstMacro(BlockBits, unsigned long, 8);
+  itkStaticConstMacro(BlockSize, unsigned long, 1 << BlockBits);
+  itkStaticConstMacro(BlockMask, unsigned long, BlockSize - 1);
+
+  VecType       m_Vec;
+  VecType       m_Blocks;
+  unsigned long m_Size;
+  unsigned long m_RankPosition;
+  unsigned long m_Below;
+  unsigned long m_Entries;
+};
+
+// now create RankHistogram specializations using the VectorRankHistogram
+// as base class for the pixel types with up to 16 bits
+
+template<>
+class RankHistogram<unsigned char>:
+  public VectorRankHistogram<unsigned char>
+{
+};
+
+template<>
+class RankHistogram<signed char>:
+  public VectorRankHistogram<signed char>
+{
+};
+
+template<>
+class RankHistogram<bool>:
+  public VectorRankHistogram<bool>
+{
+};
+
+template<>
+class RankHistogram<unsigned short>:
+  public VectorRankHistogram<unsigned short>
+{
+};
+
+template<>
+class RankHistogram<short>:
+  public VectorRankHistogram<short>
+{
+};
+
+} // end namespace Function
+} // end namespace itk
+#endif
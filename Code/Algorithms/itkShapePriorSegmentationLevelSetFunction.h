@@ -98,7 +98,9 @@ public:
   { return m_ShapePriorWeight; }
 
   /** The ShapeFunction encapsulates the signed distance to the shape used to
-   * influence the evolution of the level set. */
+   * influence the evolution of the level set. The sparse field solver calls
+   * ComputeUpdate() from several threads, so the Evaluate() method of the
+   * shape function must be safe to call concurrently. */
   void SetShapeFunction(const ShapeFunctionType *ptr)
   { m_ShapeFunction = ptr; }
   const ShapeFunctionType * GetShapeFunction() const
@@ -112,6 +114,10 @@ public:
   /** Compute global time step from the global data structure. */
   virtual TimeStepType ComputeGlobalTimeStep(void *globalData) const;
 
+  /** Combine the global data of two sets of pixels, including the shape
+   * prior term. */
+  virtual void CombineGlobalData(void *globalData, const void *otherGlobalData) const;
+
   /** A global data type used to store values needed to compute the time step.
     */
   typedef typename Superclass::GlobalDataStruct GlobalDataStruct;
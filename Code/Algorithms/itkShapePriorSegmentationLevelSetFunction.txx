@@ -87,6 +87,22 @@ ShapePriorSegmentationLevelSetFunction< TImageType, TFeatureImageType >
   return value;
 }
 
+/**
+ * Combine the global data of two sets of pixels.
+ */
+template< class TImageType, class TFeatureImageType >
+void
+ShapePriorSegmentationLevelSetFunction< TImageType, TFeatureImageType >
+::CombineGlobalData(void *gd, const void *otherGd) const
+{
+  this->Superclass::CombineGlobalData(gd, otherGd);
+
+  ShapePriorGlobalDataStruct *      d = (ShapePriorGlobalDataStruct *)gd;
+  const ShapePriorGlobalDataStruct *o = (const ShapePriorGlobalDataStruct *)otherGd;
+
+  d->m_MaxShapePriorChange = vnl_math_max(d->m_MaxShapePriorChange, o->m_MaxShapePriorChange);
+}
+
 /**
  * Compute the global time step.
  */
@@ -0,0 +1,132 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkVnlFFTCommon_h
+#define __itkVnlFFTCommon_h
+
+#include "itkMultiThreader.h"
+#include "itkSize.h"
+#include "vnl/algo/vnl_fft_prime_factors.h"
+
+#include <complex>
+#include <vector>
+
+namespace itk
+{
+/** \class VnlFFTTransform
+ * \brief One dimensional Fourier transforms of any length with vnl.
+ *
+ * The transforms of lengths whose only prime factors are 2, 3 and 5 are
+ * computed directly by the vnl prime factor algorithm.  Other lengths use
+ * Bluestein's algorithm, which turns the transform into a circular
+ * convolution with a chirp of such a length.
+ *
+ * Like the vnl transforms, the direction -1 computes
+ * sum_n x(n) exp(-2 pi i n k / N) and the direction +1 the same sum with
+ * the opposite sign, without dividing by N.  A transform may be shared by
+ * several threads, each with its own work buffer.
+ *
+ * \ingroup FourierTransform
+ */
+template< class TPixel >
+class VnlFFTTransform
+{
+public:
+  typedef std::complex< TPixel > ComplexType;
+
+  VnlFFTTransform();
+  explicit VnlFFTTransform(unsigned long size);
+
+  void SetSize(unsigned long size);
+  unsigned long GetSize() const { return m_Size; }
+
+  /** True if n has no prime factor other than 2, 3 and 5. */
+  static bool IsDirectSize(unsigned long n);
+
+  /** Number of complex values of the work buffer needed per line. */
+  unsigned long GetWorkSize() const { return m_BluesteinSize; }
+
+  /** Transform numberOfLines lines of data in place.  The element i of
+   * the line l is data[l * jump + i * increment].  The work buffer holds
+   * GetWorkSize() values per line; it may be null when the transform is
+   * direct. */
+  void Transform(ComplexType *data, unsigned long increment, unsigned long jump,
+                 unsigned long numberOfLines, int direction, ComplexType *work) const;
+
+private:
+  VnlFFTTransform(const VnlFFTTransform &); //purposely not implemented
+  void operator=(const VnlFFTTransform &);  //purposely not implemented
+
+  void DirectTransform(ComplexType *data, unsigned long increment, unsigned long jump,
+                       unsigned long numberOfLines, int direction) const;
+
+  unsigned long m_Size;
+
+  /** Length of the Bluestein convolution, 0 for a direct transform. */
+  unsigned long m_BluesteinSize;
+
+  /** Factors of the length of the vnl transforms. */
+  vnl_fft_prime_factors< TPixel > m_Factors;
+
+  /** exp(-pi i n^2 / N), and the transforms of the conjugate chirp for
+   * both directions divided by the convolution length. */
+  std::vector< ComplexType > m_Chirp;
+  std::vector< ComplexType > m_ChirpTransform[2];
+};
+
+/** \class VnlFFTCommon
+ * \brief Threaded Fourier transforms of image buffers for the VnlFFT
+ * filters.
+ *
+ * The transform of an image is computed one dimension after the other.
+ * Along each dimension the lines are transformed with a VnlFFTTransform,
+ * divided between the threads.  Adjacent lines are transformed together,
+ * so the lines across the buffer are read along the memory.  Any size and
+ * any number of dimensions are supported.
+ *
+ * \ingroup FourierTransform
+ */
+template< class TPixel, unsigned int VDimension >
+class VnlFFTCommon
+{
+public:
+  typedef std::complex< TPixel > ComplexType;
+  typedef Size< VDimension >     SizeType;
+  typedef VnlFFTTransform< TPixel > LineTransformType;
+
+  /** Transform the buffer of an image of the given size in place. */
+  static void Transform(ComplexType *data, const SizeType & size, int direction,
+                        MultiThreader *threader);
+
+private:
+  struct TransformThreadStruct {
+    ComplexType *Data;
+    const LineTransformType *LineTransform;
+    unsigned long Stride;
+    unsigned long NumberOfLines;
+    int Direction;
+  };
+
+  static ITK_THREAD_RETURN_TYPE TransformThreaderCallback(void *arg);
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkVnlFFTCommon.txx"
+#endif
+
+#endif
@@ -0,0 +1,278 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkVnlFFTCommon_txx
+#define __itkVnlFFTCommon_txx
+
+#include "itkVnlFFTCommon.h"
+#include "vnl/algo/vnl_fft.h"
+#include "vnl/vnl_math.h"
+
+#include <algorithm>
+
+namespace itk
+{
+template< class TPixel >
+VnlFFTTransform< TPixel >
+::VnlFFTTransform():
+  m_Size(0),
+  m_BluesteinSize(0)
+{}
+
+template< class TPixel >
+VnlFFTTransform< TPixel >
+::VnlFFTTransform(unsigned long size):
+  m_Size(0),
+  m_BluesteinSize(0)
+{
+  this->SetSize(size);
+}
+
+template< class TPixel >
+bool
+VnlFFTTransform< TPixel >
+::IsDirectSize(unsigned long n)
+{
+  if ( n == 0 )
+    {
+    return false;
+    }
+  const unsigned long factors[] = { 2, 3, 5 };
+  for ( unsigned int i = 0; i < 3; i++ )
+    {
+    while ( n % factors[i] == 0 )
+      {
+      n /= factors[i];
+      }
+    }
+  return n == 1;
+}
+
+template< class TPixel >
+void
+VnlFFTTransform< TPixel >
+::SetSize(unsigned long size)
+{
+  m_Size = size;
+  m_BluesteinSize = 0;
+  m_Chirp.clear();
+  m_ChirpTransform[0].clear();
+  m_ChirpTransform[1].clear();
+  if ( size <= 1 )
+    {
+    return;
+    }
+  if ( IsDirectSize(size) )
+    {
+    m_Factors.resize(size);
+    return;
+    }
+
+  // the convolution with the chirp must not wrap around
+  unsigned long length = 2 * size - 1;
+  while ( !IsDirectSize(length) )
+    {
+    length++;
+    }
+  m_BluesteinSize = length;
+  m_Factors.resize(length);
+
+  // exp(-pi i n^2 / N), with n^2 reduced modulo 2N for the accuracy
+  m_Chirp.resize(size);
+  unsigned long square = 0;
+  for ( unsigned long n = 0; n < size; n++ )
+    {
+    const double angle = -vnl_math::pi * square / size;
+    m_Chirp[n] = ComplexType( static_cast< TPixel >( vcl_cos(angle) ),
+                              static_cast< TPixel >( vcl_sin(angle) ) );
+    square = ( square + 2 * n + 1 ) % ( 2 * size );
+    }
+
+  // the transforms of the conjugate chirps, on both sides of zero
+  for ( unsigned int d = 0; d < 2; d++ )
+    {
+    std::vector< ComplexType > & chirpTransform = m_ChirpTransform[d];
+    chirpTransform.assign( length, ComplexType(0) );
+    for ( unsigned long n = 0; n < size; n++ )
+      {
+      const ComplexType value = ( d == 0 ) ? vcl_conj(m_Chirp[n]) : m_Chirp[n];
+      chirpTransform[n] = value;
+      if ( n > 0 )
+        {
+        chirpTransform[length - n] = value;
+        }
+      }
+    this->DirectTransform(&chirpTransform[0], 1, length, 1, -1);
+    for ( unsigned long m = 0; m < length; m++ )
+      {
+      chirpTransform[m] /= static_cast< TPixel >( length );
+      }
+    }
+}
+
+template< class TPixel >
+void
+VnlFFTTransform< TPixel >
+::DirectTransform(ComplexType *data, unsigned long increment, unsigned long jump,
+                  unsigned long numberOfLines, int direction) const
+{
+  // This relies on std::complex<T> being laid out as two T, as
+  // vnl_fft_base does.
+  TPixel *values = reinterpret_cast< TPixel * >( data );
+  long    info = 0;
+
+  vnl_fft_gpfa( values, values + 1, m_Factors.trigs(),
+                2 * increment, 2 * jump, m_Factors.number(),
+                numberOfLines, direction, m_Factors.pqr(), &info );
+}
+
+template< class TPixel >
+void
+VnlFFTTransform< TPixel >
+::Transform(ComplexType *data, unsigned long increment, unsigned long jump,
+            unsigned long numberOfLines, int direction, ComplexType *work) const
+{
+  if ( m_Size <= 1 || numberOfLines == 0 )
+    {
+    return;
+    }
+  if ( m_BluesteinSize == 0 )
+    {
+    this->DirectTransform(data, increment, jump, numberOfLines, direction);
+    return;
+    }
+
+  // X(k) = c(k) sum_n x(n) c(n) conj( c(k - n) ), with
+  // c(n) = exp(direction pi i n^2 / N)
+  const unsigned long        length = m_BluesteinSize;
+  const std::vector< ComplexType > & chirpTransform = m_ChirpTransform[direction < 0 ? 0 : 1];
+  for ( unsigned long l = 0; l < numberOfLines; l++ )
+    {
+    const ComplexType *line = data + l * jump;
+    ComplexType *      lineWork = work + l * length;
+    for ( unsigned long n = 0; n < m_Size; n++ )
+      {
+      const ComplexType chirp = ( direction < 0 ) ? m_Chirp[n] : vcl_conj(m_Chirp[n]);
+      lineWork[n] = line[n * increment] * chirp;
+      }
+    std::fill( lineWork + m_Size, lineWork + length, ComplexType(0) );
+    }
+
+  this->DirectTransform(work, 1, length, numberOfLines, -1);
+  for ( unsigned long l = 0; l < numberOfLines; l++ )
+    {
+    ComplexType *lineWork = work + l * length;
+    for ( unsigned long m = 0; m < length; m++ )
+      {
+      lineWork[m] *= chirpTransform[m];
+      }
+    }
+  this->DirectTransform(work, 1, length, numberOfLines, 1);
+
+  for ( unsigned long l = 0; l < numberOfLines; l++ )
+    {
+    ComplexType *      line = data + l * jump;
+    const ComplexType *lineWork = work + l * length;
+    for ( unsigned long k = 0; k < m_Size; k++ )
+      {
+      const ComplexType chirp = ( direction < 0 ) ? m_Chirp[k] : vcl_conj(m_Chirp[k]);
+      line[k * increment] = lineWork[k] * chirp;
+      }
+    }
+}
+
+template< class TPixel, unsigned int VDimension >
+void
+VnlFFTCommon< TPixel, VDimension >
+::Transform(ComplexType *data, const SizeType & size, int direction,
+            MultiThreader *threader)
+{
+  unsigned long stride = 1;
+  unsigned long numberOfPixels = 1;
+  for ( unsigned int i = 0; i < VDimension; i++ )
+    {
+    numberOfPixels *= size[i];
+    }
+
+  for ( unsigned int i = 0; i < VDimension; i++ )
+    {
+    if ( size[i] > 1 )
+      {
+      const LineTransformType lineTransform(size[i]);
+
+      TransformThreadStruct str;
+      str.Data = data;
+      str.LineTransform = &lineTransform;
+      str.Stride = stride;
+      str.NumberOfLines = numberOfPixels / size[i];
+      str.Direction = direction;
+
+      threader->SetSingleMethod(TransformThreaderCallback, &str);
+      threader->SingleMethodExecute();
+      }
+    stride *= size[i];
+    }
+}
+
+template< class TPixel, unsigned int VDimension >
+ITK_THREAD_RETURN_TYPE
+VnlFFTCommon< TPixel, VDimension >
+::TransformThreaderCallback(void *arg)
+{
+  const int threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  const int threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  TransformThreadStruct *str =
+    (TransformThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  const LineTransformType *lineTransform = str->LineTransform;
+  const unsigned long      length = lineTransform->GetSize();
+  const unsigned long      stride = str->Stride;
+
+  const unsigned long begin = str->NumberOfLines * threadId / threadCount;
+  const unsigned long end = str->NumberOfLines * ( threadId + 1 ) / threadCount;
+
+  // the lines are taken in batches of adjacent lines
+  const unsigned long maximumBatchSize = lineTransform->GetWorkSize() ? 8 : 64;
+  std::vector< ComplexType > work( lineTransform->GetWorkSize() * maximumBatchSize );
+  ComplexType *workPointer = work.empty() ? 0 : &work[0];
+
+  for ( unsigned long line = begin; line < end; )
+    {
+    unsigned long batchSize;
+    if ( stride == 1 )
+      {
+      batchSize = vnl_math_min( end - line, maximumBatchSize );
+      lineTransform->Transform(str->Data + line * length, 1, length,
+                               batchSize, str->Direction, workPointer);
+      }
+    else
+      {
+      const unsigned long outer = line / stride;
+      const unsigned long inner = line % stride;
+      batchSize = vnl_math_min( vnl_math_min( end - line, stride - inner ), maximumBatchSize );
+      lineTransform->Transform(str->Data + outer * stride * length + inner, stride, 1,
+                               batchSize, str->Direction, workPointer);
+      }
+    line += batchSize;
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+} // end namespace itk
+
+#endif
@@ -23,7 +23,14 @@ namespace itk
 {
 /** \class VnlFFTComplexConjugateToRealImageFilter
  *
- * \brief TODO
+ * \brief Inverse Fourier transform to a real image with vnl.
+ *
+ * The input is the full complex transform computed by
+ * VnlFFTRealToComplexConjugateImageFilter, and the output is divided by
+ * the number of pixels.  Images of any size and dimension are transformed
+ * with VnlFFTCommon, in several threads.
+ *
+ * \ingroup FourierTransform
  */
 template< class TPixel, unsigned int VDimension = 3 >
 class VnlFFTComplexConjugateToRealImageFilter:
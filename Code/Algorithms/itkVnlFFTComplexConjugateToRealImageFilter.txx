@@ -20,10 +20,9 @@
 
 #include "itkVnlFFTComplexConjugateToRealImageFilter.h"
 #include "itkFFTComplexConjugateToRealImageFilter.txx"
+#include "itkVnlFFTCommon.h"
 #include <complex>
-#include "vnl/algo/vnl_fft_1d.h"
-#include "vnl/algo/vnl_fft_2d.h"
-#include "vnl_fft_3d.h"
+#include <vector>
 #include "itkProgressReporter.h"
 
 namespace itk
@@ -60,8 +59,7 @@ VnlFFTComplexConjugateToRealImageFilter< TPixel, VDimension >::GenerateData()
   outputPtr->SetBufferedRegion( outputPtr->GetRequestedRegion() );
   outputPtr->Allocate();
 
-  std::complex< TPixel > *in = const_cast< std::complex< TPixel > * >
-                               ( inputPtr->GetBufferPointer() );
+  const std::complex< TPixel > *in = inputPtr->GetBufferPointer();
 
   unsigned int vec_size = 1;
   for ( i = 0; i < num_dims; i++ )
@@ -69,37 +67,11 @@ VnlFFTComplexConjugateToRealImageFilter< TPixel, VDimension >::GenerateData()
     vec_size *= outputSize[i];
     }
 
-  vnl_vector< vcl_complex< TPixel > > signal(vec_size);
-  for ( i = 0; i < vec_size; i++ )
-    {
-    signal[i] = in[i];
-    }
+  std::vector< std::complex< TPixel > > signal(in, in + vec_size);
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+  VnlFFTCommon< TPixel, VDimension >::Transform( &signal[0], outputSize, 1, this->GetMultiThreader() );
 
   TPixel *out = outputPtr->GetBufferPointer();
-
-  switch ( num_dims )
-    {
-    case 1:
-      {
-      vnl_fft_1d< TPixel > v1d(vec_size);
-      v1d.fwd_transform(signal);
-      }
-      break;
-    case 2:
-      {
-      vnl_fft_2d< TPixel > v2d(outputSize[1], outputSize[0]);
-      v2d.vnl_fft_2d< TPixel >::base::transform(signal.data_block(), +1);
-      }
-      break;
-    case 3:
-      {
-      vnl_fft_3d< TPixel > v3d(outputSize[2], outputSize[1], outputSize[0]);
-      v3d.vnl_fft_3d< TPixel >::base::transform(signal.data_block(), +1);
-      }
-      break;
-    default:
-      break;
-    }
   for ( i = 0; i < vec_size; i++ )
     {
     out[i] = signal[i].real() / vec_size;
@@ -23,7 +23,15 @@ namespace itk
 {
 /** \class VnlFFTRealToComplexConjugateImageFilter
  *
- * \brief TODO
+ * \brief Forward Fourier transform of a real image with vnl.
+ *
+ * The output holds the full complex transform.  Images of any size and
+ * dimension are transformed with VnlFFTCommon, one dimension after the
+ * other with the lines divided between the threads.  Sizes with prime
+ * factors other than 2, 3 and 5 are transformed with Bluestein's
+ * algorithm, which is slower than for the nearby sizes without them.
+ *
+ * \ingroup FourierTransform
  */
 template< class TPixel, unsigned int VDimension = 3 >
 class VnlFFTRealToComplexConjugateImageFilter:
@@ -52,8 +60,6 @@ public:
 protected:
   VnlFFTRealToComplexConjugateImageFilter() {}
   ~VnlFFTRealToComplexConjugateImageFilter() {}
-  ///** Method to check if an array dimension is legal for PFA FFT */
-  bool Legaldim(int n);
 
 private:
   inline std::complex< TPixel > myConj(const std::complex< TPixel > & __z)
@@ -22,42 +22,11 @@
 #include <iostream>
 #include "itkIndent.h"
 #include "itkMetaDataObject.h"
-#include "vnl/algo/vnl_fft_base.h"
-#include "vnl/algo/vnl_fft_1d.h"
-#include "vnl/algo/vnl_fft_2d.h"
-#include "vnl_fft_3d.h"
+#include "itkVnlFFTCommon.h"
 #include "itkProgressReporter.h"
 
 namespace itk
 {
-#define DEBUG_PRINT(x) x
-
-template< class TPixel, unsigned int VDimension >
-bool VnlFFTRealToComplexConjugateImageFilter< TPixel, VDimension >::Legaldim(int n)
-{
-  int ifac = 2;
-
-  for ( int l = 1; l <= 3; l++ )
-    {
-    // Original code
-//       k = 0;
-//       L10:
-//       if (n % ifac != 0) goto L20;
-//       ++k;
-//       N /= ifac;
-//       goto L10;
-//       L20:
-//       pqr[l-1] = k;
-//       ifac += l;
-    for (; n % ifac == 0; )
-      {
-      n /= ifac;
-      }
-    ifac += l;
-    }
-  return ( n == 1 ); // return false if decomposition failed
-}
-
 template< class TPixel, unsigned int VDimension >
 void
 VnlFFTRealToComplexConjugateImageFilter< TPixel, VDimension >::GenerateData()
@@ -85,7 +54,7 @@ VnlFFTRealToComplexConjugateImageFilter< TPixel, VDimension >::GenerateData()
     {
     return;
     }
-  TPixel *in = const_cast< TPixel * >( inputPtr->GetBufferPointer() );
+  const TPixel *in = inputPtr->GetBufferPointer();
   outputPtr->SetBufferedRegion( outputPtr->GetRequestedRegion() );
   outputPtr->Allocate();
   std::complex< TPixel > *out = outputPtr->GetBufferPointer();
@@ -93,50 +62,15 @@ VnlFFTRealToComplexConjugateImageFilter< TPixel, VDimension >::GenerateData()
   unsigned int vec_size = 1;
   for ( i = 0; i < num_dims; i++ )
     {
-    //#if 0
-    if ( !this->Legaldim(inputSize[i]) )
-      {
-      ExceptionObject exception(__FILE__, __LINE__);
-      exception.SetDescription("Illegal Array DIM for FFT");
-      exception.SetLocation(ITK_LOCATION);
-      throw exception;
-      }
-    //#endif
     vec_size *= inputSize[i];
     }
-  vnl_vector< vcl_complex< TPixel > > signal(vec_size);
   for ( i = 0; i < vec_size; i++ )
     {
-    signal[i] = in[i];
+    out[i] = in[i];
     }
 
-  switch ( num_dims )
-    {
-    case 1:
-      {
-      vnl_fft_1d< TPixel > v1d(vec_size);
-      v1d.bwd_transform(signal);
-      }
-      break;
-    case 2:
-      {
-      vnl_fft_2d< TPixel > v2d(inputSize[1], inputSize[0]);
-      v2d.vnl_fft_2d< TPixel >::base::transform(signal.data_block(), -1);
-      }
-      break;
-    case 3:
-      {
-      vnl_fft_3d< TPixel > v3d(inputSize[2], inputSize[1], inputSize[0]);
-      v3d.vnl_fft_3d< TPixel >::base::transform(signal.data_block(), -1);
-      }
-      break;
-    default:
-      break;
-    }
-  for ( i = 0; i < vec_size; i++ )
-    {
-    out[i] = signal[i];
-    }
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+  VnlFFTCommon< TPixel, VDimension >::Transform( out, inputSize, -1, this->GetMultiThreader() );
 }
 
 template< class TPixel, unsigned int VDimension >
@@ -26,6 +26,7 @@
 #include "itkWatershedSegmentTreeGenerator.h"
 #include "itkWatershedRelabeler.h"
 #include "itkWatershedMiniPipelineProgressCommand.h"
+#include <vector>
 
 namespace itk
 {
@@ -142,9 +143,32 @@ namespace itk
  * Get/SetThreshold() and Get/SetLevel() methods.
  *
  * \par Notes on streaming the watershed segmentation code
- *  Coming soon... 12/06/01
+ * When NumberOfStreamDivisions is greater than one, the input is requested
+ * and segmented one slab at a time along its outermost dimension, so that
+ * neither the upstream pipeline nor the segmenter has to hold the whole
+ * volume.  Each slab is padded by one pixel of overlap into its neighbors
+ * and segmented with boundary analysis turned on, and its labels are
+ * written to the output.  The flow across the faces shared by adjacent
+ * slabs is resolved with a watershed::BoundaryResolver, the adjacencies
+ * across those faces are added to the segment table, and the
+ * SegmentTreeGenerator merges the equivalent segments before computing the
+ * merge tree.  The output is then relabeled in place.  Besides the output,
+ * only one padded slab, the faces of the previous slab and the segment
+ * table are kept in memory.
  *
+ * \par
+ * The input is requested twice per slab: once to compute the range used
+ * by the threshold, and once to segment it.  The slabs are processed one
+ * after another, because the upstream pipeline cannot be updated
+ * concurrently.  The basic segmentation is not kept, so
+ * GetBasicSegmentation() is not available and changing the Level segments
+ * the slabs again.
  *
+ * \par
+ * The streamed segmentation is the same as the non-streamed one, except for
+ * flat regions that cross a slab boundary: they are kept as separate segments
+ * in the basic segmentation instead of being joined with the neighbor at
+ * their lowest boundary point, and merge at the lowest nonzero level.
  *
  * \ingroup WatershedSegmentation  */
 template< class TInputImage >
@@ -225,10 +249,21 @@ public:
 
   itkGetConstMacro(Level, double);
 
-  /** Get the basic segmentation from the Segmenter member filter. */
+  /** Set/Get the number of slabs in which the input is requested and
+   * segmented.  The default value of 1 processes the whole image at once. */
+  void SetNumberOfStreamDivisions(unsigned int);
+
+  itkGetConstMacro(NumberOfStreamDivisions, unsigned int);
+
+  /** Get the basic segmentation from the Segmenter member filter.  The
+   * basic segmentation is not kept when streaming. */
   typename watershed::Segmenter< InputImageType >::OutputImageType *
   GetBasicSegmentation()
   {
+    if ( m_NumberOfStreamDivisions > 1 )
+      {
+      itkExceptionMacro(<< "The basic segmentation is not kept when streaming.");
+      }
     m_Segmenter->Update();
     return m_Segmenter->GetOutputImage();
   }
@@ -266,6 +301,21 @@ protected:
    */
   virtual void PrepareOutputs();
 
+  /** Only request the first slab of the input when streaming.  The others
+   * are requested by GenerateData(). */
+  virtual void GenerateInputRequestedRegion();
+
+  /** Segment the input slab by slab into the output, build the merge tree
+   * of the merged results and relabel the output up to the flood level. */
+  void GenerateStreamedSegmentation();
+
+  /** Split a region into at most NumberOfStreamDivisions slabs along its
+   * outermost dimension.  The slabs are at least two pixels thick, otherwise
+   * the segmenter could not tell the overlap of a slab with its neighbor
+   * from the boundary of the data set. */
+  void SplitIntoSlabs(const RegionType & region, std::vector< RegionType > & slabs,
+                      unsigned int & splitAxis) const;
+
 private:
   /** A Percentage of the maximum depth (max - min pixel value) in the input
    *  image.  This percentage will be used to threshold the minimum values in
@@ -278,6 +328,9 @@ private:
    *  level. */
   double m_Level;
 
+  /** The number of slabs in which the input is segmented. */
+  unsigned int m_NumberOfStreamDivisions;
+
   /** The component parts of the segmentation algorithm.  These objects
    * must save state between calls to GenerateData() so that the
    * computationally expensive execution of segment tree generation is
@@ -293,6 +346,7 @@ private:
   bool m_LevelChanged;
   bool m_ThresholdChanged;
   bool m_InputChanged;
+  bool m_NumberOfStreamDivisionsChanged;
 
   TimeStamp m_GenerateDataMTime;
 };
@@ -18,6 +18,11 @@
 #ifndef __itkWatershedImageFilter_txx
 #define __itkWatershedImageFilter_txx
 #include "itkWatershedImageFilter.h"
+#include "itkWatershedBoundaryResolver.h"
+#include "itkImageRegionSplitter.h"
+#include "itkImageRegionIterator.h"
+#include <map>
+#include <vector>
 
 namespace itk
 {
@@ -70,9 +75,28 @@ WatershedImageFilter< TInputImage >
     }
 }
 
+template< class TInputImage >
+void
+WatershedImageFilter< TInputImage >
+::SetNumberOfStreamDivisions(unsigned int val)
+{
+  if ( val < 1 )
+    {
+    val = 1;
+    }
+
+  if ( val != m_NumberOfStreamDivisions )
+    {
+    m_NumberOfStreamDivisions = val;
+
+    m_NumberOfStreamDivisionsChanged = true;
+    this->Modified();
+    }
+}
+
 template< class TInputImage >
 WatershedImageFilter< TInputImage >
-::WatershedImageFilter():m_Threshold(0.0), m_Level(0.0)
+::WatershedImageFilter():m_Threshold(0.0), m_Level(0.0), m_NumberOfStreamDivisions(1)
 {
   // Set up the mini-pipeline for the first execution.
   m_Segmenter    = watershed::Segmenter< InputImageType >::New();
@@ -103,6 +127,7 @@ WatershedImageFilter< TInputImage >
   m_InputChanged = true;
   m_LevelChanged = true;
   m_ThresholdChanged = true;
+  m_NumberOfStreamDivisionsChanged = true;
 }
 
 template< class TInputImage >
@@ -114,6 +139,54 @@ WatershedImageFilter< TInputImage >
   data->SetRequestedRegionToLargestPossibleRegion();
 }
 
+template< class TInputImage >
+void
+WatershedImageFilter< TInputImage >
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  if ( m_NumberOfStreamDivisions > 1 && this->GetInput() )
+    {
+    InputImageType *input = const_cast< InputImageType * >( this->GetInput() );
+
+    std::vector< RegionType > slabs;
+    unsigned int              splitAxis;
+    this->SplitIntoSlabs(input->GetLargestPossibleRegion(), slabs, splitAxis);
+    input->SetRequestedRegion(slabs[0]);
+    }
+}
+
+template< class TInputImage >
+void
+WatershedImageFilter< TInputImage >
+::SplitIntoSlabs(const RegionType & region, std::vector< RegionType > & slabs,
+                 unsigned int & splitAxis) const
+{
+  // The splitter cuts along the outermost dimension that can be split
+  splitAxis = ImageDimension - 1;
+  while ( splitAxis > 0 && region.GetSize(splitAxis) == 1 )
+    {
+    --splitAxis;
+    }
+
+  typename ImageRegionSplitter< ImageDimension >::Pointer splitter =
+    ImageRegionSplitter< ImageDimension >::New();
+  unsigned int numberOfSlabs =
+    splitter->GetNumberOfSplits(region, m_NumberOfStreamDivisions);
+  while ( numberOfSlabs > 1
+          && splitter->GetSplit(numberOfSlabs - 1, numberOfSlabs, region).GetSize(splitAxis) < 2 )
+    {
+    numberOfSlabs = splitter->GetNumberOfSplits(region, numberOfSlabs - 1);
+    }
+
+  slabs.resize(numberOfSlabs);
+  for ( unsigned int i = 0; i < numberOfSlabs; ++i )
+    {
+    slabs[i] = splitter->GetSplit(i, numberOfSlabs, region);
+    }
+}
+
 template< class TInputImage >
 void
 WatershedImageFilter< TInputImage >
@@ -136,7 +209,8 @@ WatershedImageFilter< TInputImage >
   //
   if ( m_InputChanged
        || ( this->GetInput()->GetPipelineMTime() > m_GenerateDataMTime )
-       || m_ThresholdChanged )
+       || m_ThresholdChanged
+       || m_NumberOfStreamDivisionsChanged )
     {
     m_Segmenter->PrepareOutputs();
     m_TreeGenerator->PrepareOutputs();
@@ -172,12 +246,6 @@ void
 WatershedImageFilter< TInputImage >
 ::GenerateData()
 {
-  // Set the largest possible region in the segmenter
-  m_Segmenter->SetLargestPossibleRegion( this->GetInput()
-                                         ->GetLargestPossibleRegion() );
-  m_Segmenter->GetOutputImage()
-  ->SetRequestedRegion( this->GetInput()->GetLargestPossibleRegion() );
-
   // Setup the progress command
   WatershedMiniPipelineProgressCommand::Pointer c =
     dynamic_cast< WatershedMiniPipelineProgressCommand * >(
@@ -185,14 +253,40 @@ WatershedImageFilter< TInputImage >
   c->SetCount(0.0);
   c->SetNumberOfFilters(3);
 
-  // Graft our output on the relabeler
-  m_Relabeler->GraftOutput( this->GetOutput() );
+  if ( m_NumberOfStreamDivisions > 1 )
+    {
+    // The slabs are labeled and relabeled in the output, so the whole
+    // segmentation runs again at each update.
+    this->GenerateStreamedSegmentation();
+    }
+  else
+    {
+    // Connect the mini-pipeline, which may have been set up for streaming
+    m_Segmenter->SetDoBoundaryAnalysis(false);
+    m_Segmenter->SetSortEdgeLists(true);
+    m_Segmenter->ComputeInputRangeOn();
+
+    m_TreeGenerator->SetInputSegmentTable( m_Segmenter->GetSegmentTable() );
+    m_TreeGenerator->SetInputEquivalencyTable(0);
+    m_TreeGenerator->SetMerge(false);
+
+    m_Relabeler->SetInputImage( m_Segmenter->GetOutputImage() );
+
+    // Set the largest possible region in the segmenter
+    m_Segmenter->SetLargestPossibleRegion( this->GetInput()
+                                           ->GetLargestPossibleRegion() );
+    m_Segmenter->GetOutputImage()
+    ->SetRequestedRegion( this->GetInput()->GetLargestPossibleRegion() );
 
-  // Update the mini-pipeline
-  m_Relabeler->Update();
+    // Graft our output on the relabeler
+    m_Relabeler->GraftOutput( this->GetOutput() );
 
-  // Graft the output of the relabeler back on this filter
-  this->GraftOutput( m_Relabeler->GetOutputImage() );
+    // Update the mini-pipeline
+    m_Relabeler->Update();
+
+    // Graft the output of the relabeler back on this filter
+    this->GraftOutput( m_Relabeler->GetOutputImage() );
+    }
 
   // Keep track of when we last executed
   m_GenerateDataMTime.Modified();
@@ -201,6 +295,221 @@ WatershedImageFilter< TInputImage >
   m_InputChanged = false;
   m_LevelChanged = false;
   m_ThresholdChanged = false;
+  m_NumberOfStreamDivisionsChanged = false;
+}
+
+template< class TInputImage >
+void
+WatershedImageFilter< TInputImage >
+::GenerateStreamedSegmentation()
+{
+  typedef watershed::Segmenter< InputImageType >                  SegmenterType;
+  typedef typename SegmenterType::OutputImageType                 LabelImageType;
+  typedef typename SegmenterType::BoundaryType                    BoundaryType;
+  typedef typename SegmenterType::SegmentTableType                SegmentTableType;
+  typedef watershed::SegmentTreeGenerator< ScalarType >           TreeGeneratorType;
+  typedef typename TreeGeneratorType::SegmentTreeType             SegmentTreeType;
+  typedef watershed::BoundaryResolver< ScalarType, ImageDimension > ResolverType;
+  typedef std::pair< unsigned long, unsigned long >               EdgeType;
+  typedef std::map< EdgeType, ScalarType >                        EdgeMapType;
+
+  InputImageType *input = const_cast< InputImageType * >( this->GetInput() );
+  const RegionType largestRegion = input->GetLargestPossibleRegion();
+
+  // The labels of the slabs are written to the output, which is the only
+  // whole image of the streamed segmentation.
+  typename OutputImageType::Pointer output = this->GetOutput();
+  output->SetBufferedRegion( output->GetRequestedRegion() );
+  output->Allocate();
+
+  std::vector< RegionType > slabs;
+  unsigned int              splitAxis;
+  this->SplitIntoSlabs(largestRegion, slabs, splitAxis);
+  const unsigned int numberOfPieces = slabs.size();
+
+  WatershedMiniPipelineProgressCommand::Pointer c =
+    dynamic_cast< WatershedMiniPipelineProgressCommand * >(
+      m_TreeGenerator->GetCommand(m_ObserverTag) );
+  c->SetNumberOfFilters(numberOfPieces + 1);
+
+  //
+  // Every slab must be thresholded with the range of the whole input,
+  // which is computed by a first pass over the slabs.
+  //
+  ScalarType minimum = NumericTraits< ScalarType >::max();
+  ScalarType maximum = NumericTraits< ScalarType >::NonpositiveMin();
+  unsigned int piece;
+  for ( piece = 0; piece < numberOfPieces; ++piece )
+    {
+    const RegionType & region = slabs[piece];
+    input->SetRequestedRegion(region);
+    input->PropagateRequestedRegion();
+    input->UpdateOutputData();
+
+    ImageRegionConstIterator< InputImageType > it(input, region);
+    for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      if ( it.Get() < minimum ) { minimum = it.Get(); }
+      if ( maximum < it.Get() ) { maximum = it.Get(); }
+      }
+    }
+
+  // The values seen by the segmenter, see Segmenter::Threshold()
+  ScalarType cappedMaximum = maximum;
+  if ( NumericTraits< ScalarType >::is_integer
+       && cappedMaximum == NumericTraits< ScalarType >::max() )
+    {
+    cappedMaximum -= NumericTraits< ScalarType >::One;
+    }
+  const ScalarType threshold =
+    static_cast< ScalarType >( ( m_Threshold * ( cappedMaximum - minimum ) ) + minimum );
+
+  m_Segmenter->SetDoBoundaryAnalysis(true);
+  m_Segmenter->SetSortEdgeLists(false);
+  m_Segmenter->ComputeInputRangeOff();
+  m_Segmenter->SetInputMinimum(minimum);
+  m_Segmenter->SetInputMaximum(maximum);
+  m_Segmenter->SetLargestPossibleRegion(largestRegion);
+  m_Segmenter->SetCurrentLabel(1);
+  m_Segmenter->GetSegmentTable()->Clear();
+
+  EquivalencyTable::Pointer equivalencies = EquivalencyTable::New();
+  typename BoundaryType::Pointer previousBoundary;
+
+  for ( piece = 0; piece < numberOfPieces; ++piece )
+    {
+    // Segment the slab padded by one pixel into its neighbors.  The labels
+    // of the pixels in the slab itself are kept.
+    const RegionType & region = slabs[piece];
+    RegionType         paddedRegion = region;
+    if ( piece > 0 )
+      {
+      paddedRegion.SetIndex(splitAxis, region.GetIndex(splitAxis) - 1);
+      paddedRegion.SetSize(splitAxis, region.GetSize(splitAxis) + 1);
+      }
+    if ( piece < numberOfPieces - 1 )
+      {
+      paddedRegion.SetSize(splitAxis, paddedRegion.GetSize(splitAxis) + 1);
+      }
+
+    typename BoundaryType::Pointer boundary = BoundaryType::New();
+    m_Segmenter->SetBoundary(boundary);
+    m_Segmenter->GetOutputImage()->SetRequestedRegion(paddedRegion);
+    m_Segmenter->Update();
+
+    ImageRegionConstIterator< LabelImageType > segmentIt(m_Segmenter->GetOutputImage(), region);
+    ImageRegionIterator< OutputImageType >     labelIt(output, region);
+    for ( segmentIt.GoToBegin(), labelIt.GoToBegin(); !segmentIt.IsAtEnd(); ++segmentIt, ++labelIt )
+      {
+      labelIt.Set( segmentIt.Get() );
+      }
+
+    if ( piece > 0 )
+      {
+      // Join the segments that flow across the face shared with the
+      // previous slab.
+      typename ResolverType::Pointer resolver = ResolverType::New();
+      resolver->SetBoundaryA(previousBoundary);
+      resolver->SetBoundaryB(boundary);
+      resolver->SetFace(splitAxis);
+      resolver->Update();
+
+      EquivalencyTable::Pointer faceEquivalencies = resolver->GetEquivalencyTable();
+      for ( EquivalencyTable::ConstIterator eqIt = faceEquivalencies->Begin();
+            eqIt != faceEquivalencies->End(); ++eqIt )
+        {
+        equivalencies->Add( ( *eqIt ).first, ( *eqIt ).second );
+        }
+
+      // Each slab only knows the adjacencies among its own segments.  Add
+      // the ones across the face, with the heights the segmenter would
+      // have found on the thresholded input.  The padded slab holds the
+      // input on both sides of the face, and the labels of the previous
+      // slab are in the output.
+      RegionType lowFace = region;
+      lowFace.SetIndex(splitAxis, region.GetIndex(splitAxis) - 1);
+      lowFace.SetSize(splitAxis, 1);
+      RegionType highFace = lowFace;
+      highFace.SetIndex(splitAxis, region.GetIndex(splitAxis));
+
+      EdgeMapType edges;
+      ImageRegionConstIterator< InputImageType >  lowValueIt(input, lowFace);
+      ImageRegionConstIterator< InputImageType >  highValueIt(input, highFace);
+      ImageRegionConstIterator< OutputImageType > lowLabelIt(output, lowFace);
+      ImageRegionConstIterator< OutputImageType > highLabelIt(output, highFace);
+      for ( ; !lowValueIt.IsAtEnd(); ++lowValueIt, ++highValueIt, ++lowLabelIt, ++highLabelIt )
+        {
+        ScalarType height = lowValueIt.Get() < highValueIt.Get() ? highValueIt.Get() : lowValueIt.Get();
+        if ( height < threshold )
+          {
+          height = threshold;
+          }
+        else if ( height > cappedMaximum )
+          {
+          height = cappedMaximum;
+          }
+
+        const EdgeType edge( lowLabelIt.Get(), highLabelIt.Get() );
+        typename EdgeMapType::iterator edgeIt = edges.find(edge);
+        if ( edgeIt == edges.end() )
+          {
+          edges.insert( typename EdgeMapType::value_type(edge, height) );
+          }
+        else if ( height < ( *edgeIt ).second )
+          {
+          ( *edgeIt ).second = height;
+          }
+        }
+
+      typename SegmentTableType::Pointer segments = m_Segmenter->GetSegmentTable();
+      for ( typename EdgeMapType::const_iterator edgeIt = edges.begin(); edgeIt != edges.end(); ++edgeIt )
+        {
+        typename SegmentTableType::segment_t *low = segments->Lookup( ( *edgeIt ).first.first );
+        typename SegmentTableType::segment_t *high = segments->Lookup( ( *edgeIt ).first.second );
+        if ( low == 0 || high == 0 )
+          {
+          itkExceptionMacro(<< "A segment on a slab boundary is missing from the segment table.");
+          }
+        typedef typename SegmentTableType::edge_pair_t EdgePairType;
+        low->edge_list.push_back( EdgePairType( ( *edgeIt ).first.second, ( *edgeIt ).second ) );
+        high->edge_list.push_back( EdgePairType( ( *edgeIt ).first.first, ( *edgeIt ).second ) );
+        }
+      }
+    previousBoundary = boundary;
+    }
+
+  // Release the memory of the last slab, and keep the merged segment table
+  // away from the next updates of the segmenter.
+  m_Segmenter->GetOutputImage()->ReleaseData();
+  typename SegmentTableType::Pointer segments = m_Segmenter->GetSegmentTable();
+  segments->DisconnectPipeline();
+
+  // Give the equivalent segments the same label.  The segment tree
+  // generator merges them in the segment table.
+  equivalencies->Flatten();
+  SegmenterType::RelabelImage(output, output->GetRequestedRegion(), equivalencies);
+
+  m_TreeGenerator->SetInputSegmentTable(segments);
+  m_TreeGenerator->SetInputEquivalencyTable(equivalencies);
+  m_TreeGenerator->SetMerge(true);
+  m_TreeGenerator->SetHighestCalculatedFloodLevel(0.0);
+  m_TreeGenerator->Modified();
+  m_TreeGenerator->Update();
+
+  // Apply the merges up to the flood level, as the Relabeler does.
+  typename SegmentTreeType::Pointer tree = m_TreeGenerator->GetOutputSegmentTree();
+  if ( !tree->Empty() )
+    {
+    const ScalarType mergeLimit =
+      static_cast< ScalarType >( m_Level * tree->Back().saliency );
+    EquivalencyTable::Pointer merges = EquivalencyTable::New();
+    for ( typename SegmentTreeType::Iterator it = tree->Begin();
+          it != tree->End() && ( *it ).saliency <= mergeLimit; ++it )
+      {
+      merges->Add( ( *it ).from, ( *it ).to );
+      }
+    SegmenterType::RelabelImage(output, output->GetRequestedRegion(), merges);
+    }
 }
 
 template< class TInputImage >
@@ -211,6 +520,7 @@ WatershedImageFilter< TInputImage >
   Superclass::PrintSelf(os, indent);
   os << indent << "Threshold: " << m_Threshold << std::endl;
   os << indent << "Level: " << m_Level << std::endl;
+  os << indent << "NumberOfStreamDivisions: " << m_NumberOfStreamDivisions << std::endl;
 }
 } // end namespace itk
 
@@ -201,7 +201,9 @@ protected:
    * flood level, recomputing new potential merges as it goes.   */
   void ExtractMergeHierarchy(SegmentTableTypePointer, SegmentTreeTypePointer);
 
-  void MergeEquivalencies();
+  /** Merges the segments of the table that are marked as equivalent in the
+   * input EquivalencyTable.   */
+  void MergeEquivalencies(SegmentTableTypePointer);
 
   /** Methods required by the itk pipeline */
   void GenerateOutputRequestedRegion(DataObject *output);
@@ -82,7 +82,7 @@ void SegmentTreeGenerator< TScalarType >
     input->Modified();
     input->SortEdgeLists();
 
-    if ( m_Merge == true )   {      this->MergeEquivalencies();    }
+    if ( m_Merge == true )   {      this->MergeEquivalencies(input);    }
 
     this->CompileMergeList(input, mergeList);
     this->ExtractMergeHierarchy(input, mergeList);
@@ -91,7 +91,7 @@ void SegmentTreeGenerator< TScalarType >
     {
     seg->Copy(*input); // copy the input
     seg->SortEdgeLists();
-    if ( m_Merge == true )   {      this->MergeEquivalencies();    }
+    if ( m_Merge == true )   {      this->MergeEquivalencies(seg);    }
     this->CompileMergeList(seg, mergeList);
     this->ExtractMergeHierarchy(seg, mergeList);
     }
@@ -106,9 +106,8 @@ void SegmentTreeGenerator< TScalarType >
 
 template< class TScalarType >
 void SegmentTreeGenerator< TScalarType >
-::MergeEquivalencies()
+::MergeEquivalencies(SegmentTableTypePointer segTable)
 {
-  typename SegmentTableType::Pointer segTable = this->GetInputSegmentTable();
   typename EquivalencyTableType::Pointer eqTable  =
     this->GetInputEquivalencyTable();
   typename EquivalencyTableType::Iterator it;
@@ -230,6 +230,23 @@ public:
    * after all iterations have taken place. */
   itkGetConstMacro(SortEdgeLists, bool);
   itkSetMacro(SortEdgeLists, bool);
+
+  /** Gets/Sets the minimum and maximum values \f$ min, max \f$ from which
+   * the threshold and the maximum depth of the segment table are computed.
+   * They are only used when ComputeInputRange is false.  Streaming
+   * applications set them to the range of the complete volume so that
+   * every chunk is thresholded alike. */
+  itkSetMacro(InputMinimum, InputPixelType);
+  itkGetConstMacro(InputMinimum, InputPixelType);
+  itkSetMacro(InputMaximum, InputPixelType);
+  itkGetConstMacro(InputMaximum, InputPixelType);
+
+  /** Determines whether the range of the input values is computed over the
+   * region being processed, or taken from InputMinimum and InputMaximum.
+   * Default is true. */
+  itkSetMacro(ComputeInputRange, bool);
+  itkGetConstMacro(ComputeInputRange, bool);
+  itkBooleanMacro(ComputeInputRange);
 protected:
   /** Structure storing information about image flat regions.
    * Flat regions are connected pixels of the same value.  */
@@ -367,11 +384,14 @@ private:
    *  streaming applications*/
   ImageRegionType m_LargestPossibleRegion;
 
-  bool          m_SortEdgeLists;
-  bool          m_DoBoundaryAnalysis;
-  double        m_Threshold;
-  double        m_MaximumFloodLevel;
-  unsigned long m_CurrentLabel;
+  bool           m_SortEdgeLists;
+  bool           m_DoBoundaryAnalysis;
+  bool           m_ComputeInputRange;
+  InputPixelType m_InputMinimum;
+  InputPixelType m_InputMaximum;
+  double         m_Threshold;
+  double         m_MaximumFloodLevel;
+  unsigned long  m_CurrentLabel;
 };
 } // end namespace watershed
 } // end namespace itk
@@ -183,7 +183,15 @@ void Segmenter< TInputImage >::GenerateData()
   //
   //
   InputPixelType minimum, maximum;
-  Self::MinMax(input, regionToProcess, minimum, maximum);
+  if ( m_ComputeInputRange )
+    {
+    Self::MinMax(input, regionToProcess, minimum, maximum);
+    }
+  else
+    {
+    minimum = m_InputMinimum;
+    maximum = m_InputMaximum;
+    }
   // cap the maximum in the image so that we can always define a pixel
   // value that is one greater than the maximum value in the image.
   if ( NumericTraits< InputPixelType >::is_integer
@@ -191,6 +199,17 @@ void Segmenter< TInputImage >::GenerateData()
     {
     maximum -= NumericTraits< InputPixelType >::One;
     }
+  // The flow at the boundaries is analyzed before the retaining wall is
+  // built.  The padding along the faces on the data set boundary must
+  // already stop the flow, so build the wall there first.  The overlap with
+  // the other chunks is filled in by the threshold below.
+  if ( m_DoBoundaryAnalysis == true )
+    {
+    this->BuildRetainingWall(thresholdImage,
+                             thresholdImage->GetBufferedRegion(),
+                             maximum + NumericTraits< InputPixelType >::One);
+    }
+
   // threshold the image.
   Self::Threshold( thresholdImage, input, regionToProcess, regionToProcess,
                    static_cast< InputPixelType >( ( m_Threshold * ( maximum - minimum ) ) + minimum ) );
@@ -480,16 +499,18 @@ void Segmenter< TInputImage >
       searchIt.GoToBegin();
       labelIt.GoToBegin();
 
+      // The connectivity lists the negative offsets from the last
+      // dimension down to the first one, then the positive offsets from the
+      // first dimension up to the last one.  See GenerateConnectivity().
       if ( ( idx ).second == 0 )
         {
         // Low face
-        cPos = m_Connectivity.index[( idx ).first];
+        cPos = m_Connectivity.index[( ImageDimension - 1 ) - ( idx ).first];
         }
       else
         {
         // High face
-        cPos = m_Connectivity.index[( ImageDimension - 1 )
-                                    + ( ImageDimension - ( idx ).first )];
+        cPos = m_Connectivity.index[ImageDimension + ( idx ).first];
         }
 
       while ( !searchIt.IsAtEnd() )
@@ -1362,6 +1383,9 @@ Segmenter< TInputImage >
   m_CurrentLabel = 1;
   m_DoBoundaryAnalysis = false;
   m_SortEdgeLists = true;
+  m_ComputeInputRange = true;
+  m_InputMinimum = NumericTraits< InputPixelType >::Zero;
+  m_InputMaximum = NumericTraits< InputPixelType >::Zero;
   m_Connectivity.direction = 0;
   m_Connectivity.index = 0;
   typename OutputImageType::Pointer img =
@@ -1390,6 +1414,11 @@ Segmenter< TInputImage >
   Superclass::PrintSelf(os, indent);
   os << indent << "SortEdgeLists: " << m_SortEdgeLists << std::endl;
   os << indent << "DoBoundaryAnalysis: " << m_DoBoundaryAnalysis << std::endl;
+  os << indent << "ComputeInputRange: " << m_ComputeInputRange << std::endl;
+  os << indent << "InputMinimum: "
+     << static_cast< typename NumericTraits< InputPixelType >::PrintType >( m_InputMinimum ) << std::endl;
+  os << indent << "InputMaximum: "
+     << static_cast< typename NumericTraits< InputPixelType >::PrintType >( m_InputMaximum ) << std::endl;
   os << indent << "Threshold: " << m_Threshold << std::endl;
   os << indent << "MaximumFloodLevel: " << m_MaximumFloodLevel << std::endl;
   os << indent << "CurrentLabel: " << m_CurrentLabel << std::endl;
@@ -52,6 +52,24 @@ namespace itk
  * Manduchi (Bilateral Filtering for Gray and ColorImages. IEEE
  * ICCV. 1998.)
  *
+ * The cost of the exact filter grows with the size of the domain
+ * kernel, which is prohibitive for large DomainSigma in 3D.  With
+ * UseBilateralGrid on, the filter is approximated on a bilateral grid
+ * instead (Paris and Durand, A Fast Approximation of the Bilateral
+ * Filter using a Signal Processing Approach. ECCV. 2006).  The pixels
+ * are accumulated in a coarse grid over the image domain and the
+ * intensities, with BilateralGridSamplingRate cells per DomainSigma and
+ * per RangeSigma.  The grid is smoothed by a separable Gaussian, and the
+ * output is interpolated multilinearly in the grid at the position and
+ * the intensity of each pixel.  The cost no longer depends on the size of
+ * the kernel; higher sampling rates are more accurate and slower.  The
+ * Radius and NumberOfRangeGaussianSamples are not used by the grid.
+ * The accumulation and the smoothing of the grid are divided between
+ * the threads, by slabs of the grid and by lines of the grid.  The grid
+ * has at most 2^28 cells, which take 2 gigabytes; an exception is thrown
+ * when the sigmas are too small for the size and the dynamic range of the
+ * image at the requested sampling rate.
+ *
  * \sa GaussianOperator
  * \sa RecursiveGaussianImageFilter
  * \sa DiscreteGaussianImageFilter
@@ -161,6 +179,18 @@ public:
   itkSetMacro(NumberOfRangeGaussianSamples, unsigned long);
   itkGetConstMacro(NumberOfRangeGaussianSamples, unsigned long);
 
+  /** Set/Get whether the filter is approximated on a bilateral grid.
+   * Default is off. */
+  itkSetMacro(UseBilateralGrid, bool);
+  itkGetConstMacro(UseBilateralGrid, bool);
+  itkBooleanMacro(UseBilateralGrid);
+
+  /** Set/Get the number of cells of the bilateral grid per DomainSigma
+   * and per RangeSigma. The cells are never smaller than a pixel. Lower
+   * rates make smaller grids. Default is 2. */
+  itkSetClampMacro( BilateralGridSamplingRate, double, 0.1, NumericTraits< double >::max() );
+  itkGetConstMacro(BilateralGridSamplingRate, double);
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro( OutputHasNumericTraitsCheck,
@@ -183,6 +213,8 @@ protected:
     m_DomainMu = 2.5;  // keep small to keep kernels small
     m_RangeMu = 4.0;   // can be bigger then DomainMu since we only
                        // index into a single table
+    m_UseBilateralGrid = false;
+    m_BilateralGridSamplingRate = 2.0;
   }
 
   virtual ~BilateralImageFilter() {}
@@ -196,6 +228,9 @@ protected:
   void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                             int threadId);
 
+  /** Release the bilateral grid. */
+  void AfterThreadedGenerateData();
+
   /** BilateralImageFilter needs a larger input requested region than
    * the output requested region (larger by the size of the domain
    * Gaussian kernel).  As such, BilateralImageFilter needs to provide
@@ -209,6 +244,38 @@ private:
   BilateralImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);       //purposely not implemented
 
+  /** Accumulate the input in the bilateral grid and smooth it. */
+  void ComputeBilateralGrid();
+
+  /** Structure for passing information into the static threader
+   *  callbacks of the bilateral grid. */
+  struct BilateralGridThreadStruct {
+    Self *Filter;
+    unsigned int Dimension;
+    const std::vector< double > *Kernel;
+  };
+
+  /** Splits the slabs of the grid along its last dimension among the
+   *  threads and calls ThreadedSplatBilateralGrid. */
+  static ITK_THREAD_RETURN_TYPE SplatBilateralGridThreaderCallback(void *arg);
+
+  /** Splits the lines of the grid along a dimension among the threads
+   *  and calls ThreadedSmoothBilateralGrid. */
+  static ITK_THREAD_RETURN_TYPE SmoothBilateralGridThreaderCallback(void *arg);
+
+  /** Accumulate the pixels of the input whose cells are in the slabs
+   * [first, last) of the last dimension of the grid.  The threads write
+   * disjoint cells. */
+  void ThreadedSplatBilateralGrid(unsigned long first, unsigned long last);
+
+  /** Smooth the lines [first, last) of the grid along a dimension. */
+  void ThreadedSmoothBilateralGrid(unsigned int dimension, const std::vector< double > & kernel,
+                                   unsigned long first, unsigned long last);
+
+  /** Interpolate the output of a thread in the bilateral grid. */
+  void ThreadedGenerateDataWithBilateralGrid(const OutputImageRegionType & outputRegionForThread,
+                                             int threadId);
+
   /** The standard deviation of the gaussian blurring kernel in the image
       range. Units are intensity. */
   double m_RangeSigma;
@@ -235,6 +302,28 @@ private:
   double                m_DynamicRange;
   double                m_DynamicRangeUsed;
   std::vector< double > m_RangeGaussianTable;
+
+  /** Parameters of the bilateral grid approximation */
+  bool   m_UseBilateralGrid;
+  double m_BilateralGridSamplingRate;
+
+  /** The largest number of cells of the bilateral grid, which take two
+   * floats each. */
+  itkStaticConstMacro(MaximumNumberOfBilateralGridCells, unsigned long, 268435456);
+
+  /** The bilateral grid: the sums of the intensities and the weights,
+   * interleaved, with the intensity as the fastest dimension.  The cells
+   * of the domain dimensions are m_GridCellSize pixels wide from
+   * m_GridOrigin; the cells of the intensities are m_GridCellSize
+   * wide from m_GridMinimum.  The grid has m_GridPadding cells of margin
+   * on both sides. */
+  std::vector< float > m_Grid;
+  unsigned long        m_GridSize[ImageDimension + 1];
+  unsigned long        m_GridStride[ImageDimension + 1];
+  unsigned long        m_GridPadding[ImageDimension + 1];
+  double               m_GridCellSize[ImageDimension + 1];
+  typename TInputImage::IndexType m_GridOrigin;
+  double                          m_GridMinimum;
 };
 } // end namespace itk
 
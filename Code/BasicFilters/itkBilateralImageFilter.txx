@@ -20,6 +20,8 @@
 
 #include "itkBilateralImageFilter.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkGaussianImageSource.h"
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkZeroFluxNeumannBoundaryCondition.h"
@@ -112,6 +114,12 @@ void
 BilateralImageFilter< TInputImage, TOutputImage >
 ::BeforeThreadedGenerateData()
 {
+  if ( m_UseBilateralGrid )
+    {
+    this->ComputeBilateralGrid();
+    return;
+    }
+
   // Build a small image of the N-dimensional Gaussian used for domain filter
   //
   // Gaussian image size will be (2*vcl_ceil(2.5*sigma)+1) x
@@ -235,6 +243,12 @@ BilateralImageFilter< TInputImage, TOutputImage >
 ::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                        int threadId)
 {
+  if ( m_UseBilateralGrid )
+    {
+    this->ThreadedGenerateDataWithBilateralGrid(outputRegionForThread, threadId);
+    return;
+    }
+
   typename TInputImage::ConstPointer input = this->GetInput();
   typename TOutputImage::Pointer output = this->GetOutput();
   unsigned long i;
@@ -330,6 +344,330 @@ BilateralImageFilter< TInputImage, TOutputImage >
     }
 }
 
+template< class TInputImage, class TOutputImage >
+void
+BilateralImageFilter< TInputImage, TOutputImage >
+::AfterThreadedGenerateData()
+{
+  // release the memory of the grid
+  std::vector< float >().swap(m_Grid);
+}
+
+template< class TInputImage, class TOutputImage >
+void
+BilateralImageFilter< TInputImage, TOutputImage >
+::ComputeBilateralGrid()
+{
+  const InputImageType *                     inputImage = this->GetInput();
+  const typename InputImageType::RegionType  region = inputImage->GetRequestedRegion();
+  const typename InputImageType::SpacingType inputSpacing = inputImage->GetSpacing();
+
+  if ( m_RangeSigma <= 0.0 )
+    {
+    itkExceptionMacro(<< "RangeSigma must be positive with the bilateral grid");
+    }
+
+  // Determine the min and max intensity range
+  double minimum = NumericTraits< double >::max();
+  double maximum = NumericTraits< double >::NonpositiveMin();
+  ImageRegionConstIterator< InputImageType > it(inputImage, region);
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const double value = static_cast< double >( it.Get() );
+    minimum = vnl_math_min(minimum, value);
+    maximum = vnl_math_max(maximum, value);
+    }
+  m_DynamicRange = maximum - minimum;
+  m_GridMinimum = minimum;
+  m_GridOrigin = region.GetIndex();
+
+  // The dimension 0 of the grid is the intensity, and the dimension i + 1
+  // is the dimension i of the image.  The cells are 1 / rate sigma wide,
+  // so the Gaussians are rate cells wide, unless the cells are clamped to
+  // a pixel.  The number of cells is counted in double, which cannot
+  // overflow, and checked before the grid is allocated.
+  std::vector< double > kernels[ImageDimension + 1];
+  double                numberOfCells = 1.0;
+  for ( unsigned int g = 0; g <= ImageDimension; g++ )
+    {
+    double sigma;
+    double mu;
+    double extent;
+    if ( g == 0 )
+      {
+      sigma = m_RangeSigma;
+      mu = m_RangeMu;
+      extent = m_DynamicRange;
+      m_GridCellSize[g] = sigma / m_BilateralGridSamplingRate;
+      }
+    else
+      {
+      sigma = m_DomainSigma[g - 1] / inputSpacing[g - 1];
+      mu = m_DomainMu;
+      extent = region.GetSize(g - 1) - 1;
+      m_GridCellSize[g] = vnl_math_max(sigma / m_BilateralGridSamplingRate, 1.0);
+      }
+    const double cellSigma = sigma / m_GridCellSize[g];
+
+    // one more cell on both sides for the interpolation
+    m_GridPadding[g] = 1;
+    const double size = vcl_ceil(extent / m_GridCellSize[g]) + 1 + 2 * m_GridPadding[g];
+    numberOfCells *= size;
+    if ( numberOfCells > MaximumNumberOfBilateralGridCells )
+      {
+      itkExceptionMacro(<< "The bilateral grid would have more than "
+                        << MaximumNumberOfBilateralGridCells
+                        << " cells.  Use a lower BilateralGridSamplingRate or larger sigmas.");
+      }
+    m_GridSize[g] = static_cast< unsigned long >( size );
+    m_GridStride[g] = ( g == 0 ) ? 1 : m_GridStride[g - 1] * m_GridSize[g - 1];
+
+    const unsigned long radius = static_cast< unsigned long >( vcl_ceil( mu * cellSigma ) );
+
+    std::vector< double > & kernel = kernels[g];
+    kernel.resize(2 * radius + 1);
+    double sum = 0.0;
+    for ( unsigned long k = 0; k < kernel.size(); k++ )
+      {
+      const double x = static_cast< double >( k ) - static_cast< double >( radius );
+      kernel[k] = ( radius == 0 ) ? 1.0 : vcl_exp(-0.5 * x * x / ( cellSigma * cellSigma ) );
+      sum += kernel[k];
+      }
+    for ( unsigned long k = 0; k < kernel.size(); k++ )
+      {
+      kernel[k] /= sum;
+      }
+    }
+
+  // Accumulate the intensities and the number of pixels in the nearest
+  // cells, by slabs of the grid along its last dimension
+  m_Grid.assign(2 * static_cast< unsigned long >( numberOfCells ), 0.0f);
+
+  BilateralGridThreadStruct str;
+  str.Filter = this;
+  str.Dimension = ImageDimension;
+  str.Kernel = 0;
+
+  this->GetMultiThreader()->SetNumberOfThreads(
+    vnl_math_min( static_cast< unsigned long >( this->GetNumberOfThreads() ), m_GridSize[ImageDimension] ) );
+  this->GetMultiThreader()->SetSingleMethod(this->SplatBilateralGridThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  // Smooth the grid along each dimension, by lines
+  for ( unsigned int g = 0; g <= ImageDimension; g++ )
+    {
+    if ( kernels[g].size() == 1 )
+      {
+      continue;
+      }
+    str.Dimension = g;
+    str.Kernel = &kernels[g];
+
+    const unsigned long numberOfLines = m_Grid.size() / ( 2 * m_GridSize[g] );
+    this->GetMultiThreader()->SetNumberOfThreads(
+      vnl_math_min( static_cast< unsigned long >( this->GetNumberOfThreads() ), numberOfLines ) );
+    this->GetMultiThreader()->SetSingleMethod(this->SmoothBilateralGridThreaderCallback, &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+BilateralImageFilter< TInputImage, TOutputImage >
+::SplatBilateralGridThreaderCallback(void *arg)
+{
+  const int threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  const int threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  BilateralGridThreadStruct *str =
+    (BilateralGridThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  const unsigned long size = str->Filter->m_GridSize[ImageDimension];
+  str->Filter->ThreadedSplatBilateralGrid(size * threadId / threadCount,
+                                          size * ( threadId + 1 ) / threadCount);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+BilateralImageFilter< TInputImage, TOutputImage >
+::SmoothBilateralGridThreaderCallback(void *arg)
+{
+  const int threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  const int threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  BilateralGridThreadStruct *str =
+    (BilateralGridThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  const unsigned long numberOfLines =
+    str->Filter->m_Grid.size() / ( 2 * str->Filter->m_GridSize[str->Dimension] );
+  str->Filter->ThreadedSmoothBilateralGrid(str->Dimension, *str->Kernel,
+                                           numberOfLines * threadId / threadCount,
+                                           numberOfLines * ( threadId + 1 ) / threadCount);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+BilateralImageFilter< TInputImage, TOutputImage >
+::ThreadedSplatBilateralGrid(unsigned long first, unsigned long last)
+{
+  const InputImageType *inputImage = this->GetInput();
+  const unsigned int    slabDimension = ImageDimension - 1;
+
+  // the pixels whose cells are in the slabs, which are consecutive
+  typename InputImageType::RegionType region = inputImage->GetRequestedRegion();
+  const long    start = region.GetIndex(slabDimension);
+  const long    end = start + static_cast< long >( region.GetSize(slabDimension) );
+  long          begin = end;
+  unsigned long count = 0;
+  for ( long index = start; index < end; index++ )
+    {
+    const double        position = ( index - m_GridOrigin[slabDimension] ) / m_GridCellSize[ImageDimension];
+    const unsigned long slab = Math::Round< unsigned long >(position) + m_GridPadding[ImageDimension];
+    if ( slab >= first && slab < last )
+      {
+      begin = vnl_math_min(begin, index);
+      ++count;
+      }
+    }
+  if ( count == 0 )
+    {
+    return;
+    }
+  region.SetIndex(slabDimension, begin);
+  region.SetSize(slabDimension, count);
+
+  ImageLinearConstIteratorWithIndex< InputImageType > lineIt(inputImage, region);
+  lineIt.SetDirection(0);
+  for ( lineIt.GoToBegin(); !lineIt.IsAtEnd(); lineIt.NextLine() )
+    {
+    unsigned long lineOffset = 0;
+    for ( unsigned int i = 1; i < ImageDimension; i++ )
+      {
+      const double position = ( lineIt.GetIndex()[i] - m_GridOrigin[i] ) / m_GridCellSize[i + 1];
+      lineOffset += ( Math::Round< unsigned long >(position) + m_GridPadding[i + 1] )
+                    * m_GridStride[i + 1];
+      }
+    while ( !lineIt.IsAtEndOfLine() )
+      {
+      const double value = static_cast< double >( lineIt.Get() );
+      const double position = ( lineIt.GetIndex()[0] - m_GridOrigin[0] ) / m_GridCellSize[1];
+      const double level = ( value - m_GridMinimum ) / m_GridCellSize[0];
+      const unsigned long offset = lineOffset
+                                   + ( Math::Round< unsigned long >(position) + m_GridPadding[1] )
+                                   * m_GridStride[1]
+                                   + Math::Round< unsigned long >(level) + m_GridPadding[0];
+      m_Grid[2 * offset] += static_cast< float >( value );
+      m_Grid[2 * offset + 1] += 1.0f;
+      ++lineIt;
+      }
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void
+BilateralImageFilter< TInputImage, TOutputImage >
+::ThreadedSmoothBilateralGrid(unsigned int dimension, const std::vector< double > & kernel,
+                              unsigned long first, unsigned long last)
+{
+  const unsigned long  radius = ( kernel.size() - 1 ) / 2;
+  const unsigned long  length = m_GridSize[dimension];
+  const unsigned long  stride = m_GridStride[dimension];
+  std::vector< float > line(2 * length);
+  for ( unsigned long l = first; l < last; l++ )
+    {
+    // the first cell of the line
+    float *cell = &m_Grid[2 * ( ( l / stride ) * stride * length + l % stride )];
+    for ( unsigned long x = 0; x < length; x++ )
+      {
+      line[2 * x] = cell[2 * x * stride];
+      line[2 * x + 1] = cell[2 * x * stride + 1];
+      }
+    // the cells beyond the grid are empty
+    for ( unsigned long x = 0; x < length; x++ )
+      {
+      const unsigned long kernelBegin = ( x < radius ) ? radius - x : 0;
+      const unsigned long kernelEnd = vnl_math_min(static_cast< unsigned long >( kernel.size() ),
+                                                   length + radius - x);
+      double              value = 0.0;
+      double              weight = 0.0;
+      for ( unsigned long k = kernelBegin; k < kernelEnd; k++ )
+        {
+        value += kernel[k] * line[2 * ( x + k - radius )];
+        weight += kernel[k] * line[2 * ( x + k - radius ) + 1];
+        }
+      cell[2 * x * stride] = static_cast< float >( value );
+      cell[2 * x * stride + 1] = static_cast< float >( weight );
+      }
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void
+BilateralImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateDataWithBilateralGrid(const OutputImageRegionType & outputRegionForThread,
+                                        int threadId)
+{
+  const unsigned int GridDimension = ImageDimension + 1;
+  const unsigned int numberOfCorners = 1 << GridDimension;
+
+  // offsets of the corners of a cell
+  std::vector< unsigned long > cornerOffsets(numberOfCorners);
+  for ( unsigned int c = 0; c < numberOfCorners; c++ )
+    {
+    cornerOffsets[c] = 0;
+    for ( unsigned int g = 0; g < GridDimension; g++ )
+      {
+      if ( c & ( 1 << g ) )
+        {
+        cornerOffsets[c] += m_GridStride[g];
+        }
+      }
+    }
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+
+  ImageRegionConstIteratorWithIndex< InputImageType > inIt(this->GetInput(), outputRegionForThread);
+  ImageRegionIterator< OutputImageType > outIt(this->GetOutput(), outputRegionForThread);
+  double fraction[ImageDimension + 1];
+  for ( ; !inIt.IsAtEnd(); ++inIt, ++outIt )
+    {
+    const double value = static_cast< double >( inIt.Get() );
+
+    // the cell below the pixel, and its position in this cell
+    unsigned long offset = 0;
+    for ( unsigned int g = 0; g < GridDimension; g++ )
+      {
+      const double position = ( g == 0 )
+                              ? ( value - m_GridMinimum ) / m_GridCellSize[0]
+                              : ( inIt.GetIndex()[g - 1] - m_GridOrigin[g - 1] ) / m_GridCellSize[g];
+      const unsigned long cell = Math::Floor< unsigned long >(position);
+      fraction[g] = position - cell;
+      offset += ( cell + m_GridPadding[g] ) * m_GridStride[g];
+      }
+
+    double sum = 0.0;
+    double weight = 0.0;
+    for ( unsigned int c = 0; c < numberOfCorners; c++ )
+      {
+      double interpolationWeight = 1.0;
+      for ( unsigned int g = 0; g < GridDimension; g++ )
+        {
+        interpolationWeight *= ( c & ( 1 << g ) ) ? fraction[g] : 1.0 - fraction[g];
+        }
+      const float *cell = &m_Grid[2 * ( offset + cornerOffsets[c] )];
+      sum += interpolationWeight * cell[0];
+      weight += interpolationWeight * cell[1];
+      }
+
+    outIt.Set( static_cast< OutputPixelType >( weight > 0.0 ? sum / weight : value ) );
+    progress.CompletedPixel();
+    }
+}
+
 template< class TInputImage, class TOutputImage >
 void
 BilateralImageFilter< TInputImage, TOutputImage >
@@ -345,6 +683,8 @@ BilateralImageFilter< TInputImage, TOutputImage >
   os << indent << "Amount of dynamic range used: " << m_DynamicRangeUsed << std::endl;
   os << indent << "AutomaticKernelSize: " << m_AutomaticKernelSize << std::endl;
   os << indent << "Radius: " << m_Radius << std::endl;
+  os << indent << "UseBilateralGrid: " << m_UseBilateralGrid << std::endl;
+  os << indent << "BilateralGridSamplingRate: " << m_BilateralGridSamplingRate << std::endl;
 }
 } // end namespace itk
 
@@ -18,10 +18,7 @@
 #ifndef __itkBinaryDilateImageFilter_h
 #define __itkBinaryDilateImageFilter_h
 
-#include <vector>
-#include <queue>
 #include "itkBinaryMorphologyImageFilter.h"
-#include "itkConstNeighborhoodIterator.h"
 
 namespace itk
 {
@@ -30,15 +27,10 @@ namespace itk
  * \brief Fast binary dilation
  *
  * BinaryDilateImageFilter is a binary dilation
- * morphologic operation. This implementation is based on the papers:
- *
- * L.Vincent "Morphological transformations of binary images with
- * arbitrary structuring elements", and
- *
- * N.Nikopoulos et al. "An efficient algorithm for 3d binary
- * morphological transformations with 3d structuring elements
- * for arbitrary size and shape". IEEE Transactions on Image
- * Processing. Vol. 9. No. 3. 2000. pp. 283-286.
+ * morphologic operation. The lines of the input and of the structuring
+ * element are run-length encoded, and the output is computed in
+ * several threads. See BinaryMorphologyImageFilter for a description
+ * of the algorithm.
  *
  * Gray scale images can be processed as binary images by selecting a
  * "DilateValue".  Pixel values matching the dilate value are
@@ -121,10 +113,11 @@ protected:
   virtual ~BinaryDilateImageFilter(){}
   void PrintSelf(std::ostream & os, Indent indent) const;
 
-  void GenerateData();
-
-  // type inherited from the superclass
-  typedef typename Superclass::NeighborIndexContainer NeighborIndexContainer;
+  /** BinaryDilateImageFilter can be implemented as a multithreaded filter.
+   * \sa ImageToImageFilter::ThreadedGenerateData(),
+   *     ImageToImageFilter::GenerateData() */
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                            int threadId);
 private:
   BinaryDilateImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);          //purposely not implemented
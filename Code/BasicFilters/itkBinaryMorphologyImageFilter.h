@@ -18,8 +18,8 @@
 #ifndef __itkBinaryMorphologyImageFilter_h
 #define __itkBinaryMorphologyImageFilter_h
 
+#include <utility>
 #include <vector>
-#include <queue>
 #include "itkKernelImageFilter.h"
 #include "itkNeighborhoodIterator.h"
 #include "itkImageBoundaryCondition.h"
@@ -33,16 +33,7 @@ namespace itk
  * \brief Base class for fast binary dilation and erosion
  *
  * BinaryMorphologyImageFilter is a base class for fast binary
- * morphological operations. The implementation of this class and its
- * subclasses are based on the papers:
- *
- * L.Vincent "Morphological transformations of binary images with
- * arbitrary structuring elements", and
- *
- * N.Nikopoulos et al. "An efficient algorithm for 3d binary
- * morphological transformations with 3d structuring elements
- * for arbitrary size and shape". IEEE Transactions on Image
- * Processing. Vol. 9. No. 3. 2000. pp. 283-286.
+ * morphological operations.
  *
  * Gray scale images can be processed as binary images by selecting a
  * "ForegroundValued" (which subclasses may alias as "DilateValue" or
@@ -62,39 +53,39 @@ namespace itk
  *
  * Description of the algorithm:
  * ----------------------------------------------
- * Let's consider the set of the ON elements of the input image as X.
+ * Let's consider the set of the ON elements of the input image as X,
+ * and the structuring element as B.  The dilation of X by B is
  *
- * Let's consider the structuring element as B = {B0, B1, ..., Bn},
- * where Bi denotes a connected component of B.
+ *     X (+) B = { x + b, x belongs to X, b belongs to B }
  *
- * Let's consider bi, i in [0,n], an arbitrary point of Bi.
+ * The lines of the structuring element along the first dimension are
+ * encoded as runs of ON elements, and so are the lines of the input
+ * image.  A run [s, e] of X on a line, combined with a run [a, b] of
+ * B on the line of offset o, covers the run [s + a, e + b] of the line
+ * of X (+) B moved by o.  Each line of the output is the union of the
+ * runs obtained from the lines of the input within the radius of the
+ * structuring element, so the cost depends on the number of runs
+ * rather than on the number of pixels of the structuring element.
+ * The erosion is computed as the dilation of the background.
  *
- * We use hence the next property in order to compute minkoswki
- * addition ( which will be written (+) ):
- *
- * X (+) B = ( Xb0 UNION Xb1 UNION ... Xbn ) UNION ( BORDER(X) (+) B ),
- *
- * where Xbi is the set X translated with respect to vector bi :
- *
- * Xbi ={ x + bi, x belongs to X }
- *
- * where BORDER(X) is the extracted border of X ( 8 connectivity in
- * 2D, 26 in 3D )
- *
- * Our implementation for dilation is defined as:
- *
- *     X (+) SYM(B) = DILATION(X)_B
- *
- * Where DILATION(X)_B is the dilation of set with structuring element B.
- * Where SYM(B) is the symmetric of the structuring element relatively
- * to its center.
+ * The output lines are independent, and the filter is multithreaded.
+ * Any shape of structuring element, like the ones of
+ * FlatStructuringElement, is supported.
  *
  * This code was contributed by Jerome Schmid from the University of
  * Strasbourg who provided a fast dilation implementation. Gaetan
  * Lehmann from INRA de Jouy-en-Josas then provided a fast erosion
  * implementaton based on Jerome's implementation.  The common
  * portions of these two implementations were then placed in this
- * superclass.
+ * superclass.  They were based on the papers:
+ *
+ * L.Vincent "Morphological transformations of binary images with
+ * arbitrary structuring elements", and
+ *
+ * N.Nikopoulos et al. "An efficient algorithm for 3d binary
+ * morphological transformations with 3d structuring elements
+ * for arbitrary size and shape". IEEE Transactions on Image
+ * Processing. Vol. 9. No. 3. 2000. pp. 283-286.
  *
  * \sa ImageToImageFilter BinaryErodeImageFilter BinaryDilateImageFilter
  */
@@ -195,36 +186,22 @@ protected:
   void PrintSelf(std::ostream & os, Indent indent) const;
 
   /**
-   * Analyze kernel and prepare data for GenerateData() function */
+   * Analyze kernel and prepare data for ThreadedGenerateData() function */
   void AnalyzeKernel();
 
-  /** Type definition of container of neighbourhood index */
-  typedef std::vector< OffsetType > NeighborIndexContainer;
-
-  /** Type definition of container of container of neighbourhood index */
-  typedef std::vector< NeighborIndexContainer > NeighborIndexContainerContainer;
+  /** A run of pixels along the first dimension, given by the positions
+   * of its first and last pixels. */
+  typedef typename InputImageType::OffsetValueType      OffsetValueType;
+  typedef std::pair< OffsetValueType, OffsetValueType > RunType;
+  typedef std::vector< RunType >                        RunVectorType;
 
-  /** Type definition of the container for indices */
-  typedef std::vector< OffsetType > ComponentVectorType;
-
-  /** Iterator for ComponentVectorType */
-  typedef typename ComponentVectorType::const_iterator
-  ComponentVectorConstIterator;
-
-  /**
-   * Get the difference set for a particular offset */
-  NeighborIndexContainer & GetDifferenceSet(unsigned int code)
-  { return m_KernelDifferenceSets[code]; }
-
-  /**
-   * Get an iterator to the start of the connected component vector */
-  ComponentVectorConstIterator KernelCCVectorBegin()
-  { return m_KernelCCVector.begin(); }
-
-  /**
-   * Get an iterator to the end of the connected component vector */
-  ComponentVectorConstIterator KernelCCVectorEnd()
-  { return m_KernelCCVector.end(); }
+  /** Compute the dilation (dilate is true) or the erosion of a region of
+   * the output. The dilation spreads the pixels equal to the
+   * ForegroundValue, and the pixels outside of the image when
+   * BoundaryToForeground is true. The erosion spreads the other pixels
+   * with the same structuring element. */
+  void RunLengthThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                     int threadId, bool dilate);
 
   bool m_BoundaryToForeground;
 private:
@@ -237,13 +214,11 @@ private:
   /** Pixel value for background */
   OutputPixelType m_BackgroundValue;
 
-  /** Difference sets definition */
-  NeighborIndexContainerContainer m_KernelDifferenceSets;
-
-  /** For each Connected Component ( CC ) of structuring element we
-   * store the position of one element, arbitrary chosen, which belongs
-   * to the CC */
-  std::vector< OffsetType > m_KernelCCVector;
+  /** The offsets of the lines of the structuring element along the first
+   * dimension which have ON elements, and the runs of ON elements on each
+   * of these lines. */
+  std::vector< OffsetType >    m_KernelLineOffsets;
+  std::vector< RunVectorType > m_KernelLineRuns;
 };
 } // end namespace itk
 
@@ -18,15 +18,13 @@
 #ifndef __itkBinaryMorphologyImageFilter_txx
 #define __itkBinaryMorphologyImageFilter_txx
 
-#include "itkImageRegionIteratorWithIndex.h"
-#include "itkNeighborhoodInnerProduct.h"
-#include "itkImageRegionConstIterator.h"
-#include "itkNeighborhoodAlgorithm.h"
-#include "itkConstantBoundaryCondition.h"
+#include "itkImageLinearIteratorWithIndex.h"
 #include "itkOffset.h"
 #include "itkProgressReporter.h"
 #include "itkBinaryMorphologyImageFilter.h"
 
+#include <algorithm>
+
 namespace itk
 {
 template< class TInputImage, class TOutputImage, class TKernel >
@@ -54,279 +52,235 @@ void
 BinaryMorphologyImageFilter< TInputImage, TOutputImage, TKernel >
 ::AnalyzeKernel(void)
 {
-  // Sure clearing
-  m_KernelDifferenceSets.clear();
-  m_KernelCCVector.clear();
-
-  std::vector< unsigned int > kernelOnElements;
-
-  unsigned long i, k;
+  m_KernelLineOffsets.clear();
+  m_KernelLineRuns.clear();
 
-  // **************************
-  // Structuring element ( SE ) coding
-  // **************************
+  // The kernel is stored with its first dimension varying fastest, so its
+  // lines along the first dimension are contiguous.
+  const KernelType & kernel = this->GetKernel();
+  const unsigned long lineLength = kernel.GetSize(0);
+  const unsigned long numberOfElements = kernel.Size();
 
-  // Get symmetrical structuring element in order to satisfy
-  // our definition of binary dilation
-//   unsigned long kernelSize      = this->GetKernel().Size();
-//   unsigned long kernelCenter    = kernelSize / 2;
-//
-//   for( i = kernelCenter + 1, k = kernelCenter - 1; i < kernelSize; ++i, --k )
-//     {
-//     typename TKernel::PixelType px     =
-// this->GetKernel().GetBufferReference()[i];
-//     this->GetKernel().GetBufferReference()[i]  =
-// this->GetKernel().GetBufferReference()[k];
-//     this->GetKernel().GetBufferReference()[k]  = px;
-//     }
-
-  // Store index of SE of ON elements
-  // It allows us to have a fastest access to ON elements
-  // of SE Kernel
-  KernelIteratorType KernelBegin  = this->GetKernel().Begin();
-  KernelIteratorType KernelEnd    = this->GetKernel().End();
-  KernelIteratorType kernel_it;
-
-  for ( i = 0, kernel_it = KernelBegin; kernel_it != KernelEnd; ++kernel_it, ++i )
+  KernelIteratorType kernel_it = kernel.Begin();
+  for ( unsigned long lineStart = 0; lineStart < numberOfElements; lineStart += lineLength )
     {
-    if ( *kernel_it )
+    RunVectorType runs;
+    bool          inRun = false;
+    for ( unsigned long i = 0; i < lineLength; ++i, ++kernel_it )
       {
-      kernelOnElements.push_back(i);
+      const OffsetValueType position = kernel.GetOffset(lineStart + i)[0];
+      if ( *kernel_it )
+        {
+        if ( inRun )
+          {
+          runs.back().second = position;
+          }
+        else
+          {
+          runs.push_back( RunType(position, position) );
+          inRun = true;
+          }
+        }
+      else
+        {
+        inRun = false;
+        }
       }
-    }
 
-  // Compute the Nd vector ( called index in case of images...do not
-  // mistake with index in case of neighbourhood which is only a
-  // position in a 1 dimensional buffer...! ) of the center element in
-  // the SE neighbourhood
-  IndexType centerElementPosition;
-  for ( i = 0; i < TInputImage::ImageDimension; ++i )
-    {
-    // position of center in a given direction is the middle of the direction
-    centerElementPosition[i] = this->GetKernel().GetSize(i) / 2;
+    if ( !runs.empty() )
+      {
+      OffsetType offset = kernel.GetOffset(lineStart);
+      offset[0] = 0;
+      m_KernelLineOffsets.push_back(offset);
+      m_KernelLineRuns.push_back(runs);
+      }
     }
+}
 
-  // We have to detect the connected component of the structuring
-  // element and compute the difference sets in each direction ( 26
-  // connectivity in 3D for instance )
-
-  // Detect all the connected components of the SE.
-  // ----------------------------------------------
-  // To do this we convert the SE into a temp image
-  typedef Image< bool, TInputImage::ImageDimension > BoolImageType;
-  typename BoolImageType::Pointer tmpSEImage = BoolImageType::New();
-  tmpSEImage->SetRegions( this->GetKernel().GetSize() );
-
-  // allocation
-  tmpSEImage->Allocate();
-
-  // copy
-  ImageRegionIterator< BoolImageType > kernelImageIt; // iterator on image
-  kernelImageIt = ImageRegionIterator< BoolImageType >( tmpSEImage,
-                                                        tmpSEImage->GetRequestedRegion() );
-
-  kernelImageIt.GoToBegin();
-  kernel_it = KernelBegin;
-
-  while ( !kernelImageIt.IsAtEnd() )
+template< class TInputImage, class TOutputImage, class TKernel >
+void
+BinaryMorphologyImageFilter< TInputImage, TOutputImage, TKernel >
+::RunLengthThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                int threadId, bool dilate)
+{
+  OutputImageType *     output = this->GetOutput();
+  const InputImageType *input = this->GetInput();
+
+  const InputPixelType  foregroundValue = this->GetForegroundValue();
+  const OutputPixelType backgroundValue = this->GetBackgroundValue();
+  const InputSizeType   radius = this->GetKernel().GetRadius();
+
+  // The spread set is made of the foreground pixels when dilating, and of
+  // the other pixels when eroding. The pixels outside of the image belong
+  // to the foreground when BoundaryToForeground is true.
+  const bool spreadForeground = dilate;
+  const bool spreadBoundary = ( this->m_BoundaryToForeground == dilate );
+
+  const InputImageRegionType bufferedRegion = input->GetBufferedRegion();
+  const OffsetValueType      bufferBegin = bufferedRegion.GetIndex(0);
+  const OffsetValueType      bufferEnd = bufferBegin + bufferedRegion.GetSize(0) - 1;
+  const OffsetValueType      outputBegin = outputRegionForThread.GetIndex(0);
+  const OffsetValueType      outputEnd = outputBegin + outputRegionForThread.GetSize(0) - 1;
+  const OffsetValueType      lineLength = outputRegionForThread.GetSize(0);
+
+  // The runs of pixels outside of the image only need to reach the output
+  const OffsetValueType outsideBegin = outputBegin - radius[0] - 1;
+  const OffsetValueType outsideEnd = outputEnd + radius[0] + 1;
+
+  // Encode the lines of the input which can reach the output region of the
+  // thread. Their runs are stored one line after the other.
+  InputImageRegionType sourceRegion = outputRegionForThread;
+  sourceRegion.PadByRadius(radius);
+  sourceRegion.SetIndex(0, bufferBegin);
+  sourceRegion.SetSize( 0, bufferedRegion.GetSize(0) );
+
+  unsigned long numberOfLines = 1;
+  OffsetValueType lineStrides[InputImageDimension];
+  lineStrides[0] = 0;
+  for ( unsigned int d = 1; d < InputImageDimension; ++d )
     {
-    kernelImageIt.Set(*kernel_it ? true : false);
-    ++kernelImageIt;
-    ++kernel_it;
+    lineStrides[d] = numberOfLines;
+    numberOfLines *= sourceRegion.GetSize(d);
     }
 
-  // boundary conditions
-  // Out boundary pixels are set to false
-  ConstantBoundaryCondition< BoolImageType > cbc;
-  cbc.SetConstant(false);
-
-  // Now look for connected component and record one SE element
-  // position for each CC.
-  ImageRegionIteratorWithIndex< BoolImageType >
-  kernelImageItIndex( tmpSEImage, tmpSEImage->GetRequestedRegion() );
-
-  // Neighborhood iterator on SE element temp image
-  InputSizeType padBy;
-  padBy.Fill(1);
-  NeighborhoodIterator< BoolImageType >
-  SEoNeighbIt( padBy, tmpSEImage, tmpSEImage->GetRequestedRegion() );
-  SEoNeighbIt.OverrideBoundaryCondition(&cbc);
-  unsigned int neighborhoodSize = SEoNeighbIt.Size();
-
-  // Use a FIFO queue in order to perform the burning process
-  // which allows to identify the connected components of SE
-  std::queue< IndexType > propagQueue;
+  RunVectorType                sourceRuns;
+  std::vector< unsigned long > sourceLines(numberOfLines + 1);
 
-  // Clear vector of recorded CCs
-  m_KernelCCVector.clear();
-
-  // walk both the "image" of the kernel iterator and the kernel
-  // iterator. use the "image" iterator to keep track of
-  // components. use the kernel iterator for quick access of offsets
-  kernel_it = KernelBegin;
-  kernelImageItIndex.GoToBegin();
-  while ( !kernelImageItIndex.IsAtEnd() )
+  IndexType lineIndex = sourceRegion.GetIndex();
+  for ( unsigned long line = 0; line < numberOfLines; ++line )
     {
-    // If a ON element is found track the CC
-    if ( kernelImageItIndex.Get() )
-      {
-      // Mark current element
-      kernelImageItIndex.Set(false);
-
-      // add it to queue
-      propagQueue.push( kernelImageItIndex.GetIndex() );
+    sourceLines[line] = sourceRuns.size();
 
-      // We know also that we start a new CC, so we store the position of this
-      // element relatively to center of kernel ( i.e a vector ).
-      OffsetType offset = this->GetKernel().GetOffset(kernel_it - KernelBegin);
-      m_KernelCCVector.push_back(offset);
-
-      // Process while FIFO queue is not empty
-      while ( !propagQueue.empty() )
+    if ( bufferedRegion.IsInside(lineIndex) )
+      {
+      if ( spreadBoundary && outsideBegin < bufferBegin )
         {
-        // Extract pixel index from queue
-        IndexType currentIndex = propagQueue.front();
-        propagQueue.pop();
-
-        // Now look for neighbours that are also ON pixels
-        SEoNeighbIt.GoToBegin();
-        SEoNeighbIt.SetLocation(currentIndex);
+        sourceRuns.push_back( RunType(outsideBegin, bufferBegin - 1) );
+        }
 
-        for ( i = 0; i < neighborhoodSize; ++i )
+      const InputPixelType *pixel = input->GetBufferPointer() + input->ComputeOffset(lineIndex);
+      bool                  inRun = false;
+      for ( OffsetValueType x = bufferBegin; x <= bufferEnd; ++x, ++pixel )
+        {
+        if ( ( *pixel == foregroundValue ) == spreadForeground )
           {
-          // If current neighb pixel is ON, mark it and push it into queue
-          if ( SEoNeighbIt.GetPixel(i) )
+          if ( inRun )
             {
-            // Mark it
-            bool bIsBounds;
-            SEoNeighbIt.SetPixel(i, false, bIsBounds);
-
-            // Push
-            propagQueue.push( SEoNeighbIt.GetIndex(i) );
+            sourceRuns.back().second = x;
+            }
+          else
+            {
+            sourceRuns.push_back( RunType(x, x) );
+            inRun = true;
             }
           }
-        } // while ( !propagQueue.empty() )
-      }   // if( kernelImageItIndex.Get() )
-
-    ++kernelImageItIndex;
-    ++kernel_it;
-    }
-
-  // Free memory of tmp image
-  tmpSEImage->Initialize();
-
-  // Now look for difference sets
-  // ----------------------------
-  // Create a neighbourhood of radius m_Radius This neighbourhood is
-  // called adj neighbourhood and is used in order to get the offset
-  // in each direction.
-  Neighborhood< InputPixelType, InputImageDimension > adjNeigh;
-  adjNeigh.SetRadius(padBy);
-
-  // now we look for the difference sets in each directions: If you
-  // take a structuring element (SE) and you translate it in one of
-  // the direction of the adjacency ( (-1,0,0), (-1,1,0), etc. ) you
-  // get SE(dir). Now the difference set is SE(dir) - SE. So when you
-  // want to paint SE union SE(dir) you just need to paint SE and the
-  // difference set.
-
-  // Allocate difference sets container
-  m_KernelDifferenceSets.resize( adjNeigh.Size() );
+        else
+          {
+          inRun = false;
+          }
+        }
 
-  // For each direction of the connectivity, look for difference set
-  // in this direction
-  for ( i = 0; i < adjNeigh.Size(); ++i )
-    {
-    m_KernelDifferenceSets[i].clear();
-    // For each element of the kernel wich index is k, see if they
-    // belong to this difference set treat only "ON" elements of SE
-    std::vector< unsigned int >::const_iterator kernelOnElementsIt;
-    for ( kernelOnElementsIt = kernelOnElements.begin();
-          kernelOnElementsIt != kernelOnElements.end(); ++kernelOnElementsIt )
+      if ( spreadBoundary && outsideEnd > bufferEnd )
+        {
+        sourceRuns.push_back( RunType(bufferEnd + 1, outsideEnd) );
+        }
+      }
+    else if ( spreadBoundary )
       {
-      // Get the index in the SE neighb
-      k = *kernelOnElementsIt;
+      sourceRuns.push_back( RunType(outsideBegin, outsideEnd) );
+      }
 
-      // Get the Nd position of current SE element. In order to do
-      // that, we have not a "GetIndex" function.  So first we get the
-      // offset relatively to the center SE element and add it to the
-      // index of this center SE element:
-      OffsetType currentOffset = this->GetKernel().GetOffset(k);
-      IndexType  currentShiftedPosition = centerElementPosition + currentOffset;
+    // next line of the source region
+    for ( unsigned int d = 1; d < InputImageDimension; ++d )
+      {
+      lineIndex[d]++;
+      if ( lineIndex[d] < sourceRegion.GetIndex(d) + static_cast< OffsetValueType >( sourceRegion.GetSize(d) ) )
+        {
+        break;
+        }
+      lineIndex[d] = sourceRegion.GetIndex(d);
+      }
+    }
+  sourceLines[numberOfLines] = sourceRuns.size();
+
+  // Each line of the output is covered by the runs of the source lines
+  // combined with the runs of the kernel. The number of runs covering
+  // each pixel is counted with the differences between the pixels.
+  std::vector< int > coverage(lineLength + 1);
+
+  ProgressReporter progress( this, threadId,
+                             outputRegionForThread.GetNumberOfPixels() / lineLength );
+
+  ImageLinearIteratorWithIndex< OutputImageType > outIt(output, outputRegionForThread);
+  ImageLinearConstIteratorWithIndex< InputImageType > inIt(input, outputRegionForThread);
+  outIt.SetDirection(0);
+  inIt.SetDirection(0);
+  outIt.GoToBegin();
+  inIt.GoToBegin();
+  while ( !outIt.IsAtEnd() )
+    {
+    const IndexType outputIndex = outIt.GetIndex();
+    bool            covered = false;
 
-      // Add to current element position the offset corresponding the
-      // current adj direction
-      currentShiftedPosition += adjNeigh.GetOffset(i);
+    for ( unsigned long k = 0; k < m_KernelLineOffsets.size(); ++k )
+      {
+      // the source line which reaches the output line with this kernel line
+      unsigned long line = 0;
+      for ( unsigned int d = 1; d < InputImageDimension; ++d )
+        {
+        line += ( outputIndex[d] - m_KernelLineOffsets[k][d] - sourceRegion.GetIndex(d) ) * lineStrides[d];
+        }
 
-      // now currentShiftedPosition is the position of the current
-      // "pixel" ( SE element ) shifted in the direction i. Check if it
-      // is outside the structuring element. If it is the case, we
-      // know that the current SE element is in the difference set of
-      // the current direction i (this works only for boundary pixels!).
-      bool bIsOutside   = false;
-      for ( unsigned int dimCount = 0;
-            dimCount < TInputImage::ImageDimension; ++dimCount )
+      const RunVectorType & kernelRuns = m_KernelLineRuns[k];
+      for ( unsigned long r = sourceLines[line]; r < sourceLines[line + 1]; ++r )
         {
-        if ( currentShiftedPosition[dimCount] < 0
-             || currentShiftedPosition[dimCount] >=
-             (int)this->GetKernel().GetSize(dimCount) )
+        for ( typename RunVectorType::const_iterator kIt = kernelRuns.begin(); kIt != kernelRuns.end(); ++kIt )
           {
-          bIsOutside = true;
-          break;
+          const OffsetValueType begin = std::max(sourceRuns[r].first + kIt->first, outputBegin);
+          const OffsetValueType end = std::min(sourceRuns[r].second + kIt->second, outputEnd);
+          if ( begin <= end )
+            {
+            if ( !covered )
+              {
+              std::fill(coverage.begin(), coverage.end(), 0);
+              covered = true;
+              }
+            coverage[begin - outputBegin]++;
+            coverage[end - outputBegin + 1]--;
+            }
           }
         }
+      }
 
-      if ( bIsOutside )
+    // When dilating, the covered pixels are set to the foreground value and
+    // the other foreground pixels are removed. When eroding, the covered
+    // foreground pixels are removed and the other pixels are set to the
+    // foreground value.
+    int count = 0;
+    for ( OffsetValueType i = 0; !outIt.IsAtEndOfLine(); ++i, ++outIt, ++inIt )
+      {
+      if ( covered )
+        {
+        count += coverage[i];
+        }
+      const InputPixelType value = inIt.Get();
+      if ( ( count > 0 ) == dilate )
+        {
+        outIt.Set( static_cast< OutputPixelType >( foregroundValue ) );
+        }
+      else if ( value == foregroundValue )
         {
-        // The current SE element, which index is hence k, belongs to
-        // the difference set in the direction i.  Add it to
-        // difference set in dir i
-        m_KernelDifferenceSets[i].push_back(currentOffset);
+        outIt.Set(backgroundValue);
         }
       else
         {
-        // The current shifted SE element doesn't belong to SE
-        // boundaries. In order to see if it belongs to difference set
-        // in direction i, the value of kernel at the position of the
-        // current SE element SHIFTED in direction i must be OFF ( i.e
-        // = 0 ) In order to access to shifted value we must compute a
-        // neighbourhood index
-
-        // retrieve the index offset relatively to the current NOT
-        // shifted SE element
-        unsigned int currentRelativeIndexOffset =
-          this->GetKernel().GetNeighborhoodIndex( adjNeigh.GetOffset(i) )
-          - this->GetKernel().GetCenterNeighborhoodIndex();
-
-        // Now thanks to this relative offset, we can get the absolute
-        // neigh index of the current shifted SE element.
-        unsigned int currentShiftedIndex =
-          k /*NOT shifted position*/ +  currentRelativeIndexOffset;
-
-        // Test if shifted element is OFF: in fact diff(dir) = all the
-        // elements of SE + dir where elements of SE is ON and
-        // elements of SE + dir is OFF.
-        if ( this->GetKernel()[currentShiftedIndex] <= 0 )
-          {
-          // Add it to difference set in dir i
-          m_KernelDifferenceSets[i].push_back(currentOffset);
-          }
+        outIt.Set( static_cast< OutputPixelType >( value ) );
         }
-      } // for( kernelOnElementsIt = kernelOnElements.begin(); ...
-    }   // for( i = 0; i < adjNeigh.Size(); ++i )
-
-  // For the particular case of the m_KernelDifferenceSets at the
-  // center of the kernel ( the difference set is theoretically empty
-  // in this case because there is no shift ) we put the kernel set
-  // itself, useful for the rest of the process.
-  unsigned int centerKernelIndex  = adjNeigh.Size() / 2;
-  for ( k = 0, kernel_it = KernelBegin; kernel_it != KernelEnd; ++kernel_it, ++k )
-    {
-    if ( *kernel_it )
-      {
-      OffsetType currentOffset = this->GetKernel().GetOffset(k);
-      m_KernelDifferenceSets[centerKernelIndex].push_back(currentOffset);
       }
+
+    outIt.NextLine();
+    inIt.NextLine();
+    progress.CompletedPixel();
     }
 }
 
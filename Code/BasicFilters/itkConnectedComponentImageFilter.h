@@ -41,10 +41,14 @@ namespace itk
  * component image filter which did not produce consecutive labels or
  * impose any particular ordering.
  *
+ * The image is split in slabs which are labeled by the threads at the
+ * same time. The equivalences found in a slab are merged with those of
+ * the neighboring slabs two by two, and all the threads then number the
+ * objects of their labels and write their part of the output.
  *
  * \sa ImageToImageFilter
  *
- * \ingroup Singlethreaded
+ * \ingroup Multithreaded
  */
 
 template< class TInputImage, class TOutputImage, class TMaskImage = TInputImage >
@@ -216,6 +220,7 @@ public:
   void InitUnion(const unsigned long int size)
   {
     m_UnionFind = UnionFindType(size + 1);
+    m_Consecutive = UnionFindType(size + 1);
   }
 
   void InsertSet(const unsigned long int label);
@@ -224,7 +229,10 @@ public:
 
   void LinkLabels(const LabelType lab1, const LabelType lab2);
 
-  unsigned long int CreateConsecutive();
+  unsigned long int FindRoots(const LabelType first, const LabelType last);
+
+  void CreateConsecutive(const LabelType first, const LabelType last,
+                         const LabelType firstObject);
 
   //////////////////
   bool CheckNeighbors(const OutputIndexType & A,
@@ -247,6 +255,7 @@ public:
   }
 
   typename std::vector< long >       m_NumberOfLabels;
+  typename std::vector< long >       m_NumberOfObjects;
   typename std::vector< long >       m_FirstLineIdToJoin;
 
   typename Barrier::Pointer m_Barrier;
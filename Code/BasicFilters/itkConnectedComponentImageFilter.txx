@@ -102,6 +102,8 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
   // set up the vars used in the threads
   m_NumberOfLabels.clear();
   m_NumberOfLabels.resize(nbOfThreads, 0);
+  m_NumberOfObjects.clear();
+  m_NumberOfObjects.resize(nbOfThreads, 0);
   m_Barrier = Barrier::New();
   m_Barrier->Initialize(nbOfThreads);
   long pixelcount = output->GetRequestedRegion().GetNumberOfPixels();
@@ -205,33 +207,41 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
   // wait for the other threads to complete that part
   this->Wait();
 
-  // compute the total number of labels
+  // compute the total number of labels and the first label of this
+  // thread: the labels are given in raster order, and the lines of a
+  // thread are consecutive
   nbOfLabels = 0;
+  LabelType firstLabelForThread = 1;
   for ( int i = 0; i < nbOfThreads; i++ )
     {
+    if ( i == threadId )
+      {
+      firstLabelForThread = nbOfLabels + 1;
+      }
     nbOfLabels += m_NumberOfLabels[i];
     }
+  const LabelType lastLabelForThread = firstLabelForThread + m_NumberOfLabels[threadId];
 
   if ( threadId == 0 )
     {
     // set up the union find structure
     InitUnion(nbOfLabels);
-    // insert all the labels into the structure -- an extra loop but
-    // saves complicating the ones that come later
-    typename LineMapType::iterator MapBegin, MapEnd, LineIt;
-    MapBegin = m_LineMap.begin();
-    MapEnd = m_LineMap.end();
-    LineIt = MapBegin;
-    unsigned long label = 1;
-    for ( LineIt = MapBegin; LineIt != MapEnd; ++LineIt )
+    }
+
+  // wait for the other threads to complete that part
+  this->Wait();
+
+  // insert the labels of this thread into the structure -- an extra
+  // loop but saves complicating the ones that come later
+  LabelType label = firstLabelForThread;
+  for ( long ThisIdx = firstLineIdForThread; ThisIdx < lineId; ++ThisIdx )
+    {
+    typename lineEncoding::iterator cIt;
+    for ( cIt = m_LineMap[ThisIdx].begin(); cIt != m_LineMap[ThisIdx].end(); ++cIt )
       {
-      typename lineEncoding::iterator cIt;
-      for ( cIt = LineIt->begin(); cIt != LineIt->end(); ++cIt )
-        {
-        cIt->label = label;
-        InsertSet(label);
-        label++;
-        }
+      cIt->label = label;
+      InsertSet(label);
+      label++;
       }
     }
 
@@ -334,11 +344,30 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
     this->Wait();
     }
 
+  // find the objects of the labels of this thread. The roots are the
+  // smallest label of their object, so the objects can be numbered
+  // in raster order by all the threads at the same time.
+  m_NumberOfObjects[threadId] = FindRoots(firstLabelForThread, lastLabelForThread);
+
+  this->Wait();
+
+  LabelType firstObjectForThread = 0;
+  LabelType objectCount = 0;
+  for ( int i = 0; i < nbOfThreads; i++ )
+    {
+    if ( i == threadId )
+      {
+      firstObjectForThread = objectCount;
+      }
+    objectCount += m_NumberOfObjects[i];
+    }
   if ( threadId == 0 )
     {
-    m_ObjectCount = CreateConsecutive();
+    m_ObjectCount = objectCount;
     }
 
+  CreateConsecutive(firstLabelForThread, lastLabelForThread, firstObjectForThread);
+
   this->Wait();
 
   // check for overflow exception here
@@ -383,8 +412,7 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
 
     for ( cIt = m_LineMap[ThisIdx].begin(); cIt != m_LineMap[ThisIdx].end(); ++cIt )
       {
-      unsigned long   Ilab = LookupSet(cIt->label);
-      OutputPixelType lab = m_Consecutive[Ilab];
+      OutputPixelType lab = static_cast< OutputPixelType >( m_Consecutive[m_UnionFind[cIt->label]] );
       oit.SetIndex(cIt->where);
       // initialize the non labelled pixels
       for (; fstart != oit; ++fstart )
@@ -413,6 +441,7 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
 ::AfterThreadedGenerateData()
 {
   m_NumberOfLabels.clear();
+  m_NumberOfObjects.clear();
   m_Barrier = NULL;
   m_LineMap.clear();
   m_Input = NULL;
@@ -603,31 +632,57 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
 template< class TInputImage, class TOutputImage, class TMaskImage >
 unsigned long int
 ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
-::CreateConsecutive()
+::FindRoots(const LabelType first, const LabelType last)
 {
-  m_Consecutive = UnionFindType( m_UnionFind.size() );
+  // The roots are only read here, so several threads can find the
+  // roots of their labels at the same time. The roots are stored in
+  // m_Consecutive until all the threads are done.
+  unsigned long int count = 0;
+  for ( LabelType I = first; I < last; I++ )
+    {
+    LabelType L = m_UnionFind[I];
+    while ( L != m_UnionFind[L] )
+      {
+      L = m_UnionFind[L];
+      }
+    m_Consecutive[I] = L;
+    if ( L == I )
+      {
+      ++count;
+      }
+    }
+  return count;
+}
 
+template< class TInputImage, class TOutputImage, class TMaskImage >
+void
+ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
+::CreateConsecutive(const LabelType first, const LabelType last,
+                    const LabelType firstObject)
+{
   const LabelType background = static_cast< LabelType >( this->m_BackgroundValue );
 
-  m_Consecutive[background] = background;
-
-  unsigned long int CLab = 0;
-  unsigned long int count = 0;
-  for ( unsigned long int I = 1; I < m_UnionFind.size(); I++ )
+  unsigned long int CLab = firstObject;
+  if ( CLab >= background )
+    {
+    ++CLab;
+    }
+  for ( LabelType I = first; I < last; I++ )
     {
-    unsigned long int L = m_UnionFind[I];
+    // flatten the union find structure and number the objects,
+    // skipping the background value
+    const LabelType L = m_Consecutive[I];
+    m_UnionFind[I] = L;
     if ( L == I )
       {
-      if ( CLab == static_cast< unsigned long int >( m_BackgroundValue ) )
+      if ( CLab == background )
         {
         ++CLab;
         }
       m_Consecutive[L] = CLab;
       ++CLab;
-      ++count;
       }
     }
-  return count;
 }
 
 template< class TInputImage, class TOutputImage, class TMaskImage >
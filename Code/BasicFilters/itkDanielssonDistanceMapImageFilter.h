@@ -51,6 +51,20 @@ namespace itk
  * Danielsson, Per-Erik.  Euclidean Distance Mapping.  Computer
  * Graphics and Image Processing 14, 227-248 (1980).
  *
+ * When UseSeparableAlgorithm is on, the vector map is computed instead by
+ * the separable algorithm of Maurer et al.  It processes the image one
+ * dimension at a time, splits the image lines among the threads and
+ * computes the exact Euclidean distance in linear time:
+ *
+ * Maurer, Calvin, Rensheng Qi, and Vijay Raghavan, "A Linear Time
+ * Algorithm for Computing Exact Euclidean Distance Transforms of Binary
+ * Images in Arbitrary Dimensions", IEEE - Transactions on Pattern Analysis
+ * and Machine Intelligence, 25(2): 265-270, 2003.
+ *
+ * The outputs are the same as with the Danielsson algorithm, except where
+ * the Danielsson algorithm is not exact and where several objects are at
+ * the same distance of a pixel.
+ *
  * \ingroup ImageFeatureExtraction
  *
  */
@@ -141,6 +155,12 @@ public:
   /** Set On/Off whether spacing is used. */
   itkBooleanMacro(UseImageSpacing);
 
+  /** Set/Get whether the exact, multithreaded separable algorithm is used
+   * instead of the Danielsson algorithm.  Off by default. */
+  itkSetMacro(UseSeparableAlgorithm, bool);
+  itkGetConstReferenceMacro(UseSeparableAlgorithm, bool);
+  itkBooleanMacro(UseSeparableAlgorithm);
+
   /** Get Voronoi Map
    * This map shows for each pixel what object is closest to it.
    * Each object should be labeled by a number (larger than 0),
@@ -190,6 +210,20 @@ protected:
   /**  Compute Voronoi Map. */
   void ComputeVoronoiMap();
 
+  /** Compute the Voronoi and distance maps of a region from the vector
+   * map.  Used by ComputeVoronoiMap() and by the threads of the separable
+   * algorithm. */
+  void ThreadedComputeVoronoiMap(const RegionType & regionForThread);
+
+  /** Compute the vector map with the separable algorithm.  Used by
+   * GenerateData() when UseSeparableAlgorithm is on. */
+  void ComputeSeparableVectorMap();
+
+  /** Propagate the closest objects along the lines of direction
+   * "dimension" in a region of the vector map. */
+  void ThreadedComputeSeparableVectorMap(const RegionType & regionForThread,
+                                         unsigned int dimension);
+
   /** Update distance map locally.  Used by GenerateData(). */
   void UpdateLocalDistance(VectorImageType *,
                            const IndexType &,
@@ -199,9 +233,22 @@ private:
   DanielssonDistanceMapImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);                   //purposely not implemented
 
+  /** Structure for passing information into the static threader
+   * callback.  A dimension equal to the image dimension stands for the
+   * computation of the Voronoi and distance maps. */
+  struct SeparableThreadStruct {
+    DanielssonDistanceMapImageFilter *Filter;
+    unsigned int Dimension;
+  };
+
+  /** Split the requested region, without splitting the lines of the
+   * current dimension, and call the threaded methods. */
+  static ITK_THREAD_RETURN_TYPE SeparableThreaderCallback(void *arg);
+
   bool m_SquaredDistance;
   bool m_InputIsBinary;
   bool m_UseImageSpacing;
+  bool m_UseSeparableAlgorithm;
 }; // end of DanielssonDistanceMapImageFilter class
 } //end namespace itk
 
@@ -23,6 +23,9 @@
 #include "itkDanielssonDistanceMapImageFilter.h"
 #include "itkReflectiveImageRegionConstIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "vnl/vnl_math.h"
+#include <vector>
 
 namespace itk
 {
@@ -47,6 +50,7 @@ DanielssonDistanceMapImageFilter< TInputImage, TOutputImage >
   m_SquaredDistance     = false;
   m_InputIsBinary       = false;
   m_UseImageSpacing     = false;
+  m_UseSeparableAlgorithm = false;
 }
 
 /**
@@ -226,24 +230,40 @@ DanielssonDistanceMapImageFilter< TInputImage, TOutputImage >
 ::ComputeVoronoiMap()
 {
   itkDebugMacro(<< "ComputeVoronoiMap Start");
+
+  this->ThreadedComputeVoronoiMap( this->GetVoronoiMap()->GetRequestedRegion() );
+
+  itkDebugMacro(<< "ComputeVoronoiMap End");
+}
+
+/**
+ *  Compute the Voronoi and distance maps of a region
+ */
+template< class TInputImage, class TOutputImage >
+void
+DanielssonDistanceMapImageFilter< TInputImage, TOutputImage >
+::ThreadedComputeVoronoiMap(const RegionType & regionForThread)
+{
   OutputImagePointer voronoiMap          =  this->GetVoronoiMap();
   OutputImagePointer distanceMap         =  this->GetDistanceMap();
   VectorImagePointer distanceComponents  =  this->GetVectorDistanceMap();
 
   typename OutputImageType::RegionType region  = voronoiMap->GetRequestedRegion();
 
-  ImageRegionIteratorWithIndex< OutputImageType > ot(voronoiMap,          region);
-  ImageRegionIteratorWithIndex< VectorImageType > ct(distanceComponents,  region);
-  ImageRegionIteratorWithIndex< OutputImageType > dt(distanceMap,         region);
+  ImageRegionIteratorWithIndex< OutputImageType > ot(voronoiMap,          regionForThread);
+  ImageRegionIteratorWithIndex< VectorImageType > ct(distanceComponents,  regionForThread);
+  ImageRegionIteratorWithIndex< OutputImageType > dt(distanceMap,         regionForThread);
 
   typename InputImageType::SpacingType spacing = Self::GetInput()->GetSpacing();
 
-  itkDebugMacro(<< "ComputeVoronoiMap Region: " << region);
+  itkDebugMacro(<< "ComputeVoronoiMap Region: " << regionForThread);
   ot.GoToBegin();
   ct.GoToBegin();
   dt.GoToBegin();
   while ( !ot.IsAtEnd() )
     {
+    // The closest object pixel is its own closest object, so its value is
+    // never changed while the other pixels are being set.
     IndexType index = ct.GetIndex() + ct.Get();
     if ( region.IsInside(index) )
       {
@@ -280,7 +300,198 @@ DanielssonDistanceMapImageFilter< TInputImage, TOutputImage >
     ++ct;
     ++dt;
     }
-  itkDebugMacro(<< "ComputeVoronoiMap End");
+}
+
+/**
+ *  Compute the vector map with the separable algorithm
+ */
+template< class TInputImage, class TOutputImage >
+void
+DanielssonDistanceMapImageFilter< TInputImage, TOutputImage >
+::ComputeSeparableVectorMap()
+{
+  SeparableThreadStruct str;
+  str.Filter = this;
+
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+  this->GetMultiThreader()->SetSingleMethod(this->SeparableThreaderCallback, &str);
+
+  // The closest objects are propagated one dimension at a time, then the
+  // Voronoi and distance maps are computed by the same threads.
+  for ( unsigned int dim = 0; dim <= InputImageDimension; dim++ )
+    {
+    str.Dimension = dim;
+    this->GetMultiThreader()->SingleMethodExecute();
+    this->UpdateProgress( static_cast< float >( dim + 1 )
+                          / static_cast< float >( InputImageDimension + 1 ) );
+    }
+}
+
+/**
+ *  Split the region among the threads
+ */
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+DanielssonDistanceMapImageFilter< TInputImage, TOutputImage >
+::SeparableThreaderCallback(void *arg)
+{
+  const int threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  const int threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  SeparableThreadStruct *str =
+    (SeparableThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  RegionType splitRegion = str->Filter->GetVoronoiMap()->GetRequestedRegion();
+  IndexType  splitIndex = splitRegion.GetIndex();
+  SizeType   splitSize = splitRegion.GetSize();
+
+  // split on the outermost dimension available and avoid the dimension
+  // of the lines being processed
+  int splitAxis = InputImageDimension - 1;
+  while ( splitAxis >= 0
+          && ( splitSize[splitAxis] <= 1 || splitAxis == static_cast< int >( str->Dimension ) ) )
+    {
+    --splitAxis;
+    }
+
+  if ( splitAxis < 0 )
+    {
+    if ( threadId != 0 )
+      {
+      return ITK_THREAD_RETURN_VALUE;
+      }
+    }
+  else
+    {
+    const unsigned long range = splitSize[splitAxis];
+    const unsigned long valuesPerThread = ( range + threadCount - 1 ) / threadCount;
+    const unsigned long start = threadId * valuesPerThread;
+    if ( start >= range )
+      {
+      return ITK_THREAD_RETURN_VALUE;
+      }
+    splitIndex[splitAxis] += start;
+    splitSize[splitAxis] = vnl_math_min(valuesPerThread, range - start);
+    splitRegion.SetIndex(splitIndex);
+    splitRegion.SetSize(splitSize);
+    }
+
+  if ( str->Dimension < InputImageDimension )
+    {
+    str->Filter->ThreadedComputeSeparableVectorMap(splitRegion, str->Dimension);
+    }
+  else
+    {
+    str->Filter->ThreadedComputeVoronoiMap(splitRegion);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/**
+ *  Propagate the closest objects along the lines of one dimension
+ */
+template< class TInputImage, class TOutputImage >
+void
+DanielssonDistanceMapImageFilter< TInputImage, TOutputImage >
+::ThreadedComputeSeparableVectorMap(const RegionType & regionForThread,
+                                    unsigned int dimension)
+{
+  VectorImagePointer distanceComponents = this->GetVectorDistanceMap();
+  const RegionType   region = distanceComponents->GetRequestedRegion();
+
+  // The squared distance is weighted by the squared spacing.
+  double weight[InputImageDimension];
+  for ( unsigned int i = 0; i < InputImageDimension; i++ )
+    {
+    weight[i] = 1.0;
+    if ( m_UseImageSpacing )
+      {
+      weight[i] = static_cast< double >( this->GetInput()->GetSpacing()[i] );
+      weight[i] *= weight[i];
+      }
+    }
+
+  // Each pixel of a line knows its closest object among the ones lying in
+  // the dimensions already processed, and this object lies on the
+  // hyperplane orthogonal to the line through the pixel.  Its squared
+  // distance to the line and its position on the line define a parabola.
+  // The lower envelope of the parabolas of the line gives the closest
+  // object of each pixel.
+  const unsigned int     length = regionForThread.GetSize()[dimension];
+  std::vector< double >  g(length);
+  std::vector< double >  h(length);
+  std::vector< IndexType > closest(length);
+
+  ImageLinearIteratorWithIndex< VectorImageType > it(distanceComponents, regionForThread);
+  it.SetDirection(dimension);
+  it.GoToBegin();
+
+  while ( !it.IsAtEnd() )
+    {
+    unsigned int l = 0;
+    unsigned int i = 0;
+    while ( !it.IsAtEndOfLine() )
+      {
+      const OffsetType vector = it.Get();
+      const IndexType  here = it.GetIndex();
+      const IndexType  there = here + vector;
+      if ( region.IsInside(there) )
+        {
+        double gi = 0.0;
+        for ( unsigned int j = 0; j < InputImageDimension; j++ )
+          {
+          if ( j != dimension )
+            {
+            gi += weight[j] * vector[j] * vector[j];
+            }
+          }
+        const double hi = i;
+
+        // Remove the parabolas hidden by the new one.
+        while ( l >= 2 )
+          {
+          const double a = h[l - 1] - h[l - 2];
+          const double b = hi - h[l - 1];
+          const double c = hi - h[l - 2];
+          if ( c * g[l - 1] - b * g[l - 2] - a * gi
+               - weight[dimension] * a * b * c <= 0.0 )
+            {
+            break;
+            }
+          --l;
+          }
+        g[l] = gi;
+        h[l] = hi;
+        closest[l] = there;
+        ++l;
+        }
+      ++i;
+      ++it;
+      }
+
+    if ( l > 0 )
+      {
+      unsigned int k = 0;
+      i = 0;
+      it.GoToBeginOfLine();
+      while ( !it.IsAtEndOfLine() )
+        {
+        const double hi = i;
+        while ( k < l - 1
+                && g[k] + weight[dimension] * ( h[k] - hi ) * ( h[k] - hi )
+                > g[k + 1] + weight[dimension] * ( h[k + 1] - hi ) * ( h[k + 1] - hi ) )
+          {
+          ++k;
+          }
+        it.Set(closest[k] - it.GetIndex());
+        ++i;
+        ++it;
+        }
+      }
+
+    it.NextLine();
+    }
 }
 
 /**
@@ -333,6 +544,12 @@ DanielssonDistanceMapImageFilter< TInputImage, TOutputImage >
 {
   this->PrepareData();
 
+  if ( m_UseSeparableAlgorithm )
+    {
+    this->ComputeSeparableVectorMap();
+    return;
+    }
+
   // Specify images and regions.
 
   OutputImagePointer voronoiMap             =  this->GetVoronoiMap();
@@ -432,6 +649,7 @@ DanielssonDistanceMapImageFilter< TInputImage, TOutputImage >
   os << indent << "Input Is Binary   : " << m_InputIsBinary << std::endl;
   os << indent << "Use Image Spacing : " << m_UseImageSpacing << std::endl;
   os << indent << "Squared Distance  : " << m_SquaredDistance << std::endl;
+  os << indent << "Use Separable Algorithm : " << m_UseSeparableAlgorithm << std::endl;
 }
 } // end namespace itk
 
@@ -21,6 +21,8 @@
 #include "itkImageToImageFilter.h"
 #include "itkImage.h"
 
+#include <vector>
+
 namespace itk
 {
 /**
@@ -43,6 +45,28 @@ namespace itk
  * When the Gaussian kernel is small, this filter tends to run faster than
  * itk::RecursiveGaussianImageFilter.
  *
+ * The output is computed by blocks of some ten thousand pixels in each
+ * thread.  The input around a block is copied once into a small buffer,
+ * which is then convolved along each dimension in turn while it is in the
+ * cache, and the result is written to the output.  Beyond the edges of
+ * the input, the nearest pixels are repeated, as with the
+ * ZeroFluxNeumannBoundaryCondition.  No intermediate image is allocated.
+ *
+ * The convolutions along the successive dimensions are computed in
+ * RealOutputPixelType, and only the final result is converted to the
+ * output pixel type.  Earlier versions converted the result of each
+ * dimension to the output pixel type, so with integer output pixels the
+ * output may now differ slightly from theirs, and is closer to the exact
+ * convolution.  Vector pixels are smoothed component by component.
+ *
+ * The cost of the discrete kernels grows with their width.  When
+ * RecursiveGaussianThreshold is set, and the kernel needed in one of the
+ * dimensions is wider than this many pixels, the image is smoothed by
+ * RecursiveGaussianImageFilter instead, whose cost does not depend on the
+ * variance.  The recursive filters approximate the sampled Gaussian
+ * rather than the discrete kernel of Lindeberg, and they are not
+ * truncated by MaximumError or MaximumKernelWidth.
+ *
  * \sa GaussianOperator
  * \sa Image
  * \sa Neighborhood
@@ -81,6 +105,16 @@ public:
   typedef typename TInputImage::PixelType          InputPixelType;
   typedef typename TInputImage::InternalPixelType  InputInternalPixelType;
 
+  /** Type of the pixel used for the intermediate results. */
+  typedef typename NumericTraits< OutputPixelType >::RealType RealOutputPixelType;
+
+  /** Type of the components of the pixels, and of the weights of the
+   * kernels, which multiply whole pixels. */
+  typedef typename NumericTraits< OutputPixelType >::ValueType      OutputPixelValueType;
+  typedef typename NumericTraits< OutputPixelType >::ScalarRealType ScalarRealType;
+
+  typedef typename TOutputImage::RegionType OutputImageRegionType;
+
   /** Extract some information from the image types.  Dimensionality
    * of the two images is assumed to be the same. */
   itkStaticConstMacro(ImageDimension, unsigned int,
@@ -189,14 +223,23 @@ public:
   itkSetMacro(UseImageSpacing, bool);
   itkGetConstMacro(UseImageSpacing, bool);
 
+  /** Set/Get the kernel width, in pixels, above which the image is
+   * smoothed by recursive Gaussian filters. The default, 0, always uses
+   * the discrete kernels. */
+  itkSetMacro(RecursiveGaussianThreshold, unsigned int);
+  itkGetConstMacro(RecursiveGaussianThreshold, unsigned int);
+
   /** \brief Set/Get number of pieces to divide the input for the
    * internal composite pipeline. The upstream pipeline will not be
    * effected.
    *
    * The default value is $ImageDimension^2$.
    *
-   * This parameter was introduced to reduce the memory used by images
-   * internally, at the cost of performance.
+   * \deprecated This parameter was introduced to reduce the memory used
+   * by images internally, at the cost of performance.  The filter no
+   * longer streams an internal pipeline, since the blocks of the
+   * discrete kernels need no intermediate image, so this parameter has
+   * no effect.  It is only kept for compatibility.
    */
   itkSetMacro(InternalNumberOfStreamDivisions, unsigned int);
   itkGetConstReferenceMacro(InternalNumberOfStreamDivisions, unsigned int);
@@ -213,7 +256,7 @@ public:
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro( OutputHasNumericTraitsCheck,
-                   ( Concept::HasNumericTraits< OutputPixelType > ) );
+                   ( Concept::HasNumericTraits< OutputPixelValueType > ) );
   /** End concept checking */
 #endif
 protected:
@@ -225,22 +268,47 @@ protected:
     m_UseImageSpacing = true;
     m_FilterDimensionality = ImageDimension;
     m_InternalNumberOfStreamDivisions = ImageDimension * ImageDimension;
+    m_RecursiveGaussianThreshold = 0;
   }
 
   virtual ~DiscreteGaussianImageFilter() {}
   void PrintSelf(std::ostream & os, Indent indent) const;
 
-  /** Standard pipeline method. While this class does not implement a
-   * ThreadedGenerateData(), its GenerateData() delegates all
-   * calculations to an NeighborhoodOperatorImageFilter.  Since the
-   * NeighborhoodOperatorImageFilter is multithreaded, this filter is
-   * multithreaded by default. */
+  /** Standard pipeline method. The discrete kernels are applied by
+   * ThreadedGenerateData(), while the recursive Gaussian filters are run
+   * in an internal pipeline. */
   void GenerateData();
 
+  /** Convolve the blocks of the region of a thread with the discrete
+   * kernels. */
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                            int threadId);
+
 private:
   DiscreteGaussianImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);              //purposely not implemented
 
+  /** Coefficients of a discrete kernel along one dimension. */
+  typedef std::vector< double > KernelType;
+
+  /** Compute the discrete kernel of each dimension that is smoothed; the
+   * kernels of the other dimensions are left empty. */
+  void ComputeKernels(const InputImageType *input, std::vector< KernelType > & kernels) const;
+
+  /** True if the kernels are too wide for the given input, so that
+   * recursive Gaussian filters should be used instead. */
+  bool UseRecursiveGaussian(const InputImageType *input,
+                            const std::vector< KernelType > & kernels) const;
+
+  /** Smooth the input with recursive Gaussian filters. */
+  void GenerateDataWithRecursiveGaussian();
+
+  /** Convolve the buffer of a block along one dimension, which makes the
+   * block shorter by the width of the kernel minus one. */
+  static void ConvolveBlock(const RealOutputPixelType *input, RealOutputPixelType *output,
+                            const unsigned long *blockSize, unsigned int dimension,
+                            const KernelType & kernel);
+
   /** The variance of the gaussian blurring kernel in each dimensional
     direction. */
   ArrayType m_Variance;
@@ -261,8 +329,14 @@ private:
   bool m_UseImageSpacing;
 
   /** Number of pieces to divide the input on the internal composite
-  pipeline. The upstream pipeline will not be effected. */
+  pipeline. Deprecated, it has no effect. */
   unsigned int m_InternalNumberOfStreamDivisions;
+
+  /** Kernel width above which the recursive Gaussian filters are used. */
+  unsigned int m_RecursiveGaussianThreshold;
+
+  /** The kernels of the current update. */
+  std::vector< KernelType > m_Kernels;
 };
 } // end namespace itk
 
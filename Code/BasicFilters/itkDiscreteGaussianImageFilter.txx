@@ -19,52 +19,47 @@
 #define __itkDiscreteGaussianImageFilter_txx
 
 #include "itkDiscreteGaussianImageFilter.h"
-#include "itkNeighborhoodOperatorImageFilter.h"
 #include "itkGaussianOperator.h"
+#include "itkRecursiveGaussianImageFilter.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkProgressAccumulator.h"
-#include "itkStreamingImageFilter.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
 
 namespace itk
 {
 template< class TInputImage, class TOutputImage >
 void
 DiscreteGaussianImageFilter< TInputImage, TOutputImage >
-::GenerateInputRequestedRegion()
-throw( InvalidRequestedRegionError )
+::ComputeKernels(const InputImageType *input, std::vector< KernelType > & kernels) const
 {
-  // call the superclass' implementation of this method. this should
-  // copy the output requested region to the input requested region
-  Superclass::GenerateInputRequestedRegion();
-
-  // get pointers to the input and output
-  typename Superclass::InputImagePointer inputPtr =
-    const_cast< TInputImage * >( this->GetInput() );
-
-  if ( !inputPtr )
+  // Determine the dimensionality to filter
+  unsigned int filterDimensionality = m_FilterDimensionality;
+  if ( filterDimensionality > ImageDimension )
     {
-    return;
+    filterDimensionality = ImageDimension;
     }
 
-  // Build an operator so that we can determine the kernel size
-  GaussianOperator< OutputPixelType, ImageDimension > oper;
-  typename TInputImage::SizeType radius;
-
-  for ( unsigned int i = 0; i < TInputImage::ImageDimension; i++ )
+  kernels.clear();
+  kernels.resize(ImageDimension);
+  for ( unsigned int i = 0; i < filterDimensionality; i++ )
     {
-    // Determine the size of the operator in this dimension.  Note that the
-    // Gaussian is built as a 1D operator in each of the specified directions.
+    // The Gaussian is built as a 1D operator in each of the specified
+    // directions.
+    GaussianOperator< double, ImageDimension > oper;
     oper.SetDirection(i);
     if ( m_UseImageSpacing == true )
       {
-      if ( this->GetInput()->GetSpacing()[i] == 0.0 )
+      if ( input->GetSpacing()[i] == 0.0 )
         {
         itkExceptionMacro(<< "Pixel spacing cannot be zero");
         }
       else
         {
         // convert the variance from physical units to pixels
-        double s = this->GetInput()->GetSpacing()[i];
+        double s = input->GetSpacing()[i];
         s = s * s;
         oper.SetVariance(m_Variance[i] / s);
         }
@@ -77,16 +72,94 @@ throw( InvalidRequestedRegionError )
     oper.SetMaximumKernelWidth(m_MaximumKernelWidth);
     oper.CreateDirectional();
 
-    radius[i] = oper.GetRadius(i);
+    kernels[i].assign( oper.Begin(), oper.End() );
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+bool
+DiscreteGaussianImageFilter< TInputImage, TOutputImage >
+::UseRecursiveGaussian(const InputImageType *input,
+                       const std::vector< KernelType > & kernels) const
+{
+  if ( m_RecursiveGaussianThreshold == 0 )
+    {
+    return false;
+    }
+
+  bool wide = false;
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    if ( kernels[i].empty() )
+      {
+      continue;
+      }
+    if ( kernels[i].size() > m_RecursiveGaussianThreshold )
+      {
+      wide = true;
+      }
+    // the recursive filters need at least four pixels along each line
+    if ( input->GetLargestPossibleRegion().GetSize()[i] < 4 )
+      {
+      return false;
+      }
+    }
+  return wide;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+DiscreteGaussianImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion()
+throw( InvalidRequestedRegionError )
+{
+  // call the superclass' implementation of this method. this should
+  // copy the output requested region to the input requested region
+  Superclass::GenerateInputRequestedRegion();
+
+  // get pointers to the input and output
+  typename Superclass::InputImagePointer inputPtr =
+    const_cast< TInputImage * >( this->GetInput() );
+
+  if ( !inputPtr )
+    {
+    return;
     }
 
+  // Build the kernels so that we can determine their size
+  std::vector< KernelType > kernels;
+  this->ComputeKernels(inputPtr, kernels);
+
   // get a copy of the input requested region (should equal the output
   // requested region)
   typename TInputImage::RegionType inputRequestedRegion;
   inputRequestedRegion = inputPtr->GetRequestedRegion();
 
-  // pad the input requested region by the operator radius
-  inputRequestedRegion.PadByRadius(radius);
+  if ( this->UseRecursiveGaussian(inputPtr, kernels) )
+    {
+    // the recursive filters need the whole lines along the dimensions
+    // they smooth
+    const typename TInputImage::RegionType & largestRegion =
+      inputPtr->GetLargestPossibleRegion();
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      if ( !kernels[i].empty() )
+        {
+        inputRequestedRegion.SetIndex( i, largestRegion.GetIndex(i) );
+        inputRequestedRegion.SetSize( i, largestRegion.GetSize(i) );
+        }
+      }
+    }
+  else
+    {
+    // pad the input requested region by the kernel radius
+    typename TInputImage::SizeType radius;
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      radius[i] = kernels[i].empty() ? 0 : ( kernels[i].size() - 1 ) / 2;
+      }
+    inputRequestedRegion.PadByRadius(radius);
+    }
 
   // crop the input requested region at the input's largest possible region
   if ( inputRequestedRegion.Crop( inputPtr->GetLargestPossibleRegion() ) )
@@ -116,209 +189,362 @@ void
 DiscreteGaussianImageFilter< TInputImage, TOutputImage >
 ::GenerateData()
 {
-  typename TOutputImage::Pointer output = this->GetOutput();
+  this->ComputeKernels(this->GetInput(), m_Kernels);
 
-  output->SetBufferedRegion( output->GetRequestedRegion() );
-  output->Allocate();
-
-  // Create an internal image to protect the input image's metdata
-  // (e.g. RequestedRegion). The StreamingImageFilter changes the
-  // requested region as part of its normal processing.
-  typename TInputImage::Pointer localInput = TInputImage::New();
-  localInput->Graft( this->GetInput() );
+  if ( this->UseRecursiveGaussian(this->GetInput(), m_Kernels) )
+    {
+    this->GenerateDataWithRecursiveGaussian();
+    }
+  else
+    {
+    // allocate the output and call ThreadedGenerateData()
+    Superclass::GenerateData();
+    }
+}
 
-  // Determine the dimensionality to filter
-  unsigned int filterDimensionality = m_FilterDimensionality;
-  if ( filterDimensionality > ImageDimension )
+template< class TInputImage, class TOutputImage >
+void
+DiscreteGaussianImageFilter< TInputImage, TOutputImage >
+::ConvolveBlock(const RealOutputPixelType *input, RealOutputPixelType *output,
+                const unsigned long *blockSize, unsigned int dimension,
+                const KernelType & kernel)
+{
+  // The block is seen as outer x length x inner pixels, where inner
+  // pixels are contiguous.
+  unsigned long inner = 1;
+  unsigned long outer = 1;
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
     {
-    filterDimensionality = ImageDimension;
+    if ( i < dimension )
+      {
+      inner *= blockSize[i];
+      }
+    else if ( i > dimension )
+      {
+      outer *= blockSize[i];
+      }
     }
-  if ( filterDimensionality == 0 )
+  const unsigned long radius = ( kernel.size() - 1 ) / 2;
+  const unsigned long inputLength = blockSize[dimension];
+  const unsigned long outputLength = inputLength - 2 * radius;
+
+  // the Gaussian kernels are symmetric, so the pixels on both sides of
+  // the center are added before they are weighted.  The weights are
+  // scalars, which also scale the components of vector pixels.
+  const ScalarRealType center = static_cast< ScalarRealType >( kernel[radius] );
+  for ( unsigned long o = 0; o < outer; o++ )
     {
-    // no smoothing, copy input to output
-    ImageRegionConstIterator< InputImageType > inIt(
-      localInput,
-      this->GetOutput()->GetRequestedRegion() );
-    ImageRegionIterator< OutputImageType > outIt(
-      output,
-      this->GetOutput()->GetRequestedRegion() );
-
-    while ( !inIt.IsAtEnd() )
+    for ( unsigned long x = 0; x < outputLength; x++ )
       {
-      outIt.Set( static_cast< OutputPixelType >( inIt.Get() ) );
-      ++inIt;
-      ++outIt;
+      const RealOutputPixelType *in = input + ( o * inputLength + x ) * inner;
+      RealOutputPixelType *      out = output + ( o * outputLength + x ) * inner;
+      if ( inner == 1 )
+        {
+        RealOutputPixelType sum = in[radius] * center;
+        for ( unsigned long j = 0; j < radius; j++ )
+          {
+          sum += ( in[j] + in[2 * radius - j] ) * static_cast< ScalarRealType >( kernel[j] );
+          }
+        *out = sum;
+        }
+      else
+        {
+        const RealOutputPixelType *inCenter = in + radius * inner;
+        for ( unsigned long m = 0; m < inner; m++ )
+          {
+          out[m] = inCenter[m] * center;
+          }
+        for ( unsigned long j = 0; j < radius; j++ )
+          {
+          const ScalarRealType       weight = static_cast< ScalarRealType >( kernel[j] );
+          const RealOutputPixelType *low = in + j * inner;
+          const RealOutputPixelType *high = in + ( 2 * radius - j ) * inner;
+          for ( unsigned long m = 0; m < inner; m++ )
+            {
+            out[m] += ( low[m] + high[m] ) * weight;
+            }
+          }
+        }
       }
-    return;
     }
+}
 
-  // Type of the pixel to use for intermediate results
-  typedef typename NumericTraits< OutputPixelType >::RealType RealOutputPixelType;
-  typedef Image< OutputPixelType, ImageDimension >            RealOutputImageType;
+template< class TInputImage, class TOutputImage >
+void
+DiscreteGaussianImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                       int threadId)
+{
+  typedef typename TInputImage::RegionType InputImageRegionType;
+  typedef typename TInputImage::IndexType  InputIndexType;
+
+  const InputImageType *input = this->GetInput();
+  OutputImageType *     output = this->GetOutput();
+
+  // Each block, padded by the kernel radius, holds about this many
+  // pixels.  The dimensions are kept whole from the first one, so that
+  // the blocks are slabs of the region of the thread unless its slices
+  // are too large.
+  const unsigned long blockPixels = 65536;
+
+  unsigned long radius[ImageDimension];
+  unsigned long blockSize[ImageDimension];
+  unsigned long numberOfBlocks[ImageDimension];
+  unsigned long paddedPixels = 1;
+  unsigned long totalBlocks = 1;
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    radius[i] = m_Kernels[i].empty() ? 0 : ( m_Kernels[i].size() - 1 ) / 2;
 
-  // Type definition for the internal neighborhood filter
-  //
-  // First filter convolves and changes type from input type to real type
-  // Middle filters convolves from real to real
-  // Last filter convolves and changes type from real type to output type
-  // Streaming filter forces the mini-pipeline to run in chunks
-  typedef NeighborhoodOperatorImageFilter< InputImageType,
-                                           RealOutputImageType, RealOutputPixelType > FirstFilterType;
-  typedef NeighborhoodOperatorImageFilter< RealOutputImageType,
-                                           RealOutputImageType, RealOutputPixelType > IntermediateFilterType;
-  typedef NeighborhoodOperatorImageFilter< RealOutputImageType,
-                                           OutputImageType, RealOutputPixelType > LastFilterType;
-  typedef NeighborhoodOperatorImageFilter< InputImageType,
-                                           OutputImageType, RealOutputPixelType > SingleFilterType;
-  typedef StreamingImageFilter< OutputImageType, OutputImageType >
-  StreamingFilterType;
+    const unsigned long regionSize = outputRegionForThread.GetSize(i);
+    unsigned long       size = regionSize;
+    if ( i > 0 && paddedPixels * ( size + 2 * radius[i] ) > blockPixels )
+      {
+      // at least twice the radius, so that the padding is at most half
+      // of the block
+      const unsigned long fit = blockPixels / paddedPixels;
+      size = ( fit > 4 * radius[i] ) ? fit - 2 * radius[i] : 2 * radius[i];
+      size = vnl_math_min( vnl_math_max( size, 1UL ), regionSize );
+      }
+    blockSize[i] = size;
+    numberOfBlocks[i] = ( regionSize + size - 1 ) / size;
+    paddedPixels *= size + 2 * radius[i];
+    totalBlocks *= numberOfBlocks[i];
+    }
 
-  typedef typename FirstFilterType::Pointer        FirstFilterPointer;
-  typedef typename IntermediateFilterType::Pointer IntermediateFilterPointer;
-  typedef typename LastFilterType::Pointer         LastFilterPointer;
-  typedef typename SingleFilterType::Pointer       SingleFilterPointer;
-  typedef typename StreamingFilterType::Pointer    StreamingFilterPointer;
+  ProgressReporter progress(this, threadId, totalBlocks);
 
-  // Create a series of operators
-  typedef GaussianOperator< RealOutputPixelType, ImageDimension > OperatorType;
-  std::vector< OperatorType > oper;
-  oper.resize(filterDimensionality);
+  std::vector< RealOutputPixelType > buffer(paddedPixels);
+  std::vector< RealOutputPixelType > convolved(paddedPixels);
 
-  // Create a process accumulator for tracking the progress of minipipeline
-  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-  progress->SetMiniPipelineFilter(this);
+  const InputImageRegionType & bufferedRegion = input->GetBufferedRegion();
 
-  // Set up the operators
-  unsigned int i;
-  for ( i = 0; i < filterDimensionality; ++i )
+  for ( unsigned long block = 0; block < totalBlocks; block++ )
     {
-    // we reverse the direction to minimize computation while, because
-    // the largest dimension will be split slice wise for streaming
-    unsigned int reverse_i = filterDimensionality - i - 1;
+    // the block of the output, and the input around it
+    OutputImageRegionType blockRegion;
+    InputImageRegionType  paddedRegion;
+    unsigned long         remainder = block;
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      const unsigned long position = ( remainder % numberOfBlocks[i] ) * blockSize[i];
+      remainder /= numberOfBlocks[i];
+
+      blockRegion.SetIndex( i, outputRegionForThread.GetIndex(i) + position );
+      blockRegion.SetSize( i, vnl_math_min( blockSize[i],
+                                            outputRegionForThread.GetSize(i) - position ) );
+      paddedRegion.SetIndex( i, blockRegion.GetIndex(i) - static_cast< long >( radius[i] ) );
+      paddedRegion.SetSize( i, blockRegion.GetSize(i) + 2 * radius[i] );
+      }
 
-    // Set up the operator for this dimension
-    oper[reverse_i].SetDirection(i);
-    if ( m_UseImageSpacing == true )
+    unsigned long size[ImageDimension];
+    unsigned long stride[ImageDimension];
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      size[i] = paddedRegion.GetSize(i);
+      stride[i] = ( i == 0 ) ? 1 : stride[i - 1] * size[i - 1];
+      }
+
+    // copy the input that is available
+    InputImageRegionType sourceRegion = paddedRegion;
+    sourceRegion.Crop(bufferedRegion);
+
+    ImageLinearConstIteratorWithIndex< InputImageType > inIt(input, sourceRegion);
+    inIt.SetDirection(0);
+    for ( inIt.GoToBegin(); !inIt.IsAtEnd(); inIt.NextLine() )
       {
-      if ( localInput->GetSpacing()[i] == 0.0 )
+      const InputIndexType & index = inIt.GetIndex();
+      unsigned long          offset = 0;
+      for ( unsigned int i = 0; i < ImageDimension; i++ )
         {
-        itkExceptionMacro(<< "Pixel spacing cannot be zero");
+        offset += ( index[i] - paddedRegion.GetIndex(i) ) * stride[i];
         }
-      else
+      RealOutputPixelType *line = &buffer[offset];
+      while ( !inIt.IsAtEndOfLine() )
         {
-        // convert the variance from physical units to pixels
-        double s = localInput->GetSpacing()[i];
-        s = s * s;
-        oper[reverse_i].SetVariance(m_Variance[i] / s);
+        *line++ = static_cast< RealOutputPixelType >( inIt.Get() );
+        ++inIt;
         }
       }
-    else
+
+    // and repeat the pixels at the edges of the input beyond them, one
+    // dimension after the other
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
       {
-      oper[reverse_i].SetVariance(m_Variance[i]);
+      const unsigned long lower = sourceRegion.GetIndex(i) - paddedRegion.GetIndex(i);
+      const unsigned long upper = lower + sourceRegion.GetSize(i);
+      if ( lower == 0 && upper == size[i] )
+        {
+        continue;
+        }
+      const unsigned long inner = stride[i];
+      const unsigned long outer = paddedPixels / ( inner * size[i] );
+      for ( unsigned long o = 0; o < outer; o++ )
+        {
+        RealOutputPixelType *slab = &buffer[o * inner * size[i]];
+        for ( unsigned long x = 0; x < lower; x++ )
+          {
+          std::copy( slab + lower * inner, slab + ( lower + 1 ) * inner, slab + x * inner );
+          }
+        for ( unsigned long x = upper; x < size[i]; x++ )
+          {
+          std::copy( slab + ( upper - 1 ) * inner, slab + upper * inner, slab + x * inner );
+          }
+        }
+      }
+
+    // convolve along each dimension, the last one first
+    RealOutputPixelType *current = &buffer[0];
+    RealOutputPixelType *next = &convolved[0];
+    for ( int i = ImageDimension - 1; i >= 0; i-- )
+      {
+      if ( radius[i] == 0 )
+        {
+        continue;
+        }
+      ConvolveBlock(current, next, size, i, m_Kernels[i]);
+      size[i] -= 2 * radius[i];
+      std::swap(current, next);
       }
 
-    oper[reverse_i].SetMaximumKernelWidth(m_MaximumKernelWidth);
-    oper[reverse_i].SetMaximumError(m_MaximumError[i]);
-    oper[reverse_i].CreateDirectional();
+    ImageRegionIterator< OutputImageType > outIt(output, blockRegion);
+    for ( outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt )
+      {
+      outIt.Set( static_cast< OutputPixelType >( *current++ ) );
+      }
+
+    progress.CompletedPixel();
     }
+}
 
-  // Create a chain of filters
-  //
+template< class TInputImage, class TOutputImage >
+void
+DiscreteGaussianImageFilter< TInputImage, TOutputImage >
+::GenerateDataWithRecursiveGaussian()
+{
+  typename TOutputImage::Pointer output = this->GetOutput();
+
+  output->SetBufferedRegion( output->GetRequestedRegion() );
+  output->Allocate();
+
+  // Create an internal image to protect the input image's metdata
+  // (e.g. RequestedRegion).
+  typename TInputImage::Pointer localInput = TInputImage::New();
+  localInput->Graft( this->GetInput() );
+
+  // the dimensions to smooth
+  std::vector< unsigned int > directions;
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    if ( !m_Kernels[i].empty() )
+      {
+      directions.push_back(i);
+      }
+    }
+  const unsigned int filterDimensionality = directions.size();
+
+  // Type definition for the internal recursive filters
   //
+  // First filter smoothes and changes type from input type to real type
+  // Middle filters smooth from real to real
+  // Last filter smoothes and changes type from real type to output type
+  typedef Image< RealOutputPixelType, ImageDimension > RealOutputImageType;
+  typedef RecursiveGaussianImageFilter< InputImageType, RealOutputImageType >      FirstFilterType;
+  typedef RecursiveGaussianImageFilter< RealOutputImageType, RealOutputImageType > IntermediateFilterType;
+  typedef RecursiveGaussianImageFilter< RealOutputImageType, OutputImageType >     LastFilterType;
+  typedef RecursiveGaussianImageFilter< InputImageType, OutputImageType >          SingleFilterType;
+
+  typedef typename FirstFilterType::Pointer        FirstFilterPointer;
+  typedef typename IntermediateFilterType::Pointer IntermediateFilterPointer;
+  typedef typename LastFilterType::Pointer         LastFilterPointer;
+  typedef typename SingleFilterType::Pointer       SingleFilterPointer;
+
+  // The standard deviations, in physical units as the recursive filters
+  // expect them
+  std::vector< double > sigma(filterDimensionality);
+  for ( unsigned int i = 0; i < filterDimensionality; i++ )
+    {
+    const unsigned int direction = directions[i];
+    sigma[i] = vcl_sqrt(m_Variance[direction]);
+    if ( !m_UseImageSpacing )
+      {
+      sigma[i] *= localInput->GetSpacing()[direction];
+      }
+    }
+
+  // Create a process accumulator for tracking the progress of minipipeline
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter(this);
 
   if ( filterDimensionality == 1 )
     {
-    // Use just a single filter
     SingleFilterPointer singleFilter = SingleFilterType::New();
-    singleFilter->SetOperator(oper[0]);
+    singleFilter->SetDirection(directions[0]);
+    singleFilter->SetSigma(sigma[0]);
+    singleFilter->SetZeroOrder();
     singleFilter->SetInput(localInput);
-    progress->RegisterInternalFilter(singleFilter, 1.0f / m_FilterDimensionality);
+    progress->RegisterInternalFilter(singleFilter, 1.0f);
 
     // Graft this filters output onto the mini-pipeline so the mini-pipeline
     // has the correct region ivars and will write to this filters bulk data
     // output.
     singleFilter->GraftOutput(output);
-
-    // Update the filter
     singleFilter->Update();
 
     // Graft the last output of the mini-pipeline onto this filters output so
     // the final output has the correct region ivars and a handle to the final
     // bulk data
-    this->GraftOutput(output);
+    this->GraftOutput( singleFilter->GetOutput() );
+    return;
     }
-  else
-    {
-    // Setup a full mini-pipeline and stream the data through the
-    // pipeline.
-    unsigned int numberOfStages = filterDimensionality * this->GetInternalNumberOfStreamDivisions() + 1;
-
-    // First filter convolves and changes type from input type to real type
-    FirstFilterPointer firstFilter = FirstFilterType::New();
-    firstFilter->SetOperator(oper[0]);
-    firstFilter->ReleaseDataFlagOn();
-    firstFilter->SetInput(localInput);
-    progress->RegisterInternalFilter(firstFilter, 1.0f / numberOfStages);
-
-    // Middle filters convolves from real to real
-    std::vector< IntermediateFilterPointer > intermediateFilters;
-    if ( filterDimensionality > 2 )
-      {
-      for ( i = 1; i < filterDimensionality - 1; ++i )
-        {
-        IntermediateFilterPointer f = IntermediateFilterType::New();
-        f->SetOperator(oper[i]);
-        f->ReleaseDataFlagOn();
-        progress->RegisterInternalFilter(f, 1.0f / numberOfStages);
 
-        if ( i == 1 )
-          {
-          f->SetInput( firstFilter->GetOutput() );
-          }
-        else
-          {
-          // note: first filter in vector (zeroth element) is for i==1
-          f->SetInput( intermediateFilters[i - 2]->GetOutput() );
-          }
+  const float weight = 1.0f / filterDimensionality;
 
-        intermediateFilters.push_back(f);
-        }
-      }
+  FirstFilterPointer firstFilter = FirstFilterType::New();
+  firstFilter->SetDirection(directions[0]);
+  firstFilter->SetSigma(sigma[0]);
+  firstFilter->SetZeroOrder();
+  firstFilter->ReleaseDataFlagOn();
+  firstFilter->SetInput(localInput);
+  progress->RegisterInternalFilter(firstFilter, weight);
 
-    // Last filter convolves and changes type from real type to output type
-    LastFilterPointer lastFilter = LastFilterType::New();
-    lastFilter->SetOperator(oper[filterDimensionality - 1]);
-    lastFilter->ReleaseDataFlagOn();
-    if ( filterDimensionality > 2 )
+  std::vector< IntermediateFilterPointer > intermediateFilters;
+  for ( unsigned int i = 1; i < filterDimensionality - 1; i++ )
+    {
+    IntermediateFilterPointer f = IntermediateFilterType::New();
+    f->SetDirection(directions[i]);
+    f->SetSigma(sigma[i]);
+    f->SetZeroOrder();
+    f->ReleaseDataFlagOn();
+    if ( i == 1 )
       {
-      lastFilter->SetInput( intermediateFilters[filterDimensionality - 3]->GetOutput() );
+      f->SetInput( firstFilter->GetOutput() );
       }
     else
       {
-      lastFilter->SetInput( firstFilter->GetOutput() );
+      f->SetInput( intermediateFilters.back()->GetOutput() );
       }
-    progress->RegisterInternalFilter(lastFilter, 1.0f / numberOfStages);
-
-    // Put in a StreamingImageFilter so the mini-pipeline is processed
-    // in chunks to minimize memory usage
-    StreamingFilterPointer streamingFilter = StreamingFilterType::New();
-    streamingFilter->SetInput( lastFilter->GetOutput() );
-    streamingFilter->SetNumberOfStreamDivisions( this->GetInternalNumberOfStreamDivisions() );
-    progress->RegisterInternalFilter(streamingFilter, 1.0f / numberOfStages);
-
-    // Graft this filters output onto the mini-pipeline so the mini-pipeline
-    // has the correct region ivars and will write to this filters bulk data
-    // output.
-    streamingFilter->GraftOutput(output);
-
-    // Update the last filter in the chain
-    streamingFilter->Update();
+    progress->RegisterInternalFilter(f, weight);
+    intermediateFilters.push_back(f);
+    }
 
-    // Graft the last output of the mini-pipeline onto this filters output so
-    // the final output has the correct region ivars and a handle to the final
-    // bulk data
-    this->GraftOutput(output);
+  LastFilterPointer lastFilter = LastFilterType::New();
+  lastFilter->SetDirection(directions[filterDimensionality - 1]);
+  lastFilter->SetSigma(sigma[filterDimensionality - 1]);
+  lastFilter->SetZeroOrder();
+  if ( intermediateFilters.empty() )
+    {
+    lastFilter->SetInput( firstFilter->GetOutput() );
+    }
+  else
+    {
+    lastFilter->SetInput( intermediateFilters.back()->GetOutput() );
     }
+  progress->RegisterInternalFilter(lastFilter, weight);
+
+  lastFilter->GraftOutput(output);
+  lastFilter->Update();
+  this->GraftOutput( lastFilter->GetOutput() );
 }
 
 template< class TInputImage, class TOutputImage >
@@ -334,6 +560,7 @@ DiscreteGaussianImageFilter< TInputImage, TOutputImage >
   os << indent << "FilterDimensionality: " << m_FilterDimensionality << std::endl;
   os << indent << "UseImageSpacing: " << m_UseImageSpacing << std::endl;
   os << indent << "InternalNumberOfStreamDivisions: " << m_InternalNumberOfStreamDivisions << std::endl;
+  os << indent << "RecursiveGaussianThreshold: " << m_RecursiveGaussianThreshold << std::endl;
 }
 } // end namespace itk
 
@@ -35,6 +35,10 @@ namespace itk
  * This filter requires that the input pixel type provides an operator<()
  * (LessThan Comparable).
  *
+ * For the pixel types with at most 16 bits, the median is found with an
+ * array histogram that slides along the lines of the image, instead of
+ * partially sorting each neighborhood.  The result is the same.
+ *
  * \sa Image
  * \sa Neighborhood
  * \sa NeighborhoodOperator
@@ -105,6 +109,12 @@ protected:
   void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                             int threadId);
 
+  /** Compute the median with a histogram which slides along the lines of
+   * the region. Only used with the pixel types that have an array
+   * histogram. */
+  void HistogramThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                     int threadId);
+
 private:
   MedianImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);    //purposely not implemented
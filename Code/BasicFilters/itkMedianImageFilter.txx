@@ -22,9 +22,11 @@
 #include "itkConstNeighborhoodIterator.h"
 #include "itkNeighborhoodInnerProduct.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageLinearIteratorWithIndex.h"
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkOffset.h"
 #include "itkProgressReporter.h"
+#include "itkRankHistogram.h"
 
 #include <vector>
 #include <algorithm>
@@ -42,6 +44,12 @@ MedianImageFilter< TInputImage, TOutputImage >
 ::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                        int threadId)
 {
+  if ( Function::RankHistogram< InputPixelType >::UseVectorBasedAlgorithm() )
+    {
+    this->HistogramThreadedGenerateData(outputRegionForThread, threadId);
+    return;
+    }
+
   // Allocate output
   typename OutputImageType::Pointer output = this->GetOutput();
   typename  InputImageType::ConstPointer input  = this->GetInput();
@@ -94,6 +102,120 @@ MedianImageFilter< TInputImage, TOutputImage >
       }
     }
 }
+
+template< class TInputImage, class TOutputImage >
+void
+MedianImageFilter< TInputImage, TOutputImage >
+::HistogramThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                int threadId)
+{
+  typedef Function::RankHistogram< InputPixelType >       HistogramType;
+  typedef typename InputImageType::IndexType             IndexType;
+  typedef typename InputImageType::OffsetValueType       OffsetValueType;
+  typedef ImageLinearIteratorWithIndex< OutputImageType > OutputIteratorType;
+
+  OutputImageType *     output = this->GetOutput();
+  const InputImageType *input = this->GetInput();
+  const InputSizeType   radius = this->GetRadius();
+
+  // The zero flux Neumann boundary condition repeats the pixels on the
+  // faces of the buffered region, so the indices of the neighbors are
+  // clamped to that region.
+  const InputImageRegionType bufferedRegion = input->GetBufferedRegion();
+  const IndexType            bufferStart = bufferedRegion.GetIndex();
+  const InputPixelType *     buffer = input->GetBufferPointer();
+  const OffsetValueType *    offsetTable = input->GetOffsetTable();
+
+  // The offsets of the columns of neighbors met along a line, and the
+  // offsets of the pixels of a column.
+  const long          lineStart = outputRegionForThread.GetIndex()[0];
+  const long          lineLength = outputRegionForThread.GetSize()[0];
+  const unsigned long width = 2 * radius[0] + 1;
+
+  std::vector< OffsetValueType > columns(lineLength + width - 1);
+  for ( unsigned long c = 0; c < columns.size(); ++c )
+    {
+    long x = lineStart - static_cast< long >( radius[0] ) + static_cast< long >( c );
+    x = std::max( x, static_cast< long >( bufferStart[0] ) );
+    x = std::min( x, static_cast< long >( bufferStart[0] + bufferedRegion.GetSize()[0] ) - 1 );
+    columns[c] = ( x - bufferStart[0] ) * offsetTable[0];
+    }
+
+  unsigned long columnSize = 1;
+  for ( unsigned int d = 1; d < InputImageDimension; ++d )
+    {
+    columnSize *= 2 * radius[d] + 1;
+    }
+  std::vector< OffsetValueType > column(columnSize);
+
+  HistogramType histogram;
+  histogram.SetRank(0.5);
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+
+  OutputIteratorType it(output, outputRegionForThread);
+  it.SetDirection(0);
+  it.GoToBegin();
+  while ( !it.IsAtEnd() )
+    {
+    const IndexType lineIndex = it.GetIndex();
+    for ( unsigned long k = 0; k < columnSize; ++k )
+      {
+      unsigned long   rest = k;
+      OffsetValueType offset = 0;
+      for ( unsigned int d = 1; d < InputImageDimension; ++d )
+        {
+        const unsigned long size = 2 * radius[d] + 1;
+        long                idx = lineIndex[d] - static_cast< long >( radius[d] )
+                                  + static_cast< long >( rest % size );
+        rest /= size;
+        idx = std::max( idx, static_cast< long >( bufferStart[d] ) );
+        idx = std::min( idx, static_cast< long >( bufferStart[d] + bufferedRegion.GetSize()[d] ) - 1 );
+        offset += ( idx - bufferStart[d] ) * offsetTable[d];
+        }
+      column[k] = offset;
+      }
+
+    // The neighborhood of the first pixel of the line
+    for ( unsigned long c = 0; c < width; ++c )
+      {
+      for ( unsigned long k = 0; k < columnSize; ++k )
+        {
+        histogram.AddPixel( buffer[columns[c] + column[k]] );
+        }
+      }
+
+    // Slide the histogram by one column at each pixel, and empty it at the
+    // end of the line
+    for ( long i = 0; !it.IsAtEndOfLine(); ++i, ++it )
+      {
+      it.Set( static_cast< OutputPixelType >( histogram.GetValue( InputPixelType() ) ) );
+      for ( unsigned long k = 0; k < columnSize; ++k )
+        {
+        histogram.RemovePixel( buffer[columns[i] + column[k]] );
+        }
+      if ( i + 1 < lineLength )
+        {
+        for ( unsigned long k = 0; k < columnSize; ++k )
+          {
+          histogram.AddPixel( buffer[columns[i + width] + column[k]] );
+          }
+        }
+      else
+        {
+        for ( unsigned long c = i + 1; c < i + width; ++c )
+          {
+          for ( unsigned long k = 0; k < columnSize; ++k )
+            {
+            histogram.RemovePixel( buffer[columns[c] + column[k]] );
+            }
+          }
+        }
+      progress.CompletedPixel();
+      }
+    it.NextLine();
+    }
+}
 } // end namespace itk
 
 #endif
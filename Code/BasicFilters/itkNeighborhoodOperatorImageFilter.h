@@ -22,6 +22,7 @@
 #include "itkNeighborhoodOperator.h"
 #include "itkImage.h"
 #include "itkZeroFluxNeumannBoundaryCondition.h"
+#include "itkProgressReporter.h"
 
 namespace itk
 {
@@ -35,6 +36,17 @@ namespace itk
  * with the image region.  Apply the mirror()'d operator for
  * non-symmetric NeighborhoodOperators.
  *
+ * Away from the boundaries of the buffer, where the neighborhoods need
+ * no boundary condition, the neighborhood iterator is not used.  The
+ * offsets of the operator in the buffer are computed once, and each line
+ * of the output is accumulated from the lines of the input under each
+ * row of the operator, which the compiler can vectorize.  The rows of
+ * one coefficient, as in the directional operators along the other
+ * dimensions, and of three coefficients, as in the 3x3 and 3x3x3
+ * operators, are unrolled.
+ * The coefficients are added in the same order as by
+ * NeighborhoodInnerProduct.
+ *
  * \ingroup ImageFilters
  *
  * \sa Image
@@ -163,6 +175,12 @@ protected:
 
   void PrintSelf(std::ostream & os, Indent indent) const
   {  Superclass::PrintSelf(os, indent); }
+
+  /** Compute a region where the neighborhoods are inside the buffer of
+   * the input.  VWidth is the width of the operator along the first
+   * dimension, or 0 if it is only known at run time. */
+  template< unsigned int VWidth >
+  void ComputeInteriorRegion(const OutputImageRegionType & region, ProgressReporter & progress);
 private:
   NeighborhoodOperatorImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);                  //purposely not implemented
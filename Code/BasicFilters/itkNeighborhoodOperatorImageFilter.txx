@@ -21,6 +21,7 @@
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkNeighborhoodInnerProduct.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkConstNeighborhoodIterator.h"
 #include "itkProgressReporter.h"
 
@@ -120,6 +121,24 @@ NeighborhoodOperatorImageFilter< TInputImage, TOutputImage, TOperatorValueType >
   ConstNeighborhoodIterator< InputImageType > bit;
   for ( fit = faceList.begin(); fit != faceList.end(); ++fit )
     {
+    // the first region is free of boundary conditions
+    if ( fit == faceList.begin() )
+      {
+      if ( m_Operator.GetSize(0) == 1 )
+        {
+        this->template ComputeInteriorRegion< 1 >(*fit, progress);
+        }
+      else if ( m_Operator.GetSize(0) == 3 )
+        {
+        this->template ComputeInteriorRegion< 3 >(*fit, progress);
+        }
+      else
+        {
+        this->template ComputeInteriorRegion< 0 >(*fit, progress);
+        }
+      continue;
+      }
+
     bit =
       ConstNeighborhoodIterator< InputImageType >(m_Operator.GetRadius(),
                                                   input, *fit);
@@ -135,6 +154,84 @@ NeighborhoodOperatorImageFilter< TInputImage, TOutputImage, TOperatorValueType >
       }
     }
 }
+
+template< class TInputImage, class TOutputImage, class TOperatorValueType >
+template< unsigned int VWidth >
+void
+NeighborhoodOperatorImageFilter< TInputImage, TOutputImage, TOperatorValueType >
+::ComputeInteriorRegion(const OutputImageRegionType & region, ProgressReporter & progress)
+{
+  if ( region.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  const InputImageType *input = this->GetInput();
+  OutputImageType *     output = this->GetOutput();
+
+  // the pixels are read as by the neighborhood iterators
+  typename InputImageType::NeighborhoodAccessorFunctorType accessor =
+    input->GetNeighborhoodAccessor();
+  accessor.SetBegin( input->GetBufferPointer() );
+  const InputInternalPixelType *buffer = input->GetBufferPointer();
+
+  // The operator is made of rows of width coefficients along the first
+  // dimension.  The offset of the first coefficient of each row in the
+  // buffer is computed once.
+  const unsigned int width = VWidth ? VWidth : m_Operator.GetSize(0);
+  const unsigned int numberOfRows = m_Operator.Size() / width;
+  const typename InputImageType::OffsetValueType *offsetTable = input->GetOffsetTable();
+
+  std::vector< long >              rowOffsets(numberOfRows);
+  std::vector< OperatorValueType > coefficients( m_Operator.Size() );
+  for ( unsigned int r = 0; r < numberOfRows; r++ )
+    {
+    const typename OutputNeighborhoodType::OffsetType offset = m_Operator.GetOffset(r * width);
+    rowOffsets[r] = 0;
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      rowOffsets[r] += offset[i] * offsetTable[i];
+      }
+    }
+  for ( unsigned int n = 0; n < m_Operator.Size(); n++ )
+    {
+    coefficients[n] = static_cast< OperatorValueType >( m_Operator[n] );
+    }
+
+  const unsigned long lineLength = region.GetSize(0);
+  std::vector< OperatorValueType > sums(lineLength);
+
+  ImageRegionIterator< OutputImageType > it(output, region);
+  ImageLinearConstIteratorWithIndex< InputImageType > lineIt(input, region);
+  lineIt.SetDirection(0);
+  for ( lineIt.GoToBegin(); !lineIt.IsAtEnd(); lineIt.NextLine() )
+    {
+    const InputInternalPixelType *center = buffer + input->ComputeOffset( lineIt.GetIndex() );
+
+    std::fill( sums.begin(), sums.end(), NumericTraits< OperatorValueType >::Zero );
+    for ( unsigned int r = 0; r < numberOfRows; r++ )
+      {
+      const InputInternalPixelType *row = center + rowOffsets[r];
+      const OperatorValueType *     rowCoefficients = &coefficients[r * width];
+      for ( unsigned long x = 0; x < lineLength; x++ )
+        {
+        OperatorValueType sum = sums[x];
+        for ( unsigned int j = 0; j < width; j++ )
+          {
+          sum += rowCoefficients[j] * static_cast< OperatorValueType >( accessor.Get(row + x + j) );
+          }
+        sums[x] = sum;
+        }
+      }
+
+    for ( unsigned long x = 0; x < lineLength; x++ )
+      {
+      it.Value() = static_cast< typename OutputImageType::PixelType >( sums[x] );
+      ++it;
+      progress.CompletedPixel();
+      }
+    }
+}
 } // end namespace itk
 
 #endif
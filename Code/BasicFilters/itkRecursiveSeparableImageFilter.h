@@ -43,6 +43,14 @@ namespace itk
  * G. Farneback & C.-F. Westin, "On Implementation of Recursive Gaussian
  * Filters", so far unpublished.
  *
+ * The recursion along a line depends on its previous outputs, so a single
+ * line cannot be computed in parallel.  The filter therefore processes
+ * NumberOfParallelLines lines together, interleaved in its buffers, and
+ * the compiler vectorizes the inner loops over these lines.  The lines are
+ * taken in the order of the image, so when filtering along any direction
+ * but 0 the pixels read together are adjacent in memory.  Setting
+ * NumberOfParallelLines to 1 filters one line at a time.
+ *
  * \ingroup ImageFilters
  */
 template< typename TInputImage, typename TOutputImage = TInputImage >
@@ -86,6 +94,10 @@ public:
   /** Set the direction in which the filter is to be applied. */
   itkSetMacro(Direction, unsigned int);
 
+  /** Set/Get the number of lines filtered together. The default is 8. */
+  itkSetClampMacro( NumberOfParallelLines, unsigned int, 1, NumericTraits< unsigned int >::max() );
+  itkGetConstMacro(NumberOfParallelLines, unsigned int);
+
   /** Set Input Image. */
   void SetInputImage(const TInputImage *);
 
@@ -129,6 +141,12 @@ protected:
   void FilterDataArray(RealType *outs, const RealType *data, RealType *scratch,
                        unsigned int ln);
 
+  /** Apply the Recursive Filter to numberOfLines interleaved lines: the
+   * element i of the line l is at i * numberOfLines + l in the three
+   * arrays, which hold ln * numberOfLines values. */
+  void FilterDataArrays(RealType *outs, const RealType *data, RealType *scratch,
+                        unsigned int ln, unsigned int numberOfLines);
+
 protected:
   /** Causal coefficients that multiply the input data. */
   ScalarRealType m_N0;
@@ -168,6 +186,8 @@ private:
   /** Direction in which the filter is to be applied
    * this should be in the range [0,ImageDimension-1]. */
   unsigned int m_Direction;
+
+  unsigned int m_NumberOfParallelLines;
 };
 } // end namespace itk
 
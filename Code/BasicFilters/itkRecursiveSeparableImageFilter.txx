@@ -23,6 +23,7 @@
 #include "itkImageLinearIteratorWithIndex.h"
 #include "itkProgressReporter.h"
 #include <new>
+#include <vector>
 
 namespace itk
 {
@@ -31,6 +32,7 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 ::RecursiveSeparableImageFilter()
 {
   m_Direction = 0;
+  m_NumberOfParallelLines = 8;
   this->SetNumberOfRequiredOutputs(1);
   this->SetNumberOfRequiredInputs(1);
 }
@@ -150,6 +152,125 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
     }
 }
 
+/**
+ * Apply Recursive Filter to interleaved lines
+ */
+template< typename TInputImage, typename TOutputImage >
+void
+RecursiveSeparableImageFilter< TInputImage, TOutputImage >
+::FilterDataArrays(RealType *outs, const RealType *data,
+                   RealType *scratch, unsigned int ln, unsigned int numberOfLines)
+{
+  // The operations are those of FilterDataArray, in the same order, with
+  // the loop over the lines innermost.  The coefficients are copied so the
+  // compiler knows that they do not change when the buffers are written.
+  if ( numberOfLines == 1 )
+    {
+    this->FilterDataArray(outs, data, scratch, ln);
+    return;
+    }
+
+  const unsigned int   nl = numberOfLines;
+  const ScalarRealType n0 = m_N0, n1 = m_N1, n2 = m_N2, n3 = m_N3;
+  const ScalarRealType d1 = m_D1, d2 = m_D2, d3 = m_D3, d4 = m_D4;
+  const ScalarRealType m1 = m_M1, m2 = m_M2, m3 = m_M3, m4 = m_M4;
+  const ScalarRealType bn1 = m_BN1, bn2 = m_BN2, bn3 = m_BN3, bn4 = m_BN4;
+  const ScalarRealType bm1 = m_BM1, bm2 = m_BM2, bm3 = m_BM3, bm4 = m_BM4;
+
+  /**
+   * Causal direction pass, stored in outs
+   */
+  for ( unsigned int l = 0; l < nl; l++ )
+    {
+    const RealType *in = data + l;
+    RealType *      out = outs + l;
+
+    // this value is assumed to exist from the border to infinity.
+    const RealType outV1 = in[0];
+
+    out[0]      = RealType(outV1      * n0 + outV1      * n1 + outV1      * n2 + outV1 * n3);
+    out[nl]     = RealType(in[nl]     * n0 + outV1      * n1 + outV1      * n2 + outV1 * n3);
+    out[2 * nl] = RealType(in[2 * nl] * n0 + in[nl]     * n1 + outV1      * n2 + outV1 * n3);
+    out[3 * nl] = RealType(in[3 * nl] * n0 + in[2 * nl] * n1 + in[nl]     * n2 + outV1 * n3);
+
+    out[0]      -= RealType(outV1       * bn1 + outV1       * bn2 + outV1   * bn3 + outV1 * bn4);
+    out[nl]     -= RealType(out[0]      * d1  + outV1       * bn2 + outV1   * bn3 + outV1 * bn4);
+    out[2 * nl] -= RealType(out[nl]     * d1  + out[0]      * d2  + outV1   * bn3 + outV1 * bn4);
+    out[3 * nl] -= RealType(out[2 * nl] * d1  + out[nl]     * d2  + out[0]  * d3  + outV1 * bn4);
+    }
+
+  for ( unsigned int i = 4; i < ln; i++ )
+    {
+    const RealType *in0 = data + i * nl;
+    const RealType *in1 = in0 - nl;
+    const RealType *in2 = in1 - nl;
+    const RealType *in3 = in2 - nl;
+    RealType *      out0 = outs + i * nl;
+    const RealType *out1 = out0 - nl;
+    const RealType *out2 = out1 - nl;
+    const RealType *out3 = out2 - nl;
+    const RealType *out4 = out3 - nl;
+    for ( unsigned int l = 0; l < nl; l++ )
+      {
+      out0[l]  = RealType(in0[l] * n0 + in1[l] * n1 + in2[l] * n2 + in3[l] * n3);
+      out0[l] -= RealType(out1[l] * d1 + out2[l] * d2 + out3[l] * d3 + out4[l] * d4);
+      }
+    }
+
+  /**
+   * AntiCausal direction pass, in scratch
+   */
+  const unsigned int e1 = ( ln - 1 ) * nl;
+  const unsigned int e2 = e1 - nl;
+  const unsigned int e3 = e2 - nl;
+  const unsigned int e4 = e3 - nl;
+  for ( unsigned int l = 0; l < nl; l++ )
+    {
+    const RealType *in = data + l;
+    RealType *      tmp = scratch + l;
+
+    // this value is assumed to exist from the border to infinity.
+    const RealType outV2 = in[e1];
+
+    tmp[e1] = RealType(outV2  * m1 + outV2  * m2 + outV2  * m3 + outV2 * m4);
+    tmp[e2] = RealType(in[e1] * m1 + outV2  * m2 + outV2  * m3 + outV2 * m4);
+    tmp[e3] = RealType(in[e2] * m1 + in[e1] * m2 + outV2  * m3 + outV2 * m4);
+    tmp[e4] = RealType(in[e3] * m1 + in[e2] * m2 + in[e1] * m3 + outV2 * m4);
+
+    tmp[e1] -= RealType(outV2   * bm1 + outV2   * bm2 + outV2   * bm3 + outV2 * bm4);
+    tmp[e2] -= RealType(tmp[e1] * d1  + outV2   * bm2 + outV2   * bm3 + outV2 * bm4);
+    tmp[e3] -= RealType(tmp[e2] * d1  + tmp[e1] * d2  + outV2   * bm3 + outV2 * bm4);
+    tmp[e4] -= RealType(tmp[e3] * d1  + tmp[e2] * d2  + tmp[e1] * d3  + outV2 * bm4);
+    }
+
+  for ( unsigned int i = ln - 4; i > 0; i-- )
+    {
+    const RealType *in0 = data + i * nl;
+    const RealType *in1 = in0 + nl;
+    const RealType *in2 = in1 + nl;
+    const RealType *in3 = in2 + nl;
+    RealType *      tmp0 = scratch + ( i - 1 ) * nl;
+    const RealType *tmp1 = tmp0 + nl;
+    const RealType *tmp2 = tmp1 + nl;
+    const RealType *tmp3 = tmp2 + nl;
+    const RealType *tmp4 = tmp3 + nl;
+    for ( unsigned int l = 0; l < nl; l++ )
+      {
+      tmp0[l]  = RealType(in0[l] * m1 + in1[l] * m2 + in2[l] * m3 + in3[l] * m4);
+      tmp0[l] -= RealType(tmp1[l] * d1 + tmp2[l] * d2 + tmp3[l] * d3 + tmp4[l] * d4);
+      }
+    }
+
+  /**
+   * Roll the antiCausal part into the output
+   */
+  const unsigned int size = ln * nl;
+  for ( unsigned int i = 0; i < size; i++ )
+    {
+    outs[i] += scratch[i];
+    }
+}
+
 //
 // we need all of the image in just the "Direction" we are separated into
 //
@@ -276,7 +397,7 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 
 /**
  * Compute Recursive filter
- * line by line in one of the dimensions
+ * on batches of lines in one of the dimensions
  */
 template< typename TInputImage, typename TOutputImage >
 void
@@ -303,13 +424,17 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 
   const unsigned int ln = region.GetSize()[this->m_Direction];
 
+  // the lines are filtered in batches, interleaved in the buffers
+  const unsigned int maximumNumberOfLines = this->m_NumberOfParallelLines;
+  const unsigned int bufferSize = ln * maximumNumberOfLines;
+
   RealType *inps = 0;
   RealType *outs = 0;
   RealType *scratch = 0;
 
   try
     {
-    inps = new RealType[ln];
+    inps = new RealType[bufferSize];
     }
   catch ( std::bad_alloc & )
     {
@@ -318,7 +443,7 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 
   try
     {
-    outs = new RealType[ln];
+    outs = new RealType[bufferSize];
     }
   catch ( std::bad_alloc & )
     {
@@ -328,7 +453,7 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 
   try
     {
-    scratch = new RealType[ln];
+    scratch = new RealType[bufferSize];
     }
   catch ( std::bad_alloc & )
     {
@@ -347,30 +472,55 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 
   try  // this try is intended to catch an eventual AbortException.
     {
-    while ( !inputIterator.IsAtEnd() && !outputIterator.IsAtEnd() )
+    std::vector< InputConstIteratorType > inputLines(maximumNumberOfLines, inputIterator);
+    std::vector< OutputIteratorType >     outputLines(maximumNumberOfLines, outputIterator);
+
+    unsigned long remainingLines = region.GetNumberOfPixels() / ln;
+    while ( remainingLines > 0 )
       {
-      unsigned int i = 0;
-      while ( !inputIterator.IsAtEndOfLine() )
+      const unsigned int numberOfLines =
+        static_cast< unsigned int >( vnl_math_min(remainingLines,
+                                                  static_cast< unsigned long >( maximumNumberOfLines ) ) );
+      remainingLines -= numberOfLines;
+
+      // The lines visited one after the other are mostly adjacent in the
+      // image, so reading them together uses the cache better.
+      for ( unsigned int l = 0; l < numberOfLines; l++ )
         {
-        inps[i++]      = inputIterator.Get();
-        ++inputIterator;
+        inputLines[l] = inputIterator;
+        outputLines[l] = outputIterator;
+        inputIterator.NextLine();
+        outputIterator.NextLine();
         }
 
-      this->FilterDataArray(outs, inps, scratch, ln);
-
-      unsigned int j = 0;
-      while ( !outputIterator.IsAtEndOfLine() )
+      RealType *in = inps;
+      for ( unsigned int i = 0; i < ln; i++ )
         {
-        outputIterator.Set( static_cast< OutputPixelType >( outs[j++] ) );
-        ++outputIterator;
+        for ( unsigned int l = 0; l < numberOfLines; l++ )
+          {
+          *in++ = inputLines[l].Get();
+          ++inputLines[l];
+          }
         }
 
-      inputIterator.NextLine();
-      outputIterator.NextLine();
+      this->FilterDataArrays(outs, inps, scratch, ln, numberOfLines);
+
+      const RealType *out = outs;
+      for ( unsigned int i = 0; i < ln; i++ )
+        {
+        for ( unsigned int l = 0; l < numberOfLines; l++ )
+          {
+          outputLines[l].Set( static_cast< OutputPixelType >( *out++ ) );
+          ++outputLines[l];
+          }
+        }
 
       // Although the method name is CompletedPixel(),
       // this is being called after each line is processed
-      progress.CompletedPixel();
+      for ( unsigned int l = 0; l < numberOfLines; l++ )
+        {
+        progress.CompletedPixel();
+        }
       }
     }
   catch ( ProcessAborted  & )
@@ -403,6 +553,7 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
   Superclass::PrintSelf(os, indent);
 
   os << indent << "Direction: " << m_Direction << std::endl;
+  os << indent << "NumberOfParallelLines: " << m_NumberOfParallelLines << std::endl;
 }
 } // end namespace itk
 
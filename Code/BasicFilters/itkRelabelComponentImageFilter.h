@@ -20,6 +20,7 @@
 
 #include "itkInPlaceImageFilter.h"
 #include "itkImage.h"
+#include "itk_hash_map.h"
 #include <vector>
 
 namespace itk
@@ -65,9 +66,13 @@ namespace itk
  * controlled via methods in the superclass,
  * InPlaceImageFilter::InPlaceOn() and InPlaceImageFilter::InPlaceOff().
  *
+ * The objects are counted by all the threads, each thread filling its
+ * own histogram of the labels, and the image is then relabeled by all
+ * the threads through a lookup table.
+ *
  * \sa ConnectedComponentImageFilter, BinaryThresholdImageFilter, ThresholdImageFilter
  *
- * \ingroup Singlethreaded
+ * \ingroup Multithreaded
  */
 
 template< class TInputImage, class TOutputImage >
@@ -107,6 +112,7 @@ public:
   typedef   typename TInputImage::IndexType   IndexType;
   typedef   typename TInputImage::SizeType    SizeType;
   typedef   typename TOutputImage::RegionType RegionType;
+  typedef   typename TInputImage::RegionType  InputRegionType;
 
   /**
    * Smart pointer typedef support
@@ -231,9 +237,17 @@ protected:
   RelabelComponentImageFilter(const Self &) {}
 
   /**
-   * Standard pipeline method.
+   * Standard pipeline methods.
    */
-  void GenerateData();
+  void BeforeThreadedGenerateData();
+
+  void ThreadedGenerateData(const RegionType & outputRegionForThread, int threadId);
+
+  void AfterThreadedGenerateData();
+
+  /** Count the pixels of each label in a region of the input. Each
+   * thread updates its own histogram. */
+  void ThreadedCountLabels(const InputRegionType & regionForThread, int threadId);
 
   /** RelabelComponentImageFilter needs the entire input. Therefore
    * it must provide an implementation GenerateInputRequestedRegion().
@@ -278,6 +292,27 @@ public:
   };
 private:
 
+  /** Internal structure used for passing image data into the threading
+   * library */
+  struct RelabelThreadStruct {
+    Self *Filter;
+  };
+
+  /** Split the input among the threads to count the labels */
+  static ITK_THREAD_RETURN_TYPE CountLabelsThreaderCallback(void *arg);
+
+  /** The histograms are dense up to the number of pixels counted by
+   * a thread. Larger labels are counted in a hash map. */
+  typedef std::vector< ObjectSizeType >              HistogramType;
+  typedef itk::hash_map< LabelType, ObjectSizeType > SparseHistogramType;
+  typedef std::vector< LabelType >                   RelabelTableType;
+  typedef itk::hash_map< LabelType, LabelType >      SparseRelabelTableType;
+
+  std::vector< HistogramType >       m_Histograms;
+  std::vector< SparseHistogramType > m_SparseHistograms;
+  RelabelTableType                   m_RelabelTable;
+  SparseRelabelTableType             m_SparseRelabelTable;
+
   LabelType      m_NumberOfObjects;
   LabelType      m_NumberOfObjectsToPrint;
   LabelType      m_OriginalNumberOfObjects;
@@ -22,8 +22,8 @@
 #include "itkImageRegionIterator.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
-#include "itk_hash_map.h"
-#include <map>
+#include "itkImageRegionSplitter.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -46,28 +46,12 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
 template< class TInputImage, class TOutputImage >
 void
 RelabelComponentImageFilter< TInputImage, TOutputImage >
-::GenerateData()
+::BeforeThreadedGenerateData()
 {
   unsigned long i;
 
-  // Use a map to keep track of the size of each object.  Object
-  // number -> ObjectType (which has Object number and the two sizes)
-  typedef itk::hash_map< LabelType, RelabelComponentObjectType > MapType;
-  MapType sizeMap;
-  typename MapType::iterator mapIt;
-  typedef typename MapType::value_type MapValueType;
-
-  // Get the input and the output
+  // Get the input
   typename TInputImage::ConstPointer input = this->GetInput();
-  typename TOutputImage::Pointer output = this->GetOutput();
-
-  // Setup a progress reporter.  We have 2 stages to the algorithm so
-  // use the total number of pixels accessed. We walk the entire input
-  // in the first pass, then walk just the output requested region in
-  // the second pass.
-  ProgressReporter progress( this, 0,
-                             input->GetRequestedRegion().GetNumberOfPixels()
-                             + output->GetRequestedRegion().GetNumberOfPixels() );
 
   // Calculate the size of pixel
   float physicalPixelSize = 1.0;
@@ -76,46 +60,45 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
     physicalPixelSize *= input->GetSpacing()[i];
     }
 
-  RelabelComponentObjectType initialSize;
-  initialSize.m_SizeInPixels = 1;
-  initialSize.m_SizeInPhysicalUnits = physicalPixelSize;
-
   // First pass: walk the entire input image and determine what
   // labels are used and the number of pixels used in each label.
+  // Each thread counts a part of the input in its own histogram.
   //
-
-  // walk the input
-  ImageRegionConstIterator< InputImageType > it( input, input->GetRequestedRegion() );
-  it.GoToBegin();
-
-  while ( !it.IsAtEnd() )
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+  const unsigned int numberOfThreads = this->GetMultiThreader()->GetNumberOfThreads();
+  m_Histograms.clear();
+  m_Histograms.resize(numberOfThreads);
+  m_SparseHistograms.clear();
+  m_SparseHistograms.resize(numberOfThreads);
+
+  RelabelThreadStruct str;
+  str.Filter = this;
+  this->GetMultiThreader()->SetSingleMethod(this->CountLabelsThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  // Merge the histograms of the threads
+  HistogramType       histogram;
+  SparseHistogramType sparseHistogram;
+  for ( unsigned int t = 0; t < numberOfThreads; t++ )
     {
-    // Get the input pixel value
-    const LabelType inputValue = static_cast< LabelType >( it.Get() );
-
-    // if the input pixel is not the background
-    if ( inputValue != NumericTraits< LabelType >::Zero )
+    const HistogramType & threadHistogram = m_Histograms[t];
+    if ( threadHistogram.size() > histogram.size() )
       {
-      // Does this label already exist
-      mapIt = sizeMap.find(inputValue);
-      if ( mapIt == sizeMap.end() )
-        {
-        // label is not currently in the map
-        initialSize.m_ObjectNumber = inputValue;
-        sizeMap.insert( MapValueType(inputValue, initialSize) );
-        }
-      else
-        {
-        // label is already in the map, update the values
-        ( *mapIt ).second.m_SizeInPixels++;
-        ( *mapIt ).second.m_SizeInPhysicalUnits += physicalPixelSize;
-        }
+      histogram.resize(threadHistogram.size(), 0);
+      }
+    for ( i = 0; i < threadHistogram.size(); ++i )
+      {
+      histogram[i] += threadHistogram[i];
       }
 
-    // increment the iterators
-    ++it;
-    progress.CompletedPixel();
+    typename SparseHistogramType::const_iterator sIt;
+    for ( sIt = m_SparseHistograms[t].begin(); sIt != m_SparseHistograms[t].end(); ++sIt )
+      {
+      sparseHistogram[sIt->first] += sIt->second;
+      }
     }
+  m_Histograms.clear();
+  m_SparseHistograms.clear();
 
   // Now we need to reorder the labels. Use the m_ObjectSortingOrder
   // to determine how to sort the objects. Define a map for converting
@@ -125,13 +108,25 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
   VectorType sizeVector;
   typename VectorType::iterator vit;
 
-  typedef std::map< LabelType, LabelType > RelabelMapType;
-  RelabelMapType relabelMap;
-
-  // copy the original object map to a vector so we can sort it
-  for ( mapIt = sizeMap.begin(); mapIt != sizeMap.end(); ++mapIt )
+  // copy the histograms to a vector so we can sort it
+  RelabelComponentObjectType object;
+  for ( i = 1; i < histogram.size(); ++i )
     {
-    sizeVector.push_back( ( *mapIt ).second );
+    if ( histogram[i] != 0 )
+      {
+      object.m_ObjectNumber = i;
+      object.m_SizeInPixels = histogram[i];
+      object.m_SizeInPhysicalUnits = static_cast< float >( histogram[i] * physicalPixelSize );
+      sizeVector.push_back(object);
+      }
+    }
+  typename SparseHistogramType::const_iterator sIt;
+  for ( sIt = sparseHistogram.begin(); sIt != sparseHistogram.end(); ++sIt )
+    {
+    object.m_ObjectNumber = sIt->first;
+    object.m_SizeInPixels = sIt->second;
+    object.m_SizeInPhysicalUnits = static_cast< float >( sIt->second * physicalPixelSize );
+    sizeVector.push_back(object);
     }
 
   // sort the objects by size and define the map to use to relabel the image
@@ -139,6 +134,10 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
 
   // create a lookup table to map the input label to the output label.
   // cache the object sizes for later access by the user
+  m_RelabelTable.clear();
+  m_RelabelTable.resize(histogram.size(), 0);
+  m_SparseRelabelTable.clear();
+
   m_NumberOfObjects = sizeVector.size();
   m_OriginalNumberOfObjects = sizeVector.size();
   m_SizeOfObjectsInPixels.clear();
@@ -150,22 +149,31 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
     {
     // if we find an object smaller than the minimum size, we
     // terminate the loop.
+    LabelType outputLabel = 0;
     if ( m_MinimumObjectSize > 0 && ( *vit ).m_SizeInPixels < m_MinimumObjectSize )
       {
       // map small objects to the background
       NumberOfObjectsRemoved++;
-      relabelMap.insert( RelabelMapType::value_type( ( *vit ).m_ObjectNumber, 0 ) );
       }
     else
       {
       // map for input labels to output labels (Note we use i+1 in the
       // map since index 0 is the background)
-      relabelMap.insert( RelabelMapType::value_type( ( *vit ).m_ObjectNumber, i + 1 ) );
+      outputLabel = i + 1;
 
       // cache object sizes for later access by the user
       m_SizeOfObjectsInPixels[i] = ( *vit ).m_SizeInPixels;
       m_SizeOfObjectsInPhysicalUnits[i] = ( *vit ).m_SizeInPhysicalUnits;
       }
+
+    if ( ( *vit ).m_ObjectNumber < m_RelabelTable.size() )
+      {
+      m_RelabelTable[( *vit ).m_ObjectNumber] = outputLabel;
+      }
+    else
+      {
+      m_SparseRelabelTable[( *vit ).m_ObjectNumber] = outputLabel;
+      }
     }
 
   // update number of objects and resize cache vectors if we have removed small
@@ -176,22 +184,101 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
     m_SizeOfObjectsInPixels.resize(m_NumberOfObjects);
     m_SizeOfObjectsInPhysicalUnits.resize(m_NumberOfObjects);
     }
+}
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+RelabelComponentImageFilter< TInputImage, TOutputImage >
+::CountLabelsThreaderCallback(void *arg)
+{
+  const int threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  const int threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  RelabelThreadStruct *str =
+    (RelabelThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  typedef ImageRegionSplitter< itkGetStaticConstMacro(InputImageDimension) > SplitterType;
+  typename SplitterType::Pointer splitter = SplitterType::New();
+
+  const InputRegionType region = str->Filter->GetInput()->GetRequestedRegion();
+  const int total = splitter->GetNumberOfSplits(region, threadCount);
+  if ( threadId < total )
+    {
+    str->Filter->ThreadedCountLabels(splitter->GetSplit(threadId, total, region), threadId);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+RelabelComponentImageFilter< TInputImage, TOutputImage >
+::ThreadedCountLabels(const InputRegionType & regionForThread, int threadId)
+{
+  HistogramType &       histogram = m_Histograms[threadId];
+  SparseHistogramType & sparseHistogram = m_SparseHistograms[threadId];
+
+  // A thread can't see more labels than pixels, so a larger dense
+  // histogram would mostly be empty.
+  const LabelType maximumDenseLabel = regionForThread.GetNumberOfPixels();
+
+  // Setup a progress reporter.  We have 2 stages to the algorithm so
+  // the first pass over the input is the first half of the progress.
+  ProgressReporter progress(this, threadId, regionForThread.GetNumberOfPixels(),
+                            100, 0.0f, 0.5f);
+
+  // walk the input
+  ImageRegionConstIterator< InputImageType > it(this->GetInput(), regionForThread);
+  it.GoToBegin();
+
+  while ( !it.IsAtEnd() )
+    {
+    // Get the input pixel value
+    const LabelType inputValue = static_cast< LabelType >( it.Get() );
+
+    // if the input pixel is not the background
+    if ( inputValue != NumericTraits< LabelType >::Zero )
+      {
+      if ( inputValue < histogram.size() )
+        {
+        histogram[inputValue]++;
+        }
+      else if ( inputValue <= maximumDenseLabel )
+        {
+        histogram.resize(inputValue + 1, 0);
+        histogram[inputValue]++;
+        }
+      else
+        {
+        sparseHistogram[inputValue]++;
+        }
+      }
+
+    // increment the iterators
+    ++it;
+    progress.CompletedPixel();
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void
+RelabelComponentImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData(const RegionType & outputRegionForThread, int threadId)
+{
+  // Get the input and the output
+  typename TInputImage::ConstPointer input = this->GetInput();
+  typename TOutputImage::Pointer output = this->GetOutput();
 
   // Second pass: walk just the output requested region and relabel
   // the necessary pixels.
   //
-
-  // Allocate the output
-  this->AllocateOutputs();
+  ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels(),
+                            100, 0.5f, 0.5f);
 
   // Remap the labels.  Note we only walk the region of the output
   // that was requested.  This may be a subset of the input image.
-  OutputPixelType                        outputValue;
-  ImageRegionIterator< OutputImageType > oit;
-  oit = ImageRegionIterator< OutputImageType >( output,
-                                                output->GetRequestedRegion() );
-  it = ImageRegionConstIterator< InputImageType >( input,
-                                                   output->GetRequestedRegion() );
+  ImageRegionIterator< OutputImageType >     oit(output, outputRegionForThread);
+  ImageRegionConstIterator< InputImageType > it(input, outputRegionForThread);
 
   it.GoToBegin();
   oit.GoToBegin();
@@ -202,8 +289,20 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
     if ( inputValue != NumericTraits< LabelType >::Zero )
       {
       // lookup the mapped label
-      outputValue = static_cast< OutputPixelType >( relabelMap[inputValue] );
-      oit.Set(outputValue);
+      LabelType outputValue = 0;
+      if ( inputValue < m_RelabelTable.size() )
+        {
+        outputValue = m_RelabelTable[inputValue];
+        }
+      else
+        {
+        typename SparseRelabelTableType::const_iterator sIt = m_SparseRelabelTable.find(inputValue);
+        if ( sIt != m_SparseRelabelTable.end() )
+          {
+          outputValue = sIt->second;
+          }
+        }
+      oit.Set( static_cast< OutputPixelType >( outputValue ) );
       }
     else
       {
@@ -217,6 +316,15 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
     }
 }
 
+template< class TInputImage, class TOutputImage >
+void
+RelabelComponentImageFilter< TInputImage, TOutputImage >
+::AfterThreadedGenerateData()
+{
+  m_RelabelTable.clear();
+  m_SparseRelabelTable.clear();
+}
+
 template< class TInputImage, class TOutputImage >
 void
 RelabelComponentImageFilter< TInputImage, TOutputImage >
@@ -23,6 +23,7 @@
 #include "itkImageRegionIterator.h"
 #include "itkImageToImageFilter.h"
 #include "itkLinearInterpolateImageFunction.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
 #include "itkBSplineInterpolateImageFunction.h"
 #include "itkSize.h"
 
@@ -64,6 +65,14 @@ namespace itk
  * This filter is implemented as a multithreaded filter.  It provides a
  * ThreadedGenerateData() method for its implementation.
  *
+ * When the transform is linear (for instance a subclass of
+ * MatrixOffsetTransformBase), the output is computed scanline by
+ * scanline by adding a constant increment to the continuous index in the
+ * input image. If in addition the interpolator is a
+ * LinearInterpolateImageFunction or a
+ * NearestNeighborInterpolateImageFunction, the interpolation is inlined
+ * in the scanline loop.
+ *
  * \ingroup GeometricTransforms
  */
 template< class TInputImage,
@@ -119,6 +128,11 @@ public:
   typedef typename LinearInterpolatorType::Pointer
   LinearInterpolatorPointerType;
 
+  typedef NearestNeighborInterpolateImageFunction< InputImageType,
+                                                   TInterpolatorPrecisionType >   NearestNeighborInterpolatorType;
+  typedef typename NearestNeighborInterpolatorType::Pointer
+  NearestNeighborInterpolatorPointerType;
+
   typedef BSplineInterpolateImageFunction< InputImageType,
                                            TInterpolatorPrecisionType >   BSplineInterpolatorType;
   typedef typename BSplineInterpolatorType::Pointer
@@ -285,6 +299,17 @@ protected:
                                   outputRegionForThread,
                                   int threadId);
 
+  /** Implementation for resampling with linear transformation types
+   * and an interpolator whose exact type is known at compile time. The
+   * interpolation is done by one of the InlinedLinearInterpolator or
+   * InlinedNearestNeighborInterpolator helpers below, which the compiler
+   * inlines in the scanline loop. */
+  template< class TInlinedInterpolator >
+  void InlinedLinearThreadedGenerateData(const TInlinedInterpolator & interpolator,
+                                         const OutputImageRegionType &
+                                         outputRegionForThread,
+                                         int threadId);
+
 private:
   ResampleImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);      //purposely not implemented
@@ -312,6 +337,142 @@ private:
   LinearInterpolatorPointerType  m_LinearInterpolator;
   bool                           m_InterpolatorIsBSpline;
   BSplineInterpolatorPointerType m_BSplineInterpolator;
+
+  // True when the interpolator is exactly of the type used by the
+  // inlined fast path, and not a subclass that may override Evaluate.
+  bool m_InterpolatorIsExactlyLinear;
+  bool m_InterpolatorIsNearestNeighbor;
+
+  typedef typename InterpolatorType::OutputType          InterpolatorOutputType;
+  typedef typename InterpolatorType::ContinuousIndexType InputContinuousIndexType;
+  typedef typename InputImageType::IndexType             InputIndexType;
+  typedef typename InputImageType::OffsetValueType       InputOffsetValueType;
+  typedef typename InputImageType::InternalPixelType     InputInternalPixelType;
+  typedef typename InputImageType::AccessorFunctorType   InputAccessorFunctorType;
+
+  /** Evaluates a LinearInterpolateImageFunction directly on the input
+   * buffer. For images of up to three dimensions the interpolation is
+   * done as in LinearInterpolateImageFunction, one dimension after the
+   * other, so the result is the same. Neighbors are reached through the
+   * offset table instead of computing the offset of each of them. */
+  class InlinedLinearInterpolator
+  {
+public:
+    InlinedLinearInterpolator(const LinearInterpolatorType *interpolator):
+      m_Interpolator(interpolator)
+    {
+      const InputImageType *image = interpolator->GetInputImage();
+
+      m_Buffer = image->GetBufferPointer();
+      m_StartIndex = interpolator->GetStartIndex();
+      m_EndIndex = interpolator->GetEndIndex();
+      for ( unsigned int dim = 0; dim < ImageDimension; dim++ )
+        {
+        m_OffsetTable[dim] = image->GetOffsetTable()[dim];
+        }
+
+      typename InputImageType::AccessorType accessor = image->GetPixelAccessor();
+      m_AccessorFunctor.SetPixelAccessor(accessor);
+      m_AccessorFunctor.SetBegin(m_Buffer);
+    }
+
+    inline bool IsInsideBuffer(const InputContinuousIndexType & index) const
+    {
+      return m_Interpolator->LinearInterpolatorType::IsInsideBuffer(index);
+    }
+
+    inline InterpolatorOutputType Evaluate(const InputContinuousIndexType & index) const
+    {
+      if ( ImageDimension > 3 )
+        {
+        return m_Interpolator->LinearInterpolatorType::EvaluateAtContinuousIndex(index);
+        }
+
+      typedef typename LinearInterpolatorType::IndexValueType IndexValueType;
+      typedef typename NumericTraits< InputPixelType >::RealType RealType;
+
+      // Offset of the base pixel and, for each dimension, the step to
+      // the upper neighbor (zero on the upper border) and the distance.
+      const unsigned int Neighbors = 1 << ImageDimension;
+      InputOffsetValueType offset = 0;
+      InputOffsetValueType step[ImageDimension];
+      double               distance[ImageDimension];
+      for ( unsigned int dim = 0; dim < ImageDimension; dim++ )
+        {
+        IndexValueType base = Math::Floor< IndexValueType >(index[dim]);
+        if ( base < m_StartIndex[dim] )
+          {
+          base = m_StartIndex[dim];
+          distance[dim] = 0.0;
+          }
+        else
+          {
+          distance[dim] = index[dim] - static_cast< double >( base );
+          }
+        step[dim] = ( base < m_EndIndex[dim] ) ? m_OffsetTable[dim] : 0;
+        offset += ( base - m_StartIndex[dim] ) * m_OffsetTable[dim];
+        }
+
+      RealType values[Neighbors];
+      for ( unsigned int counter = 0; counter < Neighbors; counter++ )
+        {
+        InputOffsetValueType neighbor = offset;
+        for ( unsigned int dim = 0; dim < ImageDimension; dim++ )
+          {
+          if ( counter & ( 1 << dim ) )
+            {
+            neighbor += step[dim];
+            }
+          }
+        values[counter] =
+          static_cast< RealType >( m_AccessorFunctor.Get( *( m_Buffer + neighbor ) ) );
+        }
+
+      // Interpolate along the first dimension, then along the second on
+      // the results, and so on.
+      unsigned int remaining = Neighbors;
+      for ( unsigned int dim = 0; dim < ImageDimension; dim++ )
+        {
+        remaining >>= 1;
+        for ( unsigned int i = 0; i < remaining; i++ )
+          {
+          values[i] = values[2 * i] + ( values[2 * i + 1] - values[2 * i] ) * distance[dim];
+          }
+        }
+
+      return static_cast< InterpolatorOutputType >( values[0] );
+    }
+
+private:
+    const LinearInterpolatorType *m_Interpolator;
+    const InputInternalPixelType *m_Buffer;
+    InputAccessorFunctorType      m_AccessorFunctor;
+    InputIndexType                m_StartIndex;
+    InputIndexType                m_EndIndex;
+    InputOffsetValueType          m_OffsetTable[ImageDimension];
+  };
+
+  /** Calls a NearestNeighborInterpolateImageFunction without virtual
+   * dispatch. */
+  class InlinedNearestNeighborInterpolator
+  {
+public:
+    InlinedNearestNeighborInterpolator(const NearestNeighborInterpolatorType *interpolator):
+      m_Interpolator(interpolator) {}
+
+    inline bool IsInsideBuffer(const InputContinuousIndexType & index) const
+    {
+      return m_Interpolator->NearestNeighborInterpolatorType::IsInsideBuffer(index);
+    }
+
+    inline InterpolatorOutputType Evaluate(const InputContinuousIndexType & index) const
+    {
+      return m_Interpolator->NearestNeighborInterpolatorType::EvaluateAtContinuousIndex(index);
+    }
+
+private:
+    const NearestNeighborInterpolatorType *m_Interpolator;
+  };
 };
 } // end namespace itk
 
@@ -26,6 +26,8 @@
 #include "itkImageLinearIteratorWithIndex.h"
 #include "itkSpecialCoordinatesImage.h"
 
+#include <typeinfo>
+
 namespace itk
 {
 /**
@@ -59,6 +61,9 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
   m_Interpolator = dynamic_cast< InterpolatorType * >
                    ( m_LinearInterpolator.GetPointer() );
 
+  m_InterpolatorIsExactlyLinear = true;
+  m_InterpolatorIsNearestNeighbor = false;
+
   m_DefaultPixelValue = 0;
 }
 
@@ -210,6 +215,16 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
       m_LinearInterpolator = test2Ptr;
       }
     }
+
+  // The inlined fast path calls the interpolator without virtual
+  // dispatch, so it is only used when the interpolator is not a subclass.
+  const std::type_info & interpolatorType = typeid( *m_Interpolator );
+
+  m_InterpolatorIsExactlyLinear = m_InterpolatorIsLinear
+                                  && interpolatorType == typeid( LinearInterpolatorType );
+
+  m_InterpolatorIsNearestNeighbor =
+    ( interpolatorType == typeid( NearestNeighborInterpolatorType ) );
 }
 
 /**
@@ -538,6 +553,27 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
                              outputRegionForThread,
                              int threadId)
 {
+  // Use the inlined scanline loop when the exact type of the
+  // interpolator is known.
+  if ( m_InterpolatorIsExactlyLinear )
+    {
+    const InlinedLinearInterpolator interpolator( m_LinearInterpolator.GetPointer() );
+    this->InlinedLinearThreadedGenerateData(interpolator,
+                                            outputRegionForThread,
+                                            threadId);
+    return;
+    }
+
+  if ( m_InterpolatorIsNearestNeighbor )
+    {
+    const InlinedNearestNeighborInterpolator interpolator(
+      static_cast< const NearestNeighborInterpolatorType * >( m_Interpolator.GetPointer() ) );
+    this->InlinedLinearThreadedGenerateData(interpolator,
+                                            outputRegionForThread,
+                                            threadId);
+    return;
+    }
+
   // Get the output pointers
   OutputImagePointer outputPtr = this->GetOutput();
 
@@ -806,6 +842,148 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
   return;
 }
 
+template< class TInputImage,
+          class TOutputImage,
+          class TInterpolatorPrecisionType >
+template< class TInlinedInterpolator >
+void
+ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+::InlinedLinearThreadedGenerateData(const TInlinedInterpolator & interpolator,
+                                    const OutputImageRegionType &
+                                    outputRegionForThread,
+                                    int threadId)
+{
+  // Get the output pointers
+  OutputImagePointer outputPtr = this->GetOutput();
+
+  // Get ths input pointers
+  InputImageConstPointer inputPtr = this->GetInput();
+
+  // Create an iterator that will walk the output region for this thread.
+  typedef ImageLinearIteratorWithIndex< TOutputImage > OutputIterator;
+
+  OutputIterator outIt(outputPtr, outputRegionForThread);
+  outIt.SetDirection(0);
+
+  PointType outputPoint;
+  PointType inputPoint;
+  PointType tmpOutputPoint;
+  PointType tmpInputPoint;
+
+  InputContinuousIndexType inputIndex;
+  InputContinuousIndexType tmpInputIndex;
+
+  typedef typename PointType::VectorType VectorType;
+  VectorType delta;
+  IndexType  index;
+
+  // Support for progress methods/callbacks
+  ProgressReporter progress( this,
+                             threadId,
+                             outputRegionForThread.GetNumberOfPixels() );
+
+  typedef InterpolatorOutputType OutputType;
+
+  const PixelType defaultValue = this->GetDefaultPixelValue();
+
+  const PixelType minValue =  NumericTraits< PixelType >::NonpositiveMin();
+  const PixelType maxValue =  NumericTraits< PixelType >::max();
+
+  const OutputType minOutputValue = static_cast< OutputType >( minValue );
+  const OutputType maxOutputValue = static_cast< OutputType >( maxValue );
+
+  const TransformType *transform;
+
+  if ( threadId > 0 )
+    {
+    transform = this->m_ThreaderTransform[threadId - 1];
+    }
+  else
+    {
+    transform = this->m_Transform;
+    }
+
+  // The increment of the continuous index between two adjacent pixels of
+  // an output scanline, as in LinearThreadedGenerateData().
+  index = outIt.GetIndex();
+  outputPtr->TransformIndexToPhysicalPoint(index, outputPoint);
+  inputPoint = transform->TransformPoint(outputPoint);
+  inputPtr->TransformPhysicalPointToContinuousIndex(inputPoint, inputIndex);
+
+  ++index[0];
+  outputPtr->TransformIndexToPhysicalPoint(index, tmpOutputPoint);
+  tmpInputPoint = transform->TransformPoint(tmpOutputPoint);
+  inputPtr->TransformPhysicalPointToContinuousIndex(tmpInputPoint,
+                                                    tmpInputIndex);
+  delta = tmpInputIndex - inputIndex;
+
+  const double precisionConstant = 1 << ( NumericTraits< double >::digits >> 1 );
+
+  while ( !outIt.IsAtEnd() )
+    {
+    index = outIt.GetIndex();
+    outputPtr->TransformIndexToPhysicalPoint(index, outputPoint);
+    inputPoint = transform->TransformPoint(outputPoint);
+    inputPtr->TransformPhysicalPointToContinuousIndex(inputPoint, inputIndex);
+
+    // Truncate the start index to the same precision as
+    // LinearThreadedGenerateData() so that both paths agree.
+    for ( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+      long roundedInputIndex = (long)( inputIndex[i] );
+      if ( inputIndex[i] < 0.0 && inputIndex[i] != (double)roundedInputIndex )
+        {
+        --roundedInputIndex;
+        }
+      double inputIndexFrac = inputIndex[i] - roundedInputIndex;
+      double newInputIndexFrac = (long)( precisionConstant
+                                         * inputIndexFrac )
+                                 / precisionConstant;
+      inputIndex[i] = roundedInputIndex + newInputIndexFrac;
+      }
+
+    while ( !outIt.IsAtEndOfLine()
+            && !interpolator.IsInsideBuffer(inputIndex) )
+      {
+      outIt.Set(defaultValue);
+      progress.CompletedPixel();
+      ++outIt;
+      inputIndex += delta;
+      }
+
+    // The buffer is convex, so the scanline leaves it at most once.
+    while ( !outIt.IsAtEndOfLine()
+            && interpolator.IsInsideBuffer(inputIndex) )
+      {
+      const OutputType value = interpolator.Evaluate(inputIndex);
+      if ( value <  minOutputValue )
+        {
+        outIt.Set(minValue);
+        }
+      else if ( value > maxOutputValue )
+        {
+        outIt.Set(maxValue);
+        }
+      else
+        {
+        outIt.Set( static_cast< PixelType >( value ) );
+        }
+      progress.CompletedPixel();
+      ++outIt;
+      inputIndex += delta;
+      }
+
+    while ( !outIt.IsAtEndOfLine() )
+      {
+      outIt.Set(defaultValue);
+      progress.CompletedPixel();
+      ++outIt;
+      }
+
+    outIt.NextLine();
+    }
+}
+
 /**
  * Inform pipeline of necessary input image region
  *
@@ -160,6 +160,14 @@ public:
   /** Set On/Off whether spacing is used. */
   itkBooleanMacro(UseImageSpacing);
 
+  /** Set/Get whether the internal distance map filters use the exact,
+   * multithreaded separable algorithm.  See
+   * DanielssonDistanceMapImageFilter::SetUseSeparableAlgorithm().  Off by
+   * default. */
+  itkSetMacro(UseSeparableAlgorithm, bool);
+  itkGetConstReferenceMacro(UseSeparableAlgorithm, bool);
+  itkBooleanMacro(UseSeparableAlgorithm);
+
   /** Set if the inside represents positive values in the signed distance
    *  map. By convention ON pixels are treated as inside pixels.           */
   itkSetMacro(InsideIsPositive, bool);
@@ -222,6 +230,7 @@ private:
   bool m_SquaredDistance;
   bool m_UseImageSpacing;
   bool m_InsideIsPositive; // ON is treated as inside pixels
+  bool m_UseSeparableAlgorithm;
 };                         // end of SignedDanielssonDistanceMapImageFilter
                            // class
 } //end namespace itk
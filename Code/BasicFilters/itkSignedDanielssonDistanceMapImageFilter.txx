@@ -46,6 +46,7 @@ SignedDanielssonDistanceMapImageFilter< TInputImage, TOutputImage >
                                         //doesn't make sense in a SignedDaniel
   this->m_UseImageSpacing     = false;
   this->m_InsideIsPositive    = false;
+  this->m_UseSeparableAlgorithm = false;
 }
 
 /** This is overloaded to create the VectorDistanceMap output image */
@@ -124,6 +125,10 @@ void SignedDanielssonDistanceMapImageFilter< TInputImage, TOutputImage >
   filter2->SetUseImageSpacing(m_UseImageSpacing);
   filter1->SetSquaredDistance(m_SquaredDistance);
   filter2->SetSquaredDistance(m_SquaredDistance);
+  filter1->SetUseSeparableAlgorithm(m_UseSeparableAlgorithm);
+  filter2->SetUseSeparableAlgorithm(m_UseSeparableAlgorithm);
+  filter1->SetNumberOfThreads( this->GetNumberOfThreads() );
+  filter2->SetNumberOfThreads( this->GetNumberOfThreads() );
 
   //Invert input image for second Danielsson filter
   typedef typename InputImageType::PixelType                InputPixelType;
@@ -207,6 +212,7 @@ void SignedDanielssonDistanceMapImageFilter< TInputImage, TOutputImage >
   os << indent << "Use Image Spacing : " << m_UseImageSpacing << std::endl;
   os << indent << "Squared Distance  : " << m_SquaredDistance << std::endl;
   os << indent << "Inside is positive  : " << m_InsideIsPositive << std::endl;
+  os << indent << "Use Separable Algorithm : " << m_UseSeparableAlgorithm << std::endl;
 }
 } // end namespace itk
 
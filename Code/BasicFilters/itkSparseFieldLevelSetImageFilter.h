@@ -19,6 +19,7 @@
 #define __itkSparseFieldLevelSetImageFilter_h
 
 #include "itkFiniteDifferenceImageFilter.h"
+#include "itkLevelSetFunction.h"
 #include "itkMultiThreader.h"
 #include "itkSparseFieldLayer.h"
 #include "itkObjectStore.h"
@@ -162,6 +163,20 @@ private:
  *  layers according to their neighbors.  At the very outer layers, add or
  *  remove indicies which have come into or moved out of the sparse field.
  *
+ * \par
+ *  Steps 1 and 3 are multithreaded: the nodes of a layer are copied into a
+ *  contiguous array which is split in chunks among the threads, and the
+ *  layers are then modified by a single thread in the order of the lists.
+ *  Step 2 depends on the order in which the active layer is visited and is
+ *  not threaded.  The difference function is therefore called from
+ *  several threads at once; ComputeUpdate() may only modify the global
+ *  data it is given.  The level set functions of the toolkit, and the
+ *  shape signed distance functions used by the shape prior functions,
+ *  follow this rule.  The global data of the threads are combined before
+ *  the time step is computed, so for the level set functions the result
+ *  does not depend on the number of threads.  For other functions the
+ *  smallest time step of the chunks is used.
+ *
  * \par HOW TO USE THIS CLASS
  *  Typically, this class should be subclassed with additional functionality
  *  for specific applications.  It is possible, however to use this solver as a
@@ -309,6 +324,16 @@ public:
   void InterpolateSurfaceLocationOff()
   { this->SetInterpolateSurfaceLocation(false); }
 
+  /** Set/Get the number of iterations between two compactions of the
+   *  layers.  A compaction sorts the nodes of each layer by their offset in
+   *  the image and stores them at increasing memory addresses, so that the
+   *  layers are traversed with sequential memory accesses.  The order of the
+   *  nodes changes the order in which the active layer is updated, so the
+   *  result is not bit-identical to the result without compaction, and the
+   *  compaction is therefore opt-in.  Zero, the default, disables it. */
+  itkSetMacro(LayerCompactionInterval, unsigned int);
+  itkGetConstMacro(LayerCompactionInterval, unsigned int);
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro( OutputEqualityComparableCheck,
@@ -363,9 +388,17 @@ protected:
   void ApplyUpdate(TimeStepType dt);
 
   /** Traverses the active layer list and calculates the change at these
-   *  indicies to be applied in the current iteration. */
+   *  indicies to be applied in the current iteration.  The active layer is
+   *  copied into a contiguous array which is split in chunks among the
+   *  threads. */
   TimeStepType CalculateChange();
 
+  /** Calculates the change for the nodes [first, last) of the active layer
+   *  array and stores it in the update buffer.  The difference function
+   *  collects the data of its time step in globalData. */
+  void ThreadedCalculateChange(unsigned int first, unsigned int last,
+                               void *globalData);
+
   /** Initializes a layer of the sparse field using a previously initialized
    * layer. Builds the list of nodes in m_Layer[to] using m_Layer[from].
    * Marks values in the m_StatusImage. */
@@ -380,6 +413,10 @@ protected:
   /** Initializes the values of the active layer set. */
   void InitializeActiveLayerValues();
 
+  /** Sorts every layer by image offset and gives each layer a contiguous
+   *  range of the node storage, in order of memory address. */
+  void CompactLayers();
+
   /** Adjusts the values in a single layer "to" using values in a neighboring
    *  layer "from".  The list of indicies in "to" are traversed and assigned
    *  new values appropriately. Any indicies in "to" without neighbors in
@@ -390,6 +427,14 @@ protected:
   void PropagateLayerValues(StatusType from, StatusType to,
                             StatusType promote, int InOrOut);
 
+  /** Computes the new values of the nodes [first, last) of the layer array
+   *  from their neighbors in layer "from".  This is the part of
+   *  PropagateLayerValues which is done by several threads; the layers are
+   *  modified afterwards by a single thread. */
+  void ThreadedPropagateLayerValues(StatusType from, StatusType to,
+                                    int InOrOut,
+                                    unsigned int first, unsigned int last);
+
   /** Adjusts the values associated with all the index layers of the sparse
    * field by propagating out one layer at a time from the active set. This
    * method also takes care of deleting nodes from the layers which have been
@@ -486,6 +531,9 @@ protected:
       default this is turned on. Subclasses which do not sample propagation
       (speed), advection, or curvature terms should turn this flag off. */
   bool m_InterpolateSurfaceLocation;
+
+  /** Number of iterations between two compactions of the layers. */
+  unsigned int m_LayerCompactionInterval;
 private:
   SparseFieldLevelSetImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);                 //purposely not implemented
@@ -493,6 +541,39 @@ private:
   /** This flag is true when methods need to check boundary conditions and
       false when methods do not need to check for boundary conditions. */
   bool m_BoundsCheckingActive;
+
+  /** Copies the nodes of a layer into m_LayerNodeArray and returns the
+   *  number of threads to use for processing them.  Small layers are
+   *  processed by a single thread. */
+  int CopyLayerToNodeArray(StatusType layer);
+
+  /** Structure for passing information into the static threader
+   *  callbacks. */
+  struct SparseFieldThreadStruct {
+    SparseFieldLevelSetImageFilter *Filter;
+    StatusType From;
+    StatusType To;
+    int InOrOut;
+    void **GlobalDataList;
+    ExceptionObject *ExceptionList;
+    bool *FailedList;
+  };
+
+  /** Splits the layer array among the threads and calls
+   *  ThreadedCalculateChange. */
+  static ITK_THREAD_RETURN_TYPE CalculateChangeThreaderCallback(void *arg);
+
+  /** Splits the layer array among the threads and calls
+   *  ThreadedPropagateLayerValues. */
+  static ITK_THREAD_RETURN_TYPE PropagateLayerValuesThreaderCallback(void *arg);
+
+  /** The nodes of the layer being processed by the threads, in the order
+   *  of the linked list. */
+  std::vector< LayerNodeType * > m_LayerNodeArray;
+
+  /** Per node results of ThreadedPropagateLayerValues. */
+  std::vector< ValueType >     m_PropagatedValues;
+  std::vector< unsigned char > m_PropagatedStatus;
 };
 } // end namespace itk
 
@@ -23,6 +23,7 @@
 #include "itkImageRegionIterator.h"
 #include "itkShiftScaleImageFilter.h"
 #include "itkNeighborhoodAlgorithm.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -136,6 +137,7 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
   m_LayerNodeStore->SetGrowthStrategyToExponential();
   this->SetRMSChange( static_cast< double >( m_ValueZero ) );
   m_InterpolateSurfaceLocation = true;
+  m_LayerCompactionInterval = 0;
   m_BoundsCheckingActive = false;
   m_ConstantGradientValue = 1.0;
 }
@@ -216,6 +218,57 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
   // Finally, we update all of the layer values (excluding the active layer,
   // which has already been updated).
   this->PropagateAllLayerValues();
+
+  // The nodes moved between the layers are scattered in memory and in the
+  // image.  Restore the locality of the layers from time to time.
+  if ( m_LayerCompactionInterval > 0
+       && ( this->GetElapsedIterations() + 1 ) % m_LayerCompactionInterval == 0 )
+    {
+    this->CompactLayers();
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void
+SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
+::CompactLayers()
+{
+  typedef typename StatusImageType::OffsetValueType OffsetValueType;
+
+  // Take all the nodes out of the layers and sort the offsets of each
+  // layer.
+  std::vector< OffsetValueType > offsets;
+  std::vector< unsigned int >    layerEnd( m_Layers.size() );
+
+  m_LayerNodeArray.clear();
+  for ( unsigned int k = 0; k < m_Layers.size(); ++k )
+    {
+    LayerType *layer = m_Layers[k];
+    while ( !layer->Empty() )
+      {
+      LayerNodeType *node = layer->Front();
+      layer->PopFront();
+      m_LayerNodeArray.push_back(node);
+      offsets.push_back( m_StatusImage->ComputeOffset(node->m_Value) );
+      }
+    layerEnd[k] = static_cast< unsigned int >( offsets.size() );
+    std::sort( offsets.begin() + ( k == 0 ? 0 : layerEnd[k - 1] ), offsets.end() );
+    }
+
+  // Give each layer a contiguous range of the nodes, in order of their
+  // memory address, and link them in order of their offset.
+  std::sort( m_LayerNodeArray.begin(), m_LayerNodeArray.end() );
+
+  for ( unsigned int k = m_Layers.size(); k > 0; --k )
+    {
+    LayerType *        layer = m_Layers[k - 1];
+    const unsigned int begin = ( k == 1 ? 0 : layerEnd[k - 2] );
+    for ( unsigned int n = layerEnd[k - 1]; n > begin; --n )
+      {
+      m_LayerNodeArray[n - 1]->m_Value = m_StatusImage->ComputeIndex(offsets[n - 1]);
+      layer->PushFront(m_LayerNodeArray[n - 1]);
+      }
+    }
 }
 
 template< class TInputImage, class TOutputImage >
@@ -895,11 +948,170 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
   m_UpdateBuffer.reserve( m_Layers[0]->Size() );
 }
 
+template< class TInputImage, class TOutputImage >
+int
+SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
+::CopyLayerToNodeArray(StatusType layer)
+{
+  // Threads are not worth starting for less nodes than this.
+  const unsigned int MINIMUM_NODES_PER_THREAD = 1024;
+
+  m_LayerNodeArray.clear();
+  m_LayerNodeArray.reserve( m_Layers[layer]->Size() );
+
+  typename LayerType::Iterator layerIt;
+  for ( layerIt = m_Layers[layer]->Begin(); layerIt != m_Layers[layer]->End(); ++layerIt )
+    {
+    m_LayerNodeArray.push_back( layerIt.GetPointer() );
+    }
+
+  const unsigned int maximumNumberOfThreads =
+    static_cast< unsigned int >( m_LayerNodeArray.size() ) / MINIMUM_NODES_PER_THREAD;
+  if ( maximumNumberOfThreads < 1 )
+    {
+    return 1;
+    }
+  return vnl_math_min( this->GetNumberOfThreads(),
+                       static_cast< int >( maximumNumberOfThreads ) );
+}
+
 template< class TInputImage, class TOutputImage >
 typename
 SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >::TimeStepType
 SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
 ::CalculateChange()
+{
+  // The active layer is copied into contiguous memory and each thread
+  // processes one chunk of it.  The update values are stored in the same
+  // order as the nodes of the active layer.
+  const int threadCount = this->CopyLayerToNodeArray(0);
+
+  m_UpdateBuffer.clear();
+  m_UpdateBuffer.resize( m_LayerNodeArray.size() );
+
+  const typename Superclass::FiniteDifferenceFunctionType::Pointer df =
+    this->GetDifferenceFunction();
+
+  // Each thread has its own global data.
+  SparseFieldThreadStruct str;
+  str.Filter = this;
+  str.From = str.To = 0;
+  str.InOrOut = 0;
+  str.GlobalDataList = new void *[threadCount];
+  str.ExceptionList = new ExceptionObject[threadCount];
+  str.FailedList = new bool[threadCount];
+  for ( int i = 0; i < threadCount; ++i )
+    {
+    str.GlobalDataList[i] = df->GetGlobalDataPointer();
+    str.FailedList[i] = false;
+    }
+
+  this->GetMultiThreader()->SetNumberOfThreads(threadCount);
+  this->GetMultiThreader()->SetSingleMethod(this->CalculateChangeThreaderCallback,
+                                            &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  // The exceptions thrown by the difference function in the threads are
+  // thrown again here, in chunk order.
+  for ( int i = 0; i < threadCount; ++i )
+    {
+    if ( str.FailedList[i] )
+      {
+      ExceptionObject err = str.ExceptionList[i];
+      for ( int j = 0; j < threadCount; ++j )
+        {
+        df->ReleaseGlobalDataPointer(str.GlobalDataList[j]);
+        }
+      delete[] str.GlobalDataList;
+      delete[] str.ExceptionList;
+      delete[] str.FailedList;
+      throw err;
+      }
+    }
+
+  TimeStepType timeStep;
+  typedef LevelSetFunction< OutputImageType > LevelSetFunctionType;
+  const LevelSetFunctionType *levelSetFunction =
+    dynamic_cast< const LevelSetFunctionType * >( df.GetPointer() );
+  if ( levelSetFunction )
+    {
+    // The level set functions keep the largest changes of their terms,
+    // which combine into the global data of the whole active layer.  The
+    // time step is the one of a single thread.
+    for ( int i = 1; i < threadCount; ++i )
+      {
+      levelSetFunction->CombineGlobalData(str.GlobalDataList[0], str.GlobalDataList[i]);
+      }
+    timeStep = df->ComputeGlobalTimeStep(str.GlobalDataList[0]);
+    }
+  else
+    {
+    // Otherwise, the smallest time step of the chunks that hold nodes.
+    const unsigned long size = m_LayerNodeArray.size();
+    TimeStepType *      timeStepList = new TimeStepType[threadCount];
+    bool *              validTimeStepList = new bool[threadCount];
+    bool                valid = false;
+    for ( int i = 0; i < threadCount; ++i )
+      {
+      timeStepList[i] = df->ComputeGlobalTimeStep(str.GlobalDataList[i]);
+      validTimeStepList[i] = ( size * ( i + 1 ) / threadCount > size * i / threadCount );
+      valid |= validTimeStepList[i];
+      }
+    if ( !valid )
+      {
+      validTimeStepList[0] = true;
+      }
+    timeStep = this->ResolveTimeStep(timeStepList, validTimeStepList, threadCount);
+    delete[] timeStepList;
+    delete[] validTimeStepList;
+    }
+
+  for ( int i = 0; i < threadCount; ++i )
+    {
+    df->ReleaseGlobalDataPointer(str.GlobalDataList[i]);
+    }
+  delete[] str.GlobalDataList;
+  delete[] str.ExceptionList;
+  delete[] str.FailedList;
+
+  return timeStep;
+}
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
+::CalculateChangeThreaderCallback(void *arg)
+{
+  const int threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  const int threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  SparseFieldThreadStruct *str =
+    (SparseFieldThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  const unsigned long size = str->Filter->m_LayerNodeArray.size();
+  const unsigned int  first = static_cast< unsigned int >( size * threadId / threadCount );
+  const unsigned int  last = static_cast< unsigned int >( size * ( threadId + 1 ) / threadCount );
+
+  // An exception must not leave the thread; it is thrown again by
+  // CalculateChange.
+  try
+    {
+    str->Filter->ThreadedCalculateChange(first, last, str->GlobalDataList[threadId]);
+    }
+  catch ( ExceptionObject & err )
+    {
+    str->ExceptionList[threadId] = err;
+    str->FailedList[threadId] = true;
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
+::ThreadedCalculateChange(unsigned int first, unsigned int last,
+                          void *globalData)
 {
   const typename Superclass::FiniteDifferenceFunctionType::Pointer df =
     this->GetDifferenceFunction();
@@ -918,30 +1130,20 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
     MIN_NORM *= minSpacing;
     }
 
-  void *globalData = df->GetGlobalDataPointer();
-
-  typename LayerType::ConstIterator layerIt;
   NeighborhoodIterator< OutputImageType > outputIt( df->GetRadius(),
                                                     this->GetOutput(), this->GetOutput()->GetRequestedRegion() );
-  TimeStepType timeStep;
-
-  const NeighborhoodScalesType neighborhoodScales = this->GetDifferenceFunction()->ComputeNeighborhoodScales();
-
   if ( m_BoundsCheckingActive == false )
     {
     outputIt.NeedToUseBoundaryConditionOff();
     }
 
-  m_UpdateBuffer.clear();
-  m_UpdateBuffer.reserve( m_Layers[0]->Size() );
-
   // Calculates the update values for the active layer indicies in this
-  // iteration.  Iterates through the active layer index list, applying
+  // iteration.  Iterates through the active layer index array, applying
   // the level set function to the output image (level set image) at each
   // index.  Update values are stored in the update buffer.
-  for ( layerIt = m_Layers[0]->Begin(); layerIt != m_Layers[0]->End(); ++layerIt )
+  for ( unsigned int n = first; n < last; ++n )
     {
-    outputIt.SetLocation(layerIt->m_Value);
+    outputIt.SetLocation(m_LayerNodeArray[n]->m_Value);
 
     // Calculate the offset to the surface from the center of this
     // neighborhood.  This is used by some level set functions in sampling a
@@ -994,22 +1196,13 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
         offset[i] = ( offset[i] * centerValue ) / ( norm_grad_phi_squared + MIN_NORM );
         }
 
-      m_UpdateBuffer.push_back( df->ComputeUpdate(outputIt, globalData, offset) );
+      m_UpdateBuffer[n] = df->ComputeUpdate(outputIt, globalData, offset);
       }
     else // Don't do interpolation
       {
-      m_UpdateBuffer.push_back( df->ComputeUpdate(outputIt, globalData) );
+      m_UpdateBuffer[n] = df->ComputeUpdate(outputIt, globalData);
       }
     }
-
-  // Ask the finite difference function to compute the time step for
-  // this iteration.  We give it the global data pointer to use, then
-  // ask it to free the global data memory.
-  timeStep = df->ComputeGlobalTimeStep(globalData);
-
-  df->ReleaseGlobalDataPointer(globalData);
-
-  return timeStep;
 }
 
 template< class TInputImage, class TOutputImage >
@@ -1037,25 +1230,114 @@ void
 SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
 ::PropagateLayerValues(StatusType from, StatusType to,
                        StatusType promote, int InOrOut)
+{
+  LayerNodeType *node;
+  StatusType     past_end = static_cast< StatusType >( m_Layers.size() ) - 1;
+
+  // The new values of the "to" layer only depend on the values in the
+  // "from" layer, so they are computed by several threads over chunks of
+  // the layer.  The nodes are then moved between the layers in the order
+  // of the list by this thread.
+  const int threadCount = this->CopyLayerToNodeArray(to);
+
+  m_PropagatedValues.resize( m_LayerNodeArray.size() );
+  m_PropagatedStatus.resize( m_LayerNodeArray.size() );
+
+  SparseFieldThreadStruct str;
+  str.Filter = this;
+  str.From = from;
+  str.To = to;
+  str.InOrOut = InOrOut;
+  str.GlobalDataList = 0;
+  str.ExceptionList = 0;
+  str.FailedList = 0;
+
+  this->GetMultiThreader()->SetNumberOfThreads(threadCount);
+  this->GetMultiThreader()->SetSingleMethod(this->PropagateLayerValuesThreaderCallback,
+                                            &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  const unsigned int size = static_cast< unsigned int >( m_LayerNodeArray.size() );
+  for ( unsigned int n = 0; n < size; ++n )
+    {
+    node = m_LayerNodeArray[n];
+
+    if ( m_PropagatedStatus[n] == 0 )
+      {
+      // This index was marked for deletion: the status image has been
+      // marked with another layer's value.
+      m_Layers[to]->Unlink(node);
+      m_LayerNodeStore->Return(node);
+      }
+    else if ( m_PropagatedStatus[n] == 1 )
+      {
+      // Set the new value using the smallest distance
+      // found in our "from" neighbors.
+      this->GetOutput()->SetPixel(node->m_Value, m_PropagatedValues[n]);
+      }
+    else
+      {
+      // Did not find any neighbors on the "from" list, then promote this
+      // node.  A "promote" value past the end of my sparse field size
+      // means delete the node instead.  Change the status value in the
+      // status image accordingly.
+      m_Layers[to]->Unlink(node);
+      if ( promote > past_end )
+        {
+        m_LayerNodeStore->Return(node);
+        m_StatusImage->SetPixel(node->m_Value, m_StatusNull);
+        }
+      else
+        {
+        m_Layers[promote]->PushFront(node);
+        m_StatusImage->SetPixel(node->m_Value, promote);
+        }
+      }
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
+::PropagateLayerValuesThreaderCallback(void *arg)
+{
+  const int threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  const int threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  SparseFieldThreadStruct *str =
+    (SparseFieldThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  const unsigned long size = str->Filter->m_LayerNodeArray.size();
+  const unsigned int  first = static_cast< unsigned int >( size * threadId / threadCount );
+  const unsigned int  last = static_cast< unsigned int >( size * ( threadId + 1 ) / threadCount );
+
+  str->Filter->ThreadedPropagateLayerValues(str->From, str->To, str->InOrOut,
+                                            first, last);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
+::ThreadedPropagateLayerValues(StatusType from, StatusType to, int InOrOut,
+                               unsigned int first, unsigned int last)
 {
   unsigned int i;
   ValueType    value, value_temp, delta;
 
   value = NumericTraits< ValueType >::Zero; // warnings
   bool found_neighbor_flag;
-  typename LayerType::Iterator toIt;
-  LayerNodeType *node;
-  StatusType     past_end = static_cast< StatusType >( m_Layers.size() ) - 1;
 
   // Are we propagating values inward (more negative) or outward (more
   // positive)?
   if ( InOrOut == 1 ) { delta = -m_ConstantGradientValue; }
   else { delta = m_ConstantGradientValue; }
 
-  NeighborhoodIterator< OutputImageType >
+  ConstNeighborhoodIterator< OutputImageType >
   outputIt( m_NeighborList.GetRadius(), this->GetOutput(),
             this->GetOutput()->GetRequestedRegion() );
-  NeighborhoodIterator< StatusImageType >
+  ConstNeighborhoodIterator< StatusImageType >
   statusIt( m_NeighborList.GetRadius(), m_StatusImage,
             this->GetOutput()->GetRequestedRegion() );
 
@@ -1065,24 +1347,23 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
     statusIt.NeedToUseBoundaryConditionOff();
     }
 
-  toIt  = m_Layers[to]->Begin();
-  while ( toIt != m_Layers[to]->End() )
+  // The status of the nodes is recorded as 0 for a node marked for
+  // deletion, 1 for a node with a new value and 2 for a node without
+  // neighbors in the "from" layer.
+  for ( unsigned int n = first; n < last; ++n )
     {
-    statusIt.SetLocation(toIt->m_Value);
+    statusIt.SetLocation(m_LayerNodeArray[n]->m_Value);
 
     // Is this index marked for deletion? If the status image has
     // been marked with another layer's value, we need to delete this node
-    // from the current list then skip to the next iteration.
+    // from the current list.
     if ( statusIt.GetCenterPixel() != to )
       {
-      node = toIt.GetPointer();
-      ++toIt;
-      m_Layers[to]->Unlink(node);
-      m_LayerNodeStore->Return(node);
+      m_PropagatedStatus[n] = 0;
       continue;
       }
 
-    outputIt.SetLocation(toIt->m_Value);
+    outputIt.SetLocation(m_LayerNodeArray[n]->m_Value);
 
     found_neighbor_flag = false;
     for ( i = 0; i < m_NeighborList.GetSize(); ++i )
@@ -1122,30 +1403,12 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
       }
     if ( found_neighbor_flag == true )
       {
-      // Set the new value using the smallest distance
-      // found in our "from" neighbors.
-      outputIt.SetCenterPixel(value + delta);
-      ++toIt;
+      m_PropagatedValues[n] = value + delta;
+      m_PropagatedStatus[n] = 1;
       }
     else
       {
-      // Did not find any neighbors on the "from" list, then promote this
-      // node.  A "promote" value past the end of my sparse field size
-      // means delete the node instead.  Change the status value in the
-      // status image accordingly.
-      node  = toIt.GetPointer();
-      ++toIt;
-      m_Layers[to]->Unlink(node);
-      if ( promote > past_end )
-        {
-        m_LayerNodeStore->Return(node);
-        statusIt.SetCenterPixel(m_StatusNull);
-        }
-      else
-        {
-        m_Layers[promote]->PushFront(node);
-        statusIt.SetCenterPixel(promote);
-        }
+      m_PropagatedStatus[n] = 2;
       }
     }
 }
@@ -1198,6 +1461,7 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
   os << indent << "m_IsoSurfaceValue: " << m_IsoSurfaceValue << std::endl;
   os << indent << "m_LayerNodeStore: " << std::endl;
   m_LayerNodeStore->Print( os, indent.GetNextIndent() );
+  os << indent << "m_LayerCompactionInterval: " << m_LayerCompactionInterval << std::endl;
   os << indent << "m_BoundsCheckingActive: " << m_BoundsCheckingActive;
   for ( i = 0; i < m_Layers.size(); i++ )
     {
@@ -189,6 +189,12 @@ public:
    * for each thread by the finite difference solver filters. */
   virtual TimeStepType ComputeGlobalTimeStep(void *GlobalData) const;
 
+  /** Combines into GlobalData the global data of another set of pixels, so
+   * that ComputeGlobalTimeStep() returns the time step of the union of the
+   * two sets.  Used by the solvers that give each thread its own global
+   * data. */
+  virtual void CombineGlobalData(void *GlobalData, const void *OtherGlobalData) const;
+
   /** Returns a pointer to a global data structure that is passed to this
    * object from the solver at each calculation.  The idea is that the solver
    * holds the state of any global values needed to calculate the time step,
@@ -269,6 +269,19 @@ LevelSetFunction< TImageType >
   return dt;
 }
 
+template< class TImageType >
+void
+LevelSetFunction< TImageType >
+::CombineGlobalData(void *GlobalData, const void *OtherGlobalData) const
+{
+  GlobalDataStruct *      d = (GlobalDataStruct *)GlobalData;
+  const GlobalDataStruct *o = (const GlobalDataStruct *)OtherGlobalData;
+
+  d->m_MaxAdvectionChange = vnl_math_max(d->m_MaxAdvectionChange, o->m_MaxAdvectionChange);
+  d->m_MaxPropagationChange = vnl_math_max(d->m_MaxPropagationChange, o->m_MaxPropagationChange);
+  d->m_MaxCurvatureChange = vnl_math_max(d->m_MaxCurvatureChange, o->m_MaxCurvatureChange);
+}
+
 template< class TImageType >
 void
 LevelSetFunction< TImageType >
@@ -186,9 +186,8 @@ private:
   /** transform and interpolator/extrapolator for image interpolation */
   typename TransformType::Pointer m_Transform;
 
-  InterpolatorPointerVector     m_Interpolators;
-  ExtrapolatorPointerVector     m_Extrapolators;
-  mutable FunctionPointerVector m_Selectors;
+  InterpolatorPointerVector m_Interpolators;
+  ExtrapolatorPointerVector m_Extrapolators;
 
   /** shape and pose parameters */
   ParametersType m_WeightOfPrincipalComponents;
@@ -22,6 +22,8 @@
 #include "itkConstantBoundaryCondition.h"
 #include "itkInterpolateImageFunction.h"
 
+#include <vector>
+
 namespace itk
 {
 namespace Function
@@ -214,23 +216,25 @@ private:
  * The fifth (TCoordRep) is again standard for interpolating functions,
  * and should be float or double.
  *
- * \par CAVEATS
+ * \par PERFORMANCE
+ *
+ * The computational expense comes from two sources: computing the
+ * kernel weights K(t) and multiplying the pixels in the window by the
+ * kernel weights. The weights are computed in \f$ 2 m d \f$ kernel
+ * evaluations (where d is the dimensionality of the image). The kernel
+ * is separable, so the pixels are combined one dimension at a time by
+ * keeping intermediate sums, in \f$ O ( (2m)^d ) \f$ operations. When
+ * the window lies inside the buffered region of the image, the pixels
+ * are read directly from the buffer and the boundary condition is not
+ * used.
  *
- * There are a few improvements that an enthusiasting ITK developer
- * could make to this filter. One issue is with the way that the kernel
- * is applied. The computational expense comes from two sources:
- * computing the kernel weights K(t) and multiplying the pixels in the
- * window by the kernel weights. The first is done more or less
- * efficiently in \f$ 2 m d \f$ operations (where d is the
- * dimensionality of the image). The second can be done
- * better. Presently, each pixel \f$ I(i,j,k) \f$ is multiplied by the
- * weights \f$ K(x-i), K(y-j), K(z-k) \f$ and added to the running
- * total. This results in \f$ d (2m)^d \f$ multiplication
- * operations. However, by keeping intermediate sums, it would be
- * possible to do the operation in \f$ O ( (2m)^d ) \f$
- * operations. This would require some creative coding. In addition, in
- * the case when one of the coordinates is integer, the computation
- * could be reduced by an order of magnitude.
+ * \par
+ * Each kernel evaluation calls the sinc and the window function. With
+ * UseKernelLookupTable on, K(t) is instead read from a table sampled
+ * KernelLookupTableResolution times per pixel and linearly interpolated,
+ * which makes the weights much cheaper for a small loss of accuracy. The
+ * table assumes that the window function is symmetric, which is the case
+ * of all the window functions defined here.
  *
  * \sa LinearInterpolateImageFunction ResampleImageFilter
  * \sa Function::HammingWindowFunction
@@ -297,6 +301,19 @@ public:
   virtual OutputType EvaluateAtContinuousIndex(
     const ContinuousIndexType & index) const;
 
+  /** Set/Get whether the kernel is read from a precomputed table
+   * instead of evaluating the sinc and the window functions for each
+   * weight. The default is false. */
+  virtual void SetUseKernelLookupTable(bool flag);
+  itkGetConstMacro(UseKernelLookupTable, bool);
+  itkBooleanMacro(UseKernelLookupTable);
+
+  /** Set/Get the number of samples of the kernel lookup table per
+   * pixel. Between samples the kernel is linearly interpolated. The
+   * default is 1000. */
+  virtual void SetKernelLookupTableResolution(unsigned int resolution);
+  itkGetConstMacro(KernelLookupTableResolution, unsigned int);
+
 protected:
   WindowedSincInterpolateImageFunction();
   virtual ~WindowedSincInterpolateImageFunction();
@@ -311,6 +328,10 @@ private:
   typedef ConstNeighborhoodIterator<
     ImageType, TBoundaryCondition > IteratorType;
 
+  typedef typename ImageType::OffsetValueType     OffsetValueType;
+  typedef typename ImageType::InternalPixelType   InternalPixelType;
+  typedef typename ImageType::AccessorFunctorType AccessorFunctorType;
+
   // Constant to store twice the radius
   static const unsigned int m_WindowSize;
 
@@ -327,6 +348,17 @@ private:
   /** Index into the weights array for each offset */
   unsigned int **m_WeightOffsetTable;
 
+  /** Offset in the image buffer of each neighbor from the base pixel */
+  std::vector< OffsetValueType > m_BufferOffsetTable;
+
+  /** Kernel lookup table */
+  bool                  m_UseKernelLookupTable;
+  unsigned int          m_KernelLookupTableResolution;
+  std::vector< double > m_KernelLookupTable;
+
+  /** Fill the kernel lookup table */
+  void ComputeKernelLookupTable();
+
   /** The sinc function */
   inline double Sinc(double x) const
   {
@@ -334,6 +366,38 @@ private:
 
     return ( x == 0.0 ) ? 1.0 : vcl_sin(px) / px;
   }
+
+  /** The windowed sinc kernel, from the lookup table when it is used */
+  inline double Kernel(double x) const
+  {
+    if ( m_KernelLookupTable.empty() )
+      {
+      return m_WindowFunction(x) * Sinc(x);
+      }
+
+    const double       t = vnl_math_abs(x) * m_KernelLookupTableResolution;
+    const unsigned int i = static_cast< unsigned int >( t );
+    return m_KernelLookupTable[i]
+           + ( m_KernelLookupTable[i + 1] - m_KernelLookupTable[i] ) * ( t - i );
+  }
+
+  /** Add the contribution of the j-th neighbor to the intermediate sums.
+   * The neighbors are visited with the first dimension varying fastest,
+   * so a sum is complete when the weight index of its dimension is the
+   * last one. */
+  inline void AccumulateNeighbor(double *sums, double value, unsigned int j,
+                                 const double xWeight[][2 * VRadius]) const
+  {
+    const unsigned int *weightIndex = m_WeightOffsetTable[j];
+
+    sums[0] += value * xWeight[0][weightIndex[0]];
+    for ( unsigned int dim = 0; dim + 1 < ImageDimension
+          && weightIndex[dim] == m_WindowSize - 1; dim++ )
+      {
+      sums[dim + 1] += sums[dim] * xWeight[dim + 1][weightIndex[dim + 1]];
+      sums[dim] = 0.0;
+      }
+  }
 };
 } // namespace itk
 
@@ -91,6 +91,9 @@ WindowedSincInterpolateImageFunction< TInputImage, VRadius,
     {
     m_WeightOffsetTable[i] = new unsigned int[ImageDimension];
     }
+
+  m_UseKernelLookupTable = false;
+  m_KernelLookupTableResolution = 1000;
 }
 
 /** Destructor */
@@ -137,6 +140,7 @@ WindowedSincInterpolateImageFunction< TInputImage, VRadius,
 
   // Compute the offset tables (we ignore all the zero indices
   // in the neighborhood)
+  m_BufferOffsetTable.resize(m_OffsetTableSize);
   unsigned int iOffset = 0;
   int          empty = VRadius;
   for ( unsigned int iPos = 0; iPos < it.Size(); iPos++ )
@@ -167,12 +171,77 @@ WindowedSincInterpolateImageFunction< TInputImage, VRadius,
         m_WeightOffsetTable[iOffset][dim] = off[dim] + VRadius - 1;
         }
 
+      // Set the offset in the buffer
+      m_BufferOffsetTable[iOffset] = 0;
+      for ( dim = 0; dim < ImageDimension; dim++ )
+        {
+        m_BufferOffsetTable[iOffset] += off[dim] * image->GetOffsetTable()[dim];
+        }
+
       // Increment the index
       iOffset++;
       }
     }
 }
 
+template< class TInputImage, unsigned int VRadius,
+          class TWindowFunction, class TBoundaryCondition, class TCoordRep >
+void
+WindowedSincInterpolateImageFunction< TInputImage, VRadius,
+                                      TWindowFunction, TBoundaryCondition, TCoordRep >
+::SetUseKernelLookupTable(bool flag)
+{
+  if ( m_UseKernelLookupTable != flag )
+    {
+    m_UseKernelLookupTable = flag;
+    this->ComputeKernelLookupTable();
+    this->Modified();
+    }
+}
+
+template< class TInputImage, unsigned int VRadius,
+          class TWindowFunction, class TBoundaryCondition, class TCoordRep >
+void
+WindowedSincInterpolateImageFunction< TInputImage, VRadius,
+                                      TWindowFunction, TBoundaryCondition, TCoordRep >
+::SetKernelLookupTableResolution(unsigned int resolution)
+{
+  if ( resolution < 1 )
+    {
+    resolution = 1;
+    }
+  if ( m_KernelLookupTableResolution != resolution )
+    {
+    m_KernelLookupTableResolution = resolution;
+    this->ComputeKernelLookupTable();
+    this->Modified();
+    }
+}
+
+/** Sample the kernel on [0, VRadius], with one extra sample so that the
+ * last interval can be interpolated */
+template< class TInputImage, unsigned int VRadius,
+          class TWindowFunction, class TBoundaryCondition, class TCoordRep >
+void
+WindowedSincInterpolateImageFunction< TInputImage, VRadius,
+                                      TWindowFunction, TBoundaryCondition, TCoordRep >
+::ComputeKernelLookupTable()
+{
+  m_KernelLookupTable.clear();
+  if ( !m_UseKernelLookupTable )
+    {
+    return;
+    }
+
+  const unsigned int numberOfSamples = VRadius * m_KernelLookupTableResolution + 2;
+  m_KernelLookupTable.resize(numberOfSamples);
+  for ( unsigned int i = 0; i < numberOfSamples; i++ )
+    {
+    const double x = static_cast< double >( i ) / m_KernelLookupTableResolution;
+    m_KernelLookupTable[i] = m_WindowFunction(x) * Sinc(x);
+    }
+}
+
 /** PrintSelf */
 template< class TInputImage, unsigned int VRadius,
           class TWindowFunction, class TBoundaryCondition, class TCoordRep >
@@ -182,6 +251,10 @@ WindowedSincInterpolateImageFunction< TInputImage, VRadius,
 ::PrintSelf(std::ostream & os, Indent indent) const
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "UseKernelLookupTable: "
+     << ( m_UseKernelLookupTable ? "On" : "Off" ) << std::endl;
+  os << indent << "KernelLookupTableResolution: "
+     << m_KernelLookupTableResolution << std::endl;
 }
 
 /** Evaluate at image index position */
@@ -207,15 +280,6 @@ WindowedSincInterpolateImageFunction< TInputImage, VRadius,
     distance[dim] = index[dim] - static_cast< double >( baseIndex[dim] );
     }
 
-  // cout << "Sampling at index " << index << " discrete " << baseIndex << endl;
-
-  // Position the neighborhood at the index of interest
-  Size< ImageDimension > radius;
-  radius.Fill(VRadius);
-  IteratorType nit = IteratorType( radius, this->GetInputImage(),
-                                   this->GetInputImage()->GetBufferedRegion() );
-  nit.SetLocation(baseIndex);
-
   // Compute the sinc function for each dimension
   double xWeight[ImageDimension][2 * VRadius];
   for ( dim = 0; dim < ImageDimension; dim++ )
@@ -243,32 +307,68 @@ WindowedSincInterpolateImageFunction< TInputImage, VRadius,
         x -= 1.0;
 
         // Compute the weight for this m
-        xWeight[dim][i] = m_WindowFunction(x) * Sinc(x);
+        xWeight[dim][i] = this->Kernel(x);
         }
       }
     }
 
-  // Iterate over the neighborhood, taking the correct set
-  // of weights in each dimension
-  double xPixelValue = 0.0;
-  for ( unsigned int j = 0; j < m_OffsetTableSize; j++ )
+  // Check whether the whole window is inside the buffered region
+  bool inside = true;
+  for ( dim = 0; dim < ImageDimension; dim++ )
     {
-    // Get the offset for this neighbor
-    unsigned int off = m_OffsetTable[j];
+    if ( baseIndex[dim] - static_cast< IndexValueType >( VRadius ) + 1 < this->m_StartIndex[dim]
+         || baseIndex[dim] + static_cast< IndexValueType >( VRadius ) > this->m_EndIndex[dim] )
+      {
+      inside = false;
+      break;
+      }
+    }
+
+  // Intermediate sums of the separable convolution, one per dimension
+  double sums[ImageDimension];
+  for ( dim = 0; dim < ImageDimension; dim++ )
+    {
+    sums[dim] = 0.0;
+    }
 
-    // Get the intensity value at the pixel
-    double xVal = nit.GetPixel(off);
+  const ImageType *image = this->GetInputImage();
 
-    // Multiply the intensity by each of the weights. Gotta hope
-    // that the compiler will unwrap this loop and pipeline this!
-    for ( dim = 0; dim < ImageDimension; dim++ )
+  if ( inside )
+    {
+    // Read the pixels directly from the buffer
+    const InternalPixelType *basePixel =
+      image->GetBufferPointer() + image->ComputeOffset(baseIndex);
+
+    AccessorFunctorType                      accessorFunctor;
+    typename ImageType::AccessorType         accessor = image->GetPixelAccessor();
+    accessorFunctor.SetPixelAccessor(accessor);
+    accessorFunctor.SetBegin( image->GetBufferPointer() );
+
+    for ( unsigned int j = 0; j < m_OffsetTableSize; j++ )
       {
-      xVal *= xWeight[dim][m_WeightOffsetTable[j][dim]];
+      const double xVal =
+        static_cast< double >( accessorFunctor.Get( *( basePixel + m_BufferOffsetTable[j] ) ) );
+      this->AccumulateNeighbor(sums, xVal, j, xWeight);
       }
-
-    // Increment the pixel value
-    xPixelValue += xVal;
     }
+  else
+    {
+    // Position the neighborhood at the index of interest, the boundary
+    // condition gives the pixels outside of the buffer
+    Size< ImageDimension > radius;
+    radius.Fill(VRadius);
+    IteratorType nit = IteratorType( radius, image,
+                                     image->GetBufferedRegion() );
+    nit.SetLocation(baseIndex);
+
+    for ( unsigned int j = 0; j < m_OffsetTableSize; j++ )
+      {
+      const double xVal = nit.GetPixel(m_OffsetTable[j]);
+      this->AccumulateNeighbor(sums, xVal, j, xWeight);
+      }
+    }
+
+  const double xPixelValue = sums[ImageDimension - 1];
 
   // Return the interpolated value
   return static_cast< OutputType >( xPixelValue );
@@ -19,12 +19,31 @@
 #define __itkConvolutionImageFilter_h
 
 #include "itkImageToImageFilter.h"
+#include "itkImage.h"
 
 namespace itk
 {
 /** \class ConvolutionImageFilter
  * \brief Convolve a given image with an arbitrary image kernel
  *
+ * The output pixel at index x is the sum over the kernel indices k of
+ * kernel(k) * input(x + k - r), where r is half the kernel size rounded
+ * down.  The input is extended past its buffered region with a zero flux
+ * Neumann boundary condition.
+ *
+ * Small kernels are applied in the spatial domain with a neighborhood
+ * iterator.  For large kernels the filter multiplies the Fourier
+ * transforms of the input and of the kernel instead, with the filters
+ * returned by FFTRealToComplexConjugateImageFilter::New() and
+ * FFTComplexConjugateToRealImageFilter::New().  The output region is
+ * processed in tiles, so that the Fourier transforms never hold more than
+ * MaximumNumberOfFFTPixels pixels.  Each tile reads the input around it,
+ * so the tiles do not need to be added together.  By default the filter
+ * picks the method with the lowest estimated cost; SetConvolutionMethod()
+ * forces one of them.  The automatic choice only uses the Fourier
+ * transforms for kernels of odd size, as the spatial method does not
+ * center even sized kernels.
+ *
  * http://hdl.handle.net/1926/1323
  *
  * \author Nicholas J. Tustison
@@ -66,6 +85,29 @@ public:
   itkGetConstMacro(Normalize, bool);
   itkBooleanMacro(Normalize);
 
+  /** Method used to compute the convolution. */
+  enum {
+    AutomaticConvolution = 0,
+    SpatialConvolution = 1,
+    FFTConvolution = 2
+    };
+  itkSetMacro(ConvolutionMethod, int);
+  itkGetConstMacro(ConvolutionMethod, int);
+  void SetConvolutionMethodToAutomatic()
+  { this->SetConvolutionMethod(AutomaticConvolution); }
+  void SetConvolutionMethodToSpatial()
+  { this->SetConvolutionMethod(SpatialConvolution); }
+  void SetConvolutionMethodToFFT()
+  { this->SetConvolutionMethod(FFTConvolution); }
+
+  /** Largest number of pixels in a Fourier transformed tile. */
+  itkSetMacro(MaximumNumberOfFFTPixels, unsigned long);
+  itkGetConstMacro(MaximumNumberOfFFTPixels, unsigned long);
+
+  /** Method used by the last update, either SpatialConvolution or
+   * FFTConvolution. */
+  itkGetConstMacro(LastConvolutionMethod, int);
+
   /** ConvolutionImageFilter needs a smaller 2nd input (the image kernel)
    * requested region than output requested region.  As such, this filter
    * needs to provide an implementation for GenerateInputRequestedRegion() in
@@ -80,14 +122,40 @@ protected:
 
   void PrintSelf(std::ostream & os, Indent indent) const;
 
+  /** Pick the convolution method, then run the threaded spatial
+   * convolution or the Fourier based one. */
+  void GenerateData();
+
   void ThreadedGenerateData(const OutputRegionType & outputRegionForThread, int threadId);
 
+  typedef double                                   FFTPixelType;
+  typedef Image< FFTPixelType, ImageDimension >    FFTImageType;
+  typedef typename FFTImageType::SizeType          FFTSizeType;
+  typedef typename FFTSizeType::SizeValueType      SizeValueType;
+
+  /** Smallest length that is not less than n and has no prime factor
+   * other than 2, 3 and 5, for which the transforms are the fastest. */
+  static SizeValueType GetFFTLength(SizeValueType n);
+
+  /** Size of the tiles of the output region and of their Fourier
+   * transforms.  Returns the estimated cost of the Fourier method. */
+  double ComputeFFTTiles(FFTSizeType & tileSize, FFTSizeType & fftSize) const;
+
+  /** Convolve the output requested region tile by tile with the Fourier
+   * transforms. */
+  void FFTGenerateData(const FFTSizeType & tileSize, const FFTSizeType & fftSize);
+
 private:
   ConvolutionImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);         //purposely not implemented
 
 private:
   bool m_Normalize;
+
+  int m_ConvolutionMethod;
+  int m_LastConvolutionMethod;
+
+  unsigned long m_MaximumNumberOfFFTPixels;
 };
 }
 
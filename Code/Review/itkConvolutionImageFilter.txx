@@ -24,6 +24,9 @@
 #include "itkImageBase.h"
 #include "itkImageKernelOperator.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkFFTRealToComplexConjugateImageFilter.h"
+#include "itkFFTComplexConjugateToRealImageFilter.h"
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkNeighborhoodInnerProduct.h"
 #include "itkConstNeighborhoodIterator.h"
@@ -39,6 +42,9 @@ ConvolutionImageFilter< TInputImage, TOutputImage >
 {
   this->SetNumberOfRequiredInputs(2);
   m_Normalize = false;
+  m_ConvolutionMethod = AutomaticConvolution;
+  m_LastConvolutionMethod = SpatialConvolution;
+  m_MaximumNumberOfFFTPixels = 1UL << 22;
 }
 
 template< class TInputImage, class TOutputImage >
@@ -46,6 +52,288 @@ ConvolutionImageFilter< TInputImage, TOutputImage >
 ::~ConvolutionImageFilter()
 {}
 
+template< class TInputImage, class TOutputImage >
+typename ConvolutionImageFilter< TInputImage, TOutputImage >::SizeValueType
+ConvolutionImageFilter< TInputImage, TOutputImage >
+::GetFFTLength(SizeValueType n)
+{
+  for ( SizeValueType length = vnl_math_max( n, static_cast< SizeValueType >( 1 ) );; length++ )
+    {
+    SizeValueType remainder = length;
+    const SizeValueType factors[] = { 2, 3, 5 };
+    for ( unsigned int i = 0; i < 3; i++ )
+      {
+      while ( remainder % factors[i] == 0 )
+        {
+        remainder /= factors[i];
+        }
+      }
+    if ( remainder == 1 )
+      {
+      return length;
+      }
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+double
+ConvolutionImageFilter< TInputImage, TOutputImage >
+::ComputeFFTTiles(FFTSizeType & tileSize, FFTSizeType & fftSize) const
+{
+  const OutputRegionType region = this->GetOutput()->GetRequestedRegion();
+  const typename InputImageType::SizeType kernelSize =
+    this->GetImageKernelInput()->GetLargestPossibleRegion().GetSize();
+
+  // halve the longest side of the tiles until their transforms fit
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    tileSize[i] = region.GetSize()[i];
+    }
+  double fftPixels;
+  for (;; )
+    {
+    fftPixels = 1.0;
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      fftSize[i] = GetFFTLength(tileSize[i] + kernelSize[i] - 1);
+      fftPixels *= fftSize[i];
+      }
+    unsigned int longest = 0;
+    for ( unsigned int i = 1; i < ImageDimension; i++ )
+      {
+      if ( tileSize[i] > tileSize[longest] )
+        {
+        longest = i;
+        }
+      }
+    if ( fftPixels <= m_MaximumNumberOfFFTPixels || tileSize[longest] == 1 )
+      {
+      break;
+      }
+    tileSize[longest] = ( tileSize[longest] + 1 ) / 2;
+    }
+
+  // grow the tiles into the padding of the transforms
+  double numberOfTiles = 1.0;
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    tileSize[i] = vnl_math_min( static_cast< SizeValueType >( region.GetSize()[i] ),
+                                fftSize[i] - kernelSize[i] + 1 );
+    numberOfTiles *= ( region.GetSize()[i] + tileSize[i] - 1 ) / tileSize[i];
+    }
+
+  // a forward and an inverse transform per tile, in units of a multiply
+  // and add of the spatial method
+  return numberOfTiles * fftPixels * ( 2.0 * vcl_log(fftPixels) / vcl_log(2.0) + 4.0 );
+}
+
+template< class TInputImage, class TOutputImage >
+void
+ConvolutionImageFilter< TInputImage, TOutputImage >
+::GenerateData()
+{
+  int method = m_ConvolutionMethod;
+
+  FFTSizeType tileSize;
+  FFTSizeType fftSize;
+  if ( method != SpatialConvolution )
+    {
+    const double fftCost = this->ComputeFFTTiles(tileSize, fftSize);
+    if ( method == AutomaticConvolution )
+      {
+      const typename InputImageType::SizeType kernelSize =
+        this->GetImageKernelInput()->GetLargestPossibleRegion().GetSize();
+      double spatialCost =
+        static_cast< double >( this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() );
+      bool oddKernel = true;
+      for ( unsigned int i = 0; i < ImageDimension; i++ )
+        {
+        spatialCost *= kernelSize[i];
+        oddKernel = oddKernel && ( kernelSize[i] % 2 == 1 );
+        }
+      method = ( oddKernel && fftCost < spatialCost )
+               ? FFTConvolution : SpatialConvolution;
+      }
+    }
+
+  m_LastConvolutionMethod = method;
+  if ( method == FFTConvolution )
+    {
+    this->FFTGenerateData(tileSize, fftSize);
+    }
+  else
+    {
+    Superclass::GenerateData();
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void
+ConvolutionImageFilter< TInputImage, TOutputImage >
+::FFTGenerateData(const FFTSizeType & tileSize, const FFTSizeType & fftSize)
+{
+  typedef FFTRealToComplexConjugateImageFilter< FFTPixelType, ImageDimension > FFTFilterType;
+  typedef FFTComplexConjugateToRealImageFilter< FFTPixelType, ImageDimension > IFFTFilterType;
+  typedef typename FFTFilterType::TOutputImageType                             ComplexImageType;
+  typedef typename FFTImageType::IndexType                                     FFTIndexType;
+  typedef typename FFTImageType::RegionType                                    FFTRegionType;
+
+  this->AllocateOutputs();
+
+  const InputImageType *input = this->GetInput();
+  const InputImageType *kernel = this->GetImageKernelInput();
+  OutputImageType *     output = this->GetOutput();
+
+  const OutputRegionType                     region = output->GetRequestedRegion();
+  const typename InputImageType::RegionType  inputRegion = input->GetBufferedRegion();
+  const typename InputImageType::RegionType  kernelRegion = kernel->GetLargestPossibleRegion();
+  const typename InputImageType::SizeType    kernelSize = kernelRegion.GetSize();
+
+  double scalingFactor = 1.0;
+  if ( this->GetNormalize() )
+    {
+    double                                     sum = 0.0;
+    ImageRegionConstIterator< InputImageType > It(kernel, kernelRegion);
+    for ( It.GoToBegin(); !It.IsAtEnd(); ++It )
+      {
+      sum += static_cast< double >( It.Get() );
+      }
+    if ( sum != 0.0 )
+      {
+      scalingFactor = 1.0 / sum;
+      }
+    }
+
+  unsigned long numberOfTiles = 1;
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    numberOfTiles *= ( region.GetSize()[i] + tileSize[i] - 1 ) / tileSize[i];
+    }
+  ProgressReporter progress(this, 0, numberOfTiles + 1);
+
+  FFTRegionType fftRegion;
+  fftRegion.SetSize(fftSize);
+  typename FFTImageType::Pointer buffer = FFTImageType::New();
+  buffer->SetRegions(fftRegion);
+  buffer->Allocate();
+  buffer->FillBuffer(0.0);
+
+  // The transform of the flipped kernel turns the products into a
+  // correlation with the kernel.
+  ImageRegionConstIteratorWithIndex< InputImageType > kernelIt(kernel, kernelRegion);
+  for ( kernelIt.GoToBegin(); !kernelIt.IsAtEnd(); ++kernelIt )
+    {
+    FFTIndexType index;
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      index[i] = kernelSize[i] - 1 - ( kernelIt.GetIndex()[i] - kernelRegion.GetIndex()[i] );
+      }
+    buffer->SetPixel( index, scalingFactor * static_cast< FFTPixelType >( kernelIt.Get() ) );
+    }
+
+  typename FFTFilterType::Pointer fft = FFTFilterType::New();
+  fft->SetNumberOfThreads( this->GetNumberOfThreads() );
+  fft->SetInput(buffer);
+  fft->Update();
+  typename ComplexImageType::Pointer kernelTransform = fft->GetOutput();
+  kernelTransform->DisconnectPipeline();
+  progress.CompletedPixel();
+
+  typename ComplexImageType::Pointer product = ComplexImageType::New();
+  product->SetRegions( kernelTransform->GetLargestPossibleRegion() );
+  product->Allocate();
+
+  typename IFFTFilterType::Pointer ifft = IFFTFilterType::New();
+  ifft->SetNumberOfThreads( this->GetNumberOfThreads() );
+  ifft->SetActualXDimensionIsOdd( fftSize[0] % 2 == 1 );
+  ifft->SetInput(product);
+
+  // Each tile reads the input pixels its kernel reaches, which do not
+  // overlap the wrap around of the circular convolution: the pixel of the
+  // tile at t is found at t + kernelSize - 1.
+  FFTIndexType resultIndex;
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    resultIndex[i] = kernelSize[i] - 1;
+    }
+
+  FFTIndexType tilePosition;
+  tilePosition.Fill(0);
+  for ( unsigned long tile = 0; tile < numberOfTiles; tile++ )
+    {
+    OutputRegionType tileRegion;
+    FFTRegionType    dataRegion;
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      const SizeValueType start = tilePosition[i] * tileSize[i];
+      tileRegion.SetIndex( i, region.GetIndex()[i] + start );
+      tileRegion.SetSize( i, vnl_math_min( tileSize[i], region.GetSize()[i] - start ) );
+      dataRegion.SetSize( i, tileRegion.GetSize()[i] + kernelSize[i] - 1 );
+      }
+
+    buffer->FillBuffer(0.0);
+    ImageRegionIteratorWithIndex< FFTImageType > bufferIt(buffer, dataRegion);
+    for ( bufferIt.GoToBegin(); !bufferIt.IsAtEnd(); ++bufferIt )
+      {
+      typename InputImageType::IndexType index;
+      for ( unsigned int i = 0; i < ImageDimension; i++ )
+        {
+        const long begin = inputRegion.GetIndex()[i];
+        const long end = begin + static_cast< long >( inputRegion.GetSize()[i] ) - 1;
+        const long position = tileRegion.GetIndex()[i] + bufferIt.GetIndex()[i]
+                              - static_cast< long >( kernelSize[i] / 2 );
+        index[i] = vnl_math_min( vnl_math_max(position, begin), end );
+        }
+      bufferIt.Set( static_cast< FFTPixelType >( input->GetPixel(index) ) );
+      }
+    buffer->Modified();
+    fft->Update();
+
+    ImageRegionConstIterator< ComplexImageType > imageTransformIt(
+      fft->GetOutput(), fft->GetOutput()->GetLargestPossibleRegion() );
+    ImageRegionConstIterator< ComplexImageType > kernelTransformIt(
+      kernelTransform, kernelTransform->GetLargestPossibleRegion() );
+    ImageRegionIterator< ComplexImageType > productIt(
+      product, product->GetLargestPossibleRegion() );
+    for (; !productIt.IsAtEnd(); ++productIt, ++imageTransformIt, ++kernelTransformIt )
+      {
+      productIt.Set( imageTransformIt.Get() * kernelTransformIt.Get() );
+      }
+    product->Modified();
+    ifft->Update();
+
+    FFTRegionType resultRegion;
+    resultRegion.SetIndex(resultIndex);
+    resultRegion.SetSize( tileRegion.GetSize() );
+    ImageRegionConstIterator< FFTImageType > resultIt(ifft->GetOutput(), resultRegion);
+    ImageRegionIterator< OutputImageType >   outIt(output, tileRegion);
+    for (; !outIt.IsAtEnd(); ++outIt, ++resultIt )
+      {
+      double value = resultIt.Get();
+      if ( NumericTraits< OutputPixelType >::is_integer )
+        {
+        // do not let the round off move an integer result below it
+        const double rounded = vcl_floor(value + 0.5);
+        if ( vnl_math_abs(value - rounded) < 1e-6 * ( 1.0 + vnl_math_abs(rounded) ) )
+          {
+          value = rounded;
+          }
+        }
+      outIt.Set( static_cast< OutputPixelType >( value ) );
+      }
+
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      if ( static_cast< SizeValueType >( ++tilePosition[i] ) * tileSize[i] < region.GetSize()[i] )
+        {
+        break;
+        }
+      tilePosition[i] = 0;
+      }
+    progress.CompletedPixel();
+    }
+}
+
 template< class TInputImage, class TOutputImage >
 void
 ConvolutionImageFilter< TInputImage, TOutputImage >
@@ -181,6 +469,9 @@ ConvolutionImageFilter< TInputImage, TOutputImage >
   Superclass::PrintSelf(os, indent);
 
   os << indent << "Normalize: "  << m_Normalize << std::endl;
+  os << indent << "ConvolutionMethod: "  << m_ConvolutionMethod << std::endl;
+  os << indent << "LastConvolutionMethod: "  << m_LastConvolutionMethod << std::endl;
+  os << indent << "MaximumNumberOfFFTPixels: "  << m_MaximumNumberOfFFTPixels << std::endl;
   //  NOT REALLY MEMBER DATA. Need to fool PrintSelf check
   //  os << indent << "ImageKernel: "  << m_ImageKernel << std::e0ndl;
 }
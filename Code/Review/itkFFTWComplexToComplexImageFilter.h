@@ -21,7 +21,7 @@
 #if defined( USE_FFTWF ) || defined( USE_FFTWD )
 
 #include "itkFFTComplexToComplexImageFilter.h"
-#include "fftw3.h"
+#include "itkFFTWCommon.h"
 
 namespace itk
 {
@@ -30,6 +30,9 @@ namespace itk
  *  Fourier transform of images with complex valued voxels to be computed using
  *  either FFTW from MIT or the FFTW interface in Intel MKL.
  *
+ * The plans come from fftw::PlanCache: they are computed once per size,
+ * direction and number of threads, and executed on the image buffers.
+ *
  * \ingroup FourierTransform
  *
  * \author Simon K. Warfield simon.warfield@childrens.harvard.edu
@@ -78,20 +81,14 @@ public:
   /** Image type typedef support. */
   typedef InputImageType               ImageType;
   typedef typename ImageType::SizeType ImageSizeType;
-protected:
 
-  FFTWComplexToComplexImageFilter()
-  {
-    this->m_PlanComputed = false;
-  }
+  /** The plans are shared with the other FFTW filters. */
+  typedef fftw::Proxy< TPixel >     FFTWProxyType;
+  typedef fftw::PlanCache< TPixel > FFTWPlanCacheType;
+protected:
 
-  virtual ~FFTWComplexToComplexImageFilter()
-  {
-    if ( m_PlanComputed )
-      {
-      fftwf_destroy_plan(m_Plan);
-      }
-  }
+  FFTWComplexToComplexImageFilter() {}
+  virtual ~FFTWComplexToComplexImageFilter() {}
 
   /**
    * these methods should be defined in every FFT filter class
@@ -103,9 +100,6 @@ protected:
 private:
   FFTWComplexToComplexImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);                  //purposely not implemented
-
-  bool       m_PlanComputed;
-  fftwf_plan m_Plan;
 };
 
 template< unsigned int NDimension >
@@ -136,20 +130,14 @@ public:
   /** Image type typedef support. */
   typedef InputImageType               ImageType;
   typedef typename ImageType::SizeType ImageSizeType;
-protected:
 
-  FFTWComplexToComplexImageFilter()
-  {
-    m_PlanComputed = false;
-  }
+  /** The plans are shared with the other FFTW filters. */
+  typedef fftw::Proxy< TPixel >     FFTWProxyType;
+  typedef fftw::PlanCache< TPixel > FFTWPlanCacheType;
+protected:
 
-  virtual ~FFTWComplexToComplexImageFilter()
-  {
-    if ( this->m_PlanComputed )
-      {
-      fftw_destroy_plan(this->m_Plan);
-      }
-  }
+  FFTWComplexToComplexImageFilter() {}
+  virtual ~FFTWComplexToComplexImageFilter() {}
 
   //
   // these should be defined in every FFT filter class
@@ -160,9 +148,6 @@ protected:
 private:
   FFTWComplexToComplexImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);                  //purposely not implemented
-
-  bool      m_PlanComputed;
-  fftw_plan m_Plan;
 };
 } // namespace itk
 
@@ -74,57 +74,29 @@ FFTWComplexToComplexImageFilter< float, NDimension >::GenerateData()
   outputPtr->SetBufferedRegion( outputPtr->GetRequestedRegion() );
   outputPtr->Allocate();
 
-  std::complex< TPixel > *in =
-    const_cast< std::complex< TPixel > * >( inputPtr->GetBufferPointer() );
-
-  unsigned int total_size = 1;
-
+  unsigned long sizes[NDimension];
+  unsigned long total_size = 1;
+  for ( unsigned int i = 0; i < NDimension; i++ )
     {
-    // This reinterpret_cast only makes sense if TPixel is float...
-    fftwf_complex *dptr = reinterpret_cast< fftwf_complex * >( in );
-    fftwf_complex *out = reinterpret_cast< fftwf_complex * >( outputPtr->GetBufferPointer() );
-
-    int transformDirection = 1;
-    if ( this->GetTransformDirection() == Superclass::INVERSE )
-      {
-      transformDirection = -1;
-      }
-
-    switch ( num_dims )
-      {
-      case 1:
-        this->m_Plan = fftwf_plan_dft_1d(outputSize[0],
-                                         dptr, out,
-                                         transformDirection, FFTW_ESTIMATE);
-        total_size = outputSize[0];
-        break;
-      case 2:
-        this->m_Plan = fftwf_plan_dft_2d(outputSize[1], outputSize[0],
-                                         dptr, out,
-                                         transformDirection, FFTW_ESTIMATE);
-        total_size = outputSize[0] * outputSize[1];
-        break;
-      case 3:
-        this->m_Plan = fftwf_plan_dft_3d(outputSize[2], outputSize[1], outputSize[0],
-                                         dptr, out,
-                                         transformDirection, FFTW_ESTIMATE);
-        total_size = outputSize[0] * outputSize[1] * outputSize[2];
-        break;
-      default:
-        int *sizes = new int[num_dims];
-        for ( unsigned int i = 0; i < num_dims; i++ )
-          {
-          sizes[( num_dims - 1 ) - i] = outputSize[i];
-          total_size *= outputSize[i];
-          }
-        this->m_Plan = fftwf_plan_dft(num_dims, sizes,
-                                      dptr, out, transformDirection, FFTW_ESTIMATE);
-        delete[] sizes;
-      }
-    this->m_PlanComputed = true;
-    fftwf_execute(this->m_Plan);
+    sizes[i] = outputSize[i];
+    total_size *= outputSize[i];
     }
 
+  // the forward transform of this filter has always used the positive
+  // sign of FFTW_BACKWARD, and the inverse one the negative sign
+  const int kind = ( this->GetTransformDirection() == Superclass::INVERSE ) ?
+                   FFTWPlanCacheType::ComplexToComplexForward :
+                   FFTWPlanCacheType::ComplexToComplexBackward;
+  typename FFTWProxyType::PlanType plan =
+    FFTWPlanCacheType::GetPlan(kind, NDimension, sizes, this->GetNumberOfThreads());
+
+  // the out of place plan does not write to its input
+  FFTWProxyType::Execute_dft( plan,
+                              reinterpret_cast< typename FFTWProxyType::ComplexType * >(
+                                const_cast< std::complex< TPixel > * >( inputPtr->GetBufferPointer() ) ),
+                              reinterpret_cast< typename FFTWProxyType::ComplexType * >(
+                                outputPtr->GetBufferPointer() ) );
+
   typedef ImageRegionIterator< OutputImageType > IteratorType;
 
   IteratorType it( outputPtr, outputPtr->GetLargestPossibleRegion() );
@@ -182,57 +154,29 @@ FFTWComplexToComplexImageFilter< double, NDimension >::GenerateData()
   outputPtr->SetBufferedRegion( outputPtr->GetRequestedRegion() );
   outputPtr->Allocate();
 
-  std::complex< TPixel > *in = const_cast< std::complex< TPixel > * >
-                               ( inputPtr->GetBufferPointer() );
-
-  unsigned int total_size = 1;
-
+  unsigned long sizes[NDimension];
+  unsigned long total_size = 1;
+  for ( unsigned int i = 0; i < NDimension; i++ )
     {
-    // This reinterpret_cast only makes sense if TPixel is double...
-    fftw_complex *dptr = reinterpret_cast< fftw_complex * >( in );
-    fftw_complex *out  = reinterpret_cast< fftw_complex * >( outputPtr->GetBufferPointer() );
-
-    int transformDirection = 1;
-    if ( this->GetTransformDirection() == Superclass::INVERSE )
-      {
-      transformDirection = -1;
-      }
-
-    switch ( num_dims )
-      {
-      case 1:
-        this->m_Plan = fftw_plan_dft_1d(outputSize[0],
-                                        dptr, out,
-                                        transformDirection, FFTW_ESTIMATE);
-        total_size = outputSize[0];
-        break;
-      case 2:
-        this->m_Plan = fftw_plan_dft_2d(outputSize[1], outputSize[0],
-                                        dptr, out,
-                                        transformDirection, FFTW_ESTIMATE);
-        total_size = outputSize[0] * outputSize[1];
-        break;
-      case 3:
-        this->m_Plan = fftw_plan_dft_3d(outputSize[2], outputSize[1], outputSize[0],
-                                        dptr, out,
-                                        transformDirection, FFTW_ESTIMATE);
-        total_size = outputSize[0] * outputSize[1] * outputSize[2];
-        break;
-      default:
-        int *sizes = new int[num_dims];
-        for ( unsigned int i = 0; i < num_dims; i++ )
-          {
-          sizes[( num_dims - 1 ) - i] = outputSize[i];
-          total_size *= outputSize[i];
-          }
-        this->m_Plan = fftw_plan_dft(num_dims, sizes,
-                                     dptr, out, transformDirection, FFTW_ESTIMATE);
-        delete[] sizes;
-      }
-    this->m_PlanComputed = true;
-    fftw_execute(this->m_Plan);
+    sizes[i] = outputSize[i];
+    total_size *= outputSize[i];
     }
 
+  // the forward transform of this filter has always used the positive
+  // sign of FFTW_BACKWARD, and the inverse one the negative sign
+  const int kind = ( this->GetTransformDirection() == Superclass::INVERSE ) ?
+                   FFTWPlanCacheType::ComplexToComplexForward :
+                   FFTWPlanCacheType::ComplexToComplexBackward;
+  typename FFTWProxyType::PlanType plan =
+    FFTWPlanCacheType::GetPlan(kind, NDimension, sizes, this->GetNumberOfThreads());
+
+  // the out of place plan does not write to its input
+  FFTWProxyType::Execute_dft( plan,
+                              reinterpret_cast< typename FFTWProxyType::ComplexType * >(
+                                const_cast< std::complex< TPixel > * >( inputPtr->GetBufferPointer() ) ),
+                              reinterpret_cast< typename FFTWProxyType::ComplexType * >(
+                                outputPtr->GetBufferPointer() ) );
+
   ImageRegionIterator< OutputImageType > it( outputPtr, outputPtr->GetLargestPossibleRegion() );
 
   //
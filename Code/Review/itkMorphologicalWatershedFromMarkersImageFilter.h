@@ -63,6 +63,13 @@ namespace itk
  * Chapter 9.2 of Pierre Soille's book "Morphological Image Analysis:
  * Principles and Applications", Second Edition, Springer, 2003.
  *
+ * The flooding is not multithreaded. On the plateaus of the input, the
+ * order of the hierarchical queue decides which marker reaches a pixel
+ * first and where the watershed lines fall, so flooding parts of the image
+ * independently would change the output. The flooding works instead on
+ * flat copies of the images with a border of one pixel, where the
+ * neighbors of a pixel are at fixed offsets.
+ *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  * \author Richard Beare. Department of Medicine, Monash University, Melbourne, Australia.
  *
@@ -19,16 +19,12 @@
 #define __itkMorphologicalWatershedFromMarkersImageFilter_txx
 
 #include <algorithm>
-#include <queue>
-#include <list>
+#include <deque>
+#include <map>
+#include <vector>
 #include "itkMorphologicalWatershedFromMarkersImageFilter.h"
 #include "itkProgressReporter.h"
 #include "itkImageRegionIterator.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
-#include "itkConstShapedNeighborhoodIterator.h"
-#include "itkConstantBoundaryCondition.h"
-#include "itkSize.h"
-#include "itkConnectedComponentAlgorithm.h"
 // #include "itkFillSides.h"
 
 namespace itk
@@ -87,8 +83,8 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
   // The 2 algorithms are very similar and so are integrated in the same filter.
 
   //---------------------------------------------------------------------------
-  // declare the vars common to the 2 algorithms: constants, iterators,
-  // hierarchical queue, progress reporter, and status image
+  // declare the vars common to the 2 algorithms: constants, work buffers,
+  // hierarchical queue, progress reporter, and status buffer
   // also allocate output images and verify preconditions
   //---------------------------------------------------------------------------
 
@@ -117,40 +113,101 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
     itkExceptionMacro(<< "Marker and input must have the same size.");
     }
 
+  // The flooding works on flat copies of the images with a border of one
+  // pixel, so the neighbors of a pixel are at fixed offsets in the buffers
+  // and are never out of bounds. The border plays the role of the
+  // boundary conditions of the neighborhood iterators.
+  const typename LabelImageType::SizeType size = markerImage->GetRequestedRegion().GetSize();
+  long strides[ImageDimension];
+  long bufferSize = 1;
+  long firstPixel = 0;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    strides[d] = bufferSize;
+    firstPixel += bufferSize;
+    bufferSize *= size[d] + 2;
+    }
+
+  // the offsets of the neighbors, in the same order as the active
+  // neighbors of a shaped neighborhood iterator
+  std::vector< long > neighbors;
+  unsigned int neighborhoodSize = 1;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    neighborhoodSize *= 3;
+    }
+  for ( unsigned int n = 0; n < neighborhoodSize; n++ )
+    {
+    long         offset = 0;
+    unsigned int nonZero = 0;
+    unsigned int rest = n;
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      const long o = static_cast< long >( rest % 3 ) - 1;
+      rest /= 3;
+      offset += o * strides[d];
+      if ( o != 0 )
+        {
+        nonZero++;
+        }
+      }
+    if ( nonZero == 1 || ( m_FullyConnected && nonZero > 0 ) )
+      {
+      neighbors.push_back(offset);
+      }
+    }
+  const unsigned int numberOfNeighbors = neighbors.size();
+
   // FAH (in french: File d'Attente Hierarchique)
-  typedef std::queue< IndexType >                    QueueType;
+  typedef std::deque< long >                         QueueType;
   typedef std::map< InputImagePixelType, QueueType > MapType;
   MapType fah;
 
-  // the radius which will be used for all the shaped iterators
-  Size< ImageDimension > radius;
-  radius.Fill(1);
-
-  // iterator for the marker image
-  typedef ConstShapedNeighborhoodIterator< LabelImageType > MarkerIteratorType;
-  typename MarkerIteratorType::ConstIterator nmIt;
-  MarkerIteratorType
-  markerIt( radius, markerImage, markerImage->GetRequestedRegion() );
-  // add a boundary constant to avoid adding pixels on the border in the fah
-  ConstantBoundaryCondition< LabelImageType > lcbc;
-  lcbc.SetConstant( NumericTraits< LabelImagePixelType >::max() );
-  markerIt.OverrideBoundaryCondition(&lcbc);
-  setConnectivity(&markerIt, m_FullyConnected);
-
-  // iterator for the input image
-  typedef ConstShapedNeighborhoodIterator< InputImageType > InputIteratorType;
-  InputIteratorType
-  inputIt( radius, inputImage, inputImage->GetRequestedRegion() );
-  typename InputIteratorType::ConstIterator niIt;
-  setConnectivity(&inputIt, m_FullyConnected);
-
-  // iterator for the output image
-  typedef ShapedNeighborhoodIterator< LabelImageType > OutputIteratorType;
-  typedef typename OutputIteratorType::OffsetType      OffsetType;
-  typename OutputIteratorType::Iterator noIt;
-  OutputIteratorType
-  outputIt( radius, outputImage, outputImage->GetRequestedRegion() );
-  setConnectivity(&outputIt, m_FullyConnected);
+  // copy the images in the work buffers. Outside pixels are watershed in
+  // Meyer's algorithm so they won't be use to find real watershed pixels.
+  // In Beucher's algorithm they can't be labeled.
+  std::vector< InputImagePixelType > input(bufferSize);
+  std::vector< LabelImagePixelType > output( bufferSize, m_MarkWatershedLine ? wsLabel
+                                             : NumericTraits< LabelImagePixelType >::max() );
+  // the state of each pixel (processed or not). Outside pixels are
+  // already processed.
+  std::vector< unsigned char > status;
+  if ( m_MarkWatershedLine )
+    {
+    status.resize(bufferSize, 1);
+    }
+
+  ImageRegionConstIterator< LabelImageType > markerIt( markerImage, markerImage->GetRequestedRegion() );
+  ImageRegionConstIterator< InputImageType > inputIt( inputImage, inputImage->GetRequestedRegion() );
+  // the position of the current pixel in the image, used to jump over the
+  // border of the buffers
+  typedef typename LabelImageType::SizeValueType SizeValueType;
+  SizeValueType position[ImageDimension];
+  std::fill(position, position + ImageDimension, 0);
+  long p = firstPixel;
+  for ( markerIt.GoToBegin(), inputIt.GoToBegin(); !markerIt.IsAtEnd(); ++markerIt, ++inputIt )
+    {
+    const LabelImagePixelType markerPixel = markerIt.Get();
+    input[p] = inputIt.Get();
+    output[p] = markerPixel;
+    if ( m_MarkWatershedLine )
+      {
+      // the marker pixels are already processed
+      status[p] = ( markerPixel != bgLabel );
+      }
+
+    // move to the next pixel, jumping over the border
+    ++p;
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      if ( ++position[d] < size[d] )
+        {
+        break;
+        }
+      position[d] = 0;
+      p += 2 * strides[d];
+      }
+    }
 
   //---------------------------------------------------------------------------
   // Meyer's algorithm
@@ -158,130 +215,73 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
   if ( m_MarkWatershedLine )
     {
     // first stage:
-    //  - set markers pixels to already processed status
-    //  - copy markers pixels to output image
     //  - init FAH with indexes of background pixels with marker pixel(s) in
     //    their neighborhood
-
-    ConstantBoundaryCondition< LabelImageType > lcbc2;
-    // outside pixel are watershed so they won't be use to find real watershed
-    // pixels
-    lcbc2.SetConstant(wsLabel);
-    outputIt.OverrideBoundaryCondition(&lcbc2);
-
-    // create a temporary image to store the state of each pixel (processed or
-    // not)
-    typedef Image< bool, ImageDimension > StatusImageType;
-    typename StatusImageType::Pointer statusImage = StatusImageType::New();
-    statusImage->SetRegions( markerImage->GetLargestPossibleRegion() );
-    statusImage->Allocate();
-
-    // iterator for the status image
-    typedef ShapedNeighborhoodIterator< StatusImageType > StatusIteratorType;
-    typename StatusIteratorType::Iterator nsIt;
-    StatusIteratorType
-                                                 statusIt( radius, statusImage, outputImage->GetRequestedRegion() );
-    ConstantBoundaryCondition< StatusImageType > bcbc;
-    bcbc.SetConstant(true);    // outside pixel are already processed
-    statusIt.OverrideBoundaryCondition(&bcbc);
-    setConnectivity(&statusIt, m_FullyConnected);
-
-    // the status image must be initialized before the first stage. In the
-    // first stage, the set to true are the neighbors of the marker (and the
-    // marker) so it's difficult (impossible ?) to init the status image at
-    // the same time
-    // the overhead should be small
-    statusImage->FillBuffer(false);
-
-    for ( markerIt.GoToBegin(), statusIt.GoToBegin(), outputIt.GoToBegin(), inputIt.GoToBegin();
-          !markerIt.IsAtEnd();
-          ++markerIt, ++outputIt )
+    // The marker pixels have already been copied to the output and marked
+    // as processed. Non marked pixels are watershed by default because some
+    // pixels may be never processed.
+    std::fill(position, position + ImageDimension, 0);
+    p = firstPixel;
+    for ( markerIt.GoToBegin(); !markerIt.IsAtEnd(); ++markerIt )
       {
-      LabelImagePixelType markerPixel = markerIt.GetCenterPixel();
-      if ( markerPixel != bgLabel )
+      if ( output[p] != bgLabel )
         {
-        IndexType idx = markerIt.GetIndex();
-
-        // move the iterators to the right place
-        OffsetType shift = idx - statusIt.GetIndex();
-        statusIt += shift;
-        inputIt += shift;
-
-        // this pixel belongs to a marker
-        // mark it as already processed
-        statusIt.SetCenterPixel(true);
-        // copy it to the output image
-        outputIt.SetCenterPixel(markerPixel);
-        // and increase progress because this pixel will not be used in the
+        // increase progress because this pixel will not be used in the
         // flooding stage.
         progress.CompletedPixel();
 
         // search the background pixels in the neighborhood
-        for ( nmIt = markerIt.Begin(), nsIt = statusIt.Begin(), niIt = inputIt.Begin();
-              nmIt != markerIt.End();
-              nmIt++, nsIt++, niIt++ )
+        for ( unsigned int n = 0; n < numberOfNeighbors; n++ )
           {
-          if ( !nsIt.Get() && nmIt.Get() == bgLabel )
+          const long q = p + neighbors[n];
+          if ( !status[q] && output[q] == bgLabel )
             {
             // this neighbor is a background pixel and is not already
             // processed; add its index to fah
-            fah[niIt.Get()].push( markerIt.GetIndex()
-                                  + nmIt.GetNeighborhoodOffset() );
+            fah[input[q]].push_back(q);
             // mark it as already in the fah to avoid adding it several times
-            nsIt.Set(true);
+            status[q] = 1;
             }
           }
         }
-      else
-        {
-        // Some pixels may be never processed so, by default, non marked pixels
-        // must be marked as watershed
-        outputIt.SetCenterPixel(wsLabel);
-        }
       // one more pixel done in the init stage
       progress.CompletedPixel();
+
+      ++p;
+      for ( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        if ( ++position[d] < size[d] )
+          {
+          break;
+          }
+        position[d] = 0;
+        p += 2 * strides[d];
+        }
       }
-    // fill the borders of the status image with "true"
-    //FillSides<StatusImageType>(statusImage, true);
-    // Now disable the boundary checks
-    //outputIt.NeedToUseBoundaryConditionOff();
-    //statusIt.NeedToUseBoundaryConditionOff();
-    //inputIt.NeedToUseBoundaryConditionOff();
     // end of init stage
 
-    // flooding
-    // init all the iterators
-    outputIt.GoToBegin();
-    statusIt.GoToBegin();
-    inputIt.GoToBegin();
-
     // and start flooding
+    QueueType currentQueue;
     while ( !fah.empty() )
       {
       // store the current vars
-      InputImagePixelType currentValue = fah.begin()->first;
-      QueueType           currentQueue = fah.begin()->second;
+      const InputImagePixelType currentValue = fah.begin()->first;
+      currentQueue.swap(fah.begin()->second);
       // and remove them from the fah
       fah.erase( fah.begin() );
 
       while ( !currentQueue.empty() )
         {
-        IndexType idx = currentQueue.front();
-        currentQueue.pop();
-
-        // move the iterators to the right place
-        OffsetType shift = idx - outputIt.GetIndex();
-        outputIt += shift;
-        statusIt += shift;
-        inputIt += shift;
+        const long current = currentQueue.front();
+        currentQueue.pop_front();
 
         // iterate over the neighbors. If there is only one marker value, give
         // that value to the pixel, else keep it as is (watershed line)
         LabelImagePixelType marker = wsLabel;
         bool                collision = false;
-        for ( noIt = outputIt.Begin(); noIt != outputIt.End(); noIt++ )
+        for ( unsigned int n = 0; n < numberOfNeighbors; n++ )
           {
-          LabelImagePixelType o = noIt.Get();
+          const LabelImagePixelType o = output[current + neighbors[n]];
           if ( o != wsLabel )
             {
             if ( marker != wsLabel && o != marker )
@@ -296,28 +296,25 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
         if ( !collision )
           {
           // set the marker value
-          outputIt.SetCenterPixel(marker);
+          output[current] = marker;
           // and propagate to the neighbors
-          for ( niIt = inputIt.Begin(), nsIt = statusIt.Begin();
-                niIt != inputIt.End();
-                niIt++, nsIt++ )
+          for ( unsigned int n = 0; n < numberOfNeighbors; n++ )
             {
-            if ( !nsIt.Get() )
+            const long q = current + neighbors[n];
+            if ( !status[q] )
               {
               // the pixel is not yet processed. add it to the fah
-              InputImagePixelType GrayVal = niIt.Get();
+              const InputImagePixelType GrayVal = input[q];
               if ( GrayVal <= currentValue )
                 {
-                currentQueue.push( inputIt.GetIndex()
-                                   + niIt.GetNeighborhoodOffset() );
+                currentQueue.push_back(q);
                 }
               else
                 {
-                fah[GrayVal].push( inputIt.GetIndex()
-                                   + niIt.GetNeighborhoodOffset() );
+                fah[GrayVal].push_back(q);
                 }
               // mark it as already in the fah
-              nsIt.Set(true);
+              status[q] = 1;
               }
             }
           }
@@ -333,35 +330,21 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
   else
     {
     // first stage:
-    //  - copy markers pixels to output image
-    //  - init FAH with indexes of pixels with background pixel in their
-    //    neighborhood
-
-    ConstantBoundaryCondition< LabelImageType > lcbc2;
-    // outside pixel are watershed so they won't be use to find real watershed
-    // pixels
-    lcbc2.SetConstant( NumericTraits< LabelImagePixelType >::max() );
-    outputIt.OverrideBoundaryCondition(&lcbc2);
-
-    for ( markerIt.GoToBegin(), outputIt.GoToBegin(), inputIt.GoToBegin();
-          !markerIt.IsAtEnd();
-          ++markerIt, ++outputIt )
+    //  - init FAH with indexes of marker pixels with background pixel in
+    //    their neighborhood
+    // The marker pixels have already been copied to the output, and the
+    // background pixels are the ones to label.
+    std::fill(position, position + ImageDimension, 0);
+    p = firstPixel;
+    for ( markerIt.GoToBegin(); !markerIt.IsAtEnd(); ++markerIt )
       {
-      LabelImagePixelType markerPixel = markerIt.GetCenterPixel();
-      if ( markerPixel != bgLabel )
+      if ( output[p] != bgLabel )
         {
-        IndexType  idx = markerIt.GetIndex();
-        OffsetType shift = idx - inputIt.GetIndex();
-        inputIt += shift;
-
-        // this pixels belongs to a marker
-        // copy it to the output image
-        outputIt.SetCenterPixel(markerPixel);
         // search if it has background pixel in its neighborhood
         bool haveBgNeighbor = false;
-        for ( nmIt = markerIt.Begin(); nmIt != markerIt.End(); nmIt++ )
+        for ( unsigned int n = 0; n < numberOfNeighbors; n++ )
           {
-          if ( nmIt.Get() == bgLabel )
+          if ( output[p + neighbors[n]] == bgLabel )
             {
             haveBgNeighbor = true;
             break;
@@ -370,7 +353,7 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
         if ( haveBgNeighbor )
           {
           // there is a background pixel in the neighborhood; add to fah
-          fah[inputIt.GetCenterPixel()].push( markerIt.GetIndex() );
+          fah[input[p]].push_back(p);
           }
         else
           {
@@ -379,60 +362,54 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
           progress.CompletedPixel();
           }
         }
-      else
+      progress.CompletedPixel();
+
+      ++p;
+      for ( unsigned int d = 0; d < ImageDimension; d++ )
         {
-        outputIt.SetCenterPixel(wsLabel);
+        if ( ++position[d] < size[d] )
+          {
+          break;
+          }
+        position[d] = 0;
+        p += 2 * strides[d];
         }
-      progress.CompletedPixel();
       }
     // end of init stage
 
-    // flooding
-    // init all the iterators
-    outputIt.GoToBegin();
-    inputIt.GoToBegin();
-
     // and start flooding
+    QueueType currentQueue;
     while ( !fah.empty() )
       {
       // store the current vars
-      InputImagePixelType currentValue = fah.begin()->first;
-      QueueType           currentQueue = fah.begin()->second;
+      const InputImagePixelType currentValue = fah.begin()->first;
+      currentQueue.swap(fah.begin()->second);
       // and remove them from the fah
       fah.erase( fah.begin() );
 
       while ( !currentQueue.empty() )
         {
-        IndexType idx = currentQueue.front();
-        currentQueue.pop();
+        const long current = currentQueue.front();
+        currentQueue.pop_front();
 
-        // move the iterators to the right place
-        OffsetType shift = idx - outputIt.GetIndex();
-        outputIt += shift;
-        inputIt += shift;
-
-        LabelImagePixelType currentMarker = outputIt.GetCenterPixel();
-        // get the current value of the pixel
+        const LabelImagePixelType currentMarker = output[current];
         // iterate over neighbors to propagate the marker
-        for ( noIt = outputIt.Begin(), niIt = inputIt.Begin();
-              noIt != outputIt.End();
-              noIt++, niIt++ )
+        for ( unsigned int n = 0; n < numberOfNeighbors; n++ )
           {
-          if ( noIt.Get() == wsLabel )
+          const long q = current + neighbors[n];
+          if ( output[q] == wsLabel )
             {
             // the pixel is not yet processed. It can be labeled with the
             // current label
-            noIt.Set(currentMarker);
-            InputImagePixelType GrayVal = niIt.Get();
+            output[q] = currentMarker;
+            const InputImagePixelType GrayVal = input[q];
             if ( GrayVal <= currentValue )
               {
-              currentQueue.push( inputIt.GetIndex()
-                                 + noIt.GetNeighborhoodOffset() );
+              currentQueue.push_back(q);
               }
             else
               {
-              fah[GrayVal].push( inputIt.GetIndex()
-                                 + noIt.GetNeighborhoodOffset() );
+              fah[GrayVal].push_back(q);
               }
             progress.CompletedPixel();
             }
@@ -440,6 +417,26 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
         }
       }
     }
+
+  // copy the labels to the output image
+  ImageRegionIterator< LabelImageType > outputIt( outputImage, outputImage->GetRequestedRegion() );
+  std::fill(position, position + ImageDimension, 0);
+  p = firstPixel;
+  for ( outputIt.GoToBegin(); !outputIt.IsAtEnd(); ++outputIt )
+    {
+    outputIt.Set(output[p]);
+
+    ++p;
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      if ( ++position[d] < size[d] )
+        {
+        break;
+        }
+      position[d] = 0;
+      p += 2 * strides[d];
+      }
+    }
 }
 
 template< class TInputImage, class TLabelImage >
@@ -39,6 +39,18 @@ namespace itk
  * The filter computes a second output image (accessed by the GetScalesOutput method)
  * containing the scales at which each pixel gave the best reponse.
  *
+ * By default the Hessian and the measure are computed over the whole image
+ * at each scale, so the filter holds a tensor image of the size of the
+ * input.  When NumberOfStreamDivisions is greater than one, the output is
+ * computed in that many blocks instead.  For each block, the input is
+ * extracted with a margin, the Hessian and the measure are computed at
+ * every scale on this padded block only, and the best response so far is
+ * kept for the pixels of the block.  The tensor and measure images then
+ * have the size of a block.  The margin is StreamPaddingInSigmas times the
+ * largest sigma, so that the recursive Gaussian filters barely see the
+ * edges of the block; the responses differ from the unstreamed ones by
+ * the tail of the smoothing kernel beyond this margin.
+ *
  * \author Luca Antiga Ph.D.  Medical Imaging Unit,
  *                            Bioengineering Deparment, Mario Negri Institute, Italy.
  *
@@ -166,6 +178,16 @@ public:
   itkGetConstMacro(GenerateHessianOutput, bool);
   itkBooleanMacro(GenerateHessianOutput);
 
+  /** Set/Get the number of blocks in which the output is computed. The
+   * default, 1, computes each scale over the whole image. */
+  itkSetClampMacro( NumberOfStreamDivisions, unsigned int, 1, NumericTraits< unsigned int >::max() );
+  itkGetConstMacro(NumberOfStreamDivisions, unsigned int);
+
+  /** Set/Get the margin around the blocks, in multiples of the largest
+   * sigma. The default is 4. */
+  itkSetMacro(StreamPaddingInSigmas, double);
+  itkGetConstMacro(StreamPaddingInSigmas, double);
+
   /** This is overloaded to create the Scales and Hessian output images */
   virtual DataObjectPointer MakeOutput(unsigned int idx);
 
@@ -178,7 +200,7 @@ protected:
   void GenerateData(void);
 
 private:
-  void UpdateMaximumResponse(double sigma);
+  void UpdateMaximumResponse(double sigma, const OutputRegionType & region);
 
   double ComputeSigmaValue(int scaleLevel);
 
@@ -204,6 +226,9 @@ private:
 
   bool m_GenerateScalesOutput;
   bool m_GenerateHessianOutput;
+
+  unsigned int m_NumberOfStreamDivisions;
+  double       m_StreamPaddingInSigmas;
 };
 } // end namespace itk
 
@@ -20,8 +20,12 @@
 
 #include "itkMultiScaleHessianBasedMeasureImageFilter.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionSplitter.h"
+#include "itkExtractImageFilter.h"
 #include "vnl/vnl_math.h"
 
+#include <vector>
+
 namespace itk
 {
 /**
@@ -51,6 +55,9 @@ MultiScaleHessianBasedMeasureImageFilter
   m_GenerateScalesOutput = false;
   m_GenerateHessianOutput = false;
 
+  m_NumberOfStreamDivisions = 1;
+  m_StreamPaddingInSigmas = 4.0;
+
   typename ScalesImageType::Pointer scalesImage = ScalesImageType::New();
   typename HessianImageType::Pointer hessianImage = HessianImageType::New();
   this->ProcessObject::SetNumberOfRequiredOutputs(3);
@@ -172,62 +179,110 @@ MultiScaleHessianBasedMeasureImageFilter
 
   typename InputImageType::ConstPointer input = this->GetInput();
 
-  this->m_HessianFilter->SetInput(input);
-
   this->m_HessianFilter->SetNormalizeAcrossScale(true);
 
+  // the scales, from the smallest
+  std::vector< double > sigmas;
+  double                sigma = m_SigmaMinimum;
+  int                   scaleLevel = 1;
+  while ( sigma <= m_SigmaMaximum )
+    {
+    if ( m_NumberOfSigmaSteps == 0 )
+      {
+      break;
+      }
+    sigmas.push_back(sigma);
+    sigma  = this->ComputeSigmaValue(scaleLevel);
+    scaleLevel++;
+    if ( m_NumberOfSigmaSteps == 1 )
+      {
+      break;
+      }
+    }
+
+  // the blocks of the output
+  const OutputRegionType outputRegion = this->GetOutput()->GetRequestedRegion();
+  typedef ImageRegionSplitter< itkGetStaticConstMacro(ImageDimension) > SplitterType;
+  typename SplitterType::Pointer splitter = SplitterType::New();
+  const unsigned int numberOfBlocks =
+    splitter->GetNumberOfSplits(outputRegion, m_NumberOfStreamDivisions);
+
+  // the margin of the blocks
+  typename OutputRegionType::SizeType padding;
+  padding.Fill(0);
+  if ( numberOfBlocks > 1 && !sigmas.empty() )
+    {
+    const double maximumSigma = sigmas.back();
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      padding[d] = static_cast< typename OutputRegionType::SizeType::SizeValueType >(
+        vcl_ceil(m_StreamPaddingInSigmas * maximumSigma / input->GetSpacing()[d]) ) + 4;
+      }
+    }
+
+  typedef ExtractImageFilter< InputImageType, InputImageType > ExtractFilterType;
+  typename ExtractFilterType::Pointer extractFilter = ExtractFilterType::New();
+  extractFilter->SetInput(input);
+
   // Create a process accumulator for tracking the progress of this
   // minipipeline
   ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-  progress = ProgressAccumulator::New();
   progress->SetMiniPipelineFilter(this);
 
   // prevent a divide by zero
-  if ( m_NumberOfSigmaSteps > 0 )
+  if ( !sigmas.empty() )
     {
-    progress->RegisterInternalFilter(this->m_HessianFilter, .5 / m_NumberOfSigmaSteps);
-    progress->RegisterInternalFilter(this->m_HessianToMeasureFilter, .5 / m_NumberOfSigmaSteps);
+    const float weight = 0.5f / ( sigmas.size() * numberOfBlocks );
+    progress->RegisterInternalFilter(this->m_HessianFilter, weight);
+    progress->RegisterInternalFilter(this->m_HessianToMeasureFilter, weight);
     }
 
-  double sigma = m_SigmaMinimum;
-
-  int scaleLevel = 1;
-
-  while ( sigma <= m_SigmaMaximum )
+  for ( unsigned int block = 0; block < numberOfBlocks; block++ )
     {
-    if ( m_NumberOfSigmaSteps == 0 )
+    const OutputRegionType blockRegion = splitter->GetSplit(block, numberOfBlocks, outputRegion);
+
+    if ( numberOfBlocks > 1 )
       {
-      break;
+      typename InputImageType::RegionType paddedRegion = blockRegion;
+      paddedRegion.PadByRadius(padding);
+      paddedRegion.Crop( input->GetLargestPossibleRegion() );
+      extractFilter->SetExtractionRegion(paddedRegion);
+      this->m_HessianFilter->SetInput( extractFilter->GetOutput() );
+      }
+    else
+      {
+      this->m_HessianFilter->SetInput(input);
       }
 
-    itkDebugMacro (<< "Computing measure for scale with sigma = " << sigma);
-
-    m_HessianFilter->SetSigma(sigma);
-
-    m_HessianToMeasureFilter->SetInput ( m_HessianFilter->GetOutput() );
-
-    m_HessianToMeasureFilter->Update();
+    for ( unsigned int s = 0; s < sigmas.size(); s++ )
+      {
+      itkDebugMacro (<< "Computing measure for scale with sigma = " << sigmas[s]);
 
-    this->UpdateMaximumResponse(sigma);
+      m_HessianFilter->SetSigma(sigmas[s]);
 
-    sigma  = this->ComputeSigmaValue(scaleLevel);
+      m_HessianToMeasureFilter->SetInput ( m_HessianFilter->GetOutput() );
 
-    scaleLevel++;
+      m_HessianToMeasureFilter->UpdateLargestPossibleRegion();
 
-    // reset the progress accumulator after each pass to continue
-    // addtion of progress for the next pass
-    progress->ResetFilterProgressAndKeepAccumulatedProgress();
+      this->UpdateMaximumResponse(sigmas[s], blockRegion);
 
-    if ( m_NumberOfSigmaSteps == 1 )
-      {
-      break;
+      // reset the progress accumulator after each pass to continue
+      // addtion of progress for the next pass
+      progress->ResetFilterProgressAndKeepAccumulatedProgress();
       }
     }
 
+  if ( numberOfBlocks > 1 )
+    {
+    // the images of the last block are not part of the result
+    this->m_HessianFilter->SetInput(input);
+    m_HessianFilter->GetOutput()->ReleaseData();
+    m_HessianToMeasureFilter->GetOutput()->ReleaseData();
+    }
+
   // Write out the best response to the output image
   // we can assume that the meta-data should match between these two
   // image, therefore we iterate over the desired output region
-  OutputRegionType                        outputRegion = this->GetOutput()->GetBufferedRegion();
   ImageRegionIterator< UpdateBufferType > it(m_UpdateBuffer, outputRegion);
   it.GoToBegin();
 
@@ -251,11 +306,10 @@ template< typename TInputImage,
 void
 MultiScaleHessianBasedMeasureImageFilter
 < TInputImage, THessianImage, TOutputImage >
-::UpdateMaximumResponse(double sigma)
+::UpdateMaximumResponse(double sigma, const OutputRegionType & outputRegion)
 {
   // the meta-data should match between these images, therefore we
-  // iterate over the desired output region
-  OutputRegionType outputRegion = this->GetOutput()->GetBufferedRegion();
+  // iterate over the given region of the output
 
   ImageRegionIterator< UpdateBufferType > oit(m_UpdateBuffer, outputRegion);
 
@@ -419,6 +473,8 @@ MultiScaleHessianBasedMeasureImageFilter
   os << indent << "NonNegativeHessianBasedMeasure:  " << m_NonNegativeHessianBasedMeasure << std::endl;
   os << indent << "GenerateScalesOutput: " << m_GenerateScalesOutput << std::endl;
   os << indent << "GenerateHessianOutput: " << m_GenerateHessianOutput << std::endl;
+  os << indent << "NumberOfStreamDivisions: " << m_NumberOfStreamDivisions << std::endl;
+  os << indent << "StreamPaddingInSigmas: " << m_StreamPaddingInSigmas << std::endl;
 }
 } // end namespace itk
 
@@ -93,7 +93,9 @@ int main( int argc, char * argv[] )
 
   inputsize = inputreader->GetOutput()->GetLargestPossibleRegion().GetSize();
 
-  // worksize is the nearest multiple of 2 larger than the input
+  // worksize is the next power of 2 larger than the input.  The vnl
+  // transforms accept any size, but they are the fastest for the sizes
+  // without prime factors other than 2, 3 and 5.
   for( unsigned int i=0; i < 2; i++ )
     {
     int n=0;
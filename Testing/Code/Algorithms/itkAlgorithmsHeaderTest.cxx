@@ -69,6 +69,7 @@
 #include "itkFFTRealToComplexConjugateImageFilter.txx"
 #include "itkFFTWCommon.h"
 #include "itkFFTWComplexConjugateToRealImageFilter.txx"
+#include "itkFFTWGlobalConfiguration.h"
 #include "itkFFTWRealToComplexConjugateImageFilter.txx"
 #endif
 #include "itkFastChamferDistanceImageFilter.txx"
@@ -178,6 +179,7 @@
 #include "itkUnsharpMaskLevelSetImageFilter.txx"
 #include "itkVectorThresholdSegmentationLevelSetFunction.txx"
 #include "itkVectorThresholdSegmentationLevelSetImageFilter.txx"
+#include "itkVnlFFTCommon.txx"
 #include "itkVnlFFTComplexConjugateToRealImageFilter.txx"
 #include "itkVnlFFTRealToComplexConjugateImageFilter.txx"
 #include "itkVoronoiDiagram2D.txx"
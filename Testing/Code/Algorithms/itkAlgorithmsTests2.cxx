@@ -42,6 +42,7 @@ void RegisterTests()
   REGISTER_TEST(itkMatchCardinalityImageToImageMetricTest );
   REGISTER_TEST(itkOtsuMultipleThresholdsCalculatorTest );
   REGISTER_TEST(itkOtsuMultipleThresholdsImageFilterTest );
+  REGISTER_TEST(itkPDEDeformableRegistrationFilterSmoothingTest );
   REGISTER_TEST(itkPointSetToPointSetRegistrationTest );
   REGISTER_TEST(itkPointSetToSpatialObjectDemonsRegistrationTest );
   REGISTER_TEST(itkRegularSphereMeshSourceTest );
@@ -42,6 +42,7 @@ void RegisterTests()
   REGISTER_TEST(itkMultiResolutionImageRegistrationMethodTest_1 );
   REGISTER_TEST(itkMultiResolutionImageRegistrationMethodTest_2 );
   REGISTER_TEST(itkMultiResolutionPDEDeformableRegistrationTest );
+  REGISTER_TEST(itkMultiResolutionPyramidImageCacheTest );
   REGISTER_TEST(itkMultiResolutionPyramidImageFilterTest );
   REGISTER_TEST(itkMutualInformationHistogramImageToImageMetricTest );
   REGISTER_TEST(itkMutualInformationMetricTest );
@@ -32,13 +32,18 @@ void RegisterTests()
   REGISTER_TEST(itkBinaryMedialNodeMetricTest); //Test disabled when centerd coordinates not used
   REGISTER_TEST(itkCurvesLevelSetImageFilterZeroSigmaTest );
   REGISTER_TEST(itkFastMarchingUpwindGradientTest );
+  REGISTER_TEST(itkFastMarchingFastIterativeTest );
   REGISTER_TEST(itkGeodesicActiveContourLevelSetImageFilterZeroSigmaTest );
   REGISTER_TEST(itkLabelVotingImageFilterTest );
   REGISTER_TEST(itkNarrowBandCurvesLevelSetImageFilterTest );
+  REGISTER_TEST(itkSparseFieldLevelSetThreadingTest );
   REGISTER_TEST(itkVectorThresholdSegmentationLevelSetImageFilterTest );
   REGISTER_TEST(itkWatershedImageFilterTest );
+  REGISTER_TEST(itkWatershedImageFilterStreamingTest );
+  REGISTER_TEST(itkWatershedSegmenterBoundaryTest );
   REGISTER_TEST(itkVoronoiPartitioningImageFilterTest );
   REGISTER_TEST(itkVnlFFTTest);
+  REGISTER_TEST(itkVnlFFTArbitrarySizeTest);
 #if defined(USE_FFTWF)
   REGISTER_TEST(itkFFTWF_FFTTest);
   REGISTER_TEST(itkVnlFFTWF_FFTTest);
@@ -47,6 +52,9 @@ void RegisterTests()
   REGISTER_TEST(itkFFTWD_FFTTest);
   REGISTER_TEST(itkVnlFFTWD_FFTTest);
 #endif
+#if defined(USE_FFTWF) || defined(USE_FFTWD)
+  REGISTER_TEST(itkFFTWPlanCacheTest);
+#endif
 #if defined(USE_FFTWD)
   REGISTER_TEST(itkCurvatureRegistrationFilterTest);
 #endif
@@ -26,6 +26,8 @@
 #include "itkRescaleIntensityImageFilter.h"
 #include "itkImageFileWriter.h"
 
+#include <vector>
+
 int itkCollidingFrontsImageFilterTest(int argc, char* argv[] )
 {
 
@@ -112,6 +114,7 @@ int itkCollidingFrontsImageFilterTest(int argc, char* argv[] )
       iterator ( output, output->GetBufferedRegion() );
 
   bool passed = true;
+  std::vector<bool> negative;
 
   for ( ; !iterator.IsAtEnd(); ++iterator )
     {
@@ -125,6 +128,7 @@ int itkCollidingFrontsImageFilterTest(int argc, char* argv[] )
       }
     distance = vcl_sqrt( distance );
     InternalImageType::PixelType outputPixel = iterator.Get();
+    negative.push_back( outputPixel < 0.0 );
 
     // for test to pass, the circle of radius 10 centered in offset
     // must be made up only of negative pixels and vice-versa
@@ -187,6 +191,37 @@ int itkCollidingFrontsImageFilterTest(int argc, char* argv[] )
     std::cout << err << std::endl;
     }
 
+  // the fast iterative method must select the same region
+  collidingFronts->StopOnTargetsOff();
+  collidingFronts->UseFastIterativeMethodOn();
+  try
+    {
+    collidingFronts->Update();
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cout << err << std::endl;
+    }
+
+  itk::ImageRegionIterator<InternalImageType>
+      fastIterativeIterator ( collidingFronts->GetOutput(),
+                              collidingFronts->GetOutput()->GetBufferedRegion() );
+  for ( unsigned int i = 0; !fastIterativeIterator.IsAtEnd(); ++fastIterativeIterator, i++ )
+    {
+    if ( ( fastIterativeIterator.Get() < 0.0 ) != negative[i] )
+      {
+      std::cout << "Fast iterative method: " << fastIterativeIterator.Get()
+                << " at " << fastIterativeIterator.GetIndex() << std::endl;
+      passed = false;
+      }
+    }
+
+  if (!passed)
+    {
+    std::cout << "Colliding Fronts test with the fast iterative method failed. " << std::endl;
+    return EXIT_FAILURE;
+    }
+
   std::cout << "Colliding Fronts test passed. " << std::endl;
   return EXIT_SUCCESS;
 
@@ -0,0 +1,155 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkConfigure.h"
+
+#if defined(USE_FFTWF) || defined(USE_FFTWD)
+
+#include "itkFFTWRealToComplexConjugateImageFilter.h"
+#include "itkFFTWComplexConjugateToRealImageFilter.h"
+#include "itkVnlFFTRealToComplexConjugateImageFilter.h"
+#include "itkImageRegionIterator.h"
+
+#include <iostream>
+
+// Transform images of several sizes again and again, with several numbers
+// of threads and both plan rigors, so the shared plans are computed and
+// then reused.  The FFTW transforms are compared with the vnl ones.
+namespace
+{
+template< class TPixel >
+bool TestPlanCache( double tolerance )
+{
+  typedef itk::Image< TPixel, 2 >                                       RealImageType;
+  typedef itk::FFTWRealToComplexConjugateImageFilter< TPixel, 2 >       FFTType;
+  typedef itk::FFTWComplexConjugateToRealImageFilter< TPixel, 2 >       IFFTType;
+  typedef itk::VnlFFTRealToComplexConjugateImageFilter< TPixel, 2 >     VnlFFTType;
+  typedef typename FFTType::TOutputImageType                           ComplexImageType;
+
+  const unsigned int sizes[][2] = { { 8, 6 }, { 7, 5 }, { 8, 6 }, { 9, 1 } };
+  const int numberOfThreads[] = { 1, 2 };
+  const unsigned int rigors[] = { FFTW_ESTIMATE, FFTW_MEASURE };
+
+  for( unsigned int r = 0; r < 2; r++ )
+    {
+    itk::FFTWGlobalConfiguration::SetPlanRigor( rigors[r] );
+    for( unsigned int s = 0; s < 4; s++ )
+      {
+      typename RealImageType::SizeType size;
+      size[0] = sizes[s][0];
+      size[1] = sizes[s][1];
+      typename RealImageType::RegionType region;
+      region.SetSize( size );
+
+      typename RealImageType::Pointer image = RealImageType::New();
+      image->SetRegions( region );
+      image->Allocate();
+      unsigned long seed = 31 * s + 7;
+      itk::ImageRegionIterator< RealImageType > it( image, region );
+      for( ; !it.IsAtEnd(); ++it )
+        {
+        seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+        it.Set( static_cast< TPixel >( ( seed % 1000 ) / 100.0 ) );
+        }
+
+      typename VnlFFTType::Pointer vnlFFT = VnlFFTType::New();
+      vnlFFT->SetInput( image );
+      vnlFFT->Update();
+
+      for( unsigned int t = 0; t < 2; t++ )
+        {
+        typename FFTType::Pointer fft = FFTType::New();
+        fft->SetInput( image );
+        fft->SetNumberOfThreads( numberOfThreads[t] );
+        fft->Update();
+
+        // the FFTW output only holds the first half of the fastest dimension
+        itk::ImageRegionIterator< ComplexImageType > fftIt(
+          fft->GetOutput(), fft->GetOutput()->GetLargestPossibleRegion() );
+        for( ; !fftIt.IsAtEnd(); ++fftIt )
+          {
+          const typename ComplexImageType::PixelType expected =
+            vnlFFT->GetOutput()->GetPixel( fftIt.GetIndex() );
+          if( vcl_abs( fftIt.Get() - expected ) > tolerance * region.GetNumberOfPixels() )
+            {
+            std::cout << "Transform of size " << size << " at " << fftIt.GetIndex()
+                      << ": " << fftIt.Get() << " instead of " << expected << std::endl;
+            return false;
+            }
+          }
+
+        typename IFFTType::Pointer ifft = IFFTType::New();
+        ifft->SetInput( fft->GetOutput() );
+        ifft->SetNumberOfThreads( numberOfThreads[t] );
+        ifft->Update();
+        itk::ImageRegionIterator< RealImageType > ifftIt( ifft->GetOutput(), region );
+        for( it.GoToBegin(); !it.IsAtEnd(); ++it, ++ifftIt )
+          {
+          if( vnl_math_abs( it.Get() - ifftIt.Get() ) > tolerance * 10.0 )
+            {
+            std::cout << "Inverse transform of size " << size << ": " << ifftIt.Get()
+                      << " instead of " << it.Get() << std::endl;
+            return false;
+            }
+          }
+
+        // the input of the inverse transform is left alone
+        itk::ImageRegionIterator< ComplexImageType > inputIt(
+          fft->GetOutput(), fft->GetOutput()->GetLargestPossibleRegion() );
+        for( ; !inputIt.IsAtEnd(); ++inputIt )
+          {
+          if( vcl_abs( inputIt.Get() - vnlFFT->GetOutput()->GetPixel( inputIt.GetIndex() ) )
+              > tolerance * region.GetNumberOfPixels() )
+            {
+            std::cout << "The inverse transform changed its input" << std::endl;
+            return false;
+            }
+          }
+        }
+      }
+    }
+  itk::FFTWGlobalConfiguration::SetPlanRigor( FFTW_ESTIMATE );
+  return true;
+}
+}
+
+int itkFFTWPlanCacheTest(int, char* [] )
+{
+  bool passed = true;
+
+#if defined(USE_FFTWD)
+  passed &= TestPlanCache< double >( 1e-12 );
+#endif
+#if defined(USE_FFTWF)
+  passed &= TestPlanCache< float >( 1e-5 );
+#endif
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
+
+#endif
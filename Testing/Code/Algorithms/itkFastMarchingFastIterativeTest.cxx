@@ -0,0 +1,352 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkFastMarchingUpwindGradientImageFilter.h"
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include "vnl/vnl_math.h"
+
+#include <iostream>
+
+// Compare the fast iterative method with fast marching on the same
+// problem: the arrival times must agree up to round-off and the points
+// must be labeled the same way.
+namespace
+{
+const double Tolerance = 1e-4;
+
+template< class TMarcher >
+void SetupMarcher( TMarcher * marcher,
+                   typename TMarcher::SpeedImageType * speedImage,
+                   double stoppingValue )
+{
+  typedef typename TMarcher::NodeType          NodeType;
+  typedef typename TMarcher::NodeContainer     NodeContainer;
+  typedef typename TMarcher::IndexType         IndexType;
+  const unsigned int Dimension = TMarcher::SetDimension;
+
+  typename NodeContainer::Pointer alivePoints = NodeContainer::New();
+  typename NodeContainer::Pointer trialPoints = NodeContainer::New();
+
+  // an alive point with its neighbors as trial points
+  IndexType center;
+  for( unsigned int j = 0; j < Dimension; j++ )
+    {
+    center[j] = 7 + 2 * j;
+    }
+
+  NodeType node;
+  node.SetValue( 0.0 );
+  node.SetIndex( center );
+  alivePoints->InsertElement( 0, node );
+
+  for( unsigned int j = 0; j < Dimension; j++ )
+    {
+    for( int s = -1; s < 2; s += 2 )
+      {
+      IndexType index = center;
+      index[j] += s;
+      node.SetValue( 1.0 );
+      node.SetIndex( index );
+      trialPoints->InsertElement( trialPoints->Size(), node );
+      }
+    }
+
+  // an isolated trial point and an out of range trial point
+  IndexType index;
+  index.Fill( 3 );
+  index[0] = speedImage->GetBufferedRegion().GetSize()[0] - 4;
+  node.SetValue( 4.0 );
+  node.SetIndex( index );
+  trialPoints->InsertElement( trialPoints->Size(), node );
+
+  index.Fill( 300 );
+  node.SetIndex( index );
+  trialPoints->InsertElement( trialPoints->Size(), node );
+
+  marcher->SetAlivePoints( alivePoints );
+  marcher->SetTrialPoints( trialPoints );
+  marcher->SetInput( speedImage );
+  marcher->SetStoppingValue( stoppingValue );
+}
+
+template< class TMarcher >
+bool CompareMarchers( TMarcher * reference, TMarcher * marcher )
+{
+  typedef typename TMarcher::LevelSetImageType LevelSetImageType;
+  typedef typename TMarcher::LabelImageType    LabelImageType;
+
+  itk::ImageRegionIteratorWithIndex< LevelSetImageType > refIt(
+    reference->GetOutput(), reference->GetOutput()->GetBufferedRegion() );
+  itk::ImageRegionIteratorWithIndex< LevelSetImageType > it(
+    marcher->GetOutput(), marcher->GetOutput()->GetBufferedRegion() );
+  itk::ImageRegionIteratorWithIndex< LabelImageType > refLabelIt(
+    reference->GetLabelImage(), reference->GetLabelImage()->GetBufferedRegion() );
+  itk::ImageRegionIteratorWithIndex< LabelImageType > labelIt(
+    marcher->GetLabelImage(), marcher->GetLabelImage()->GetBufferedRegion() );
+
+  unsigned long numberOfAlivePoints = 0;
+  for( ; !refIt.IsAtEnd(); ++refIt, ++it, ++refLabelIt, ++labelIt )
+    {
+    const double refValue = refIt.Get();
+    const double value = it.Get();
+    if( vnl_math_abs( refValue - value ) > Tolerance * vnl_math_max( 1.0, refValue ) )
+      {
+      std::cout << "Value at " << refIt.GetIndex() << ": " << value
+                << " instead of " << refValue << std::endl;
+      return false;
+      }
+    if( refLabelIt.Get() != labelIt.Get() )
+      {
+      std::cout << "Label at " << refIt.GetIndex() << ": "
+                << static_cast< int >( labelIt.Get() ) << " instead of "
+                << static_cast< int >( refLabelIt.Get() ) << std::endl;
+      return false;
+      }
+    if( labelIt.Get() == TMarcher::AlivePoint )
+      {
+      numberOfAlivePoints++;
+      }
+    }
+
+  if( numberOfAlivePoints < 10 )
+    {
+    std::cout << "Too few alive points: " << numberOfAlivePoints << std::endl;
+    return false;
+    }
+
+  // the processed points are collected in order of arrival time
+  if( reference->GetProcessedPoints()->Size() != marcher->GetProcessedPoints()->Size() )
+    {
+    std::cout << "Collected " << marcher->GetProcessedPoints()->Size()
+              << " points instead of " << reference->GetProcessedPoints()->Size() << std::endl;
+    return false;
+    }
+  for( unsigned long i = 1; i < marcher->GetProcessedPoints()->Size(); i++ )
+    {
+    if( marcher->GetProcessedPoints()->GetElement( i ).GetValue()
+        < marcher->GetProcessedPoints()->GetElement( i - 1 ).GetValue() )
+      {
+      std::cout << "Processed points are not sorted" << std::endl;
+      return false;
+      }
+    }
+
+  return true;
+}
+
+template< unsigned int VDimension >
+bool TestFastIterativeMethod( unsigned int sizeValue, double stoppingValue )
+{
+  typedef itk::Image< float, VDimension >                          ImageType;
+  typedef itk::FastMarchingUpwindGradientImageFilter< ImageType >  MarcherType;
+  typedef typename MarcherType::GradientImageType                  GradientImageType;
+
+  // a speed image with slow and fast areas
+  typename ImageType::SizeType size;
+  size.Fill( sizeValue );
+  typename ImageType::RegionType region;
+  region.SetSize( size );
+
+  typename ImageType::Pointer speedImage = ImageType::New();
+  speedImage->SetRegions( region );
+  speedImage->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > speedIt( speedImage, region );
+  for( ; !speedIt.IsAtEnd(); ++speedIt )
+    {
+    double speed = 1.0;
+    for( unsigned int j = 0; j < VDimension; j++ )
+      {
+      speed += 0.4 * vcl_sin( 0.3 * ( j + 1 ) * speedIt.GetIndex()[j] );
+      }
+    speedIt.Set( static_cast< float >( vnl_math_max( speed, 0.1 ) ) );
+    }
+
+  typename MarcherType::Pointer reference = MarcherType::New();
+  SetupMarcher< MarcherType >( reference, speedImage, stoppingValue );
+  reference->CollectPointsOn();
+  reference->GenerateGradientImageOn();
+  reference->Update();
+
+  // blocks that do not divide the image and several threads
+  typename MarcherType::Pointer marcher = MarcherType::New();
+  SetupMarcher< MarcherType >( marcher, speedImage, stoppingValue );
+  marcher->CollectPointsOn();
+  marcher->GenerateGradientImageOn();
+  marcher->UseFastIterativeMethodOn();
+  marcher->SetFastIterativeBlockSize( 5 );
+  marcher->SetNumberOfThreads( 3 );
+  marcher->Update();
+
+  if( !CompareMarchers< MarcherType >( reference, marcher ) )
+    {
+    std::cout << "Fast iterative method differs in dimension " << VDimension << std::endl;
+    return false;
+    }
+
+  itk::ImageRegionIteratorWithIndex< GradientImageType > refGradientIt(
+    reference->GetGradientImage(), reference->GetGradientImage()->GetBufferedRegion() );
+  itk::ImageRegionIteratorWithIndex< GradientImageType > gradientIt(
+    marcher->GetGradientImage(), marcher->GetGradientImage()->GetBufferedRegion() );
+  for( ; !refGradientIt.IsAtEnd(); ++refGradientIt, ++gradientIt )
+    {
+    for( unsigned int j = 0; j < VDimension; j++ )
+      {
+      if( vnl_math_abs( refGradientIt.Get()[j] - gradientIt.Get()[j] ) > 1e-3 )
+        {
+        std::cout << "Gradient at " << refGradientIt.GetIndex() << ": "
+                  << gradientIt.Get() << " instead of " << refGradientIt.Get() << std::endl;
+        return false;
+        }
+      }
+    }
+
+  if( reference->GetTargetValue() != marcher->GetTargetValue() )
+    {
+    std::cout << "TargetValue " << marcher->GetTargetValue() << " instead of "
+              << reference->GetTargetValue() << std::endl;
+    return false;
+    }
+
+  // the front stops after reaching the targets
+  typedef typename MarcherType::NodeContainer NodeContainer;
+  typename NodeContainer::Pointer targetPoints = NodeContainer::New();
+  typename MarcherType::NodeType node;
+  typename ImageType::IndexType index;
+  index.Fill( 2 );
+  node.SetIndex( index );
+  targetPoints->InsertElement( 0, node );
+  index.Fill( 10 );
+  index[0] = 14;
+  node.SetIndex( index );
+  targetPoints->InsertElement( 1, node );
+
+  for( unsigned int mode = 0; mode < 2; mode++ )
+    {
+    MarcherType * marchers[2] = { reference, marcher };
+    for( unsigned int m = 0; m < 2; m++ )
+      {
+      marchers[m]->SetTargetPoints( targetPoints );
+      marchers[m]->SetTargetOffset( 0.5 );
+      if( mode == 0 )
+        {
+        marchers[m]->SetTargetReachedModeToOneTarget();
+        }
+      else
+        {
+        marchers[m]->SetTargetReachedModeToAllTargets();
+        }
+      marchers[m]->Update();
+      }
+
+    if( !CompareMarchers< MarcherType >( reference, marcher ) )
+      {
+      std::cout << "Fast iterative method differs with targets in dimension "
+                << VDimension << std::endl;
+      return false;
+      }
+    if( vnl_math_abs( reference->GetTargetValue() - marcher->GetTargetValue() ) > Tolerance
+        || marcher->GetStoppingValue() != stoppingValue )
+      {
+      std::cout << "TargetValue " << marcher->GetTargetValue() << " instead of "
+                << reference->GetTargetValue() << std::endl;
+      return false;
+      }
+    }
+
+  // The values, the labels, the gradients and the target value do not
+  // depend on the number of threads.
+  const int numberOfThreads[] = { 1, 2, 4 };
+  for( unsigned int t = 0; t < 3; t++ )
+    {
+    typename MarcherType::Pointer threaded = MarcherType::New();
+    SetupMarcher< MarcherType >( threaded, speedImage, stoppingValue );
+    threaded->CollectPointsOn();
+    threaded->GenerateGradientImageOn();
+    threaded->UseFastIterativeMethodOn();
+    threaded->SetFastIterativeBlockSize( 5 );
+    threaded->SetNumberOfThreads( numberOfThreads[t] );
+    threaded->SetTargetPoints( targetPoints );
+    threaded->SetTargetOffset( 0.5 );
+    threaded->SetTargetReachedModeToAllTargets();
+    threaded->Update();
+
+    if( threaded->GetTargetValue() != marcher->GetTargetValue() )
+      {
+      std::cout << "TargetValue with " << numberOfThreads[t] << " threads: "
+                << threaded->GetTargetValue() << " instead of "
+                << marcher->GetTargetValue() << std::endl;
+      return false;
+      }
+    if( threaded->GetReachedTargetPoints()->Size() != marcher->GetReachedTargetPoints()->Size() )
+      {
+      std::cout << "Reached " << threaded->GetReachedTargetPoints()->Size()
+                << " targets with " << numberOfThreads[t] << " threads instead of "
+                << marcher->GetReachedTargetPoints()->Size() << std::endl;
+      return false;
+      }
+
+    typedef typename MarcherType::LabelImageType LabelImageType;
+    const typename ImageType::RegionType & bufferedRegion = marcher->GetOutput()->GetBufferedRegion();
+    itk::ImageRegionIteratorWithIndex< ImageType >         valueIt( marcher->GetOutput(), bufferedRegion );
+    itk::ImageRegionIteratorWithIndex< ImageType >         threadedValueIt( threaded->GetOutput(), bufferedRegion );
+    itk::ImageRegionIteratorWithIndex< LabelImageType >    labelIt( marcher->GetLabelImage(), bufferedRegion );
+    itk::ImageRegionIteratorWithIndex< LabelImageType >    threadedLabelIt( threaded->GetLabelImage(), bufferedRegion );
+    itk::ImageRegionIteratorWithIndex< GradientImageType > gradientIt( marcher->GetGradientImage(), bufferedRegion );
+    itk::ImageRegionIteratorWithIndex< GradientImageType > threadedGradientIt( threaded->GetGradientImage(), bufferedRegion );
+    for( ; !valueIt.IsAtEnd(); ++valueIt, ++threadedValueIt, ++labelIt, ++threadedLabelIt,
+           ++gradientIt, ++threadedGradientIt )
+      {
+      if( valueIt.Get() != threadedValueIt.Get() || labelIt.Get() != threadedLabelIt.Get()
+          || gradientIt.Get() != threadedGradientIt.Get() )
+        {
+        std::cout << "With " << numberOfThreads[t] << " threads at " << valueIt.GetIndex()
+                  << ": value " << threadedValueIt.Get() << " instead of " << valueIt.Get()
+                  << ", label " << static_cast< int >( threadedLabelIt.Get() )
+                  << " instead of " << static_cast< int >( labelIt.Get() ) << std::endl;
+        return false;
+        }
+      }
+    }
+
+  return true;
+}
+}
+
+int itkFastMarchingFastIterativeTest(int, char* [] )
+{
+  bool passed = true;
+
+  passed &= TestFastIterativeMethod< 2 >( 37, 25.0 );
+  passed &= TestFastIterativeMethod< 2 >( 30, 1000.0 );
+  passed &= TestFastIterativeMethod< 3 >( 19, 9.0 );
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -140,6 +140,7 @@ int itkFastMarchingTest(int, char* [] )
   speedImage->Print( std::cout );
   marcher->SetInput( speedImage );
   marcher->SetStoppingValue( 100.0 );
+  marcher->CollectPointsOn();
 
   // turn on debugging
   marcher->DebugOn();
@@ -186,6 +187,39 @@ int itkFastMarchingTest(int, char* [] )
 
     }
 
+  // The points are processed in increasing order of value, each one once
+  NodeContainer::Pointer processedPoints = marcher->GetProcessedPoints();
+  FloatImage::Pointer processedImage = FloatImage::New();
+  processedImage->SetRegions( output->GetBufferedRegion() );
+  processedImage->Allocate();
+  processedImage->FillBuffer( 0.0 );
+  for ( unsigned int i = 0; i < processedPoints->Size(); i++ )
+    {
+    node = processedPoints->GetElement( i );
+    if ( i > 0 && node.GetValue() < processedPoints->GetElement( i - 1 ).GetValue() )
+      {
+      std::cout << "Point " << node.GetIndex() << " processed out of order" << std::endl;
+      passed = false;
+      }
+    if ( node.GetValue() != output->GetPixel( node.GetIndex() ) )
+      {
+      std::cout << "Point " << node.GetIndex() << " processed with a stale value" << std::endl;
+      passed = false;
+      }
+    if ( processedImage->GetPixel( node.GetIndex() ) != 0.0 )
+      {
+      std::cout << "Point " << node.GetIndex() << " processed twice" << std::endl;
+      passed = false;
+      }
+    processedImage->SetPixel( node.GetIndex(), 1.0 );
+    }
+  // all the pixels but the alive point
+  if ( processedPoints->Size() != size[0] * size[1] - 1 )
+    {
+    std::cout << processedPoints->Size() << " points processed" << std::endl;
+    passed = false;
+    }
+
   // Exercise other member functions
   std::cout << "SpeedConstant: " << marcher->GetSpeedConstant() << std::endl;
   std::cout << "StoppingValue: " << marcher->GetStoppingValue() << std::endl;
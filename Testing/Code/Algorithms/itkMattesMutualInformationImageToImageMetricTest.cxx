@@ -405,7 +405,8 @@ int TestMattesMetricWithAffineTransform(
 template< class TImage, class TInterpolator>
 int TestMattesMetricWithBSplineDeformableTransform(
   TInterpolator * interpolator, bool useSampling,
-  bool useExplicitJointPDFDerivatives, bool useCachingBSplineWeights )
+  bool useExplicitJointPDFDerivatives, bool useCachingBSplineWeights,
+  bool useSparsePDFDerivatives )
 {
 
 //------------------------------------------------------------
@@ -563,6 +564,7 @@ int TestMattesMetricWithBSplineDeformableTransform(
 
   metric->SetUseExplicitPDFDerivatives( useExplicitJointPDFDerivatives );
   metric->SetUseCachingOfBSplineWeights( useCachingBSplineWeights );
+  metric->SetUseSparsePDFDerivatives( useSparsePDFDerivatives );
 
   if( useSampling )
     {
@@ -694,6 +696,7 @@ int itkMattesMutualInformationImageToImageMetricTest(int argc, char * argv [] )
 
   bool useExplicitJointPDFDerivatives = true;
   bool useCachingBSplineWeights = true;
+  bool useSparsePDFDerivatives = false;
 
   if( argc > 1 )
     {
@@ -705,6 +708,11 @@ int itkMattesMutualInformationImageToImageMetricTest(int argc, char * argv [] )
     useCachingBSplineWeights = atoi( argv[2] );
     }
 
+  if( argc > 3 )
+    {
+    useSparsePDFDerivatives = atoi( argv[3] );
+    }
+
   int failed;
   typedef itk::Image<unsigned char,2> ImageType;
 
@@ -774,7 +782,8 @@ int itkMattesMutualInformationImageToImageMetricTest(int argc, char * argv [] )
   useSampling = true;
   failed = TestMattesMetricWithBSplineDeformableTransform<
     ImageType,BSplineInterpolatorType>( bSplineInterpolator, useSampling,
-        useExplicitJointPDFDerivatives, useCachingBSplineWeights );
+        useExplicitJointPDFDerivatives, useCachingBSplineWeights,
+        useSparsePDFDerivatives );
 
   if ( failed )
     {
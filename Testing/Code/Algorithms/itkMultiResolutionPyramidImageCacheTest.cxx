@@ -0,0 +1,279 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkMultiResolutionPyramidImageCache.h"
+#include "itkRecursiveMultiResolutionPyramidImageFilter.h"
+#include "itkShiftScaleImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkMultiThreader.h"
+#include "itkCommand.h"
+
+#include <iostream>
+
+namespace
+{
+// Count the executions of the pyramid filter
+class PyramidExecutionCounter
+{
+public:
+  PyramidExecutionCounter() { m_Count = 0; }
+  void Count() { ++m_Count; }
+  unsigned int m_Count;
+};
+
+typedef itk::Image< float, 2 >                             ImageType;
+typedef itk::MultiResolutionPyramidImageCache< ImageType > CacheType;
+typedef CacheType::PyramidType                             PyramidType;
+
+// Request the same levels from several threads
+struct ThreadedRequestStruct
+{
+  CacheType                    *Cache;
+  ImageType                    *Image;
+  itk::Command                 *Command;
+  CacheType::LevelContainerType Levels[4];
+};
+
+ITK_THREAD_RETURN_TYPE ThreadedRequest( void *arg )
+{
+  itk::MultiThreader::ThreadInfoStruct *info =
+    static_cast< itk::MultiThreader::ThreadInfoStruct * >( arg );
+  ThreadedRequestStruct *str = static_cast< ThreadedRequestStruct * >( info->UserData );
+
+  PyramidType::Pointer pyramid = PyramidType::New();
+  pyramid->SetNumberOfLevels( 3 );
+  pyramid->SetNumberOfThreads( 1 );
+  pyramid->AddObserver( itk::StartEvent(), str->Command );
+  str->Levels[info->ThreadID] = str->Cache->GetLevels( pyramid, str->Image );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+}
+
+int itkMultiResolutionPyramidImageCacheTest(int, char* [] )
+{
+  ImageType::SizeType size = {{64,64}};
+  ImageType::RegionType region;
+  region.SetSize( size );
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+
+  itk::ImageRegionIterator< ImageType > it( image, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    it.Set( static_cast< float >( it.GetIndex()[0] * it.GetIndex()[1] ) );
+    }
+
+  PyramidType::Pointer pyramid = PyramidType::New();
+  pyramid->SetNumberOfLevels( 3 );
+
+  PyramidExecutionCounter counter;
+  typedef itk::SimpleMemberCommand< PyramidExecutionCounter > CommandType;
+  CommandType::Pointer command = CommandType::New();
+  command->SetCallbackFunction( &counter, &PyramidExecutionCounter::Count );
+  pyramid->AddObserver( itk::StartEvent(), command );
+
+  CacheType::Pointer cache = CacheType::New();
+  cache->Print( std::cout );
+
+  // The first request runs the pyramid.
+  CacheType::LevelContainerType levels = cache->GetLevels( pyramid, image );
+  if( levels.size() != 3 || counter.m_Count != 1 )
+    {
+    std::cerr << "First request: got " << levels.size() << " levels and "
+              << counter.m_Count << " executions" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for( unsigned int level = 0; level < levels.size(); level++ )
+    {
+    const unsigned int factor = pyramid->GetSchedule()[level][0];
+    if( levels[level]->GetLargestPossibleRegion().GetSize()[0] != size[0] / factor )
+      {
+      std::cerr << "Level " << level << " has the wrong size" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The second request must come from the cache, even through another
+  // pyramid filter with the same schedule.
+  PyramidType::Pointer pyramid2 = PyramidType::New();
+  pyramid2->SetNumberOfLevels( 3 );
+  pyramid2->AddObserver( itk::StartEvent(), command );
+
+  CacheType::LevelContainerType levels2 = cache->GetLevels( pyramid2, image );
+  if( counter.m_Count != 1 )
+    {
+    std::cerr << "Second request executed the pyramid" << std::endl;
+    return EXIT_FAILURE;
+    }
+  for( unsigned int level = 0; level < levels.size(); level++ )
+    {
+    if( levels[level] != levels2[level] )
+      {
+      std::cerr << "Second request returned different levels" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // A different schedule is a different entry.
+  pyramid2->SetNumberOfLevels( 2 );
+  if( cache->HasLevels( image, pyramid2 ) )
+    {
+    std::cerr << "Unexpected cached levels for a different schedule" << std::endl;
+    return EXIT_FAILURE;
+    }
+  cache->GetLevels( pyramid2, image );
+  if( counter.m_Count != 2 || cache->GetNumberOfEntries() != 1 )
+    {
+    std::cerr << "Different schedule: " << counter.m_Count << " executions, "
+              << cache->GetNumberOfEntries() << " entries" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Modifying the image invalidates the cached levels.
+  cache->SetMaximumNumberOfEntries( 2 );
+  cache->GetLevels( pyramid, image );
+  if( counter.m_Count != 3 || cache->GetNumberOfEntries() != 2 )
+    {
+    std::cerr << "Two entries expected" << std::endl;
+    return EXIT_FAILURE;
+    }
+  image->Modified();
+  cache->GetLevels( pyramid, image );
+  if( counter.m_Count != 4 || cache->GetNumberOfEntries() != 1 )
+    {
+    std::cerr << "Modified image: " << counter.m_Count << " executions, "
+              << cache->GetNumberOfEntries() << " entries" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Externally provided levels are returned as is.
+  cache->ReleaseLevels();
+  cache->SetLevels( image, pyramid, levels );
+  CacheType::LevelContainerType levels3 = cache->GetLevels( pyramid, image );
+  if( counter.m_Count != 4 || levels3[0] != levels[0] )
+    {
+    std::cerr << "Externally provided levels were not used" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  bool caught = false;
+  try
+    {
+    CacheType::LevelContainerType tooFew( 1 );
+    cache->SetLevels( image, pyramid, tooFew );
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    std::cout << "Caught expected exception: " << err.GetDescription() << std::endl;
+    caught = true;
+    }
+  if( !caught )
+    {
+    std::cerr << "Mismatched number of levels was accepted" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A pyramid of another type with the same schedule is a different entry.
+  typedef itk::RecursiveMultiResolutionPyramidImageFilter< ImageType, ImageType > RecursivePyramidType;
+  RecursivePyramidType::Pointer recursive = RecursivePyramidType::New();
+  recursive->SetNumberOfLevels( 3 );
+  recursive->AddObserver( itk::StartEvent(), command );
+  if( cache->HasLevels( image, recursive.GetPointer() ) )
+    {
+    std::cerr << "Unexpected cached levels for a recursive pyramid" << std::endl;
+    return EXIT_FAILURE;
+    }
+  cache->GetLevels( recursive, image );
+  if( counter.m_Count != 5 )
+    {
+    std::cerr << "Recursive pyramid was not executed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // So is a pyramid with another maximum error.
+  cache->SetMaximumNumberOfEntries( 4 );
+  pyramid2->SetNumberOfLevels( 3 );
+  pyramid2->SetMaximumError( 0.01 );
+  cache->GetLevels( pyramid2, image );
+  if( counter.m_Count != 6 )
+    {
+    std::cerr << "Pyramid with another maximum error was not executed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The image is brought up to date before the lookup: a change upstream
+  // of the image gives new levels.
+  typedef itk::ShiftScaleImageFilter< ImageType, ImageType > ShiftType;
+  ShiftType::Pointer shift = ShiftType::New();
+  shift->SetInput( image );
+  shift->SetShift( 1.0 );
+  shift->Update();
+
+  CacheType::LevelContainerType shifted = cache->GetLevels( pyramid, shift->GetOutput() );
+  if( counter.m_Count != 7 )
+    {
+    std::cerr << "Shifted image: " << counter.m_Count << " executions" << std::endl;
+    return EXIT_FAILURE;
+    }
+  shift->SetShift( 100.0 );
+  CacheType::LevelContainerType reshifted = cache->GetLevels( pyramid, shift->GetOutput() );
+  ImageType::IndexType origin = {{ 0, 0 }};
+  if( counter.m_Count != 8
+      || reshifted[2]->GetPixel( origin ) - shifted[2]->GetPixel( origin ) < 98.0 )
+    {
+    std::cerr << "Stale levels returned after a change of the source: "
+              << counter.m_Count << " executions, " << reshifted[2]->GetPixel( origin )
+              << " and " << shifted[2]->GetPixel( origin ) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Requests from several threads run the pyramid once.
+  cache->ReleaseLevels();
+  counter.m_Count = 0;
+  ThreadedRequestStruct str;
+  str.Cache = cache;
+  str.Image = image;
+  str.Command = command;
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( 4 );
+  threader->SetSingleMethod( ThreadedRequest, &str );
+  threader->SingleMethodExecute();
+  if( counter.m_Count != 1 )
+    {
+    std::cerr << "Threaded requests: " << counter.m_Count << " executions" << std::endl;
+    return EXIT_FAILURE;
+    }
+  for( int t = 1; t < threader->GetNumberOfThreads(); t++ )
+    {
+    if( str.Levels[t].size() != 3 || str.Levels[t][0] != str.Levels[0][0] )
+      {
+      std::cerr << "Thread " << t << " got different levels" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
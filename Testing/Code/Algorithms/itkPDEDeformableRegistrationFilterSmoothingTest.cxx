@@ -0,0 +1,211 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkDemonsRegistrationFilter.h"
+#include "itkGaussianOperator.h"
+#include "itkVectorNeighborhoodOperatorImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include "vnl/vnl_math.h"
+
+#include <iostream>
+
+// Compare the in-place smoothing of the deformation and update fields of
+// the PDE deformable registration filters with the out-of-place smoothing
+// by one VectorNeighborhoodOperatorImageFilter per dimension.
+namespace
+{
+const unsigned int Dimension = 3;
+
+typedef itk::Image< float, Dimension >                          ImageType;
+typedef itk::Vector< float, Dimension >                         VectorType;
+typedef itk::Image< VectorType, Dimension >                     FieldType;
+
+class SmoothingTestFilter :
+  public itk::DemonsRegistrationFilter< ImageType, ImageType, FieldType >
+{
+public:
+  typedef SmoothingTestFilter                                                Self;
+  typedef itk::DemonsRegistrationFilter< ImageType, ImageType, FieldType >   Superclass;
+  typedef itk::SmartPointer< Self >                                          Pointer;
+  itkNewMacro( Self );
+
+  /** Smooth the field as the deformation field of the filter. */
+  void SmoothAsDeformationField( FieldType *field )
+    {
+    this->GraftOutput( field );
+    this->SmoothDeformationField();
+    }
+
+  /** Smooth the field with the update field standard deviations. */
+  void SmoothAsUpdateField( FieldType *field )
+    {
+    this->SmoothGivenField( field, this->GetUpdateFieldStandardDeviations() );
+    }
+
+protected:
+  SmoothingTestFilter() {}
+};
+
+FieldType::Pointer MakeField( const FieldType::SizeType & size )
+{
+  FieldType::RegionType region;
+  region.SetSize( size );
+
+  FieldType::Pointer field = FieldType::New();
+  field->SetRegions( region );
+  field->Allocate();
+
+  unsigned long seed = 777;
+  itk::ImageRegionIteratorWithIndex< FieldType > it( field, region );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    VectorType value;
+    for( unsigned int j = 0; j < Dimension; j++ )
+      {
+      seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+      value[j] = static_cast< float >( ( seed % 2000 ) / 100.0 - 10.0 );
+      }
+    it.Set( value );
+    }
+  return field;
+}
+
+FieldType::Pointer CopyField( const FieldType *field )
+{
+  FieldType::Pointer copy = FieldType::New();
+  copy->SetRegions( field->GetBufferedRegion() );
+  copy->Allocate();
+
+  itk::ImageRegionConstIteratorWithIndex< FieldType > in( field, field->GetBufferedRegion() );
+  itk::ImageRegionIteratorWithIndex< FieldType >      out( copy, field->GetBufferedRegion() );
+  for( ; !in.IsAtEnd(); ++in, ++out )
+    {
+    out.Set( in.Get() );
+    }
+  return copy;
+}
+
+/** The smoothing of the filters before it was done in place. */
+FieldType::Pointer SmoothOutOfPlace( FieldType *field, const double *standardDeviations,
+                                     double maximumError, unsigned int maximumKernelWidth )
+{
+  typedef itk::GaussianOperator< float, Dimension >                           OperatorType;
+  typedef itk::VectorNeighborhoodOperatorImageFilter< FieldType, FieldType >  SmootherType;
+
+  FieldType::Pointer smoothed = field;
+  for( unsigned int j = 0; j < Dimension; j++ )
+    {
+    OperatorType oper;
+    oper.SetDirection( j );
+    oper.SetVariance( vnl_math_sqr( standardDeviations[j] ) );
+    oper.SetMaximumError( maximumError );
+    oper.SetMaximumKernelWidth( maximumKernelWidth );
+    oper.CreateDirectional();
+
+    SmootherType::Pointer smoother = SmootherType::New();
+    smoother->SetOperator( oper );
+    smoother->SetInput( smoothed );
+    smoother->Update();
+    smoothed = smoother->GetOutput();
+    smoothed->DisconnectPipeline();
+    }
+  return smoothed;
+}
+
+bool CompareFields( const char *name, int numberOfThreads,
+                    const FieldType *field, const FieldType *baseline )
+{
+  itk::ImageRegionConstIteratorWithIndex< FieldType > it( field, baseline->GetBufferedRegion() );
+  itk::ImageRegionConstIteratorWithIndex< FieldType > bIt( baseline, baseline->GetBufferedRegion() );
+  for( ; !bIt.IsAtEnd(); ++it, ++bIt )
+    {
+    // Only the rounding of the sums differs.
+    if( ( it.Get() - bIt.Get() ).GetNorm() > 1e-4 )
+      {
+      std::cout << name << " with " << numberOfThreads << " threads at "
+                << bIt.GetIndex() << ": " << it.Get() << " instead of "
+                << bIt.Get() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+bool TestSmoothing( const FieldType::SizeType & size,
+                    double *standardDeviations,
+                    double *updateStandardDeviations )
+{
+  const int numberOfThreads[] = { 1, 3 };
+  for( unsigned int t = 0; t < 2; t++ )
+    {
+    SmoothingTestFilter::Pointer filter = SmoothingTestFilter::New();
+    filter->SetStandardDeviations( standardDeviations );
+    filter->SetUpdateFieldStandardDeviations( updateStandardDeviations );
+    filter->SetMaximumError( 0.05 );
+    filter->SetMaximumKernelWidth( 12 );
+    filter->SetNumberOfThreads( numberOfThreads[t] );
+
+    FieldType::Pointer field = MakeField( size );
+    FieldType::Pointer baseline = SmoothOutOfPlace( CopyField( field ), standardDeviations,
+                                                    0.05, 12 );
+    filter->SmoothAsDeformationField( field );
+    if( !CompareFields( "Deformation field", numberOfThreads[t], field, baseline ) )
+      {
+      return false;
+      }
+
+    // smooth again, reusing the line buffers of the filter
+    field = MakeField( size );
+    baseline = SmoothOutOfPlace( CopyField( field ), updateStandardDeviations, 0.05, 12 );
+    filter->SmoothAsUpdateField( field );
+    if( !CompareFields( "Update field", numberOfThreads[t], field, baseline ) )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int itkPDEDeformableRegistrationFilterSmoothingTest(int, char* [] )
+{
+  bool passed = true;
+
+  double standardDeviations[Dimension] = { 1.0, 1.5, 0.5 };
+  double updateStandardDeviations[Dimension] = { 2.0, 0.8, 1.2 };
+
+  FieldType::SizeType size = {{ 17, 13, 11 }};
+  passed &= TestSmoothing( size, standardDeviations, updateStandardDeviations );
+
+  // kernels wider than the lines
+  FieldType::SizeType thin = {{ 15, 3, 2 }};
+  passed &= TestSmoothing( thin, standardDeviations, updateStandardDeviations );
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
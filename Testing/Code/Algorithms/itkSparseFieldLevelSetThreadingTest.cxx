@@ -0,0 +1,301 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkThresholdSegmentationLevelSetImageFilter.h"
+#include "itkGeodesicActiveContourLevelSetImageFilter.h"
+#include "itkGeodesicActiveContourShapePriorLevelSetImageFilter.h"
+#include "itkIsotropicFourthOrderLevelSetImageFilter.h"
+#include "itkPCAShapeSignedDistanceFunction.h"
+#include "itkAmoebaOptimizer.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <iostream>
+
+// The sparse field solver splits its layers among the threads.  The
+// result must not depend on the number of threads, and it must not change
+// much when the layers are compacted.
+namespace
+{
+typedef itk::Image< float, 3 > ImageType;
+
+template< class TFilter >
+bool CompareThreadedRuns( TFilter * singleThreaded, TFilter * multiThreaded )
+{
+  singleThreaded->SetNumberOfThreads( 1 );
+  singleThreaded->Update();
+
+  multiThreaded->SetNumberOfThreads( 4 );
+  multiThreaded->Update();
+
+  if( singleThreaded->GetElapsedIterations() != multiThreaded->GetElapsedIterations()
+      || singleThreaded->GetRMSChange() != multiThreaded->GetRMSChange() )
+    {
+    std::cout << "Iterations " << multiThreaded->GetElapsedIterations()
+              << " RMS " << multiThreaded->GetRMSChange() << " instead of "
+              << singleThreaded->GetElapsedIterations() << " RMS "
+              << singleThreaded->GetRMSChange() << std::endl;
+    return false;
+    }
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it(
+    singleThreaded->GetOutput(), singleThreaded->GetOutput()->GetBufferedRegion() );
+  itk::ImageRegionIteratorWithIndex< ImageType > threadedIt(
+    multiThreaded->GetOutput(), multiThreaded->GetOutput()->GetBufferedRegion() );
+  unsigned long numberOfInsidePixels = 0;
+  for( ; !it.IsAtEnd(); ++it, ++threadedIt )
+    {
+    if( it.Get() != threadedIt.Get() )
+      {
+      std::cout << "Pixel " << it.GetIndex() << ": " << threadedIt.Get()
+                << " instead of " << it.Get() << std::endl;
+      return false;
+      }
+    if( it.Get() < 0 )
+      {
+      numberOfInsidePixels++;
+      }
+    }
+
+  std::cout << singleThreaded->GetElapsedIterations() << " iterations, "
+            << numberOfInsidePixels << " pixels inside" << std::endl;
+  return numberOfInsidePixels > 0;
+}
+
+// The shape prior function evaluates its shape function in the threads.
+typedef itk::GeodesicActiveContourShapePriorLevelSetImageFilter< ImageType, ImageType > ShapePriorType;
+
+ShapePriorType::Pointer MakeShapePriorFilter( ImageType *initialImage, ImageType *potentialImage )
+{
+  typedef itk::PCAShapeSignedDistanceFunction< double, 3 >                ShapeFunctionType;
+  typedef itk::ShapePriorMAPCostFunction< ImageType, float >              CostFunctionType;
+  typedef itk::TranslationTransform< double, 3 >                          TransformType;
+  typedef ShapeFunctionType::ImageType                                    ComponentImageType;
+
+  // a sphere of radius 15 as the mean shape and a scale component
+  const ImageType::RegionType & region = initialImage->GetBufferedRegion();
+  ComponentImageType::Pointer meanImage = ComponentImageType::New();
+  meanImage->SetRegions( region );
+  meanImage->Allocate();
+  itk::ImageRegionIteratorWithIndex< ComponentImageType > it( meanImage, region );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    double distance = 0.0;
+    for( unsigned int j = 0; j < 3; j++ )
+      {
+      distance += vnl_math_sqr( it.GetIndex()[j] - 27.5 );
+      }
+    it.Set( vcl_sqrt( distance ) - 15.0 );
+    }
+
+  ShapeFunctionType::ImagePointerVector pca( 1 );
+  pca[0] = ComponentImageType::New();
+  pca[0]->SetRegions( region );
+  pca[0]->Allocate();
+  pca[0]->FillBuffer( 1.0 );
+
+  ShapeFunctionType::ParametersType pcaStandardDeviations( 1 );
+  pcaStandardDeviations.Fill( 1.0 );
+
+  ShapeFunctionType::Pointer shape = ShapeFunctionType::New();
+  shape->SetNumberOfPrincipalComponents( 1 );
+  shape->SetMeanImage( meanImage );
+  shape->SetPrincipalComponentImages( pca );
+  shape->SetTransform( TransformType::New() );
+  shape->SetPrincipalComponentStandardDeviations( pcaStandardDeviations );
+  shape->Initialize();
+
+  CostFunctionType::ArrayType mean( shape->GetNumberOfShapeParameters() );
+  CostFunctionType::ArrayType standardDeviation( shape->GetNumberOfShapeParameters() );
+  mean[0] = 0.0;
+  standardDeviation[0] = 3.0;
+  CostFunctionType::Pointer costFunction = CostFunctionType::New();
+  costFunction->SetShapeParameterMeans( mean );
+  costFunction->SetShapeParameterStandardDeviations( standardDeviation );
+
+  itk::AmoebaOptimizer::Pointer optimizer = itk::AmoebaOptimizer::New();
+  optimizer->SetFunctionConvergenceTolerance( 0.1 );
+  optimizer->SetParametersConvergenceTolerance( 0.5 );
+  optimizer->SetMaximumNumberOfIterations( 10 );
+
+  ShapePriorType::ParametersType parameters( shape->GetNumberOfParameters() );
+  parameters.Fill( 0.0 );
+  parameters[1] = 1.0;
+
+  ShapePriorType::Pointer filter = ShapePriorType::New();
+  filter->SetInput( initialImage );
+  filter->SetFeatureImage( potentialImage );
+  filter->SetShapeFunction( shape );
+  filter->SetCostFunction( costFunction );
+  filter->SetOptimizer( optimizer );
+  filter->SetInitialParameters( parameters );
+  filter->SetPropagationScaling( 0.5 );
+  filter->SetCurvatureScaling( 1.0 );
+  filter->SetShapePriorScaling( 0.5 );
+  filter->SetMaximumRMSError( 0.0 );
+  filter->SetNumberOfIterations( 5 );
+  return filter;
+}
+}
+
+int itkSparseFieldLevelSetThreadingTest(int, char* [] )
+{
+  // An initial sphere and a feature image with a bright box, large enough
+  // for the active layer to be split among several threads.
+  ImageType::SizeType size;
+  size.Fill( 56 );
+  ImageType::RegionType region;
+  region.SetSize( size );
+
+  ImageType::Pointer initialImage = ImageType::New();
+  initialImage->SetRegions( region );
+  initialImage->Allocate();
+
+  ImageType::Pointer featureImage = ImageType::New();
+  featureImage->SetRegions( region );
+  featureImage->Allocate();
+
+  ImageType::Pointer potentialImage = ImageType::New();
+  potentialImage->SetRegions( region );
+  potentialImage->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( initialImage, region );
+  itk::ImageRegionIteratorWithIndex< ImageType > featureIt( featureImage, region );
+  itk::ImageRegionIteratorWithIndex< ImageType > potentialIt( potentialImage, region );
+  for( ; !it.IsAtEnd(); ++it, ++featureIt, ++potentialIt )
+    {
+    double distance = 0.0;
+    bool inBox = true;
+    for( unsigned int j = 0; j < 3; j++ )
+      {
+      const double d = it.GetIndex()[j] - 27.5;
+      distance += d * d;
+      inBox &= ( it.GetIndex()[j] > 6 + 2 * static_cast< int >( j ) && it.GetIndex()[j] < 48 );
+      }
+    it.Set( static_cast< float >( vcl_sqrt( distance ) - 17.0 ) );
+    featureIt.Set( inBox ? 100.0f : 10.0f );
+    potentialIt.Set( inBox ? 1.0f : 0.1f );
+    }
+
+  bool passed = true;
+
+  typedef itk::ThresholdSegmentationLevelSetImageFilter< ImageType, ImageType > ThresholdType;
+  ThresholdType::Pointer threshold[2];
+  for( unsigned int i = 0; i < 2; i++ )
+    {
+    threshold[i] = ThresholdType::New();
+    threshold[i]->SetInput( initialImage );
+    threshold[i]->SetFeatureImage( featureImage );
+    threshold[i]->SetLowerThreshold( 50 );
+    threshold[i]->SetUpperThreshold( 150 );
+    threshold[i]->SetCurvatureScaling( 0.5 );
+    threshold[i]->SetMaximumRMSError( 0.0 );
+    threshold[i]->SetNumberOfIterations( 15 );
+    }
+  if( !CompareThreadedRuns< ThresholdType >( threshold[0], threshold[1] ) )
+    {
+    std::cout << "Threshold segmentation depends on the number of threads" << std::endl;
+    passed = false;
+    }
+
+  // Compacting the layers changes the order in which the nodes are
+  // updated, but not the solution.  The filters above do not compact.
+  ThresholdType::Pointer compacted = ThresholdType::New();
+  compacted->SetInput( initialImage );
+  compacted->SetFeatureImage( featureImage );
+  compacted->SetLowerThreshold( 50 );
+  compacted->SetUpperThreshold( 150 );
+  compacted->SetCurvatureScaling( 0.5 );
+  compacted->SetMaximumRMSError( 0.0 );
+  compacted->SetNumberOfIterations( 15 );
+  compacted->SetLayerCompactionInterval( 1 );
+  compacted->Update();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > compactedIt(
+    compacted->GetOutput(), compacted->GetOutput()->GetBufferedRegion() );
+  itk::ImageRegionIteratorWithIndex< ImageType > uncompactedIt(
+    threshold[0]->GetOutput(), threshold[0]->GetOutput()->GetBufferedRegion() );
+  double maximumDifference = 0.0;
+  for( ; !compactedIt.IsAtEnd(); ++compactedIt, ++uncompactedIt )
+    {
+    maximumDifference = vnl_math_max( maximumDifference,
+      static_cast< double >( vnl_math_abs( compactedIt.Get() - uncompactedIt.Get() ) ) );
+    }
+  std::cout << "Maximum difference with compaction: " << maximumDifference << std::endl;
+  if( maximumDifference > 0.01 )
+    {
+    std::cout << "Compacting the layers changes the solution" << std::endl;
+    passed = false;
+    }
+
+  typedef itk::GeodesicActiveContourLevelSetImageFilter< ImageType, ImageType > GeodesicType;
+  GeodesicType::Pointer geodesic[2];
+  for( unsigned int i = 0; i < 2; i++ )
+    {
+    geodesic[i] = GeodesicType::New();
+    geodesic[i]->SetInput( initialImage );
+    geodesic[i]->SetFeatureImage( featureImage );
+    geodesic[i]->SetPropagationScaling( -1.0 );
+    geodesic[i]->SetAdvectionScaling( 0.02 );
+    geodesic[i]->SetCurvatureScaling( 1.0 );
+    geodesic[i]->SetMaximumRMSError( 0.0 );
+    geodesic[i]->SetNumberOfIterations( 15 );
+    }
+  if( !CompareThreadedRuns< GeodesicType >( geodesic[0], geodesic[1] ) )
+    {
+    std::cout << "Geodesic active contour depends on the number of threads" << std::endl;
+    passed = false;
+    }
+
+  ShapePriorType::Pointer shapePrior[2];
+  for( unsigned int i = 0; i < 2; i++ )
+    {
+    shapePrior[i] = MakeShapePriorFilter( initialImage, potentialImage );
+    }
+  if( !CompareThreadedRuns< ShapePriorType >( shapePrior[0], shapePrior[1] ) )
+    {
+    std::cout << "Shape prior segmentation depends on the number of threads" << std::endl;
+    passed = false;
+    }
+
+  // The fourth order filters use a level set function with a refit term.
+  typedef itk::IsotropicFourthOrderLevelSetImageFilter< ImageType, ImageType > FourthOrderType;
+  FourthOrderType::Pointer fourthOrder[2];
+  for( unsigned int i = 0; i < 2; i++ )
+    {
+    fourthOrder[i] = FourthOrderType::New();
+    fourthOrder[i]->SetInput( initialImage );
+    fourthOrder[i]->SetMaxFilterIteration( 6 );
+    }
+  if( !CompareThreadedRuns< FourthOrderType >( fourthOrder[0], fourthOrder[1] ) )
+    {
+    std::cout << "Fourth order level set filter depends on the number of threads" << std::endl;
+    passed = false;
+    }
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,194 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkVnlFFTRealToComplexConjugateImageFilter.h"
+#include "itkVnlFFTComplexConjugateToRealImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include "vnl/vnl_math.h"
+
+#include <iostream>
+#include <vector>
+
+// Compare the vnl transforms of lines and images of any size with the
+// sums that define them, with one and several threads.
+namespace
+{
+template< class TPixel >
+bool TestLineTransforms( double tolerance )
+{
+  typedef itk::VnlFFTTransform< TPixel > TransformType;
+  typedef typename TransformType::ComplexType ComplexType;
+
+  for( unsigned long size = 1; size <= 40; size++ )
+    {
+    TransformType transform( size );
+
+    // three lines, interleaved like the columns of an image
+    const unsigned long numberOfLines = 3;
+    std::vector< ComplexType > data( size * numberOfLines );
+    for( unsigned long i = 0; i < data.size(); i++ )
+      {
+      data[i] = ComplexType( static_cast< TPixel >( vcl_sin( 0.7 * i ) + 0.1 * ( i % 5 ) ),
+                             static_cast< TPixel >( vcl_cos( 1.3 * i ) ) );
+      }
+
+    for( int direction = -1; direction <= 1; direction += 2 )
+      {
+      std::vector< ComplexType > transformed( data );
+      std::vector< ComplexType > work( numberOfLines * transform.GetWorkSize() );
+      transform.Transform( &transformed[0], numberOfLines, 1, numberOfLines, direction,
+                           work.empty() ? 0 : &work[0] );
+
+      for( unsigned long l = 0; l < numberOfLines; l++ )
+        {
+        for( unsigned long k = 0; k < size; k++ )
+          {
+          std::complex< double > sum( 0.0 );
+          for( unsigned long n = 0; n < size; n++ )
+            {
+            const double angle = direction * 2.0 * vnl_math::pi * ( ( n * k ) % size ) / size;
+            const ComplexType value = data[n * numberOfLines + l];
+            sum += std::complex< double >( value.real(), value.imag() )
+                   * std::complex< double >( vcl_cos( angle ), vcl_sin( angle ) );
+            }
+          const ComplexType value = transformed[k * numberOfLines + l];
+          if( vcl_abs( sum - std::complex< double >( value.real(), value.imag() ) )
+              > tolerance * size )
+            {
+            std::cout << "Transform of size " << size << " in direction " << direction
+                      << " at " << k << ": " << value << " instead of " << sum << std::endl;
+            return false;
+            }
+          }
+        }
+      }
+    }
+  return true;
+}
+
+template< class TPixel, unsigned int VDimension >
+bool TestImageTransforms( const unsigned int *sizeValues, double tolerance )
+{
+  typedef itk::Image< TPixel, VDimension >                                RealImageType;
+  typedef itk::VnlFFTRealToComplexConjugateImageFilter< TPixel, VDimension > FFTType;
+  typedef itk::VnlFFTComplexConjugateToRealImageFilter< TPixel, VDimension > IFFTType;
+  typedef typename FFTType::TOutputImageType                               ComplexImageType;
+
+  typename RealImageType::SizeType size;
+  for( unsigned int i = 0; i < VDimension; i++ )
+    {
+    size[i] = sizeValues[i];
+    }
+  typename RealImageType::RegionType region;
+  region.SetSize( size );
+
+  typename RealImageType::Pointer image = RealImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  unsigned long seed = 777;
+  itk::ImageRegionIteratorWithIndex< RealImageType > it( image, region );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+    it.Set( static_cast< TPixel >( ( seed % 1000 ) / 100.0 ) );
+    }
+
+  const int numberOfThreads[] = { 1, 3 };
+  for( unsigned int t = 0; t < 2; t++ )
+    {
+    typename FFTType::Pointer fft = FFTType::New();
+    fft->SetInput( image );
+    fft->SetNumberOfThreads( numberOfThreads[t] );
+    fft->Update();
+
+    // the sum that defines each frequency
+    itk::ImageRegionIteratorWithIndex< ComplexImageType > fftIt(
+      fft->GetOutput(), fft->GetOutput()->GetLargestPossibleRegion() );
+    for( ; !fftIt.IsAtEnd(); ++fftIt )
+      {
+      std::complex< double > sum( 0.0 );
+      for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+        {
+        double phase = 0.0;
+        for( unsigned int i = 0; i < VDimension; i++ )
+          {
+          phase += static_cast< double >( fftIt.GetIndex()[i] * it.GetIndex()[i] ) / size[i];
+          }
+        const double angle = -2.0 * vnl_math::pi * phase;
+        sum += static_cast< double >( it.Get() )
+               * std::complex< double >( vcl_cos( angle ), vcl_sin( angle ) );
+        }
+      const std::complex< double > value( fftIt.Get().real(), fftIt.Get().imag() );
+      if( vcl_abs( sum - value ) > tolerance * region.GetNumberOfPixels() )
+        {
+        std::cout << "Transform at " << fftIt.GetIndex() << ": " << value
+                  << " instead of " << sum << " with " << numberOfThreads[t]
+                  << " threads" << std::endl;
+        return false;
+        }
+      }
+
+    typename IFFTType::Pointer ifft = IFFTType::New();
+    ifft->SetInput( fft->GetOutput() );
+    ifft->SetNumberOfThreads( numberOfThreads[t] );
+    ifft->Update();
+    itk::ImageRegionIteratorWithIndex< RealImageType > ifftIt( ifft->GetOutput(), region );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it, ++ifftIt )
+      {
+      if( vnl_math_abs( it.Get() - ifftIt.Get() ) > tolerance * 10.0 )
+        {
+        std::cout << "Inverse transform at " << it.GetIndex() << ": " << ifftIt.Get()
+                  << " instead of " << it.Get() << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+}
+
+int itkVnlFFTArbitrarySizeTest(int, char* [] )
+{
+  bool passed = true;
+
+  passed &= TestLineTransforms< double >( 1e-12 );
+  passed &= TestLineTransforms< float >( 1e-5 );
+
+  const unsigned int size1D[] = { 97 };
+  passed &= TestImageTransforms< double, 1 >( size1D, 1e-12 );
+  const unsigned int size2D[] = { 14, 11 };
+  passed &= TestImageTransforms< double, 2 >( size2D, 1e-12 );
+  passed &= TestImageTransforms< float, 2 >( size2D, 1e-5 );
+  const unsigned int size3D[] = { 7, 6, 5 };
+  passed &= TestImageTransforms< double, 3 >( size3D, 1e-12 );
+  const unsigned int size4D[] = { 3, 4, 2, 5 };
+  passed &= TestImageTransforms< double, 4 >( size4D, 1e-12 );
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
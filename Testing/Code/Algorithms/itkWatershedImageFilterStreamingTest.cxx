@@ -0,0 +1,215 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkWatershedImageFilter.h"
+#include "itkShiftScaleImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <iostream>
+#include <map>
+
+// Segment the same input with and without streaming.  The labels may be
+// numbered differently, but they must describe the same regions.
+namespace
+{
+template< class TImage >
+typename TImage::Pointer CreateHeightImage( const typename TImage::SizeType & size )
+{
+  const unsigned int Dimension = TImage::ImageDimension;
+
+  typename TImage::RegionType region;
+  region.SetSize( size );
+
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions( region );
+  image->Allocate();
+
+  // smooth hills with some noise, without plateaus
+  unsigned long seed = 2011;
+  itk::ImageRegionIteratorWithIndex< TImage > it( image, region );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+    double value = 2.0 + 0.001 * ( seed % 1000 );
+    for( unsigned int j = 0; j < Dimension; j++ )
+      {
+      value += vcl_sin( 0.45 * ( j + 1 ) * it.GetIndex()[j] );
+      }
+    it.Set( static_cast< typename TImage::PixelType >( value ) );
+    }
+  return image;
+}
+
+template< class TLabelImage >
+bool SameRegions( const TLabelImage * reference, const TLabelImage * labels )
+{
+  typedef std::map< unsigned long, unsigned long > MapType;
+  MapType forward;
+  MapType backward;
+
+  itk::ImageRegionConstIteratorWithIndex< TLabelImage > refIt(
+    reference, reference->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIteratorWithIndex< TLabelImage > it(
+    labels, reference->GetLargestPossibleRegion() );
+  for( ; !refIt.IsAtEnd(); ++refIt, ++it )
+    {
+    MapType::iterator f = forward.find( refIt.Get() );
+    MapType::iterator b = backward.find( it.Get() );
+    if( f == forward.end() && b == backward.end() )
+      {
+      forward[refIt.Get()] = it.Get();
+      backward[it.Get()] = refIt.Get();
+      }
+    else if( f == forward.end() || b == backward.end()
+             || ( *f ).second != it.Get() || ( *b ).second != refIt.Get() )
+      {
+      std::cout << "Regions differ at " << refIt.GetIndex() << std::endl;
+      return false;
+      }
+    }
+
+  if( forward.size() < 3 )
+    {
+    std::cout << "Too few regions: " << forward.size() << std::endl;
+    return false;
+    }
+  return true;
+}
+
+template< class TImage >
+bool TestStreaming( const typename TImage::SizeType & size, double threshold,
+                    double level, double higherLevel )
+{
+  typedef itk::WatershedImageFilter< TImage >        FilterType;
+  typedef typename FilterType::OutputImageType        LabelImageType;
+  typedef itk::ShiftScaleImageFilter< TImage, TImage > ShiftScaleType;
+
+  typename TImage::Pointer image = CreateHeightImage< TImage >( size );
+
+  typename FilterType::Pointer reference = FilterType::New();
+  reference->SetInput( image );
+  reference->SetThreshold( threshold );
+  reference->SetLevel( level );
+  reference->Update();
+
+  typename FilterType::Pointer higherReference = FilterType::New();
+  higherReference->SetInput( image );
+  higherReference->SetThreshold( threshold );
+  higherReference->SetLevel( higherLevel );
+  higherReference->Update();
+
+  const unsigned int numberOfDivisions[] = { 2, 3, 4, 7 };
+  for( unsigned int d = 0; d < 4; d++ )
+    {
+    // The input goes through a filter, which produces one slab at a time.
+    typename ShiftScaleType::Pointer source = ShiftScaleType::New();
+    source->SetInput( image );
+
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( source->GetOutput() );
+    filter->SetThreshold( threshold );
+    filter->SetLevel( level );
+    filter->SetNumberOfStreamDivisions( numberOfDivisions[d] );
+    filter->Update();
+
+    const unsigned int lastAxis = TImage::ImageDimension - 1;
+    const typename TImage::RegionType buffered = source->GetOutput()->GetBufferedRegion();
+    if( buffered.GetSize( lastAxis ) > size[lastAxis] / numberOfDivisions[d] + 3 )
+      {
+      std::cout << "The input buffer " << buffered << " is not a slab with "
+                << numberOfDivisions[d] << " divisions" << std::endl;
+      return false;
+      }
+
+    bool caught = false;
+    try
+      {
+      filter->GetBasicSegmentation();
+      }
+    catch( itk::ExceptionObject & )
+      {
+      caught = true;
+      }
+    if( !caught )
+      {
+      std::cout << "The basic segmentation is available while streaming" << std::endl;
+      return false;
+      }
+    if( !SameRegions< LabelImageType >( reference->GetOutput(), filter->GetOutput() ) )
+      {
+      std::cout << "Segmentation with " << numberOfDivisions[d] << " divisions" << std::endl;
+      return false;
+      }
+
+    // raising the level segments the slabs again
+    filter->SetLevel( higherLevel );
+    filter->Update();
+    if( !SameRegions< LabelImageType >( higherReference->GetOutput(), filter->GetOutput() ) )
+      {
+      std::cout << "Segmentation at level " << higherLevel << " with "
+                << numberOfDivisions[d] << " divisions" << std::endl;
+      return false;
+      }
+
+    // back to the non-streamed mini-pipeline
+    filter->SetLevel( level );
+    filter->SetNumberOfStreamDivisions( 1 );
+    filter->Update();
+    if( !SameRegions< LabelImageType >( reference->GetOutput(), filter->GetOutput() ) )
+      {
+      std::cout << "Segmentation after streaming with " << numberOfDivisions[d]
+                << " divisions" << std::endl;
+      return false;
+      }
+    }
+
+  return true;
+}
+}
+
+int itkWatershedImageFilterStreamingTest(int, char* [] )
+{
+  typedef itk::Image< float, 2 >  ImageType2D;
+  typedef itk::Image< double, 3 > ImageType3D;
+
+  bool passed = true;
+
+  ImageType2D::SizeType size2D;
+  size2D[0] = 61;
+  size2D[1] = 57;
+  passed &= TestStreaming< ImageType2D >( size2D, 0.0, 0.0, 0.3 );
+  passed &= TestStreaming< ImageType2D >( size2D, 0.02, 0.1, 0.4 );
+
+  ImageType3D::SizeType size3D;
+  size3D[0] = 17;
+  size3D[1] = 15;
+  size3D[2] = 13;
+  passed &= TestStreaming< ImageType3D >( size3D, 0.0, 0.05, 0.25 );
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
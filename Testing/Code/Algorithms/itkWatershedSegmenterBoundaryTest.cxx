@@ -0,0 +1,223 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkWatershedSegmenter.h"
+#include "itkWatershedSegmentTreeGenerator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <iostream>
+
+// Check the boundary analysis of the watershed segmenter on chunks of a
+// data set, and the merge of equivalent segments by the segment tree
+// generator.
+namespace
+{
+const unsigned int Dimension = 3;
+
+typedef itk::Image< float, Dimension >                 ImageType;
+typedef itk::watershed::Segmenter< ImageType >         SegmenterType;
+typedef SegmenterType::BoundaryType                    BoundaryType;
+typedef SegmenterType::ImageRegionType                 RegionType;
+
+/** Segment a chunk of the image with boundary analysis on. */
+BoundaryType::Pointer AnalyzeChunk( ImageType *image, const RegionType & chunk )
+{
+  SegmenterType::Pointer segmenter = SegmenterType::New();
+  segmenter->SetInputImage( image );
+  segmenter->SetDoBoundaryAnalysis( true );
+  segmenter->SetLargestPossibleRegion( image->GetLargestPossibleRegion() );
+  segmenter->GetOutputImage()->SetRequestedRegion( chunk );
+  segmenter->Update();
+  return segmenter->GetBoundary();
+}
+
+/** Check that every pixel of a face flows through it, to the neighbor
+ * across the face.  The neighborhood of the segmenter has a radius of
+ * one. */
+bool FlowsAcross( const char *name, BoundaryType *boundary,
+                  unsigned int dimension, unsigned int highlow )
+{
+  if( !boundary->GetValid( dimension, highlow ) )
+    {
+    std::cout << name << ": face " << dimension << ", " << highlow
+              << " is not valid" << std::endl;
+    return false;
+    }
+
+  int stride = 1;
+  for( unsigned int d = 0; d < dimension; d++ )
+    {
+    stride *= 3;
+    }
+  const int center = 13;
+  const short expected = static_cast< short >( highlow ? center + stride : center - stride );
+
+  BoundaryType::face_t::Pointer face = boundary->GetFace( dimension, highlow );
+  itk::ImageRegionIteratorWithIndex< BoundaryType::face_t > it( face, face->GetRequestedRegion() );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    if( it.Get().flow != expected )
+      {
+      std::cout << name << ": flow " << it.Get().flow << " instead of " << expected
+                << " at " << it.GetIndex() << " of face " << dimension << ", "
+                << highlow << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+bool TestFlatFaces()
+{
+  // A flat image: every face pixel has a flat connection across the face.
+  ImageType::SizeType size = {{ 9, 8, 7 }};
+  ImageType::RegionType region;
+  region.SetSize( size );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  image->FillBuffer( 5.0f );
+
+  // a chunk inside the data set, with six faces on other chunks
+  RegionType chunk;
+  ImageType::IndexType index = {{ 2, 2, 2 }};
+  ImageType::SizeType  chunkSize = {{ 5, 4, 3 }};
+  chunk.SetIndex( index );
+  chunk.SetSize( chunkSize );
+
+  BoundaryType::Pointer boundary = AnalyzeChunk( image, chunk );
+  bool passed = true;
+  for( unsigned int d = 0; d < Dimension; d++ )
+    {
+    passed &= FlowsAcross( "Flat faces", boundary, d, 0 );
+    passed &= FlowsAcross( "Flat faces", boundary, d, 1 );
+    }
+  return passed;
+}
+
+bool TestFaceNextToWall()
+{
+  // The height decreases along the first dimension.  The chunk is the low
+  // half of the data set, so its high face along the first dimension is
+  // the only one on another chunk, and the steepest descent of its pixels
+  // crosses it.  The pixels on the edges of that face are also next to the
+  // retaining wall around the data set, which must not attract the flow.
+  // The chunk is large enough for its padded copy to be a fresh
+  // allocation.
+  ImageType::SizeType size = {{ 48, 40, 40 }};
+  ImageType::RegionType region;
+  region.SetSize( size );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    it.Set( static_cast< float >( 100 - it.GetIndex()[0] ) );
+    }
+
+  RegionType chunk = region;
+  chunk.SetSize( 0, 24 );
+
+  BoundaryType::Pointer boundary = AnalyzeChunk( image, chunk );
+  for( unsigned int d = 0; d < Dimension; d++ )
+    {
+    for( unsigned int highlow = 0; highlow < 2; highlow++ )
+      {
+      if( boundary->GetValid( d, highlow ) != ( d == 0 && highlow == 1 ) )
+        {
+        std::cout << "Face " << d << ", " << highlow << " has the wrong validity" << std::endl;
+        return false;
+        }
+      }
+    }
+  return FlowsAcross( "Face next to the wall", boundary, 0, 1 );
+}
+
+bool TestMergeEquivalencies()
+{
+  typedef itk::watershed::SegmentTreeGenerator< float > TreeGeneratorType;
+  typedef TreeGeneratorType::SegmentTableType           SegmentTableType;
+  typedef SegmentTableType::edge_pair_t                 EdgePairType;
+
+  // three segments in a row; the first two are equivalent
+  SegmentTableType::Pointer table = SegmentTableType::New();
+  SegmentTableType::segment_t segment;
+  segment.min = 0.0f;
+  segment.edge_list.push_back( EdgePairType( 2, 5.0f ) );
+  table->Add( 1, segment );
+  segment.edge_list.clear();
+  segment.min = 1.0f;
+  segment.edge_list.push_back( EdgePairType( 1, 5.0f ) );
+  segment.edge_list.push_back( EdgePairType( 3, 7.0f ) );
+  table->Add( 2, segment );
+  segment.edge_list.clear();
+  segment.min = 2.0f;
+  segment.edge_list.push_back( EdgePairType( 2, 7.0f ) );
+  table->Add( 3, segment );
+  table->SetMaximumDepth( 10.0f );
+
+  itk::EquivalencyTable::Pointer equivalencies = itk::EquivalencyTable::New();
+  equivalencies->Add( 1, 2 );
+
+  TreeGeneratorType::Pointer generator = TreeGeneratorType::New();
+  generator->SetInputSegmentTable( table );
+  generator->SetInputEquivalencyTable( equivalencies );
+  generator->SetMerge( true );
+  generator->SetConsumeInput( false );
+  generator->SetFloodLevel( 1.0 );
+  generator->Update();
+
+  // The equivalent segments are merged in the copy of the table, so only
+  // one merge is left for the tree.
+  if( generator->GetOutputSegmentTree()->Size() != 1 )
+    {
+    std::cout << "Merge tree of " << generator->GetOutputSegmentTree()->Size()
+              << " merges instead of 1" << std::endl;
+    return false;
+    }
+  if( table->Size() != 3 )
+    {
+    std::cout << "The input segment table has " << table->Size()
+              << " segments instead of 3" << std::endl;
+    return false;
+    }
+  return true;
+}
+}
+
+int itkWatershedSegmenterBoundaryTest(int, char* [] )
+{
+  bool passed = true;
+
+  passed &= TestFlatFaces();
+  passed &= TestFaceNextToWall();
+  passed &= TestMergeEquivalencies();
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -46,11 +46,13 @@ void RegisterTests()
   REGISTER_TEST(itkBilateralImageFilterTest );
   REGISTER_TEST(itkBilateralImageFilterTest2 );
   REGISTER_TEST(itkBilateralImageFilterTest3 );
+  REGISTER_TEST(itkBilateralImageFilterGridTest );
   REGISTER_TEST(itkBinaryDilateImageFilterTest );
   REGISTER_TEST(itkBinaryDilateImageFilterTest2 );
   REGISTER_TEST(itkBinaryDilateImageFilterTest3 );
   REGISTER_TEST(itkBinaryErodeImageFilterTest );
   REGISTER_TEST(itkBinaryErodeImageFilterTest3 );
+  REGISTER_TEST(itkBinaryMorphologyImageFilterThreadingTest );
   REGISTER_TEST(itkBinaryMagnitudeImageFilterTest );
   REGISTER_TEST(itkBinaryMaskToNarrowBandPointSetFilterTest);
   REGISTER_TEST(itkBinaryMedianImageFilterTest );
@@ -73,6 +75,7 @@ void RegisterTests()
   REGISTER_TEST(itkConfidenceConnectedImageFilterTest  );
   REGISTER_TEST(itkConnectedComponentImageFilterTest );
   REGISTER_TEST(itkConnectedComponentImageFilterTooManyObjectsTest );
+  REGISTER_TEST(itkConnectedComponentImageFilterThreadingTest );
   REGISTER_TEST(itkConnectedComponentImageFilterTestRGB );
   REGISTER_TEST(itkConnectedThresholdImageFilterTest  );
   REGISTER_TEST(itkConstantPadImageTest );
@@ -81,11 +84,13 @@ void RegisterTests()
   REGISTER_TEST(itkCurvatureAnisotropicDiffusionImageFilterTest );
   REGISTER_TEST(itkCyclicReferences );
   REGISTER_TEST(itkDanielssonDistanceMapImageFilterTest );
+  REGISTER_TEST(itkDanielssonDistanceMapImageFilterSeparableTest );
   REGISTER_TEST(itkDeformationFieldSourceTest );
   REGISTER_TEST(itkDerivativeImageFilterTest );
   REGISTER_TEST(itkDifferenceOfGaussiansGradientTest );
   REGISTER_TEST(itkDiffusionTensor3DReconstructionImageFilterTest);
   REGISTER_TEST(itkDiscreteGaussianImageFilterTest );
+  REGISTER_TEST(itkDiscreteGaussianImageFilterBlockTest );
   REGISTER_TEST(itkDivideImageFilterTest );
   REGISTER_TEST(itkDoubleThresholdImageFilterTest );
   REGISTER_TEST(itkEdgePotentialImageFilterTest );
@@ -147,6 +152,7 @@ void RegisterTests()
   REGISTER_TEST(itkMaximumImageFilterTest );
   REGISTER_TEST(itkMeanImageFilterTest );
   REGISTER_TEST(itkMedianImageFilterTest );
+  REGISTER_TEST(itkMedianImageFilterHistogramTest );
   REGISTER_TEST(itkMinimumImageFilterTest );
   REGISTER_TEST(itkMinimumMaximumImageCalculatorTest );
   REGISTER_TEST(itkMinimumMaximumImageFilterTest );
@@ -33,6 +33,7 @@ void RegisterTests()
   REGISTER_TEST(itkNaryMaximumImageFilterTest );
   REGISTER_TEST(itkNeighborhoodConnectedImageFilterTest  );
   REGISTER_TEST(itkNeighborhoodOperatorImageFilterTest );
+  REGISTER_TEST(itkNeighborhoodOperatorImageFilterInteriorTest );
   REGISTER_TEST(itkNoiseImageFilterTest );
   REGISTER_TEST(itkNonThreadedShrinkImageTest );
   REGISTER_TEST(itkNormalizeImageFilterTest  );
@@ -50,6 +51,7 @@ void RegisterTests()
   REGISTER_TEST(itkRGBToLuminanceImageFilterAndAdaptorTest );
   REGISTER_TEST(itkRecursiveGaussianImageFiltersTest );
   REGISTER_TEST(itkRecursiveGaussianImageFiltersOnTensorsTest );
+  REGISTER_TEST(itkRecursiveGaussianImageFilterParallelLinesTest );
   REGISTER_TEST(itkReflectImageFilterTest );
   REGISTER_TEST(itkReflectiveImageRegionIteratorTest );
   REGISTER_TEST(itkRegionOfInterestImageFilterTest );
@@ -58,6 +60,7 @@ void RegisterTests()
   REGISTER_TEST(itkRemoveBoundaryObjectsTest2 );
   REGISTER_TEST(itkResampleImageTest );
   REGISTER_TEST(itkResampleImageTest2 );
+  REGISTER_TEST(itkResampleImageTest3 );
   REGISTER_TEST(itkResamplePhasedArray3DSpecialCoordinatesImageTest );
   REGISTER_TEST(itkRescaleIntensityImageFilterTest );
 }
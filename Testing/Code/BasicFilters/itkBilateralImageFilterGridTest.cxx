@@ -0,0 +1,156 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkBilateralImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <iostream>
+
+// Compare the bilateral grid approximation with the exact bilateral
+// filter on noisy steps, with one and several threads, and check that a
+// grid too large to be allocated is refused.
+namespace
+{
+template< unsigned int VDimension >
+bool TestGrid(unsigned int size, double domainSigma, double tolerance)
+{
+  typedef itk::Image< float, VDimension >                   ImageType;
+  typedef itk::BilateralImageFilter< ImageType, ImageType > FilterType;
+
+  typename ImageType::SizeType imageSize;
+  imageSize.Fill(size);
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions(imageSize);
+  image->Allocate();
+
+  unsigned long seed = 31;
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+    const typename ImageType::IndexType index = it.GetIndex();
+    double value = ( index[0] > static_cast< long >( size / 2 ) ) ? 200.0 : 50.0;
+    if ( index[1] > static_cast< long >( size / 3 ) )
+      {
+      value += 100.0;
+      }
+    it.Set( static_cast< float >( value + ( ( seed % 1000 ) / 1000.0 - 0.5 ) * 40.0 ) );
+    }
+
+  typename FilterType::Pointer exact = FilterType::New();
+  exact->SetInput(image);
+  exact->SetDomainSigma(domainSigma);
+  exact->SetRangeSigma(30.0);
+  exact->Update();
+
+  typename ImageType::Pointer reference;
+  for ( int threads = 1; threads <= 3; threads += 2 )
+    {
+    typename FilterType::Pointer grid = FilterType::New();
+    grid->SetInput(image);
+    grid->SetDomainSigma(domainSigma);
+    grid->SetRangeSigma(30.0);
+    grid->UseBilateralGridOn();
+    grid->SetNumberOfThreads(threads);
+    grid->Update();
+
+    // the noise removed by the exact filter, and the error of the grid
+    double removed = 0.0;
+    double error = 0.0;
+    itk::ImageRegionIteratorWithIndex< ImageType > exactIt( exact->GetOutput(),
+                                                            image->GetLargestPossibleRegion() );
+    for ( ; !exactIt.IsAtEnd(); ++exactIt )
+      {
+      const typename ImageType::IndexType index = exactIt.GetIndex();
+      removed += vnl_math_abs( exactIt.Get() - image->GetPixel(index) );
+      error += vnl_math_abs( exactIt.Get() - grid->GetOutput()->GetPixel(index) );
+      if ( reference && reference->GetPixel(index) != grid->GetOutput()->GetPixel(index) )
+        {
+        std::cout << "The output with " << threads << " threads differs at " << index << std::endl;
+        return false;
+        }
+      }
+    const double numberOfPixels = image->GetLargestPossibleRegion().GetNumberOfPixels();
+    std::cout << VDimension << "D, " << threads << " threads: mean error " << error / numberOfPixels
+              << " for a mean correction of " << removed / numberOfPixels << std::endl;
+    if ( error > tolerance * removed )
+      {
+      return false;
+      }
+
+    reference = grid->GetOutput();
+    reference->DisconnectPipeline();
+    }
+  return true;
+}
+
+bool TestGridTooLarge()
+{
+  typedef itk::Image< float, 3 >                            ImageType;
+  typedef itk::BilateralImageFilter< ImageType, ImageType > FilterType;
+
+  // a dynamic range of a million range sigmas
+  ImageType::SizeType size;
+  size.Fill(40);
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+  image->FillBuffer(0.0f);
+  ImageType::IndexType index;
+  index.Fill(20);
+  image->SetPixel(index, 1e6f);
+
+  FilterType::Pointer grid = FilterType::New();
+  grid->SetInput(image);
+  grid->SetDomainSigma(2.0);
+  grid->SetRangeSigma(1.0);
+  grid->UseBilateralGridOn();
+  try
+    {
+    grid->Update();
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cout << "Expected exception: " << e.GetDescription() << std::endl;
+    return true;
+    }
+  std::cout << "The grid of a million range sigmas was not refused" << std::endl;
+  return false;
+}
+}
+
+int itkBilateralImageFilterGridTest(int, char* [] )
+{
+  bool passed = true;
+
+  passed &= TestGrid< 2 >(100, 3.0, 0.05);
+  passed &= TestGrid< 3 >(24, 2.0, 0.05);
+  passed &= TestGridTooLarge();
+
+  if ( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkBinaryDilateImageFilter.h"
+#include "itkBinaryErodeImageFilter.h"
+#include "itkFlatStructuringElement.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <iostream>
+
+// Dilate and erode a labeled image with several structuring elements and
+// numbers of threads, and compare with the definition of the Minkowski
+// addition applied pixel by pixel.
+namespace
+{
+template< class TImage, class TKernel >
+bool CheckMorphology( const TImage * input, const TImage * output,
+                      const typename TImage::RegionType & region,
+                      const TKernel & kernel, bool dilate, bool boundaryToForeground,
+                      typename TImage::PixelType foreground,
+                      typename TImage::PixelType background )
+{
+  typedef typename TImage::IndexType IndexType;
+
+  const typename TImage::RegionType largestRegion = input->GetLargestPossibleRegion();
+
+  // the dilation spreads the foreground, the erosion the background
+  const bool spreadBoundary = ( boundaryToForeground == dilate );
+
+  itk::ImageRegionConstIteratorWithIndex< TImage > it( output, region );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    const IndexType index = it.GetIndex();
+    bool reached = false;
+    for( unsigned int k = 0; k < kernel.Size() && !reached; k++ )
+      {
+      if( !kernel[k] )
+        {
+        continue;
+        }
+      const IndexType source = index - kernel.GetOffset( k );
+      if( largestRegion.IsInside( source ) )
+        {
+        reached = ( input->GetPixel( source ) == foreground ) == dilate;
+        }
+      else
+        {
+        reached = spreadBoundary;
+        }
+      }
+
+    const typename TImage::PixelType value = input->GetPixel( index );
+    typename TImage::PixelType expected = value;
+    if( reached == dilate )
+      {
+      expected = foreground;
+      }
+    else if( value == foreground )
+      {
+      expected = background;
+      }
+
+    if( it.Get() != expected )
+      {
+      std::cout << ( dilate ? "Dilation" : "Erosion" ) << " with boundary to foreground "
+                << boundaryToForeground << " differs at " << index << ": "
+                << static_cast< int >( it.Get() ) << " instead of "
+                << static_cast< int >( expected ) << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+template< unsigned int VDimension >
+bool TestMorphology( unsigned int sizeValue )
+{
+  typedef itk::Image< unsigned char, VDimension >                         ImageType;
+  typedef itk::FlatStructuringElement< VDimension >                       KernelType;
+  typedef itk::BinaryDilateImageFilter< ImageType, ImageType, KernelType > DilateType;
+  typedef itk::BinaryErodeImageFilter< ImageType, ImageType, KernelType >  ErodeType;
+
+  typename ImageType::SizeType size;
+  size.Fill( sizeValue );
+  size[0] += 7;
+  typename ImageType::RegionType region;
+  region.SetSize( size );
+
+  // several labels, with objects of many sizes and holes
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  unsigned long seed = 777;
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+    double value = 0.0;
+    for( unsigned int j = 0; j < VDimension; j++ )
+      {
+      value += vcl_sin( 0.5 * ( j + 1 ) * it.GetIndex()[j] );
+      }
+    unsigned char label = value > 0.8 ? 3 : 0;
+    if( ( seed >> 8 ) % 100 < 6 )
+      {
+      label = 3 - label;
+      }
+    if( label == 0 && ( seed >> 8 ) % 100 > 90 )
+      {
+      label = 7;
+      }
+    it.Set( label );
+    }
+
+  // the structuring elements: a ball, a cross, and an asymmetric random
+  // shape made of several pieces
+  typename KernelType::RadiusType radius;
+  for( unsigned int j = 0; j < VDimension; j++ )
+    {
+    radius[j] = 2 + j % 2;
+    }
+  KernelType kernels[3];
+  kernels[0] = KernelType::Ball( radius );
+  kernels[1] = KernelType::Cross( radius );
+  kernels[2].SetRadius( radius );
+  for( unsigned int k = 0; k < kernels[2].Size(); k++ )
+    {
+    seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+    kernels[2][k] = ( seed >> 8 ) % 3 == 0;
+    }
+
+  // a requested region which does not touch the image boundary
+  typename ImageType::RegionType requestedRegion = region;
+  requestedRegion.PadByRadius( -1 );
+  requestedRegion.SetSize( 0, requestedRegion.GetSize( 0 ) - 3 );
+
+  const int numberOfThreads[] = { 1, 3 };
+  for( unsigned int k = 0; k < 3; k++ )
+    {
+    for( unsigned int t = 0; t < 2; t++ )
+      {
+      for( unsigned int b = 0; b < 2; b++ )
+        {
+        typename DilateType::Pointer dilate = DilateType::New();
+        dilate->SetInput( image );
+        dilate->SetKernel( kernels[k] );
+        dilate->SetDilateValue( 3 );
+        dilate->SetBackgroundValue( 1 );
+        dilate->SetBoundaryToForeground( b );
+        dilate->SetNumberOfThreads( numberOfThreads[t] );
+        dilate->Update();
+        if( !CheckMorphology< ImageType, KernelType >( image, dilate->GetOutput(), region,
+                                                       kernels[k], true, b, 3, 1 ) )
+          {
+          std::cout << "with kernel " << k << " and " << numberOfThreads[t] << " threads" << std::endl;
+          return false;
+          }
+
+        typename ErodeType::Pointer erode = ErodeType::New();
+        erode->SetInput( image );
+        erode->SetKernel( kernels[k] );
+        erode->SetErodeValue( 3 );
+        erode->SetBackgroundValue( 1 );
+        erode->SetBoundaryToForeground( b );
+        erode->SetNumberOfThreads( numberOfThreads[t] );
+        erode->GetOutput()->SetRequestedRegion( requestedRegion );
+        erode->Update();
+        if( !CheckMorphology< ImageType, KernelType >( image, erode->GetOutput(), requestedRegion,
+                                                       kernels[k], false, b, 3, 1 ) )
+          {
+          std::cout << "with kernel " << k << " and " << numberOfThreads[t] << " threads" << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+
+  return true;
+}
+}
+
+int itkBinaryMorphologyImageFilterThreadingTest(int, char* [] )
+{
+  bool passed = true;
+
+  passed &= TestMorphology< 2 >( 45 );
+  passed &= TestMorphology< 3 >( 17 );
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,289 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkConnectedComponentImageFilter.h"
+#include "itkRelabelComponentImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <iostream>
+#include <vector>
+
+// Label a mask with several numbers of threads and compare with a flood
+// fill that visits the objects in raster order. The relabeled output must
+// not depend on the number of threads either.
+namespace
+{
+template< class TImage >
+typename TImage::Pointer CreateMask( unsigned int sizeValue )
+{
+  const unsigned int Dimension = TImage::ImageDimension;
+
+  typename TImage::SizeType size;
+  size.Fill( sizeValue );
+  size[0] += 5;
+  typename TImage::RegionType region;
+  region.SetSize( size );
+
+  typename TImage::Pointer mask = TImage::New();
+  mask->SetRegions( region );
+  mask->Allocate();
+
+  // a pseudo random pattern with objects of many sizes and shapes
+  unsigned long seed = 12345;
+  itk::ImageRegionIteratorWithIndex< TImage > it( mask, region );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+    double value = 0.0;
+    for( unsigned int j = 0; j < Dimension; j++ )
+      {
+      value += vcl_sin( 0.7 * ( j + 1 ) * it.GetIndex()[j] );
+      }
+    const bool inside = value > 1.2 || ( seed % 100 ) < 12;
+    it.Set( inside ? 200 : 0 );
+    }
+  return mask;
+}
+
+template< class TInputImage, class TLabelImage >
+typename TLabelImage::Pointer
+FloodFillReference( const TInputImage * mask, bool fullyConnected,
+                    unsigned long & numberOfObjects )
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  typedef typename TInputImage::IndexType  IndexType;
+  typedef typename TInputImage::OffsetType OffsetType;
+
+  const typename TInputImage::RegionType region = mask->GetLargestPossibleRegion();
+
+  typename TLabelImage::Pointer labels = TLabelImage::New();
+  labels->SetRegions( region );
+  labels->Allocate();
+  labels->FillBuffer( 0 );
+
+  // the neighbors of a pixel
+  std::vector< OffsetType > offsets;
+  OffsetType offset;
+  offset.Fill( -1 );
+  for( ;; )
+    {
+    unsigned int nonZero = 0;
+    for( unsigned int j = 0; j < Dimension; j++ )
+      {
+      nonZero += offset[j] != 0;
+      }
+    if( nonZero == 1 || ( fullyConnected && nonZero > 0 ) )
+      {
+      offsets.push_back( offset );
+      }
+    unsigned int j = 0;
+    while( j < Dimension && offset[j] == 1 )
+      {
+      offset[j++] = -1;
+      }
+    if( j == Dimension )
+      {
+      break;
+      }
+    offset[j]++;
+    }
+
+  numberOfObjects = 0;
+  itk::ImageRegionConstIteratorWithIndex< TInputImage > it( mask, region );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    if( it.Get() == 0 || labels->GetPixel( it.GetIndex() ) != 0 )
+      {
+      continue;
+      }
+    numberOfObjects++;
+    std::vector< IndexType > stack( 1, it.GetIndex() );
+    labels->SetPixel( it.GetIndex(), numberOfObjects );
+    while( !stack.empty() )
+      {
+      const IndexType index = stack.back();
+      stack.pop_back();
+      for( unsigned int i = 0; i < offsets.size(); i++ )
+        {
+        const IndexType neighbor = index + offsets[i];
+        if( region.IsInside( neighbor ) && mask->GetPixel( neighbor ) != 0
+            && labels->GetPixel( neighbor ) == 0 )
+          {
+          labels->SetPixel( neighbor, numberOfObjects );
+          stack.push_back( neighbor );
+          }
+        }
+      }
+    }
+  return labels;
+}
+
+template< class TImage >
+bool SameImages( const TImage * image1, const TImage * image2, const char * what )
+{
+  itk::ImageRegionConstIteratorWithIndex< TImage > it1(
+    image1, image1->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIteratorWithIndex< TImage > it2(
+    image2, image2->GetLargestPossibleRegion() );
+  for( ; !it1.IsAtEnd(); ++it1, ++it2 )
+    {
+    if( it1.Get() != it2.Get() )
+      {
+      std::cout << what << " differs at " << it1.GetIndex() << ": "
+                << it2.Get() << " instead of " << it1.Get() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+template< unsigned int VDimension >
+bool TestThreadedLabeling( unsigned int sizeValue )
+{
+  typedef itk::Image< unsigned char, VDimension > MaskImageType;
+  typedef itk::Image< unsigned long, VDimension > LabelImageType;
+
+  typedef itk::ConnectedComponentImageFilter< MaskImageType, LabelImageType > LabelerType;
+  typedef itk::RelabelComponentImageFilter< LabelImageType, LabelImageType >  RelabelerType;
+
+  typename MaskImageType::Pointer mask = CreateMask< MaskImageType >( sizeValue );
+
+  const int numberOfThreads[] = { 1, 2, 3, 7 };
+  for( unsigned int fullyConnected = 0; fullyConnected < 2; fullyConnected++ )
+    {
+    unsigned long numberOfObjects = 0;
+    typename LabelImageType::Pointer reference =
+      FloodFillReference< MaskImageType, LabelImageType >( mask, fullyConnected, numberOfObjects );
+    if( numberOfObjects < 20 )
+      {
+      std::cout << "Too few objects: " << numberOfObjects << std::endl;
+      return false;
+      }
+
+    typename RelabelerType::Pointer referenceRelabeler = RelabelerType::New();
+    referenceRelabeler->SetInput( reference );
+    referenceRelabeler->SetMinimumObjectSize( 3 );
+    referenceRelabeler->SetNumberOfThreads( 1 );
+    referenceRelabeler->Update();
+
+    for( unsigned int t = 0; t < 4; t++ )
+      {
+      typename LabelerType::Pointer labeler = LabelerType::New();
+      labeler->SetInput( mask );
+      labeler->SetFullyConnected( fullyConnected );
+      labeler->SetNumberOfThreads( numberOfThreads[t] );
+      labeler->Update();
+
+      if( labeler->GetObjectCount() != numberOfObjects )
+        {
+        std::cout << "Found " << labeler->GetObjectCount() << " objects instead of "
+                  << numberOfObjects << " with " << numberOfThreads[t] << " threads"
+                  << std::endl;
+        return false;
+        }
+      if( !SameImages< LabelImageType >( reference, labeler->GetOutput(), "Label" ) )
+        {
+        std::cout << "with " << numberOfThreads[t] << " threads" << std::endl;
+        return false;
+        }
+
+      // the background value is skipped by the object numbers
+      labeler->SetBackgroundValue( 5 );
+      labeler->Update();
+      itk::ImageRegionConstIteratorWithIndex< LabelImageType > rIt(
+        reference, reference->GetLargestPossibleRegion() );
+      itk::ImageRegionConstIteratorWithIndex< LabelImageType > lIt(
+        labeler->GetOutput(), reference->GetLargestPossibleRegion() );
+      for( ; !rIt.IsAtEnd(); ++rIt, ++lIt )
+        {
+        const unsigned long expected = rIt.Get() == 0 ? 5
+          : ( rIt.Get() <= 5 ? rIt.Get() - 1 : rIt.Get() );
+        if( lIt.Get() != expected )
+          {
+          std::cout << "Label with background value differs at " << rIt.GetIndex()
+                    << ": " << lIt.Get() << " instead of " << expected << std::endl;
+          return false;
+          }
+        }
+
+      typename RelabelerType::Pointer relabeler = RelabelerType::New();
+      relabeler->SetInput( labeler->GetOutput() );
+      relabeler->SetMinimumObjectSize( 3 );
+      relabeler->SetNumberOfThreads( numberOfThreads[t] );
+      labeler->SetBackgroundValue( 0 );
+      relabeler->Update();
+      if( !SameImages< LabelImageType >( referenceRelabeler->GetOutput(),
+                                         relabeler->GetOutput(), "Relabel" )
+          || relabeler->GetNumberOfObjects() != referenceRelabeler->GetNumberOfObjects()
+          || relabeler->GetOriginalNumberOfObjects() != numberOfObjects
+          || relabeler->GetSizeOfObjectsInPixels() != referenceRelabeler->GetSizeOfObjectsInPixels() )
+        {
+        std::cout << "Relabel differs with " << numberOfThreads[t] << " threads" << std::endl;
+        return false;
+        }
+      }
+
+    // labels too large for the dense histograms give the same result
+    typename LabelImageType::Pointer sparse = LabelImageType::New();
+    sparse->SetRegions( reference->GetLargestPossibleRegion() );
+    sparse->Allocate();
+    itk::ImageRegionConstIteratorWithIndex< LabelImageType > rIt(
+      reference, reference->GetLargestPossibleRegion() );
+    itk::ImageRegionIteratorWithIndex< LabelImageType > sIt(
+      sparse, reference->GetLargestPossibleRegion() );
+    for( ; !rIt.IsAtEnd(); ++rIt, ++sIt )
+      {
+      // keep the order of the labels of the objects of the same size
+      sIt.Set( rIt.Get() < 10 ? rIt.Get() : rIt.Get() * 100000 );
+      }
+    typename RelabelerType::Pointer relabeler = RelabelerType::New();
+    relabeler->SetInput( sparse );
+    relabeler->SetMinimumObjectSize( 3 );
+    relabeler->SetNumberOfThreads( 3 );
+    relabeler->InPlaceOn();
+    relabeler->Update();
+    if( !SameImages< LabelImageType >( referenceRelabeler->GetOutput(),
+                                       relabeler->GetOutput(), "Sparse relabel" ) )
+      {
+      return false;
+      }
+    }
+
+  return true;
+}
+}
+
+int itkConnectedComponentImageFilterThreadingTest(int, char* [] )
+{
+  bool passed = true;
+
+  passed &= TestThreadedLabeling< 2 >( 67 );
+  passed &= TestThreadedLabeling< 3 >( 23 );
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkDanielssonDistanceMapImageFilter.h"
+#include "itkSignedDanielssonDistanceMapImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include "vnl/vnl_math.h"
+
+#include <iostream>
+#include <vector>
+
+// Compare the separable algorithm with a brute force computation of the
+// exact Euclidean distance on images with a few labeled objects.
+namespace
+{
+template< unsigned int VDimension >
+bool TestSeparableAlgorithm( unsigned int sizeValue, bool useImageSpacing )
+{
+  typedef itk::Image< unsigned short, VDimension >                       ImageType;
+  typedef itk::Image< float, VDimension >                                DistanceImageType;
+  typedef itk::DanielssonDistanceMapImageFilter< ImageType, DistanceImageType > FilterType;
+  typedef typename FilterType::VectorImageType                           VectorImageType;
+  typedef typename ImageType::IndexType                                  IndexType;
+
+  typename ImageType::SizeType size;
+  size.Fill( sizeValue );
+  typename ImageType::IndexType start;
+  start.Fill( 3 );
+  typename ImageType::RegionType region( start, size );
+
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  image->FillBuffer( 0 );
+
+  typename ImageType::SpacingType spacing;
+  for( unsigned int j = 0; j < VDimension; j++ )
+    {
+    spacing[j] = 1.0 + 0.5 * j;
+    }
+  image->SetSpacing( spacing );
+
+  // pseudo random objects with a few labels
+  std::vector< IndexType > objects;
+  std::vector< unsigned short > labels;
+  unsigned long seed = 12345;
+  for( unsigned int n = 0; n < 5 * VDimension; n++ )
+    {
+    IndexType index;
+    for( unsigned int j = 0; j < VDimension; j++ )
+      {
+      seed = ( seed * 1103515245 + 12345 ) % 2147483648UL;
+      index[j] = start[j] + static_cast< long >( seed % sizeValue );
+      }
+    const unsigned short label = static_cast< unsigned short >( 1 + n % 4 );
+    image->SetPixel( index, label );
+    objects.push_back( index );
+    labels.push_back( label );
+    }
+
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+  filter->SetUseImageSpacing( useImageSpacing );
+  filter->SquaredDistanceOn();
+  filter->UseSeparableAlgorithmOn();
+  filter->SetNumberOfThreads( 3 );
+  filter->Update();
+
+  itk::ImageRegionIteratorWithIndex< DistanceImageType > distanceIt(
+    filter->GetDistanceMap(), region );
+  itk::ImageRegionIteratorWithIndex< DistanceImageType > voronoiIt(
+    filter->GetVoronoiMap(), region );
+  itk::ImageRegionIteratorWithIndex< VectorImageType > vectorIt(
+    filter->GetVectorDistanceMap(), region );
+  for( ; !distanceIt.IsAtEnd(); ++distanceIt, ++voronoiIt, ++vectorIt )
+    {
+    const IndexType index = distanceIt.GetIndex();
+
+    double minimum = itk::NumericTraits< double >::max();
+    for( unsigned int n = 0; n < objects.size(); n++ )
+      {
+      double distance = 0.0;
+      for( unsigned int j = 0; j < VDimension; j++ )
+        {
+        const double d = ( objects[n][j] - index[j] ) * ( useImageSpacing ? spacing[j] : 1.0 );
+        distance += d * d;
+        }
+      minimum = vnl_math_min( minimum, distance );
+      }
+
+    if( vnl_math_abs( distanceIt.Get() - minimum ) > 1e-3 * vnl_math_max( 1.0, minimum ) )
+      {
+      std::cout << "Distance at " << index << ": " << distanceIt.Get()
+                << " instead of " << minimum << std::endl;
+      return false;
+      }
+
+    // the vector points to an object at that distance, whose label is
+    // given by the Voronoi map
+    const IndexType closest = index + vectorIt.Get();
+    if( !region.IsInside( closest ) || image->GetPixel( closest ) == 0
+        || voronoiIt.Get() != image->GetPixel( closest ) )
+      {
+      std::cout << "Closest object of " << index << ": " << closest
+                << " with label " << voronoiIt.Get() << std::endl;
+      return false;
+      }
+    }
+
+  // The Danielsson algorithm never finds a closer object.
+  typename FilterType::Pointer danielsson = FilterType::New();
+  danielsson->SetInput( image );
+  danielsson->SetUseImageSpacing( useImageSpacing );
+  danielsson->SquaredDistanceOn();
+  danielsson->Update();
+
+  itk::ImageRegionIteratorWithIndex< DistanceImageType > danielssonIt(
+    danielsson->GetDistanceMap(), region );
+  unsigned long numberOfDifferences = 0;
+  for( distanceIt.GoToBegin(); !distanceIt.IsAtEnd(); ++distanceIt, ++danielssonIt )
+    {
+    if( danielssonIt.Get() < distanceIt.Get() - 1e-3 )
+      {
+      std::cout << "Danielsson distance at " << distanceIt.GetIndex() << " is "
+                << danielssonIt.Get() << " < " << distanceIt.Get() << std::endl;
+      return false;
+      }
+    if( danielssonIt.Get() != distanceIt.Get() )
+      {
+      numberOfDifferences++;
+      }
+    }
+  std::cout << "Dimension " << VDimension << ": " << numberOfDifferences
+            << " pixels closer than with the Danielsson algorithm" << std::endl;
+
+  return true;
+}
+}
+
+int itkDanielssonDistanceMapImageFilterSeparableTest(int, char* [] )
+{
+  bool passed = true;
+
+  passed &= TestSeparableAlgorithm< 2 >( 47, false );
+  passed &= TestSeparableAlgorithm< 2 >( 40, true );
+  passed &= TestSeparableAlgorithm< 3 >( 23, false );
+  passed &= TestSeparableAlgorithm< 3 >( 21, true );
+
+  // The signed filter uses the separable algorithm of its internal filters.
+  typedef itk::Image< unsigned char, 3 > ImageType;
+  typedef itk::Image< float, 3 >         DistanceImageType;
+  typedef itk::SignedDanielssonDistanceMapImageFilter< ImageType, DistanceImageType > SignedType;
+
+  ImageType::SizeType size;
+  size.Fill( 20 );
+  ImageType::RegionType region;
+  region.SetSize( size );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    double distance = 0.0;
+    for( unsigned int j = 0; j < 3; j++ )
+      {
+      distance += ( it.GetIndex()[j] - 9.5 ) * ( it.GetIndex()[j] - 9.5 );
+      }
+    it.Set( distance < 36.0 ? 1 : 0 );
+    }
+
+  SignedType::Pointer signedFilter = SignedType::New();
+  signedFilter->SetInput( image );
+  signedFilter->UseSeparableAlgorithmOn();
+  signedFilter->Update();
+
+  itk::ImageRegionIteratorWithIndex< DistanceImageType > signedIt(
+    signedFilter->GetDistanceMap(), region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it, ++signedIt )
+    {
+    if( ( it.Get() != 0 && signedIt.Get() > 0 ) || ( it.Get() == 0 && signedIt.Get() <= 0 ) )
+      {
+      std::cout << "Signed distance at " << it.GetIndex() << ": " << signedIt.Get() << std::endl;
+      passed = false;
+      break;
+      }
+    }
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,286 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkDiscreteGaussianImageFilter.h"
+#include "itkGaussianOperator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkVector.h"
+
+#include <iostream>
+#include <vector>
+
+// Compare the blocks of DiscreteGaussianImageFilter with a direct
+// separable convolution that repeats the pixels at the edges of the image,
+// for scalar and vector pixels, and its recursive mode with the discrete
+// kernels.
+namespace
+{
+const unsigned int Dimension = 3;
+typedef itk::Image< float, Dimension >  ImageType;
+typedef itk::Image< double, Dimension > RealImageType;
+typedef itk::Vector< float, 2 >              VectorType;
+typedef itk::Image< VectorType, Dimension > VectorImageType;
+
+ImageType::Pointer MakeImage(bool smooth)
+{
+  ImageType::SizeType size;
+  size[0] = 37;
+  size[1] = 29;
+  size[2] = 23;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = 1.0;
+  spacing[2] = 1.5;
+  image->SetSpacing(spacing);
+  image->Allocate();
+
+  unsigned long seed = 12345;
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    if ( smooth )
+      {
+      it.Set( static_cast< float >( 50.0 + 20.0 * vcl_sin(0.2 * index[0])
+                                    * vcl_cos(0.15 * index[1] + 0.1 * index[2]) ) );
+      }
+    else
+      {
+      seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+      it.Set( static_cast< float >( seed % 1000 ) / 10.0f );
+      }
+    }
+  return image;
+}
+
+// Convolve along one dimension, with the pixels beyond the edges
+// replaced by the nearest ones
+RealImageType::Pointer Convolve(const RealImageType *input, unsigned int direction,
+                                double variance)
+{
+  itk::GaussianOperator< double, Dimension > oper;
+  oper.SetDirection(direction);
+  oper.SetVariance(variance);
+  oper.SetMaximumError(0.01);
+  oper.SetMaximumKernelWidth(32);
+  oper.CreateDirectional();
+  const long radius = oper.GetRadius(direction);
+
+  const RealImageType::RegionType region = input->GetLargestPossibleRegion();
+  RealImageType::Pointer output = RealImageType::New();
+  output->SetRegions(region);
+  output->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< RealImageType > it(output, region);
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    double sum = 0.0;
+    for ( long j = -radius; j <= radius; j++ )
+      {
+      RealImageType::IndexType index = it.GetIndex();
+      index[direction] = vnl_math_min( vnl_math_max( index[direction] + j, 0L ),
+                                       static_cast< long >( region.GetSize(direction) ) - 1 );
+      sum += oper[j + radius] * input->GetPixel(index);
+      }
+    it.Set(sum);
+    }
+  return output;
+}
+
+RealImageType::Pointer Reference(const ImageType *image, double variance,
+                                 unsigned int filterDimensionality)
+{
+  RealImageType::Pointer result = RealImageType::New();
+  result->SetRegions( image->GetLargestPossibleRegion() );
+  result->Allocate();
+  itk::ImageRegionIteratorWithIndex< RealImageType > it( result, result->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    it.Set( image->GetPixel( it.GetIndex() ) );
+    }
+
+  for ( unsigned int i = 0; i < filterDimensionality; i++ )
+    {
+    const double spacing = image->GetSpacing()[i];
+    result = Convolve(result, i, variance / ( spacing * spacing ) );
+    }
+  return result;
+}
+
+template< class TImage >
+double Difference(const TImage *image, const RealImageType *reference,
+                  const typename TImage::RegionType & region)
+{
+  double difference = 0.0;
+  itk::ImageRegionConstIteratorWithIndex< TImage > it(image, region);
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    difference = vnl_math_max( difference, vcl_abs( static_cast< double >( it.Get() )
+                                                    - reference->GetPixel( it.GetIndex() ) ) );
+    }
+  return difference;
+}
+
+// Each component of a vector image is smoothed as a scalar image.
+bool TestVectorPixels()
+{
+  typedef itk::DiscreteGaussianImageFilter< VectorImageType, VectorImageType > FilterType;
+
+  ImageType::Pointer components[2];
+  components[0] = MakeImage(false);
+  components[1] = MakeImage(true);
+
+  VectorImageType::Pointer image = VectorImageType::New();
+  image->CopyInformation(components[0]);
+  image->SetRegions( components[0]->GetLargestPossibleRegion() );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< VectorImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    VectorType value;
+    value[0] = components[0]->GetPixel( it.GetIndex() );
+    value[1] = components[1]->GetPixel( it.GetIndex() );
+    it.Set(value);
+    }
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+  filter->SetVariance(3.0);
+  filter->SetNumberOfThreads(3);
+  filter->Update();
+
+  for ( unsigned int c = 0; c < 2; c++ )
+    {
+    RealImageType::Pointer reference = Reference(components[c], 3.0, Dimension);
+    itk::ImageRegionConstIteratorWithIndex< VectorImageType > outIt( filter->GetOutput(),
+                                                                      image->GetLargestPossibleRegion() );
+    for ( ; !outIt.IsAtEnd(); ++outIt )
+      {
+      const double expected = reference->GetPixel( outIt.GetIndex() );
+      if ( vcl_abs( outIt.Get()[c] - expected ) > 1e-3 )
+        {
+        std::cout << "Vector pixels: component " << c << " at " << outIt.GetIndex()
+                  << " is " << outIt.Get()[c] << " instead of " << expected << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+}
+
+int itkDiscreteGaussianImageFilterBlockTest(int, char* [] )
+{
+  typedef itk::DiscreteGaussianImageFilter< ImageType, ImageType > FilterType;
+
+  bool passed = true;
+
+  ImageType::Pointer image = MakeImage(false);
+
+  // whole and partial outputs, with one and several threads
+  const double       variances[] = { 0.5, 3.0 };
+  const unsigned int dimensionalities[] = { 3, 2 };
+  for ( unsigned int v = 0; v < 2; v++ )
+    {
+    RealImageType::Pointer reference = Reference(image, variances[v], dimensionalities[v]);
+
+    for ( int threads = 1; threads <= 3; threads += 2 )
+      {
+      for ( unsigned int partial = 0; partial < 2; partial++ )
+        {
+        ImageType::RegionType region = image->GetLargestPossibleRegion();
+        if ( partial )
+          {
+          region.SetIndex(0, 3);
+          region.SetSize(0, 20);
+          region.SetIndex(2, 10);
+          region.SetSize(2, 12);
+          }
+
+        FilterType::Pointer filter = FilterType::New();
+        filter->SetInput(image);
+        filter->SetVariance(variances[v]);
+        filter->SetFilterDimensionality(dimensionalities[v]);
+        filter->SetNumberOfThreads(threads);
+        filter->GetOutput()->SetRequestedRegion(region);
+        filter->Update();
+
+        const double difference = Difference(filter->GetOutput(), reference, region);
+        if ( difference > 1e-3 )
+          {
+          std::cout << "Variance " << variances[v] << ", " << threads << " threads, "
+                    << ( partial ? "partial" : "whole" ) << " output: largest difference "
+                    << difference << std::endl;
+          passed = false;
+          }
+        }
+      }
+    }
+
+  // the recursive filters are used above the threshold, and smooth as
+  // much as the discrete kernels
+  ImageType::Pointer smoothImage = MakeImage(true);
+  FilterType::Pointer discrete = FilterType::New();
+  discrete->SetInput(smoothImage);
+  discrete->SetVariance(4.0);
+  discrete->Update();
+
+  FilterType::Pointer recursive = FilterType::New();
+  recursive->SetInput(smoothImage);
+  recursive->SetVariance(4.0);
+  recursive->SetRecursiveGaussianThreshold(5);
+  recursive->Update();
+
+  RealImageType::Pointer discreteResult = Reference(smoothImage, 4.0, Dimension);
+  if ( Difference( discrete->GetOutput(), discreteResult,
+                   smoothImage->GetLargestPossibleRegion() ) > 1e-3 )
+    {
+    std::cout << "The discrete kernels differ from the reference" << std::endl;
+    passed = false;
+    }
+
+  // away from the edges, where the boundary conditions differ
+  ImageType::RegionType inside = smoothImage->GetLargestPossibleRegion();
+  for ( unsigned int i = 0; i < Dimension; i++ )
+    {
+    inside.SetIndex( i, inside.GetIndex(i) + 6 );
+    inside.SetSize( i, inside.GetSize(i) - 12 );
+    }
+  const double recursiveDifference = Difference(recursive->GetOutput(), discreteResult, inside);
+  std::cout << "Recursive Gaussian: largest difference " << recursiveDifference << std::endl;
+  if ( recursiveDifference > 0.5 )
+    {
+    passed = false;
+    }
+
+  passed &= TestVectorPixels();
+
+  if ( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
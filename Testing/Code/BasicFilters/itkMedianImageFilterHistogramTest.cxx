@@ -0,0 +1,132 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkMedianImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <iostream>
+
+// The median of the pixel types with up to 16 bits is computed with a
+// sliding histogram. It must be the same as the median found by sorting
+// the neighborhoods of the same values stored as floats.
+namespace
+{
+template< class TPixel, unsigned int VDimension >
+bool TestHistogramMedian( unsigned int sizeValue, long minimum, long maximum )
+{
+  typedef itk::Image< TPixel, VDimension >                         ImageType;
+  typedef itk::Image< float, VDimension >                          FloatImageType;
+  typedef itk::MedianImageFilter< ImageType, ImageType >           FilterType;
+  typedef itk::MedianImageFilter< FloatImageType, FloatImageType > FloatFilterType;
+
+  typename ImageType::SizeType size;
+  size.Fill( sizeValue );
+  size[0] += 3;
+  typename ImageType::RegionType region;
+  region.SetSize( size );
+
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  typename FloatImageType::Pointer floatImage = FloatImageType::New();
+  floatImage->SetRegions( region );
+  floatImage->Allocate();
+
+  // noise over the whole range, with smooth areas of few values
+  unsigned long seed = 1234;
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  itk::ImageRegionIteratorWithIndex< FloatImageType > floatIt( floatImage, region );
+  for( ; !it.IsAtEnd(); ++it, ++floatIt )
+    {
+    seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+    long value = minimum + static_cast< long >( ( seed >> 8 ) % ( maximum - minimum + 1 ) );
+    if( it.GetIndex()[0] < static_cast< long >( sizeValue / 2 ) )
+      {
+      value = minimum + ( value - minimum ) % 5 + it.GetIndex()[1];
+      }
+    it.Set( static_cast< TPixel >( value ) );
+    floatIt.Set( static_cast< float >( value ) );
+    }
+
+  typename FloatFilterType::Pointer reference = FloatFilterType::New();
+  reference->SetInput( floatImage );
+
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+
+  const int numberOfThreads[] = { 1, 3 };
+  for( unsigned int r = 0; r < 3; r++ )
+    {
+    typename ImageType::SizeType radius;
+    for( unsigned int j = 0; j < VDimension; j++ )
+      {
+      radius[j] = ( r + j ) % 3;
+      }
+    reference->SetRadius( radius );
+    reference->Update();
+
+    for( unsigned int t = 0; t < 2; t++ )
+      {
+      filter->SetRadius( radius );
+      filter->SetNumberOfThreads( numberOfThreads[t] );
+      filter->Update();
+
+      itk::ImageRegionIteratorWithIndex< FloatImageType > refIt(
+        reference->GetOutput(), region );
+      itk::ImageRegionIteratorWithIndex< ImageType > outIt(
+        filter->GetOutput(), region );
+      for( ; !refIt.IsAtEnd(); ++refIt, ++outIt )
+        {
+        if( static_cast< float >( outIt.Get() ) != refIt.Get() )
+          {
+          std::cout << "Median with radius " << radius << " and "
+                    << numberOfThreads[t] << " threads differs at " << refIt.GetIndex()
+                    << ": " << static_cast< double >( outIt.Get() ) << " instead of "
+                    << refIt.Get() << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+
+  return true;
+}
+}
+
+int itkMedianImageFilterHistogramTest(int, char* [] )
+{
+  bool passed = true;
+
+  passed &= TestHistogramMedian< unsigned char, 2 >( 31, 0, 255 );
+  passed &= TestHistogramMedian< unsigned short, 2 >( 29, 0, 65535 );
+  passed &= TestHistogramMedian< short, 2 >( 27, -3000, 3000 );
+  passed &= TestHistogramMedian< signed char, 3 >( 11, -128, 127 );
+  passed &= TestHistogramMedian< unsigned short, 3 >( 12, 100, 4000 );
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkNeighborhoodOperatorImageFilter.h"
+#include "itkNeighborhoodInnerProduct.h"
+#include "itkConstNeighborhoodIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <iostream>
+
+// Compare NeighborhoodOperatorImageFilter with the inner products of a
+// neighborhood iterator, for operators of several widths along the first
+// dimension, with one and several threads.  The coefficients are added
+// in the same order, so the results must be equal.
+namespace
+{
+const unsigned int Dimension = 3;
+typedef itk::Image< float, Dimension >         ImageType;
+typedef itk::Neighborhood< double, Dimension > OperatorType;
+
+bool TestOperator(const ImageType *image, const OperatorType & oper, int threads)
+{
+  typedef itk::NeighborhoodOperatorImageFilter< ImageType, ImageType, double > FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+  filter->SetOperator(oper);
+  filter->SetNumberOfThreads(threads);
+  filter->Update();
+
+  itk::ZeroFluxNeumannBoundaryCondition< ImageType > boundaryCondition;
+  itk::NeighborhoodInnerProduct< ImageType, double > innerProduct;
+  itk::ConstNeighborhoodIterator< ImageType > nit( oper.GetRadius(), image,
+                                                   image->GetLargestPossibleRegion() );
+  nit.OverrideBoundaryCondition(&boundaryCondition);
+
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it( filter->GetOutput(),
+                                                          image->GetLargestPossibleRegion() );
+  for ( nit.GoToBegin(); !nit.IsAtEnd(); ++nit, ++it )
+    {
+    const float expected = static_cast< float >( innerProduct(nit, oper) );
+    if ( it.Get() != expected )
+      {
+      std::cout << "Radius " << oper.GetRadius() << ", " << threads << " threads: "
+                << it.Get() << " instead of " << expected << " at " << it.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int itkNeighborhoodOperatorImageFilterInteriorTest(int, char* [] )
+{
+  ImageType::SizeType size;
+  size[0] = 23;
+  size[1] = 17;
+  size[2] = 12;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+
+  unsigned long seed = 7;
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+    it.Set( static_cast< float >( seed % 1000 ) / 7.0f );
+    }
+
+  // widths 1, 3 and 5 along the first dimension
+  const unsigned long radii[][Dimension] = { { 0, 2, 1 }, { 1, 1, 1 }, { 2, 1, 0 } };
+
+  bool passed = true;
+  for ( unsigned int r = 0; r < 3; r++ )
+    {
+    OperatorType::SizeType radius;
+    for ( unsigned int i = 0; i < Dimension; i++ )
+      {
+      radius[i] = radii[r][i];
+      }
+    OperatorType oper;
+    oper.SetRadius(radius);
+    for ( unsigned int n = 0; n < oper.Size(); n++ )
+      {
+      oper[n] = 0.1 * ( n % 7 ) - 0.25;
+      }
+
+    for ( int threads = 1; threads <= 3; threads += 2 )
+      {
+      passed &= TestOperator(image, oper, threads);
+      }
+    }
+
+  if ( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
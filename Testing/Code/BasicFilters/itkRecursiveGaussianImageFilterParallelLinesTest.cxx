@@ -0,0 +1,116 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkRecursiveGaussianImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "vnl/vnl_math.h"
+
+#include <iostream>
+
+// Filter the lines of an image in batches of several sizes, along each
+// direction and with several threads, and check that the results do not
+// depend on the batches.
+namespace
+{
+template< class TImage >
+bool TestParallelLines( TImage *image )
+{
+  typedef itk::RecursiveGaussianImageFilter< TImage, TImage > FilterType;
+
+  const unsigned int numberOfParallelLines[] = { 1, 3, 8, 16 };
+  const int          numberOfThreads[] = { 1, 3 };
+
+  for( unsigned int direction = 0; direction < TImage::ImageDimension; direction++ )
+    {
+    for( int order = 0; order < 3; order++ )
+      {
+      typename TImage::Pointer reference;
+      for( unsigned int n = 0; n < 4; n++ )
+        {
+        for( unsigned int t = 0; t < 2; t++ )
+          {
+          typename FilterType::Pointer filter = FilterType::New();
+          filter->SetInput( image );
+          filter->SetDirection( direction );
+          filter->SetSigma( 1.5 );
+          filter->SetOrder( static_cast< typename FilterType::OrderEnumType >( order ) );
+          filter->SetNumberOfParallelLines( numberOfParallelLines[n] );
+          filter->SetNumberOfThreads( numberOfThreads[t] );
+          filter->Update();
+
+          if( !reference )
+            {
+            reference = filter->GetOutput();
+            reference->DisconnectPipeline();
+            continue;
+            }
+
+          itk::ImageRegionIterator< TImage > it( filter->GetOutput(),
+                                                 filter->GetOutput()->GetLargestPossibleRegion() );
+          itk::ImageRegionIterator< TImage > rit( reference, reference->GetLargestPossibleRegion() );
+          for( ; !it.IsAtEnd(); ++it, ++rit )
+            {
+            if( vnl_math_abs( it.Get() - rit.Get() ) > 1e-5 * ( 1.0 + vnl_math_abs( rit.Get() ) ) )
+              {
+              std::cout << "Direction " << direction << ", order " << order << ", "
+                        << numberOfParallelLines[n] << " lines and " << numberOfThreads[t]
+                        << " threads: " << it.Get() << " instead of " << rit.Get()
+                        << " at " << it.GetIndex() << std::endl;
+              return false;
+              }
+            }
+          }
+        }
+      }
+    }
+  return true;
+}
+}
+
+int itkRecursiveGaussianImageFilterParallelLinesTest(int, char* [] )
+{
+  typedef itk::Image< float, 3 > ImageType;
+
+  ImageType::SizeType size;
+  size[0] = 13;
+  size[1] = 7;
+  size[2] = 5;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+
+  unsigned long seed = 1234;
+  itk::ImageRegionIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+    it.Set( static_cast< float >( seed % 1000 ) );
+    }
+
+  if( !TestParallelLines< ImageType >( image ) )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
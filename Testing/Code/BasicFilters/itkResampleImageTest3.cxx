@@ -0,0 +1,189 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include <iostream>
+
+#include "itkAffineTransform.h"
+#include "itkImage.h"
+#include "itkResampleImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// The resample filter only inlines the interpolators whose exact type it
+// knows. These subclasses do not change the interpolation, so they force
+// the generic code path and give the reference output.
+namespace
+{
+template< class TImage, class TCoordRep >
+class ReferenceLinearInterpolator:
+  public itk::LinearInterpolateImageFunction< TImage, TCoordRep >
+{
+public:
+  typedef ReferenceLinearInterpolator Self;
+  typedef itk::SmartPointer< Self >   Pointer;
+  itkNewMacro(Self);
+};
+
+template< class TImage, class TCoordRep >
+class ReferenceNearestNeighborInterpolator:
+  public itk::NearestNeighborInterpolateImageFunction< TImage, TCoordRep >
+{
+public:
+  typedef ReferenceNearestNeighborInterpolator Self;
+  typedef itk::SmartPointer< Self >            Pointer;
+  itkNewMacro(Self);
+};
+
+template< class TImage >
+bool CompareResampledImages( TImage * input,
+                             const typename TImage::SizeType & size,
+                             itk::InterpolateImageFunction< TImage, double > * fastInterpolator,
+                             itk::InterpolateImageFunction< TImage, double > * referenceInterpolator )
+{
+  const unsigned int Dimension = TImage::ImageDimension;
+
+  typedef itk::AffineTransform< double, Dimension > TransformType;
+  typename TransformType::Pointer transform = TransformType::New();
+  typename TransformType::OutputVectorType translation;
+  for( unsigned int i = 0; i < Dimension; i++ )
+    {
+    translation[i] = 1.7 + 0.3 * i;
+    }
+  transform->Translate( translation );
+  transform->Rotate( 0, 1, 0.3 );
+  transform->Scale( 0.9 );
+
+  typedef itk::ResampleImageFilter< TImage, TImage > ResampleType;
+  typename ResampleType::Pointer fast = ResampleType::New();
+  fast->SetInput( input );
+  fast->SetTransform( transform );
+  fast->SetInterpolator( fastInterpolator );
+  fast->SetSize( size );
+  fast->SetDefaultPixelValue( 7 );
+  fast->Update();
+
+  typename ResampleType::Pointer reference = ResampleType::New();
+  reference->SetInput( input );
+  reference->SetTransform( transform );
+  reference->SetInterpolator( referenceInterpolator );
+  reference->SetSize( size );
+  reference->SetDefaultPixelValue( 7 );
+  reference->Update();
+
+  itk::ImageRegionIteratorWithIndex< TImage > fastIt(
+    fast->GetOutput(), fast->GetOutput()->GetLargestPossibleRegion() );
+  itk::ImageRegionIteratorWithIndex< TImage > referenceIt(
+    reference->GetOutput(), reference->GetOutput()->GetLargestPossibleRegion() );
+
+  unsigned long numberOfDefaultPixels = 0;
+  for( ; !fastIt.IsAtEnd(); ++fastIt, ++referenceIt )
+    {
+    if( fastIt.Get() != referenceIt.Get() )
+      {
+      std::cout << "Pixel " << fastIt.GetIndex() << ": "
+                << static_cast< double >( fastIt.Get() ) << " != "
+                << static_cast< double >( referenceIt.Get() ) << std::endl;
+      return false;
+      }
+    if( fastIt.Get() == 7 )
+      {
+      numberOfDefaultPixels++;
+      }
+    }
+
+  // The transform moves part of the output outside of the input
+  if( numberOfDefaultPixels == 0 )
+    {
+    std::cout << "No pixel mapped outside of the input" << std::endl;
+    return false;
+    }
+
+  return true;
+}
+
+template< class TPixel, unsigned int VDimension >
+bool TestInlinedInterpolators( unsigned int sizeValue )
+{
+  typedef itk::Image< TPixel, VDimension > ImageType;
+
+  typename ImageType::SizeType size;
+  size.Fill( sizeValue );
+  typename ImageType::RegionType region;
+  region.SetSize( size );
+
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    double value = 0.0;
+    for( unsigned int i = 0; i < VDimension; i++ )
+      {
+      value += 1.37 * ( i + 1 ) * it.GetIndex()[i];
+      }
+    it.Set( static_cast< TPixel >( vcl_fmod( value, 250.0 ) ) );
+    }
+
+  typedef itk::LinearInterpolateImageFunction< ImageType, double >          LinearType;
+  typedef itk::NearestNeighborInterpolateImageFunction< ImageType, double > NearestType;
+
+  typename LinearType::Pointer linear = LinearType::New();
+  typename ReferenceLinearInterpolator< ImageType, double >::Pointer
+    referenceLinear = ReferenceLinearInterpolator< ImageType, double >::New();
+  if( !CompareResampledImages< ImageType >( image, size, linear, referenceLinear ) )
+    {
+    std::cout << "Linear interpolation differs in dimension " << VDimension << std::endl;
+    return false;
+    }
+
+  typename NearestType::Pointer nearest = NearestType::New();
+  typename ReferenceNearestNeighborInterpolator< ImageType, double >::Pointer
+    referenceNearest = ReferenceNearestNeighborInterpolator< ImageType, double >::New();
+  if( !CompareResampledImages< ImageType >( image, size, nearest, referenceNearest ) )
+    {
+    std::cout << "Nearest neighbor interpolation differs in dimension " << VDimension << std::endl;
+    return false;
+    }
+
+  return true;
+}
+}
+
+int itkResampleImageTest3(int, char* [] )
+{
+  bool passed = true;
+
+  passed &= TestInlinedInterpolators< float, 2 >( 41 );
+  passed &= TestInlinedInterpolators< unsigned char, 2 >( 40 );
+  passed &= TestInlinedInterpolators< float, 3 >( 21 );
+  passed &= TestInlinedInterpolators< short, 3 >( 20 );
+  passed &= TestInlinedInterpolators< float, 4 >( 9 );
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -280,6 +280,37 @@ int itkWindowedSincInterpolateImageFunctionTest(int, char* [] )
     flag = 1;
     }
 
+  /* Compare the kernel lookup table with the direct evaluation of the
+     kernel, inside the image and near its borders */
+  InterpolatorType::Pointer tableInterp = InterpolatorType::New();
+  tableInterp->UseKernelLookupTableOn();
+  tableInterp->SetKernelLookupTableResolution( 500 );
+  tableInterp->SetInputImage( image );
+  tableInterp->Print( std::cout );
+
+  double maximumDifference = 0.0;
+  for( unsigned int k = 0; k < 200; k++ )
+    {
+    for( unsigned int j = 0; j < ImageDimension; j++ )
+      {
+      cindex[j] = ( size[j] - 1 ) * ( ( k * ( 7 + 3 * j ) ) % 101 ) / 100.0 + 0.013 * j;
+      }
+    const double difference = vnl_math_abs(
+      tableInterp->EvaluateAtContinuousIndex( cindex ) -
+      interp->EvaluateAtContinuousIndex( cindex ) );
+    if( difference > maximumDifference )
+      {
+      maximumDifference = difference;
+      }
+    }
+  std::cout << "Maximum difference with the lookup table: "
+            << maximumDifference << std::endl;
+  if( maximumDifference > 1e-3 )
+    {
+    std::cout << "*** Error: the lookup table is not accurate enough" << std::endl;
+    flag = 1;
+    }
+
   /* Return results of test */
   if (flag != 0)
     {
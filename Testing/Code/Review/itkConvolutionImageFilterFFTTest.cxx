@@ -0,0 +1,195 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkConvolutionImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <iostream>
+
+// Convolve with the Fourier transforms, in one tile and in many, and
+// compare with the spatial convolution.
+namespace
+{
+template< class TImage >
+typename TImage::Pointer CreateImage( const typename TImage::SizeType & size, double frequency )
+{
+  const unsigned int Dimension = TImage::ImageDimension;
+
+  typename TImage::RegionType region;
+  region.SetSize( size );
+
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions( region );
+  image->Allocate();
+
+  unsigned long seed = 4321;
+  itk::ImageRegionIteratorWithIndex< TImage > it( image, region );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+    double value = 20.0 + ( seed % 10 );
+    for( unsigned int j = 0; j < Dimension; j++ )
+      {
+      value += 10.0 * vcl_sin( frequency * ( j + 1 ) * it.GetIndex()[j] );
+      }
+    it.Set( static_cast< typename TImage::PixelType >( value ) );
+    }
+  return image;
+}
+
+template< class TImage >
+bool SameImages( const TImage * reference, const TImage * image,
+                 const typename TImage::RegionType & region, double tolerance )
+{
+  itk::ImageRegionConstIteratorWithIndex< TImage > refIt( reference, region );
+  itk::ImageRegionConstIteratorWithIndex< TImage > it( image, region );
+  for( ; !refIt.IsAtEnd(); ++refIt, ++it )
+    {
+    const double difference = static_cast< double >( refIt.Get() ) - it.Get();
+    if( vnl_math_abs( difference ) > tolerance )
+      {
+      std::cout << "Pixel " << refIt.GetIndex() << ": "
+                << static_cast< double >( it.Get() ) << " instead of "
+                << static_cast< double >( refIt.Get() ) << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+template< class TImage >
+bool TestFFTConvolution( const typename TImage::SizeType & size,
+                         const typename TImage::SizeType & kernelSize,
+                         bool normalize, double tolerance )
+{
+  typedef itk::ConvolutionImageFilter< TImage > FilterType;
+
+  typename TImage::Pointer image = CreateImage< TImage >( size, 0.3 );
+  typename TImage::Pointer kernel = CreateImage< TImage >( kernelSize, 0.9 );
+
+  typename FilterType::Pointer spatial = FilterType::New();
+  spatial->SetInput( image );
+  spatial->SetImageKernelInput( kernel );
+  spatial->SetNormalize( normalize );
+  spatial->SetConvolutionMethodToSpatial();
+  spatial->Update();
+
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+  filter->SetImageKernelInput( kernel );
+  filter->SetNormalize( normalize );
+  filter->SetConvolutionMethodToFFT();
+  filter->Update();
+  if( filter->GetLastConvolutionMethod() != FilterType::FFTConvolution
+      || !SameImages< TImage >( spatial->GetOutput(), filter->GetOutput(),
+                                image->GetLargestPossibleRegion(), tolerance ) )
+    {
+    std::cout << "FFT convolution differs" << std::endl;
+    return false;
+    }
+
+  // tiles that do not divide the image
+  filter->SetMaximumNumberOfFFTPixels( 1000 );
+  filter->Update();
+  if( !SameImages< TImage >( spatial->GetOutput(), filter->GetOutput(),
+                             image->GetLargestPossibleRegion(), tolerance ) )
+    {
+    std::cout << "Tiled FFT convolution differs" << std::endl;
+    return false;
+    }
+
+  // a requested region away from the borders of the image
+  typename TImage::RegionType region = image->GetLargestPossibleRegion();
+  region.PadByRadius( -3 );
+  region.SetSize( 0, region.GetSize()[0] - 4 );
+  spatial->GetOutput()->SetRequestedRegion( region );
+  spatial->Update();
+  filter->GetOutput()->SetRequestedRegion( region );
+  filter->Update();
+  if( !SameImages< TImage >( spatial->GetOutput(), filter->GetOutput(), region, tolerance ) )
+    {
+    std::cout << "FFT convolution of a region differs" << std::endl;
+    return false;
+    }
+
+  return true;
+}
+}
+
+int itkConvolutionImageFilterFFTTest(int, char* [] )
+{
+  typedef itk::Image< float, 2 >         ImageType2D;
+  typedef itk::Image< unsigned char, 2 > CharImageType2D;
+  typedef itk::Image< double, 3 >        ImageType3D;
+
+  bool passed = true;
+
+  ImageType2D::SizeType size2D;
+  size2D[0] = 47;
+  size2D[1] = 38;
+  ImageType2D::SizeType kernelSize2D;
+  kernelSize2D[0] = 9;
+  kernelSize2D[1] = 5;
+  passed &= TestFFTConvolution< ImageType2D >( size2D, kernelSize2D, false, 1e-2 );
+  passed &= TestFFTConvolution< ImageType2D >( size2D, kernelSize2D, true, 1e-4 );
+  passed &= TestFFTConvolution< CharImageType2D >( size2D, kernelSize2D, true, 1.0 );
+
+  ImageType3D::SizeType size3D;
+  size3D[0] = 23;
+  size3D[1] = 19;
+  size3D[2] = 17;
+  ImageType3D::SizeType kernelSize3D;
+  kernelSize3D[0] = 7;
+  kernelSize3D[1] = 3;
+  kernelSize3D[2] = 5;
+  passed &= TestFFTConvolution< ImageType3D >( size3D, kernelSize3D, true, 1e-8 );
+
+  // the automatic method keeps the spatial convolution for small kernels
+  // and uses the Fourier transforms for large ones
+  typedef itk::ConvolutionImageFilter< ImageType3D > FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( CreateImage< ImageType3D >( size3D, 0.3 ) );
+  kernelSize3D.Fill( 3 );
+  filter->SetImageKernelInput( CreateImage< ImageType3D >( kernelSize3D, 0.9 ) );
+  filter->Update();
+  if( filter->GetLastConvolutionMethod() != FilterType::SpatialConvolution )
+    {
+    std::cout << "The 3x3x3 kernel is not applied in the spatial domain" << std::endl;
+    passed = false;
+    }
+  kernelSize3D.Fill( 15 );
+  filter->SetImageKernelInput( CreateImage< ImageType3D >( kernelSize3D, 0.9 ) );
+  filter->Update();
+  if( filter->GetLastConvolutionMethod() != FilterType::FFTConvolution )
+    {
+    std::cout << "The 15x15x15 kernel is not applied with the FFT" << std::endl;
+    passed = false;
+    }
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,275 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkMorphologicalWatershedFromMarkersImageFilter.h"
+#include "itkConstShapedNeighborhoodIterator.h"
+#include "itkConnectedComponentAlgorithm.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <map>
+#include <queue>
+#include <vector>
+#include <iostream>
+
+// Compare MorphologicalWatershedFromMarkersImageFilter with a flooding by
+// index, with the neighbors and the boundary conditions of the shaped
+// neighborhood iterators the filter used before it flooded flat buffers.
+// The images have large plateaus, where the order of the queue decides
+// the labels and the watershed lines.
+namespace
+{
+template< class TInputImage, class TLabelImage >
+typename TLabelImage::Pointer
+FloodByIndex( const TInputImage *input, const TLabelImage *markers,
+              bool markWatershedLine, bool fullyConnected )
+{
+  typedef typename TInputImage::PixelType            InputPixelType;
+  typedef typename TLabelImage::PixelType            LabelPixelType;
+  typedef typename TLabelImage::IndexType            IndexType;
+  typedef typename TLabelImage::OffsetType           OffsetType;
+  typedef itk::Image< unsigned char, TLabelImage::ImageDimension > StatusImageType;
+  typedef std::queue< IndexType >                    QueueType;
+  typedef std::map< InputPixelType, QueueType >      MapType;
+
+  const typename TLabelImage::RegionType region = markers->GetLargestPossibleRegion();
+
+  // the neighbors, in the order of a shaped neighborhood iterator
+  typename TLabelImage::SizeType radius;
+  radius.Fill( 1 );
+  itk::ConstShapedNeighborhoodIterator< TLabelImage > shapedIt( radius, markers, region );
+  itk::setConnectivity( &shapedIt, fullyConnected );
+  std::vector< OffsetType > neighbors;
+  typename itk::ConstShapedNeighborhoodIterator< TLabelImage >::ConstIterator nIt;
+  for( nIt = shapedIt.Begin(); nIt != shapedIt.End(); nIt++ )
+    {
+    neighbors.push_back( nIt.GetNeighborhoodOffset() );
+    }
+
+  typename TLabelImage::Pointer output = TLabelImage::New();
+  output->SetRegions( region );
+  output->Allocate();
+  typename StatusImageType::Pointer status = StatusImageType::New();
+  status->SetRegions( region );
+  status->Allocate();
+
+  itk::ImageRegionConstIteratorWithIndex< TLabelImage > mIt( markers, region );
+  for( mIt.GoToBegin(); !mIt.IsAtEnd(); ++mIt )
+    {
+    output->SetPixel( mIt.GetIndex(), mIt.Get() );
+    status->SetPixel( mIt.GetIndex(), mIt.Get() != 0 );
+    }
+
+  MapType fah;
+  for( mIt.GoToBegin(); !mIt.IsAtEnd(); ++mIt )
+    {
+    if( mIt.Get() == 0 )
+      {
+      continue;
+      }
+    bool haveBgNeighbor = false;
+    for( unsigned int n = 0; n < neighbors.size(); n++ )
+      {
+      const IndexType q = mIt.GetIndex() + neighbors[n];
+      if( region.IsInside( q ) && markers->GetPixel( q ) == 0 )
+        {
+        haveBgNeighbor = true;
+        if( markWatershedLine && !status->GetPixel( q ) )
+          {
+          fah[input->GetPixel( q )].push( q );
+          status->SetPixel( q, 1 );
+          }
+        }
+      }
+    if( !markWatershedLine && haveBgNeighbor )
+      {
+      fah[input->GetPixel( mIt.GetIndex() )].push( mIt.GetIndex() );
+      }
+    }
+
+  while( !fah.empty() )
+    {
+    const InputPixelType currentValue = fah.begin()->first;
+    QueueType            currentQueue = fah.begin()->second;
+    fah.erase( fah.begin() );
+
+    while( !currentQueue.empty() )
+      {
+      const IndexType current = currentQueue.front();
+      currentQueue.pop();
+
+      if( markWatershedLine )
+        {
+        // a pixel next to two markers stays on the watershed line
+        LabelPixelType marker = 0;
+        bool           collision = false;
+        for( unsigned int n = 0; n < neighbors.size() && !collision; n++ )
+          {
+          const IndexType q = current + neighbors[n];
+          const LabelPixelType o = region.IsInside( q ) ? output->GetPixel( q ) : 0;
+          if( o != 0 )
+            {
+            collision = ( marker != 0 && o != marker );
+            marker = o;
+            }
+          }
+        if( collision )
+          {
+          continue;
+          }
+        output->SetPixel( current, marker );
+        for( unsigned int n = 0; n < neighbors.size(); n++ )
+          {
+          const IndexType q = current + neighbors[n];
+          if( region.IsInside( q ) && !status->GetPixel( q ) )
+            {
+            const InputPixelType value = input->GetPixel( q );
+            if( value <= currentValue )
+              {
+              currentQueue.push( q );
+              }
+            else
+              {
+              fah[value].push( q );
+              }
+            status->SetPixel( q, 1 );
+            }
+          }
+        }
+      else
+        {
+        const LabelPixelType marker = output->GetPixel( current );
+        for( unsigned int n = 0; n < neighbors.size(); n++ )
+          {
+          const IndexType q = current + neighbors[n];
+          if( region.IsInside( q ) && output->GetPixel( q ) == 0 )
+            {
+            output->SetPixel( q, marker );
+            const InputPixelType value = input->GetPixel( q );
+            if( value <= currentValue )
+              {
+              currentQueue.push( q );
+              }
+            else
+              {
+              fah[value].push( q );
+              }
+            }
+          }
+        }
+      }
+    }
+  return output;
+}
+
+template< class TInputImage, class TLabelImage >
+bool TestFlooding( const char *name, const typename TInputImage::SizeType & size,
+                   unsigned int levels )
+{
+  typedef itk::MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage > FilterType;
+
+  typename TInputImage::RegionType region;
+  region.SetSize( size );
+
+  typename TInputImage::Pointer input = TInputImage::New();
+  input->SetRegions( region );
+  input->Allocate();
+  typename TLabelImage::Pointer markers = TLabelImage::New();
+  markers->SetRegions( region );
+  markers->Allocate();
+
+  // few gray levels, so the plateaus are large, and a few markers, some
+  // of them on the border of the image or next to each other
+  unsigned long seed = 1234;
+  itk::ImageRegionIteratorWithIndex< TInputImage > iIt( input, region );
+  itk::ImageRegionIteratorWithIndex< TLabelImage > mIt( markers, region );
+  for( ; !iIt.IsAtEnd(); ++iIt, ++mIt )
+    {
+    seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+    iIt.Set( static_cast< typename TInputImage::PixelType >( ( seed >> 8 ) % levels ) );
+    seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+    mIt.Set( ( seed >> 8 ) % 97 == 0 ? static_cast< typename TLabelImage::PixelType >( 1 + ( seed >> 16 ) % 5 ) : 0 );
+    }
+
+  for( unsigned int markWatershedLine = 0; markWatershedLine < 2; markWatershedLine++ )
+    {
+    for( unsigned int fullyConnected = 0; fullyConnected < 2; fullyConnected++ )
+      {
+      typename FilterType::Pointer filter = FilterType::New();
+      filter->SetInput( input );
+      filter->SetMarkerImage( markers );
+      filter->SetMarkWatershedLine( markWatershedLine != 0 );
+      filter->SetFullyConnected( fullyConnected != 0 );
+      filter->Update();
+
+      typename TLabelImage::Pointer baseline =
+        FloodByIndex( input.GetPointer(), markers.GetPointer(),
+                      markWatershedLine != 0, fullyConnected != 0 );
+
+      itk::ImageRegionConstIteratorWithIndex< TLabelImage > it( filter->GetOutput(), region );
+      itk::ImageRegionConstIteratorWithIndex< TLabelImage > bIt( baseline, region );
+      for( ; !bIt.IsAtEnd(); ++it, ++bIt )
+        {
+        if( it.Get() != bIt.Get() )
+          {
+          std::cout << name << " with MarkWatershedLine " << markWatershedLine
+                    << " and FullyConnected " << fullyConnected << " at "
+                    << bIt.GetIndex() << ": "
+                    << static_cast< typename itk::NumericTraits< typename TLabelImage::PixelType >::PrintType >( it.Get() )
+                    << " instead of "
+                    << static_cast< typename itk::NumericTraits< typename TLabelImage::PixelType >::PrintType >( bIt.Get() )
+                    << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+  return true;
+}
+}
+
+int itkMorphologicalWatershedFromMarkersImageFilterTest2(int, char* [] )
+{
+  typedef itk::Image< unsigned char, 2 >  UCharImageType;
+  typedef itk::Image< float, 3 >          FloatImageType;
+  typedef itk::Image< unsigned char, 2 >  LabelImageType;
+  typedef itk::Image< unsigned short, 3 > Label3DImageType;
+
+  bool passed = true;
+
+  UCharImageType::SizeType size2D = {{ 67, 41 }};
+  passed &= TestFlooding< UCharImageType, LabelImageType >( "2D", size2D, 4 );
+
+  FloatImageType::SizeType size3D = {{ 23, 19, 13 }};
+  passed &= TestFlooding< FloatImageType, Label3DImageType >( "3D", size3D, 3 );
+
+  // a line of pixels
+  UCharImageType::SizeType line = {{ 200, 1 }};
+  passed &= TestFlooding< UCharImageType, LabelImageType >( "Line", line, 2 );
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
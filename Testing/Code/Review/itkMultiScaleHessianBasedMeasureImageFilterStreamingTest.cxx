@@ -0,0 +1,144 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkHessianToObjectnessMeasureImageFilter.h"
+#include "itkMultiScaleHessianBasedMeasureImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <iostream>
+
+// Compare the responses computed over streamed blocks with the responses
+// computed over the whole image, on two crossing synthetic tubes.
+namespace
+{
+typedef itk::Image< float, 3 >                        ImageType;
+typedef itk::NumericTraits< float >::RealType         RealType;
+typedef itk::SymmetricSecondRankTensor< RealType, 3 > HessianPixelType;
+typedef itk::Image< HessianPixelType, 3 >             HessianImageType;
+typedef itk::HessianToObjectnessMeasureImageFilter< HessianImageType, ImageType >
+                                                      ObjectnessFilterType;
+typedef itk::MultiScaleHessianBasedMeasureImageFilter< ImageType, HessianImageType, ImageType >
+                                                      MultiScaleFilterType;
+
+ImageType::Pointer MakeTubes(unsigned int size)
+{
+  ImageType::SizeType imageSize;
+  imageSize.Fill(size);
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(imageSize);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    // a slanted tube along z and a thinner one along y
+    const double x1 = index[0] - size / 2.0 + 0.2 * index[2];
+    const double y1 = index[1] - size / 2.0;
+    const double x2 = index[0] - size / 3.0;
+    const double z2 = index[2] - size / 2.0;
+    it.Set( static_cast< float >( 100.0 * vcl_exp( -( x1 * x1 + y1 * y1 ) / 8.0 )
+                                  + 60.0 * vcl_exp( -( x2 * x2 + z2 * z2 ) / 3.0 ) ) );
+    }
+  return image;
+}
+
+MultiScaleFilterType::Pointer MakeFilter(ImageType *image, unsigned int divisions)
+{
+  ObjectnessFilterType::Pointer objectness = ObjectnessFilterType::New();
+  objectness->SetObjectDimension(1);
+  objectness->SetBrightObject(true);
+
+  MultiScaleFilterType::Pointer filter = MultiScaleFilterType::New();
+  filter->SetInput(image);
+  filter->SetHessianToMeasureFilter(objectness);
+  filter->SetSigmaMinimum(1.0);
+  filter->SetSigmaMaximum(3.0);
+  filter->SetNumberOfSigmaSteps(4);
+  filter->SetGenerateScalesOutput(true);
+  filter->SetNumberOfStreamDivisions(divisions);
+  filter->Update();
+  return filter;
+}
+}
+
+int itkMultiScaleHessianBasedMeasureImageFilterStreamingTest(int, char* [] )
+{
+  ImageType::Pointer image = MakeTubes(40);
+
+  MultiScaleFilterType::Pointer reference = MakeFilter(image, 1);
+
+  bool passed = true;
+  const unsigned int divisions[] = { 2, 5 };
+  for ( unsigned int d = 0; d < 2; d++ )
+    {
+    MultiScaleFilterType::Pointer streamed = MakeFilter(image, divisions[d]);
+
+    itk::ImageRegionConstIterator< ImageType > refIt( reference->GetOutput(),
+                                                      image->GetLargestPossibleRegion() );
+    itk::ImageRegionConstIterator< ImageType > it( streamed->GetOutput(),
+                                                   image->GetLargestPossibleRegion() );
+    double maximum = 0.0;
+    double difference = 0.0;
+    for ( ; !refIt.IsAtEnd(); ++refIt, ++it )
+      {
+      maximum = vnl_math_max( maximum, static_cast< double >( vnl_math_abs( refIt.Get() ) ) );
+      difference = vnl_math_max( difference,
+                                 static_cast< double >( vnl_math_abs( refIt.Get() - it.Get() ) ) );
+      }
+    std::cout << divisions[d] << " divisions: largest difference " << difference
+              << " for a largest response " << maximum << std::endl;
+    if ( maximum == 0.0 || difference > 1e-3 * maximum )
+      {
+      passed = false;
+      }
+
+    // the same scales where the tubes respond
+    typedef MultiScaleFilterType::ScalesImageType ScalesImageType;
+    itk::ImageRegionConstIterator< ScalesImageType > refScalesIt( reference->GetScalesOutput(),
+                                                                  image->GetLargestPossibleRegion() );
+    itk::ImageRegionConstIterator< ScalesImageType > scalesIt( streamed->GetScalesOutput(),
+                                                               image->GetLargestPossibleRegion() );
+    unsigned long mismatches = 0;
+    for ( refIt.GoToBegin(); !refIt.IsAtEnd(); ++refIt, ++refScalesIt, ++scalesIt )
+      {
+      if ( refIt.Get() > 0.1 * maximum && refScalesIt.Get() != scalesIt.Get() )
+        {
+        mismatches++;
+        }
+      }
+    if ( mismatches > 0 )
+      {
+      std::cout << mismatches << " scales differ with " << divisions[d] << " divisions" << std::endl;
+      passed = false;
+      }
+    }
+
+  if ( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
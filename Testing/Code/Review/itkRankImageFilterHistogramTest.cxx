@@ -0,0 +1,144 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkRankImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+// The rank filter uses an array histogram for the pixel types with up to
+// 16 bits and a sorted window for the others, which becomes a map for the
+// large windows. All must give the rank found by partially sorting the
+// neighborhood cropped at the image boundary.
+namespace
+{
+template< class TPixel, unsigned int VDimension >
+bool TestRankHistogram( unsigned int sizeValue, double minimum, double maximum,
+                        unsigned int radiusValue = 0 )
+{
+  typedef itk::Image< TPixel, VDimension >                         ImageType;
+  typedef itk::FlatStructuringElement< VDimension >                KernelType;
+  typedef itk::RankImageFilter< ImageType, ImageType, KernelType > FilterType;
+
+  typename ImageType::SizeType size;
+  size.Fill( sizeValue );
+  size[0] += 4;
+  typename ImageType::RegionType region;
+  region.SetSize( size );
+
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+
+  // noise over the whole range, with smooth areas of few values
+  unsigned long seed = 4321;
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    seed = ( 1103515245 * seed + 12345 ) % 2147483648UL;
+    double value = minimum + ( maximum - minimum ) * ( ( seed >> 8 ) % 100000 ) / 99999.0;
+    if( it.GetIndex()[1] < static_cast< long >( sizeValue / 3 ) )
+      {
+      value = minimum + ( seed >> 8 ) % 4 + it.GetIndex()[0];
+      }
+    it.Set( static_cast< TPixel >( value ) );
+    }
+
+  typename KernelType::RadiusType radius;
+  for( unsigned int j = 0; j < VDimension; j++ )
+    {
+    radius[j] = radiusValue ? radiusValue : 1 + j % 2;
+    }
+
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+  filter->SetKernel( KernelType::Box( radius ) );
+  filter->SetNumberOfThreads( 3 );
+
+  const float ranks[] = { 0.0f, 0.3f, 0.5f, 1.0f };
+  std::vector< TPixel > values;
+  for( unsigned int r = 0; r < 4; r++ )
+    {
+    filter->SetRank( ranks[r] );
+    filter->Update();
+
+    itk::ImageRegionIteratorWithIndex< ImageType > outIt( filter->GetOutput(), region );
+    for( ; !outIt.IsAtEnd(); ++outIt )
+      {
+      // the neighborhood cropped at the image boundary
+      typename ImageType::RegionType neighborhood;
+      neighborhood.SetIndex( outIt.GetIndex() - radius );
+      neighborhood.SetSize( KernelType::Box( radius ).GetSize() );
+      neighborhood.Crop( region );
+
+      values.clear();
+      itk::ImageRegionIteratorWithIndex< ImageType > nIt( image, neighborhood );
+      for( ; !nIt.IsAtEnd(); ++nIt )
+        {
+        values.push_back( nIt.Get() );
+        }
+      const typename std::vector< TPixel >::iterator rankIt =
+        values.begin() + (unsigned long)( ranks[r] * ( values.size() - 1 ) );
+      std::nth_element( values.begin(), rankIt, values.end() );
+      const TPixel expected = *rankIt;
+
+      if( outIt.Get() != expected )
+        {
+        std::cout << "Rank " << ranks[r] << " in dimension " << VDimension
+                  << " differs at " << outIt.GetIndex() << ": "
+                  << static_cast< double >( outIt.Get() ) << " instead of "
+                  << static_cast< double >( expected ) << std::endl;
+        return false;
+        }
+      }
+    }
+
+  return true;
+}
+}
+
+int itkRankImageFilterHistogramTest(int, char* [] )
+{
+  bool passed = true;
+
+  passed &= TestRankHistogram< unsigned char, 2 >( 23, 0, 255 );
+  passed &= TestRankHistogram< unsigned short, 2 >( 25, 0, 65535 );
+  passed &= TestRankHistogram< short, 2 >( 21, -20000, 20000 );
+  passed &= TestRankHistogram< float, 2 >( 22, -1.5, 3.5 );
+  passed &= TestRankHistogram< int, 2 >( 20, -100000, 100000 );
+  passed &= TestRankHistogram< unsigned short, 3 >( 9, 1000, 40000 );
+  passed &= TestRankHistogram< double, 3 >( 8, 0, 1 );
+
+  // windows of more than 16 kilobytes
+  passed &= TestRankHistogram< int, 2 >( 72, -100000, 100000, 33 );
+  passed &= TestRankHistogram< double, 2 >( 58, -1.0, 1.0, 25 );
+
+  if( !passed )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -44,6 +44,7 @@ void RegisterTests()
 
   REGISTER_TEST(itkMorphologicalWatershedImageFilterTest);
   REGISTER_TEST(itkMorphologicalWatershedFromMarkersImageFilterTest);
+  REGISTER_TEST(itkMorphologicalWatershedFromMarkersImageFilterTest2);
 
   REGISTER_TEST(itkBinaryMorphologicalClosingImageFilterTest);
   REGISTER_TEST(itkBinaryMorphologicalOpeningImageFilterTest);
@@ -115,6 +116,7 @@ void RegisterTests()
   REGISTER_TEST( itkMapRankImageFilterTest );
   REGISTER_TEST( itkMaskedRankImageFilterTest );
   REGISTER_TEST( itkMapMaskedRankImageFilterTest );
+  REGISTER_TEST( itkRankImageFilterHistogramTest );
   REGISTER_TEST( itkFastApproximateRankImageFilterTest );
 
   REGISTER_TEST( itkOptGrayscaleMorphologicalClosingImageFilterTest );
@@ -133,6 +135,7 @@ void RegisterTests()
 
   REGISTER_TEST( itkConvolutionImageFilterTest );
   REGISTER_TEST( itkConvolutionImageFilterTestInt );
+  REGISTER_TEST( itkConvolutionImageFilterFFTTest );
 
   REGISTER_TEST( itkShapedFloodFilledImageFunctionConditionalConstIteratorTest1 );
   REGISTER_TEST( itkShapedFloodFilledImageFunctionConditionalConstIteratorTest2 );
@@ -145,4 +148,5 @@ void RegisterTests()
 
   REGISTER_TEST( itkHessianToObjectnessMeasureImageFilterTest );
   REGISTER_TEST( itkMultiScaleHessianBasedMeasureImageFilterTest );
+  REGISTER_TEST( itkMultiScaleHessianBasedMeasureImageFilterStreamingTest );
 }